@@ -0,0 +1,144 @@
+/**
+ * Clasp bytecode native code benchmark
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Benchmark Suite
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * Kernels shipped as native code in a module, called through asm, against the bytecode functions they fall back to,
+ * in the threaded loop, the cached loop and with the JIT. Build with -DCMAKE_BUILD_TYPE=Release for meaningful
+ * numbers.
+*/
+
+#include <clasp/clasp.h>
+#include <clasp/bytecode_emit.h>
+#include <clasp/lower.h>
+#include <clasp/peephole.h>
+#include <clasp/resolve.h>
+#include <clasp/stringstream.h>
+#include <clasp/vm.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+// Kernels `k`, called `%d` times with the loop's `i` and total `t`, and their x86-64 code
+static const struct {
+    const char *name;
+    const char *src;
+    const char *call;
+    const char *blob;
+    size_t size;
+} KERNELS[] = {
+    { "mix",      "fn k(a: long, b: long) -> long { return a * 31 + b; }", "k(t, i)",
+      "\x48\x8b\x07\x48\x6b\xc0\x1f\x48\x03\x47\x08\xc3", 12 },                 // mov, imul, add, ret
+    { "popcount", "fn k(x: long) -> long { var n: long = 0; while (x > 0) { n += x % 2; x = x / 2; } return n; }", "k(i)",
+      "\xf3\x48\x0f\xb8\x07\xc3", 6 },                                          // popcnt rax, [rdi]; ret
+};
+
+static int64_t sink;
+
+static ClaspVMCell quiet_println(ClaspVMCell *args) {
+    sink += args[0].i;
+    return (ClaspVMCell) { 0 };
+}
+
+static ClaspBytecode *compile(const char *kernel, const char *call, int n) {
+    char src[1024];
+    snprintf(src, sizeof(src), "%s\nvar t: long = 0;\nfor (var i: int = 0; i < %d; i++) { t += %s; }\nprintln(t);\n",
+             kernel, n, call);
+    StringStream *stream = new_sstream(src);
+    ClaspLexer *lexer = calloc(1, sizeof(ClaspLexer));
+    new_lexer(lexer, (StreamReadFn)&sstream_read, stream);
+    ClaspParser *parser = malloc(sizeof(ClaspParser));
+    new_parser(parser, lexer);
+    ClaspASTNode *ast = parser_compile(parser);
+    if (typecheck(ast)) return NULL;
+    ast = lower_pow(ast);
+    ClaspResolution res;
+    ast_resolve(ast, &res);
+    ClaspBytecode *bc = bytecode_emit(ast, &res);
+    resolution_free(&res);
+    if (bc) bytecode_peephole(bc);
+    return bc;
+}
+
+// Switch calls of function 0, `k`, to asm of native code entry 0 or back. They're encoded the same size.
+static void swap_calls(ClaspBytecode *bc, ClaspOpcode from, ClaspOpcode to) {
+    ClaspBytecodeInst inst;
+    for (size_t pc = 0; bytecode_decode(bc->code, cvector_size(bc->code), pc, &inst); pc += inst.size)
+        if (inst.op == from && inst.args[0] == 0) bc->code[pc] = to;
+}
+
+// Best of `iterations` runs, in ms.
+static double time_run(ClaspBytecode *bc, ClaspVMDispatch dispatch, int iterations) {
+    double best = 1e30;
+    for (int it = 0; it < iterations; ++it) {
+        ClaspVM vm;
+        if (!vm_init(&vm, bc)) fprintf(stderr, "Error: %s\n", vm.error);
+        vm.dispatch = dispatch;
+        vm_define(&vm, "println", &quiet_println, 1, 0);
+        double start = now_ms();
+        if (!vm_run(&vm)) fprintf(stderr, "Runtime error %s\n", vm.error);
+        double ms = now_ms() - start;
+        if (ms < best) best = ms;
+        vm_free(&vm);
+    }
+    return best;
+}
+
+int main(int argc, char **argv) {
+    int n          = argc > 1 ? atoi(argv[1]) : 1000000;
+    int iterations = argc > 2 ? atoi(argv[2]) : 5;
+
+    if (!CLASP_VM_HAS_NATIVE) printf("(no native code on this platform, asm runs the fallbacks)\n");
+    const struct {
+        const char *name;
+        ClaspVMDispatch dispatch;
+    } STYLES[] = { { "threaded", CLASP_VM_THREADED }, { "cached", CLASP_VM_CACHED }, { "jit", CLASP_VM_JIT } };
+    printf("%-9s %-9s %11s %11s %9s\n", "kernel", "dispatch", "bytecode", "asm", "speedup");
+    for (size_t k = 0; k < sizeof(KERNELS) / sizeof(KERNELS[0]); ++k) {
+        ClaspBytecode *bc = compile(KERNELS[k].src, KERNELS[k].call, n);
+        if (!bc) return -1;
+        bytecode_native(bc, 0);
+        bytecode_native_blob(bc, 0, CLB_ARCH_X86_64_LINUX, KERNELS[k].blob, KERNELS[k].size);
+        for (size_t s = 0; s < sizeof(STYLES) / sizeof(STYLES[0]); ++s) {
+            double fallback = time_run(bc, STYLES[s].dispatch, iterations);
+            swap_calls(bc, OP_CALL, OP_ASM);
+            double native = time_run(bc, STYLES[s].dispatch, iterations);
+            swap_calls(bc, OP_ASM, OP_CALL);
+            printf("%-9s %-9s %8.2f ms %8.2f ms %8.2fx\n", KERNELS[k].name, STYLES[s].name, fallback, native,
+                   fallback / native);
+        }
+        bytecode_free(bc);
+    }
+    printf("(checksum %" PRId64 ")\n", sink);
+    return 0;
+}
@@ -0,0 +1,95 @@
+/**
+ * Clasp AST cache load benchmark
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Benchmark Suite
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * Compares loading a module from an AST cache against lexing and parsing it again.
+ * Build with -DCMAKE_BUILD_TYPE=Release for meaningful numbers.
+*/
+
+#include <clasp/lexer.h>
+#include <clasp/parser.h>
+#include <clasp/ast_cache.h>
+#include <clasp/stringstream.h>
+#include <cvector/cvector.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+// A module with many small functions, close to what our generators emit.
+static char *make_source(int n_functions) {
+    cvector(char) src = NULL;
+    char line[256];
+    for (int i = 0; i < n_functions; ++i) {
+        int len = snprintf(line, sizeof(line),
+            "fn helper%d(a: int, b: int) -> int { var t: int = a * %d + b; while (t > 100) { t = t - (a + b) * 2; } return t; }\n", i, i);
+        for (int j = 0; j < len; ++j) cvector_push_back(src, line[j]);
+    }
+    const char *tail = "var result: int = helper0(1, 2);\n\n";
+    for (size_t j = 0; j <= strlen(tail); ++j) cvector_push_back(src, tail[j]);
+    return src;
+}
+
+static ClaspASTNode *parse(char *src) {
+    StringStream *stream = new_sstream(src);
+    ClaspLexer *lexer = calloc(1, sizeof(ClaspLexer));
+    new_lexer(lexer, (StreamReadFn)&sstream_read, stream);
+    ClaspParser *parser = malloc(sizeof(ClaspParser));
+    new_parser(parser, lexer);
+    return parser_compile(parser);
+}
+
+int main(int argc, char **argv) {
+    int n_functions = argc > 1 ? atoi(argv[1]) : 500;
+    int iterations  = argc > 2 ? atoi(argv[2]) : 20;
+    char *src = make_source(n_functions);
+
+    double start = now_ms();
+    ClaspASTNode *ast = NULL;
+    for (int i = 0; i < iterations; ++i) ast = parse(src);
+    double parse_ms = (now_ms() - start) / iterations;
+
+    if (!ast_cache_write(ast, "ast_cache_bench.clast")) return 1;
+
+    start = now_ms();
+    for (int i = 0; i < iterations; ++i) {
+        ClaspASTCache *cache = ast_cache_load("ast_cache_bench.clast");
+        if (!cache) return 1;
+        ast_cache_free(cache);
+    }
+    double load_ms = (now_ms() - start) / iterations;
+    remove("ast_cache_bench.clast");
+
+    printf("functions: %d, source bytes: %zu\n", n_functions, cvector_size(src));
+    printf("parse:      %10.3f ms\n", parse_ms);
+    printf("cache load: %10.3f ms (%.1fx faster)\n", load_ms, parse_ms / load_ms);
+    return 0;
+}
@@ -0,0 +1,128 @@
+/**
+ * Clasp dead code elimination benchmark
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Benchmark Suite
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * A generated module where only a few of many helpers are used, compiled with and without ast_dce().
+ * Reports the tree size, the size of the emitted AST cache and the time spent in the passes after DCE.
+ * Build with -DCMAKE_BUILD_TYPE=Release for meaningful numbers.
+*/
+
+#include <clasp/lexer.h>
+#include <clasp/parser.h>
+#include <clasp/typecheck.h>
+#include <clasp/fold.h>
+#include <clasp/dce.h>
+#include <clasp/licm.h>
+#include <clasp/lower.h>
+#include <clasp/walk.h>
+#include <clasp/ast_cache.h>
+#include <clasp/stringstream.h>
+#include <cvector/cvector.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+// Helpers call each other in chains of `used`, the program only calls the last helper of every fourth chain.
+static char *make_source(int n_functions, int used) {
+    cvector(char) src = NULL;
+    char line[256];
+    for (int i = 0; i < n_functions; ++i) {
+        int len = i % used == 0
+            ? snprintf(line, sizeof(line), "fn helper%d(a: int, b: int) -> int { var t: int = a * %d + b; while (t > 100) { t = t - (a + b) ^ 2; } return t; }\n", i, i)
+            : snprintf(line, sizeof(line), "fn helper%d(a: int, b: int) -> int { var t: int = helper%d(a, b) * %d; while (t > 100) { t = t - (a + b) ^ 2; } return t; }\n", i, i - 1, i);
+        for (int j = 0; j < len; ++j) cvector_push_back(src, line[j]);
+    }
+    for (int i = used - 1; i < n_functions; i += used * 4) {
+        int len = snprintf(line, sizeof(line), "println(helper%d(%d, 2));\n", i, i);
+        for (int j = 0; j < len; ++j) cvector_push_back(src, line[j]);
+    }
+    cvector_push_back(src, '\n');
+    cvector_push_back(src, '\0');
+    return src;
+}
+
+static ClaspASTNode *parse(char *src) {
+    StringStream *stream = new_sstream(src);
+    ClaspLexer *lexer = calloc(1, sizeof(ClaspLexer));
+    new_lexer(lexer, (StreamReadFn)&sstream_read, stream);
+    ClaspParser *parser = malloc(sizeof(ClaspParser));
+    new_parser(parser, lexer);
+    return parser_compile(parser);
+}
+
+static uint64_t count_nodes(ClaspASTNode *ast) {
+    ClaspASTStats stats = { 0 };
+    ClaspASTPass pass = ast_stats_pass(&stats);
+    ast_walk(ast, &pass, 1);
+    return stats.total;
+}
+
+static void run(char *src, int iterations, bool dce) {
+    double dce_ms = 0, rest_ms = 0;
+    uint64_t nodes = 0;
+    long bytes = 0;
+    for (int i = 0; i < iterations; ++i) {
+        ClaspASTNode *ast = parse(src);
+        if (typecheck(ast) > 0) exit(1);
+        ast = ast_fold(ast);
+
+        double start = now_ms();
+        if (dce) ast = ast_dce(ast);
+        dce_ms += now_ms() - start;
+        nodes = count_nodes(ast);
+
+        start = now_ms();
+        ast = lower_pow(ast_licm(ast));
+        if (!ast_cache_write(ast, "dce_bench.clast")) exit(1);
+        rest_ms += now_ms() - start;
+    }
+    FILE *f = fopen("dce_bench.clast", "rb");
+    fseek(f, 0, SEEK_END);
+    bytes = ftell(f);
+    fclose(f);
+    remove("dce_bench.clast");
+
+    printf("%-9s nodes: %8llu   output: %9ld bytes   dce: %8.3f ms   later passes: %8.3f ms\n", dce ? "with" : "without",
+        (unsigned long long) nodes, bytes, dce_ms / iterations, rest_ms / iterations);
+}
+
+int main(int argc, char **argv) {
+    int n_functions = argc > 1 ? atoi(argv[1]) : 1000;
+    int used        = argc > 2 ? atoi(argv[2]) : 10;
+    int iterations  = argc > 3 ? atoi(argv[3]) : 10;
+    char *src = make_source(n_functions, used);
+
+    printf("functions: %d, source bytes: %zu\n", n_functions, cvector_size(src));
+    run(src, iterations, false);
+    run(src, iterations, true);
+    return 0;
+}
@@ -0,0 +1,113 @@
+/**
+ * Clasp fused AST walker benchmark
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Benchmark Suite
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * Runs three analyses over a large tree, first as three separate walks and then fused into one.
+ * Build with -DCMAKE_BUILD_TYPE=Release for meaningful numbers.
+*/
+
+#include <clasp/lexer.h>
+#include <clasp/parser.h>
+#include <clasp/stringstream.h>
+#include <clasp/walk.h>
+#include <cvector/cvector.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static char *make_source(int n_functions) {
+    cvector(char) src = NULL;
+    char line[256];
+    for (int i = 0; i < n_functions; ++i) {
+        int len = snprintf(line, sizeof(line),
+            "fn helper%d(a: int, b: int) -> int {\nvar t: int = a * %d + b;\nwhile (t > 100) { t = t - (a + b) * 2; }\nreturn t;\n}\n", i, i);
+        for (int j = 0; j < len; ++j) cvector_push_back(src, line[j]);
+    }
+    const char *tail = "var result: int = helper0(1, 2);\n\n";
+    for (size_t j = 0; j <= strlen(tail); ++j) cvector_push_back(src, tail[j]);
+    return src;
+}
+
+// Constant checking: count expressions the parser proved constant.
+static void *count_const(ClaspASTNode *node, void *args) {
+    if (node->exprType && (node->exprType->flag & TYPE_CONST)) ++*(uint64_t *) args;
+    return NULL;
+}
+
+// Name resolution stand-in: hash every referenced name.
+static void *hash_name(ClaspASTNode *node, void *args) {
+    uint64_t *h = args;
+    for (char *c = node->data.var_ref.varname->data; *c; ++c) *h = (*h ^ (uint8_t)*c) * 0x100000001b3ull;
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    int n_functions = argc > 1 ? atoi(argv[1]) : 2000;
+    int iterations  = argc > 2 ? atoi(argv[2]) : 50;
+
+    StringStream *stream = new_sstream(make_source(n_functions));
+    ClaspLexer *lexer = calloc(1, sizeof(ClaspLexer));
+    new_lexer(lexer, (StreamReadFn)&sstream_read, stream);
+    ClaspParser *parser = malloc(sizeof(ClaspParser));
+    new_parser(parser, lexer);
+    ClaspASTNode *ast = parser_compile(parser);
+
+    ClaspASTVisitor const_pre = {
+        [AST_EXPR_BINOP] = &count_const, [AST_EXPR_UNOP] = &count_const, [AST_EXPR_POSTFIX] = &count_const,
+        [AST_EXPR_LIT_NUMBER] = &count_const, [AST_EXPR_VAR_REF] = &count_const, [AST_EXPR_FN_CALL] = &count_const,
+    };
+    ClaspASTVisitor name_pre = { [AST_EXPR_VAR_REF] = &hash_name };
+
+    ClaspASTStats stats = { 0 };
+    uint64_t consts = 0, names = 0;
+    ClaspASTPass passes[] = {
+        ast_stats_pass(&stats),
+        { const_pre, NULL, &consts },
+        { name_pre,  NULL, &names  },
+    };
+    const size_t n_passes = sizeof(passes) / sizeof(passes[0]);
+
+    double start = now_ms();
+    for (int i = 0; i < iterations; ++i)
+        for (size_t j = 0; j < n_passes; ++j) ast_walk(ast, &passes[j], 1);
+    double separate_ms = (now_ms() - start) / iterations;
+
+    start = now_ms();
+    for (int i = 0; i < iterations; ++i) ast_walk(ast, passes, n_passes);
+    double fused_ms = (now_ms() - start) / iterations;
+
+    printf("nodes: %lu, passes: %zu (checksums %lu %lu)\n", (unsigned long)(stats.total / (2 * iterations)), n_passes,
+           (unsigned long) consts, (unsigned long) names);
+    printf("separate walks: %8.3f ms\n", separate_ms);
+    printf("fused walk:     %8.3f ms (%.2fx)\n", fused_ms, separate_ms / fused_ms);
+    return 0;
+}
@@ -0,0 +1,128 @@
+/**
+ * Clasp bytecode JIT benchmark
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Benchmark Suite
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * Hot functions run by the bytecode VM's threaded loop, its cached loop, and with the JIT, which compiles them once
+ * they've been called CLASP_JIT_THRESHOLD times; the time includes compiling. Build with -DCMAKE_BUILD_TYPE=Release
+ * for meaningful numbers.
+*/
+
+#include <clasp/clasp.h>
+#include <clasp/bytecode_emit.h>
+#include <clasp/jit.h>
+#include <clasp/lower.h>
+#include <clasp/peephole.h>
+#include <clasp/resolve.h>
+#include <clasp/stringstream.h>
+#include <clasp/vm.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+// Kernels, `%d` is the trip count of the loop in `k`, which is called 1000 times
+static const struct {
+    const char *name;
+    const char *src;
+} KERNELS[] = {
+    { "sum",    "fn k(n: int) -> long { var s: long = 0; for (var i: int = 0; i < n; i++) { s += i; } return s; }" },
+    { "mixed",  "fn k(n: int) -> long { var s: long = 0; var m: short = 3; for (var i: int = 0; i < n; i++) { var b: byte = i; s += b * m + i; } return s; }" },
+    { "divmod", "fn k(n: int) -> long { var s: int = 0; for (var i: int = 1; i < n; i++) { s += i % 7 + i / 13; } return s; }" },
+    { "float",  "fn k(n: int) -> long { var x: double = 0; for (var i: int = 0; i < n; i++) { x = x * 0.5 + 1.0; } return x; }" },
+    { "calls",  "fn sq(x: int) -> int { return x * x; }\nfn k(n: int) -> long { var s: long = 0; for (var i: int = 0; i < n; i++) { s += sq(i); } return s; }" },
+    { "fib",    "fn fib(n: int) -> int { if (n < 2) { return n; } return fib(n - 1) + fib(n - 2); }\nfn k(n: int) -> long { return fib(n / 200 + 8); }" },
+};
+
+static int64_t sink;
+
+static ClaspVMCell quiet_println(ClaspVMCell *args) {
+    sink += args[0].i;
+    return (ClaspVMCell) { 0 };
+}
+
+static ClaspBytecode *compile(const char *kernel, int n) {
+    char src[1024];
+    snprintf(src, sizeof(src), "%s\nvar t: long = 0;\nfor (var r: int = 0; r < 1000; r++) { t += k(%d); }\nprintln(t);\n",
+             kernel, n);
+    StringStream *stream = new_sstream(src);
+    ClaspLexer *lexer = calloc(1, sizeof(ClaspLexer));
+    new_lexer(lexer, (StreamReadFn)&sstream_read, stream);
+    ClaspParser *parser = malloc(sizeof(ClaspParser));
+    new_parser(parser, lexer);
+    ClaspASTNode *ast = parser_compile(parser);
+    if (typecheck(ast)) return NULL;
+    ast = lower_pow(ast);
+    ClaspResolution res;
+    ast_resolve(ast, &res);
+    ClaspBytecode *bc = bytecode_emit(ast, &res);
+    resolution_free(&res);
+    if (bc) bytecode_peephole(bc);
+    return bc;
+}
+
+// Best of `iterations` runs, in ms, each in a fresh VM so the JIT compiles every time.
+static double time_run(ClaspBytecode *bc, ClaspVMDispatch dispatch, int iterations) {
+    double best = 1e30;
+    for (int it = 0; it < iterations; ++it) {
+        ClaspVM vm;
+        if (!vm_init(&vm, bc)) fprintf(stderr, "Error: %s\n", vm.error);
+        vm.dispatch = dispatch;
+        vm_define(&vm, "println", &quiet_println, 1, 0);
+        double start = now_ms();
+        if (!vm_run(&vm)) fprintf(stderr, "Runtime error %s\n", vm.error);
+        double ms = now_ms() - start;
+        if (ms < best) best = ms;
+        vm_free(&vm);
+    }
+    return best;
+}
+
+int main(int argc, char **argv) {
+    int n          = argc > 1 ? atoi(argv[1]) : 2000;
+    int iterations = argc > 2 ? atoi(argv[2]) : 5;
+
+    if (!CLASP_VM_HAS_JIT) printf("(no JIT on this platform, the jit column is the cached loop)\n");
+    printf("%-8s %11s %11s %11s %9s %9s\n", "kernel", "threaded", "cached", "jit", "/threaded", "/cached");
+    for (size_t k = 0; k < sizeof(KERNELS) / sizeof(KERNELS[0]); ++k) {
+        ClaspBytecode *bc = compile(KERNELS[k].src, n);
+        if (!bc) return -1;
+        double threaded = time_run(bc, CLASP_VM_THREADED, iterations);
+        double cached = time_run(bc, CLASP_VM_CACHED, iterations);
+        double jit = time_run(bc, CLASP_VM_JIT, iterations);
+        printf("%-8s %8.2f ms %8.2f ms %8.2f ms %8.2fx %8.2fx\n", KERNELS[k].name, threaded, cached, jit,
+               threaded / jit, cached / jit);
+        bytecode_free(bc);
+    }
+    printf("(checksum %" PRId64 ")\n", sink);
+    return 0;
+}
@@ -0,0 +1,112 @@
+/**
+ * Clasp loop-invariant code motion benchmark
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Benchmark Suite
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * Loops written the way transpile_gcc emits them before and after ast_licm().
+ * The invariants here are runtime calls (what lower_pow() turns `k ^ e` into), which the C compiler can't hoist on
+ * its own: clasp_ipow lives in another translation unit and pow may set errno. Plain arithmetic invariants are
+ * already hoisted by gcc, so they only pay off for targets without an optimizer of their own.
+ * Build with -DCMAKE_BUILD_TYPE=Release for meaningful numbers.
+*/
+
+#include <clasp/runtime.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+// s += x[i] * k ^ e
+static int64_t scale_before(const int *x, int n, int k, int e) {
+    int64_t s = 0;
+    for (int i = 0; i < n; ++i) s += x[i] * clasp_ipow(k, e);
+    return s;
+}
+static int64_t scale_after(const int *x, int n, int k, int e) {
+    int64_t s = 0;
+    const int64_t __licm0 = clasp_ipow(k, e);
+    for (int i = 0; i < n; ++i) s += x[i] * __licm0;
+    return s;
+}
+
+// s += x[i] * y ^ 0.5 + (k + 1) ^ e, over doubles
+static double norm_before(const double *x, int n, double y, int k, int e) {
+    double s = 0;
+    for (int i = 0; i < n; ++i) s += x[i] * pow(y, 0.5) + clasp_ipow(k + 1, e);
+    return s;
+}
+static double norm_after(const double *x, int n, double y, int k, int e) {
+    double s = 0;
+    const double __licm0 = pow(y, 0.5);
+    const int64_t __licm1 = clasp_ipow(k + 1, e);
+    for (int i = 0; i < n; ++i) s += x[i] * __licm0 + __licm1;
+    return s;
+}
+
+#define TIME(out, expr) do {                                     \
+    double start = now_ms();                                        \
+    for (int it = 0; it < iterations; ++it) sink += (double) (expr); \
+    out = (now_ms() - start) / iterations;                          \
+} while (0)
+
+static void report(const char *kernel, double before_ms, double after_ms) {
+    printf("%-28s in loop: %8.3f ms   hoisted: %8.3f ms (%.2fx)\n", kernel, before_ms, after_ms, before_ms / after_ms);
+}
+
+int main(int argc, char **argv) {
+    int n          = argc > 1 ? atoi(argv[1]) : 1 << 20;
+    int iterations = argc > 2 ? atoi(argv[2]) : 20;
+
+    double *xd = malloc(n * sizeof(double));
+    int *xi = malloc(n * sizeof(int));
+    srand(1);
+    for (int i = 0; i < n; ++i) {
+        xd[i] = (rand() % 2000) / 1000.0 - 1.0;
+        xi[i] = rand() % 60 - 30;
+    }
+    // Read the loop-invariant inputs at run time, so nothing folds them away
+    int k = 3 + (rand() % 2), e = 7 + (rand() % 2);
+    double y = 2.0 + rand() % 3;
+
+    volatile double sink = 0;
+    double before, after;
+    TIME(before, scale_before(xi, n, k, e));
+    TIME(after,  scale_after(xi, n, k, e));
+    report("x[i] * k^e (int)", before, after);
+    TIME(before, norm_before(xd, n, y, k, e));
+    TIME(after,  norm_after(xd, n, y, k, e));
+    report("x[i] * y^0.5 + (k+1)^e", before, after);
+
+    printf("(checksum %g)\n", (double) sink);
+    free(xd);
+    free(xi);
+    return 0;
+}
@@ -0,0 +1,119 @@
+/**
+ * Clasp exponentiation lowering benchmark
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Benchmark Suite
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * Numeric kernels using `^`, written the way transpile_gcc emits them before and after lower_pow().
+ * Before lowering the only correct spelling of `^` is a libm pow() call, with int <-> double conversions for integer code.
+ * After lowering, constant exponents are multiply chains and variable integer exponents call clasp_ipow().
+ * Build with -DCMAKE_BUILD_TYPE=Release for meaningful numbers.
+*/
+
+#include <clasp/runtime.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+// 3*x^3 + 2*x^2 + x, over doubles
+static double poly_before(const double *x, int n) {
+    double s = 0;
+    for (int i = 0; i < n; ++i) s += 3 * pow(x[i], 3) + 2 * pow(x[i], 2) + x[i];
+    return s;
+}
+static double poly_after(const double *x, int n) {
+    double s = 0;
+    for (int i = 0; i < n; ++i) s += 3 * ((x[i] * x[i]) * x[i]) + 2 * (x[i] * x[i]) + x[i];
+    return s;
+}
+
+// x^5 over ints
+static int64_t quint_before(const int *x, int n) {
+    int64_t s = 0;
+    for (int i = 0; i < n; ++i) s += (int) pow(x[i], 5);
+    return s;
+}
+static int64_t quint_after(const int *x, int n) {
+    int64_t s = 0;
+    for (int i = 0; i < n; ++i) s += ((x[i] * x[i]) * (x[i] * x[i])) * x[i];
+    return s;
+}
+
+// b^e over ints with a variable exponent
+static int64_t varexp_before(const int *b, const int *e, int n) {
+    int64_t s = 0;
+    for (int i = 0; i < n; ++i) s += (int64_t) pow(b[i], e[i]);
+    return s;
+}
+static int64_t varexp_after(const int *b, const int *e, int n) {
+    int64_t s = 0;
+    for (int i = 0; i < n; ++i) s += clasp_ipow(b[i], e[i]);
+    return s;
+}
+
+#define TIME(out, expr) do {                                     \
+    double start = now_ms();                                        \
+    for (int it = 0; it < iterations; ++it) sink += (double) (expr); \
+    out = (now_ms() - start) / iterations;                          \
+} while (0)
+
+static void report(const char *kernel, const char *lowered, double before_ms, double after_ms) {
+    printf("%-18s pow(): %8.3f ms   %-11s %8.3f ms (%.2fx)\n", kernel, before_ms, lowered, after_ms, before_ms / after_ms);
+}
+
+int main(int argc, char **argv) {
+    int n          = argc > 1 ? atoi(argv[1]) : 1 << 20;
+    int iterations = argc > 2 ? atoi(argv[2]) : 20;
+
+    double *xd = malloc(n * sizeof(double));
+    int *xi = malloc(n * sizeof(int)), *ei = malloc(n * sizeof(int));
+    srand(1);
+    for (int i = 0; i < n; ++i) {
+        xd[i] = (rand() % 2000) / 1000.0 - 1.0;
+        xi[i] = rand() % 60 - 30;
+        ei[i] = rand() % 12;
+    }
+
+    volatile double sink = 0;
+    double before, after;
+    TIME(before, poly_before(xd, n));
+    TIME(after,  poly_after(xd, n));
+    report("3x^3 + 2x^2 + x", "chain:", before, after);
+    TIME(before, quint_before(xi, n));
+    TIME(after,  quint_after(xi, n));
+    report("x^5 (int)", "chain:", before, after);
+    TIME(before, varexp_before(xi, ei, n));
+    TIME(after,  varexp_after(xi, ei, n));
+    report("b^e (int)", "clasp_ipow:", before, after);
+
+    printf("(checksum %g)\n", (double) sink);
+    return 0;
+}
@@ -0,0 +1,154 @@
+/**
+ * Clasp register VM benchmark
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Benchmark Suite
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * The same programs run by the stack VM (after the peephole pass and superinstruction fusion) and by the register
+ * VM, both threaded: dispatches, time and code size side by side, to pick a format per deployment. Build with
+ * -DCMAKE_BUILD_TYPE=Release for meaningful numbers.
+*/
+
+#include <clasp/clasp.h>
+#include <clasp/bytecode_emit.h>
+#include <clasp/lower.h>
+#include <clasp/peephole.h>
+#include <clasp/regcode_emit.h>
+#include <clasp/regvm.h>
+#include <clasp/resolve.h>
+#include <clasp/stringstream.h>
+#include <clasp/vm.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+// Kernels, `%d` is the trip count. The first five are vm_bench's, the rest keep their variables in a function.
+static const struct {
+    const char *name;
+    const char *src;
+} KERNELS[] = {
+    { "sum",      "var s: long = 0;\nfor (var i: int = 0; i < %d; i++) { s += i; }\nprintln(s);" },
+    { "mixed",    "var s: long = 0;\nvar k: short = 3;\nfor (var i: int = 0; i < %d; i++) { var b: byte = i; s += b * k + i; }\nprintln(s);" },
+    { "divmod",   "var s: int = 0;\nfor (var i: int = 1; i < %d; i++) { s += i %% 7 + i / 13; }\nprintln(s);" },
+    { "float",    "var x: double = 0;\nfor (var i: int = 0; i < %d; i++) { x = x * 0.5 + 1.0; }\nprintln(x);" },
+    { "calls",    "fn sq(x: int) -> int { return x * x; }\nvar s: long = 0;\nfor (var i: int = 0; i < %d; i++) { s += sq(i); }\nprintln(s);" },
+    { "local",    "fn f(n: int) -> long { var s: long = 0; for (var i: int = 0; i < n; i++) { var t: int = i * 3; s += t - i / 5; } return s; }\nprintln(f(%d));" },
+    { "fib",      "fn fib(n: int) -> int { if (n < 2) { return n; } return fib(n - 1) + fib(n - 2); }\nvar k: int = %d;\nprintln(fib(22 + k / 1000000));" },
+};
+
+static int64_t sink;
+
+static ClaspVMCell quiet_println(ClaspVMCell *args) {
+    sink += args[0].i;
+    return (ClaspVMCell) { 0 };
+}
+
+static ClaspASTNode *parse(const char *fmt, int n) {
+    char src[512];
+    int len = snprintf(src, sizeof(src) - 1, fmt, n);
+    strcpy(src + len, "\n"); // The lexer needs a line end before EOF
+    StringStream *stream = new_sstream(src);
+    ClaspLexer *lexer = calloc(1, sizeof(ClaspLexer));
+    new_lexer(lexer, (StreamReadFn)&sstream_read, stream);
+    ClaspParser *parser = malloc(sizeof(ClaspParser));
+    new_parser(parser, lexer);
+    ClaspASTNode *ast = parser_compile(parser);
+    if (typecheck(ast)) return NULL;
+    return lower_pow(ast);
+}
+
+// Best of `iterations` runs, in ms. `dispatches` receives the count of a profiled run.
+static double time_stack(ClaspBytecode *bc, int iterations, uint64_t *dispatches) {
+    double best = 1e30;
+    for (int it = 0; it <= iterations; ++it) {
+        ClaspVM vm;
+        if (!vm_init(&vm, bc)) fprintf(stderr, "Error: %s\n", vm.error);
+        vm.dispatch = it ? CLASP_VM_THREADED : CLASP_VM_PROFILE;
+        vm_define(&vm, "println", &quiet_println, 1, 0);
+        double start = now_ms();
+        if (!vm_run(&vm)) fprintf(stderr, "Runtime error %s\n", vm.error);
+        double ms = now_ms() - start;
+        if (!it) *dispatches = vm.profile->total;
+        else if (ms < best) best = ms;
+        vm_free(&vm);
+    }
+    return best;
+}
+
+static double time_reg(ClaspRegModule *m, int iterations, uint64_t *dispatches) {
+    double best = 1e30;
+    for (int it = 0; it <= iterations; ++it) {
+        ClaspRegVM vm;
+        if (!regvm_init(&vm, m)) fprintf(stderr, "Error: %s\n", vm.error);
+        vm.dispatch = it ? CLASP_VM_THREADED : CLASP_VM_PROFILE;
+        regvm_define(&vm, "println", &quiet_println, 1, 0);
+        double start = now_ms();
+        if (!regvm_run(&vm)) fprintf(stderr, "Runtime error %s\n", vm.error);
+        double ms = now_ms() - start;
+        if (!it) *dispatches = vm.profile->total;
+        else if (ms < best) best = ms;
+        regvm_free(&vm);
+    }
+    return best;
+}
+
+int main(int argc, char **argv) {
+    int n          = argc > 1 ? atoi(argv[1]) : 2000000;
+    int iterations = argc > 2 ? atoi(argv[2]) : 5;
+
+    // Code size is the encoded module for the stack format, 16 bytes an instruction for register code; the stack
+    // VM's pre-decoded form takes 24 bytes an instruction, as does the register VM's.
+    printf("%-8s %11s %11s %7s %10s %10s %7s %9s %9s\n", "kernel", "stack disp", "reg disp", "ratio", "stack",
+           "register", "speedup", "stack B", "reg B");
+    for (size_t k = 0; k < sizeof(KERNELS) / sizeof(KERNELS[0]); ++k) {
+        ClaspASTNode *ast = parse(KERNELS[k].src, n);
+        if (!ast) return -1;
+        ClaspResolution res;
+        ast_resolve(ast, &res);
+        ClaspBytecode *bc = bytecode_emit(ast, &res);
+        ClaspRegModule *m = regcode_emit(ast, &res);
+        resolution_free(&res);
+        if (!bc || !m) return -1;
+        bytecode_peephole(bc);
+
+        uint64_t stack_disp, reg_disp;
+        double stack = time_stack(bc, iterations, &stack_disp);
+        double reg = time_reg(m, iterations, &reg_disp);
+        printf("%-8s %11" PRIu64 " %11" PRIu64 " %6.2fx %7.2f ms %7.2f ms %6.2fx %9zu %9zu\n", KERNELS[k].name,
+               stack_disp, reg_disp, (double) stack_disp / reg_disp, stack, reg, stack / reg,
+               cvector_size(bc->code), cvector_size(m->code) * sizeof(ClaspRegInst));
+        bytecode_free(bc);
+        regcode_free(m);
+    }
+    printf("(checksum %" PRId64 ")\n", sink);
+    return 0;
+}
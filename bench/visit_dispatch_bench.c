@@ -0,0 +1,132 @@
+/**
+ * Clasp visitor dispatch benchmark
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Benchmark Suite
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * Compares a table-dispatched ClaspASTVisitor (visit()) with a switch-dispatched static visitor
+ * doing the same work: a full recursive walk that counts nodes and sums literal lengths.
+ * Build with -DCMAKE_BUILD_TYPE=Release for meaningful numbers.
+*/
+
+#include <clasp/lexer.h>
+#include <clasp/parser.h>
+#include <clasp/stringstream.h>
+#include <clasp/static_visitor.h>
+#include <cvector/cvector.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static char *make_source(int n_functions) {
+    cvector(char) src = NULL;
+    char line[256];
+    for (int i = 0; i < n_functions; ++i) {
+        int len = snprintf(line, sizeof(line),
+            "fn helper%d(a: int, b: int) -> int {\nvar t: int = a * %d + b - (a - b) * (a + 1);\nwhile (t > 100) { t = t - (a + b) * 2; }\nreturn t;\n}\n", i, i);
+        for (int j = 0; j < len; ++j) cvector_push_back(src, line[j]);
+    }
+    const char *tail = "var result: int = helper0(1, 2);\n\n";
+    for (size_t j = 0; j <= strlen(tail); ++j) cvector_push_back(src, tail[j]);
+    return src;
+}
+
+/**
+ * The same handlers are generated twice, once recursing through visit() and a table, once through the
+ * static dispatcher.
+*/
+#define COUNTER_HANDLERS(prefix, RECURSE)                                                                        \
+static void *prefix##_binop(ClaspASTNode *n, void *a)   { ++*(long *)a; RECURSE(n->data.binop.left, a); RECURSE(n->data.binop.right, a); return NULL; } \
+static void *prefix##_unop(ClaspASTNode *n, void *a)    { ++*(long *)a; RECURSE(n->data.unop.right, a); return NULL; }      \
+static void *prefix##_postfix(ClaspASTNode *n, void *a) { ++*(long *)a; RECURSE(n->data.postfix.left, a); return NULL; }    \
+static void *prefix##_lit_num(ClaspASTNode *n, void *a) { *(long *)a += 1 + strlen(n->data.lit_num.value->data); return NULL; } \
+static void *prefix##_var_ref(ClaspASTNode *n, void *a) { ++*(long *)a; return NULL; }                                       \
+static void *prefix##_fn_call(ClaspASTNode *n, void *a) {                                                                    \
+    ++*(long *)a; RECURSE(n->data.fn_call.referencer, a);                                                                    \
+    for (size_t i = 0; i < cvector_size(n->data.fn_call.args); ++i) RECURSE(n->data.fn_call.args[i], a);                     \
+    return NULL; }                                                                                                           \
+static void *prefix##_return_stmt(ClaspASTNode *n, void *a) { ++*(long *)a; RECURSE(n->data.return_stmt.retval, a); return NULL; } \
+static void *prefix##_expr_stmt(ClaspASTNode *n, void *a)   { ++*(long *)a; RECURSE(n->data.expr_stmt.expr, a); return NULL; }     \
+static void *prefix##_block_stmt(ClaspASTNode *n, void *a) {                                                                 \
+    ++*(long *)a;                                                                                                            \
+    for (size_t i = 0; i < cvector_size(n->data.block_stmt.body); ++i) RECURSE(n->data.block_stmt.body[i], a);               \
+    return NULL; }                                                                                                           \
+static void *prefix##_var_decl(ClaspASTNode *n, void *a) {                                                                   \
+    ++*(long *)a; RECURSE(n->data.var_decl_stmt.type, a); RECURSE(n->data.var_decl_stmt.initializer, a); return NULL; }      \
+static void *prefix##_fn_decl(ClaspASTNode *n, void *a) {                                                                    \
+    ++*(long *)a; RECURSE(n->data.fn_decl_stmt.ret_type, a); RECURSE(n->data.fn_decl_stmt.body, a); return NULL; }           \
+static void *prefix##_if(ClaspASTNode *n, void *a)    { ++*(long *)a; RECURSE(n->data.cond_stmt.cond, a); RECURSE(n->data.cond_stmt.body, a); return NULL; } \
+static void *prefix##_while(ClaspASTNode *n, void *a) { ++*(long *)a; RECURSE(n->data.cond_stmt.cond, a); RECURSE(n->data.cond_stmt.body, a); return NULL; } \
+static void *prefix##_for(ClaspASTNode *n, void *a) {                                                                        \
+    ++*(long *)a; RECURSE(n->data.for_stmt.init, a); RECURSE(n->data.for_stmt.cond, a);                                      \
+    RECURSE(n->data.for_stmt.step, a); RECURSE(n->data.for_stmt.body, a); return NULL; }                                     \
+static void *prefix##_single_type(ClaspASTNode *n, void *a)   { ++*(long *)a; return NULL; }                                \
+static void *prefix##_array_type(ClaspASTNode *n, void *a)    { ++*(long *)a; return NULL; }                                \
+static void *prefix##_fn_type(ClaspASTNode *n, void *a)       { ++*(long *)a; return NULL; }                                \
+static void *prefix##_template_type(ClaspASTNode *n, void *a) { ++*(long *)a; return NULL; }                                \
+static void *prefix##_ptr_type(ClaspASTNode *n, void *a)      { ++*(long *)a; return NULL; }
+
+static ClaspASTVisitor table_counter;
+#define TABLE_RECURSE(node, a) visit(node, a, table_counter)
+COUNTER_HANDLERS(table, TABLE_RECURSE)
+static ClaspASTVisitor table_counter = CLASP_STATIC_VISITOR_TABLE(table);
+
+CLASP_STATIC_VISITOR(static_counter, fast)
+COUNTER_HANDLERS(fast, static_counter)
+
+int main(int argc, char **argv) {
+    int n_functions = argc > 1 ? atoi(argv[1]) : 2000;
+    int iterations  = argc > 2 ? atoi(argv[2]) : 100;
+
+    StringStream *stream = new_sstream(make_source(n_functions));
+    ClaspLexer *lexer = calloc(1, sizeof(ClaspLexer));
+    new_lexer(lexer, (StreamReadFn)&sstream_read, stream);
+    ClaspParser *parser = malloc(sizeof(ClaspParser));
+    new_parser(parser, lexer);
+    ClaspASTNode *ast = parser_compile(parser);
+
+    long table_sum = 0, static_sum = 0;
+    double start = now_ms();
+    for (int i = 0; i < iterations; ++i) visit(ast, &table_sum, table_counter);
+    double table_ms = (now_ms() - start) / iterations;
+
+    start = now_ms();
+    for (int i = 0; i < iterations; ++i) static_counter(ast, &static_sum);
+    double static_ms = (now_ms() - start) / iterations;
+
+    if (table_sum != static_sum) {
+        fprintf(stderr, "Visitors disagree: %ld != %ld\n", table_sum, static_sum);
+        return 1;
+    }
+    printf("checksum: %ld\n", table_sum / iterations);
+    printf("table dispatch:  %8.3f ms\n", table_ms);
+    printf("switch dispatch: %8.3f ms (%.2fx)\n", static_ms, table_ms / static_ms);
+    return 0;
+}
@@ -0,0 +1,155 @@
+/**
+ * Clasp bytecode VM benchmark
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Benchmark Suite
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * Numeric loops run by the bytecode VM with each dispatch style, after the peephole pass and superinstruction
+ * fusion, with how many instructions each saved. Counts come from profiled runs, so ns/dispatch is the cost of one
+ * dispatch plus its work. "cached" is the threaded loop keeping the top of the operand stack in a register, "tos" its
+ * speedup over the uncached loop. The opcode pairs still most frequent afterwards are candidates for more
+ * superinstructions.
+ * Build with -DCMAKE_BUILD_TYPE=Release for meaningful numbers.
+*/
+
+#include <clasp/clasp.h>
+#include <clasp/bytecode_emit.h>
+#include <clasp/lower.h>
+#include <clasp/peephole.h>
+#include <clasp/resolve.h>
+#include <clasp/stringstream.h>
+#include <clasp/vm.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+// Kernels, `%d` is the trip count
+static const struct {
+    const char *name;
+    const char *src;
+} KERNELS[] = {
+    { "sum",      "var s: long = 0;\nfor (var i: int = 0; i < %d; i++) { s += i; }\nprintln(s);" },
+    { "mixed",    "var s: long = 0;\nvar k: short = 3;\nfor (var i: int = 0; i < %d; i++) { var b: byte = i; s += b * k + i; }\nprintln(s);" },
+    { "divmod",   "var s: int = 0;\nfor (var i: int = 1; i < %d; i++) { s += i %% 7 + i / 13; }\nprintln(s);" },
+    { "float",    "var x: double = 0;\nfor (var i: int = 0; i < %d; i++) { x = x * 0.5 + 1.0; }\nprintln(x);" },
+    { "calls",    "fn sq(x: int) -> int { return x * x; }\nvar s: long = 0;\nfor (var i: int = 0; i < %d; i++) { s += sq(i); }\nprintln(s);" },
+};
+
+static int64_t sink;
+
+static ClaspVMCell quiet_println(ClaspVMCell *args) {
+    sink += args[0].i;
+    return (ClaspVMCell) { 0 };
+}
+
+static ClaspBytecode *compile(const char *fmt, int n) {
+    char src[512];
+    int len = snprintf(src, sizeof(src) - 1, fmt, n);
+    strcpy(src + len, "\n"); // The lexer needs a line end before EOF
+    StringStream *stream = new_sstream(src);
+    ClaspLexer *lexer = calloc(1, sizeof(ClaspLexer));
+    new_lexer(lexer, (StreamReadFn)&sstream_read, stream);
+    ClaspParser *parser = malloc(sizeof(ClaspParser));
+    new_parser(parser, lexer);
+    ClaspASTNode *ast = parser_compile(parser);
+    if (typecheck(ast)) return NULL;
+    ast = lower_pow(ast);
+    ClaspResolution res;
+    ast_resolve(ast, &res);
+    ClaspBytecode *bc = bytecode_emit(ast, &res);
+    resolution_free(&res);
+    return bc;
+}
+
+// Opcode pairs summed over every kernel's optimized run
+static uint64_t pairs[CLASP_VM_NUM_OPS][CLASP_VM_NUM_OPS];
+
+// Best of `iterations` runs, in ms. `profile` receives the counts of the last run, if given.
+static double time_run(ClaspBytecode *bc, ClaspVMDispatch dispatch, int iterations, ClaspVMProfile *profile) {
+    double best = 1e30;
+    for (int it = 0; it < iterations; ++it) {
+        ClaspVM vm;
+        if (!vm_init(&vm, bc)) fprintf(stderr, "Error: %s\n", vm.error);
+        vm.dispatch = dispatch;
+        vm_define(&vm, "println", &quiet_println, 1, 0);
+        double start = now_ms();
+        if (!vm_run(&vm)) fprintf(stderr, "Runtime error %s\n", vm.error);
+        double ms = now_ms() - start;
+        if (ms < best) best = ms;
+        if (profile) *profile = *vm.profile;
+        vm_free(&vm);
+    }
+    return best;
+}
+
+int main(int argc, char **argv) {
+    int n          = argc > 1 ? atoi(argv[1]) : 2000000;
+    int iterations = argc > 2 ? atoi(argv[2]) : 5;
+
+    // Instructions the emitted code executes, then the same after bytecode_peephole(), then the dispatches they
+    // take with superinstructions. Times and ns/dispatch are for the optimized code.
+    static ClaspVMProfile profile;
+    printf("%-8s %11s %11s %11s %6s %10s %7s %10s %7s %6s %10s %7s %7s\n", "kernel", "emitted", "peephole", "dispatches",
+           "saved", "threaded", "ns/disp", "cached", "ns/disp", "tos", "switch", "ns/disp", "speedup");
+    for (size_t k = 0; k < sizeof(KERNELS) / sizeof(KERNELS[0]); ++k) {
+        ClaspBytecode *bc = compile(KERNELS[k].src, n);
+        if (!bc) return -1;
+        time_run(bc, CLASP_VM_PROFILE, 1, &profile);
+        uint64_t emitted = profile.instructions;
+        bytecode_peephole(bc);
+        time_run(bc, CLASP_VM_PROFILE, 1, &profile);
+        for (size_t a = 0; a < CLASP_VM_NUM_OPS; ++a)
+            for (size_t b = 0; b < CLASP_VM_NUM_OPS; ++b) pairs[a][b] += profile.pairs[a][b];
+
+        double threaded = time_run(bc, CLASP_VM_THREADED, iterations, NULL);
+        double cached = time_run(bc, CLASP_VM_CACHED, iterations, NULL);
+        double sw = time_run(bc, CLASP_VM_SWITCH, iterations, NULL);
+        printf("%-8s %11" PRIu64 " %11" PRIu64 " %11" PRIu64 " %5.1f%% %7.2f ms %7.2f %7.2f ms %7.2f %5.2fx %7.2f ms %7.2f "
+               "%6.2fx\n", KERNELS[k].name, emitted, profile.instructions, profile.total,
+               100.0 - profile.total * 100.0 / emitted, threaded, threaded * 1e6 / profile.total, cached,
+               cached * 1e6 / profile.total, threaded / cached, sw, sw * 1e6 / profile.total, sw / threaded);
+        bytecode_free(bc);
+    }
+    printf("(checksum %" PRId64 ")\n", sink);
+
+    printf("\nmost frequent opcode pairs left\n");
+    for (int shown = 0; shown < 10; ++shown) {
+        size_t best_a = 0, best_b = 0;
+        for (size_t a = 0; a < CLASP_VM_NUM_OPS; ++a)
+            for (size_t b = 0; b < CLASP_VM_NUM_OPS; ++b)
+                if (pairs[a][b] > pairs[best_a][best_b]) best_a = a, best_b = b;
+        if (!pairs[best_a][best_b]) break;
+        printf("  %-10s %-10s %12" PRIu64 "\n", vm_op_name(best_a), vm_op_name(best_b), pairs[best_a][best_b]);
+        pairs[best_a][best_b] = 0;
+    }
+    return 0;
+}
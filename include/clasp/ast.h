@@ -32,36 +32,47 @@
 #include <stdint.h>
 
 /**
- * Enumeration to store types of AST nodes.
+ * List of AST node types, and the name of the visitor each one is dispatched to.
+ * Entries are X(type, visitor, arg), arg is passed through unchanged so users can thread a prefix or table name.
+ * The visitor names match the visit_* functions in clasp/visitor.h.
+*/
+#define CLASP_AST_NODE_TYPES(X, arg)             \
+    X(AST_EXPR_BINOP,      binop,         arg)   \
+    X(AST_EXPR_UNOP,       unop,          arg)   \
+    X(AST_EXPR_POSTFIX,    postfix,       arg)   \
+    X(AST_EXPR_LIT_NUMBER, lit_num,       arg)   \
+    X(AST_EXPR_VAR_REF,    var_ref,       arg)   \
+    X(AST_EXPR_FN_CALL,    fn_call,       arg)   \
+                                                 \
+    X(AST_RETURN_STMT,     return_stmt,   arg)   \
+    X(AST_EXPR_STMT,       expr_stmt,     arg)   \
+    X(AST_BLOCK_STMT,      block_stmt,    arg)   \
+    X(AST_VAR_DECL_STMT,   var_decl,      arg)   \
+    X(AST_LET_DECL_STMT,   var_decl,      arg)   \
+    X(AST_CONST_DECL_STMT, var_decl,      arg)   \
+    X(AST_FN_DECL_STMT,    fn_decl,       arg)   \
+                                                 \
+    X(AST_IF_STMT,         if,            arg)   \
+    X(AST_WHILE_STMT,      while,         arg)   \
+    X(AST_FOR_STMT,        for,           arg)   \
+                                                 \
+    X(AST_TYPE_SINGLE,     single_type,   arg)   \
+    X(AST_TYPE_ARRAY,      array_type,    arg)   \
+    X(AST_TYPE_FN,         fn_type,       arg)   \
+    X(AST_TYPE_TEMPLATE,   template_type, arg)   \
+    X(AST_TYPE_PTR,        ptr_type,      arg)
+
+/**
+ * Enumeration to store types of AST nodes, generated from CLASP_AST_NODE_TYPES.
  * CLASP_NUM_VISITORS must remain at the end of the list to accurately store the number of visitor functions needed.
 */
+#define CLASP_AST_ENUM_ENTRY(type, visitor, arg) type,
 typedef enum {
-    AST_EXPR_BINOP,
-    AST_EXPR_UNOP,
-    AST_EXPR_POSTFIX,
-    AST_EXPR_LIT_NUMBER,
-    AST_EXPR_VAR_REF,
-    AST_EXPR_FN_CALL,
-
-    AST_RETURN_STMT,
-    AST_EXPR_STMT,
-    AST_BLOCK_STMT,
-    AST_VAR_DECL_STMT,
-    AST_LET_DECL_STMT,
-    AST_CONST_DECL_STMT,
-    AST_FN_DECL_STMT,
-
-    AST_IF_STMT,
-    AST_WHILE_STMT,
-
-    AST_TYPE_SINGLE,
-    AST_TYPE_ARRAY,
-    AST_TYPE_FN,
-    AST_TYPE_TEMPLATE,
-    AST_TYPE_PTR,
+    CLASP_AST_NODE_TYPES(CLASP_AST_ENUM_ENTRY, _)
 
     CLASP_NUM_VISITORS
 } ClaspASTNodeType;
+#undef CLASP_AST_ENUM_ENTRY
 
 /**
  * The actual data stored in AST nodes.
@@ -87,6 +98,24 @@ struct ClaspType {
     ClaspTypeFlag flag;
 };
 
+/**
+ * Where a name lives at runtime. Filled in by ast_resolve() (see clasp/resolve.h), CLASP_SLOT_NONE before that.
+*/
+typedef enum {
+    CLASP_SLOT_NONE,
+    CLASP_SLOT_LOCAL,       // Slot of the current function's frame, parameters first
+    CLASP_SLOT_OUTER,       // Slot of the frame `depth` functions out
+    CLASP_SLOT_GLOBAL,      // Index into the globals table
+    CLASP_SLOT_FN,          // Index into the function table
+    CLASP_SLOT_BUILTIN,     // Index into the table of names the program uses without declaring
+} ClaspSlotKind;
+
+typedef struct ClaspSlot {
+    uint8_t kind;           // ClaspSlotKind
+    uint16_t depth;
+    uint32_t index;
+} ClaspSlot;
+
 union ASTNodeData {
     /**
      * Binary operations (5 + 3)
@@ -121,6 +150,7 @@ union ASTNodeData {
     */
     struct {
         ClaspToken *varname;
+        ClaspSlot slot;
     } var_ref;
     /**
      * Function calls (foo(), mul(a,b))
@@ -154,6 +184,7 @@ union ASTNodeData {
         ClaspToken *name;
         ClaspASTNode *type;
         ClaspASTNode *initializer;
+        ClaspSlot slot;
     } var_decl_stmt;
 
     /**
@@ -165,6 +196,9 @@ union ASTNodeData {
 
         ClaspASTNode *body;
         struct ClaspArg **args; // cvector
+
+        ClaspSlot slot;
+        uint32_t frame_size;    // Slots the body needs, parameters included
     } fn_decl_stmt;
 
     /**
@@ -175,6 +209,16 @@ union ASTNodeData {
         ClaspASTNode *body;
     } cond_stmt;
 
+    /**
+     * For statement (see syntax.md). init and step are statements, any of the parts may be NULL.
+    */
+    struct {
+        ClaspASTNode *init;
+        ClaspASTNode *cond;
+        ClaspASTNode *step;
+        ClaspASTNode *body;
+    } for_stmt;
+
 
     // Type node stuff
     /**
@@ -272,6 +316,15 @@ ClaspASTNode *lit_num(ClaspToken *num);
 */
 ClaspASTNode *var_ref(hashmap_t *vars, ClaspToken *varname);
 
+/**
+ * Helper function for creating a variable reference node with a known type, for passes that add references to names
+ * they declare themselves.
+ * @param varname The name of the variable to reference.
+ * @param type The type of the variable.
+ * @param flag The mutability of the variable.
+*/
+ClaspASTNode *typed_var_ref(ClaspToken *varname, ClaspASTNode *type, ClaspTypeFlag flag);
+
 /**
  * Helper function for creating a function call node.
  * @param referencer The object to call. This is usually a variable/fn name but can be any function type.
@@ -344,12 +397,28 @@ ClaspASTNode *if_stmt(ClaspASTNode *cond, ClaspASTNode *body);
 */
 ClaspASTNode *while_stmt(ClaspASTNode *cond, ClaspASTNode *body);
 
+/**
+ * Helper function for creating a for statement node.
+ * @param init The statement run once before the loop, usually a variable declaration. Its names are scoped to the loop.
+ * @param cond The expression node checked before every iteration.
+ * @param step The statement run after every iteration.
+ * @param body The statement representing the loop body.
+*/
+ClaspASTNode *for_stmt(ClaspASTNode *init, ClaspASTNode *cond, ClaspASTNode *step, ClaspASTNode *body);
+
 /**
  * Helper function for creating a single type node.
  * @param name The typename.
 */
 ClaspASTNode *type_single(ClaspToken *name);
 
+/**
+ * Deep copy a subtree, for passes that duplicate code.
+ * Tokens and type nodes are immutable and shared with the original, everything else is copied.
+ * @param node The root of the subtree to copy.
+*/
+ClaspASTNode *ast_clone(ClaspASTNode *node);
+
 // TODO: finish helper functions
 
 /**
@@ -369,4 +438,10 @@ typedef ClaspVisitorFn ClaspASTVisitor[CLASP_NUM_VISITORS];
 */
 void *visit(ClaspASTNode *node, void *args, ClaspASTVisitor visitor);
 
+/**
+ * Report a node with an out of range type and exit. Used by visit() and static visitors.
+ * @param node The offending node.
+*/
+void visit_unknown(ClaspASTNode *node);
+
 #endif // AST_H
\ No newline at end of file
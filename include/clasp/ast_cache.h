@@ -0,0 +1,119 @@
+/**
+ * Clasp binary AST cache declaration
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Header Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef AST_CACHE_H
+#define AST_CACHE_H
+
+#include <clasp/ast.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Cache file layout (see spec/ast_cache.md):
+ *  header | node records | token records | list entries | string table
+ * Node links are stored relative to the node that holds them, so the file can be mapped anywhere.
+*/
+#define CLASP_AST_CACHE_MAGIC   "CAST"
+#define CLASP_AST_CACHE_VERSION 2
+#define CLASP_AST_CACHE_ENDIAN  0x0102
+
+typedef struct ClaspASTCacheHeader {
+    char     magic[4];
+    uint16_t version;
+    uint16_t endian;
+    uint32_t node_count;
+    uint32_t token_count;
+    uint32_t list_count;
+    uint32_t string_size;
+    uint32_t root;
+    uint32_t _reserved;
+} ClaspASTCacheHeader;
+
+/**
+ * A single node. `a`/`b` and list entries are node links relative to this record (0 = NULL),
+ * `token` is a token index + 1 (0 = none).
+*/
+typedef struct ClaspASTCacheNode {
+    uint8_t  kind;
+    uint8_t  flag;
+    uint8_t  has_type;
+    uint8_t  _pad;
+    int32_t  type;
+    int32_t  a;
+    int32_t  b;
+    uint32_t token;
+    uint32_t list;
+    uint32_t list_len;
+} ClaspASTCacheNode;
+
+/**
+ * A single token. `data` is an offset into the string table, strings are interned.
+*/
+typedef struct ClaspASTCacheToken {
+    uint32_t data;
+    uint16_t type;
+    uint16_t _pad;
+    uint32_t lineno;
+    uint32_t where;
+} ClaspASTCacheToken;
+
+/**
+ * A loaded AST cache. The tree lives in a single arena and its strings point into the mapped file,
+ * so the cache must stay open for as long as the tree is in use.
+*/
+typedef struct ClaspASTCache {
+    ClaspASTNode *root;
+
+    void *_map;
+    size_t _map_size;
+    void *_arena;
+    size_t _node_count;
+} ClaspASTCache;
+
+/**
+ * Serialize an AST to a cache file.
+ * @param ast The tree to write.
+ * @param filename The file to write to.
+ * @return true on success.
+*/
+bool ast_cache_write(ClaspASTNode *ast, char *filename);
+
+/**
+ * Map a cache file and rebuild the tree it stores.
+ * Nodes, tokens and types are placed in one arena; only node lists (block bodies, call arguments) are
+ * allocated separately so that passes may still grow them.
+ * @param filename The cache file to load.
+ * @return The loaded cache, or NULL if the file is missing or invalid.
+*/
+ClaspASTCache *ast_cache_load(char *filename);
+
+/**
+ * Free a loaded cache and the tree it owns.
+ * @param cache The cache to free.
+*/
+void ast_cache_free(ClaspASTCache *cache);
+
+#endif // AST_CACHE_H
@@ -0,0 +1,355 @@
+/**
+ * Clasp bytecode declaration
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Header Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <clasp/ast.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * In-memory form of a `.clb` file (see spec/bytecode.md).
+ * The VM's operand stack is made of 8 byte cells, one value per cell. The b/w/d/q (and f4/f8) in an opcode name say
+ * how the cells it reads are interpreted and how its result is truncated; integers are always kept sign extended
+ * to 64 bits, so widening an integer never needs an instruction.
+ * Multi-byte operands are little endian and unaligned.
+*/
+
+#define CLASP_BYTECODE_MAGIC "CLB"
+
+/**
+ * Most global cells a module may have. Files asking for more are rejected before anything is allocated for them.
+*/
+#define CLASP_BYTECODE_MAX_GLOBALS (1 << 24)
+
+/**
+ * Value classes, selecting the width variant of an instruction. Also the operand of conv, neg and not.
+*/
+#define CLASP_VALUE_CLASSES(X) \
+    X(CLB_B,    "b")           \
+    X(CLB_W,    "w")           \
+    X(CLB_D,    "d")           \
+    X(CLB_Q,    "q")           \
+    X(CLB_F4,   "f4")          \
+    X(CLB_F8,   "f8")          \
+    X(CLB_VOID, "void")
+
+#define CLASP_VALUE_CLASS_ENTRY(cls, name) cls,
+typedef enum {
+    CLASP_VALUE_CLASSES(CLASP_VALUE_CLASS_ENTRY)
+} ClaspValueClass;
+#undef CLASP_VALUE_CLASS_ENTRY
+
+/**
+ * The `op: Operation` operand of math (ADD..XOR) and cmp (EQ..GE) instructions.
+*/
+#define CLASP_MATH_OPS(X) \
+    X(CLB_ADD, "add")     \
+    X(CLB_SUB, "sub")     \
+    X(CLB_MUL, "mul")     \
+    X(CLB_DIV, "div")     \
+    X(CLB_REM, "rem")     \
+    X(CLB_SHL, "shl")     \
+    X(CLB_XOR, "xor")     \
+    X(CLB_EQ,  "eq")      \
+    X(CLB_NE,  "ne")      \
+    X(CLB_LT,  "lt")      \
+    X(CLB_LE,  "le")      \
+    X(CLB_GT,  "gt")      \
+    X(CLB_GE,  "ge")
+
+#define CLASP_MATH_OP_ENTRY(op, name) op,
+typedef enum {
+    CLASP_MATH_OPS(CLASP_MATH_OP_ENTRY)
+
+    CLASP_NUM_MATH_OPS
+} ClaspMathOp;
+#undef CLASP_MATH_OP_ENTRY
+
+/**
+ * Pops/pushes of instructions whose stack effect depends on their operands (calls).
+*/
+#define CLB_VARIES -1
+
+/**
+ * Opcodes: X(opcode, name, operands, pops, pushes).
+ * Each character of `operands` is one operand, in encoding order:
+ *  '1', '2', '4', '8'  unsigned integer of that many bytes
+ *  'o'                 ClaspMathOp, one byte
+ *  'c'                 ClaspValueClass, one byte
+ *  'a'                 address table index, eight bytes
+ *  'n'                 native code entry index, eight bytes
+ *  'v'                 unsigned LEB128 varint
+ *  's'                 NUL terminated symbol name
+*/
+#define CLASP_OPCODES(X)                                                                                   \
+    X(OP_MATHBB, "mathbb", "o",   2, 1)                                                                    \
+    X(OP_MATHBW, "mathbw", "o",   2, 1)                                                                    \
+    X(OP_MATHBD, "mathbd", "o",   2, 1)                                                                    \
+    X(OP_MATHBQ, "mathbq", "o",   2, 1)                                                                    \
+    X(OP_MATHWB, "mathwb", "o",   2, 1)                                                                    \
+    X(OP_MATHWW, "mathww", "o",   2, 1)                                                                    \
+    X(OP_MATHWD, "mathwd", "o",   2, 1)                                                                    \
+    X(OP_MATHWQ, "mathwq", "o",   2, 1)                                                                    \
+    X(OP_MATHDB, "mathdb", "o",   2, 1)                                                                    \
+    X(OP_MATHDW, "mathdw", "o",   2, 1)                                                                    \
+    X(OP_MATHDD, "mathdd", "o",   2, 1)                                                                    \
+    X(OP_MATHDQ, "mathdq", "o",   2, 1)                                                                    \
+    X(OP_MATHQB, "mathqb", "o",   2, 1)                                                                    \
+    X(OP_MATHQW, "mathqw", "o",   2, 1)                                                                    \
+    X(OP_MATHQD, "mathqd", "o",   2, 1)                                                                    \
+    X(OP_MATHQQ, "mathqq", "o",   2, 1)                                                                    \
+    X(OP_MATHF4, "mathf4", "o",   2, 1)   /* Both operands f4                                           */ \
+    X(OP_MATHF8, "mathf8", "o",   2, 1)   /* Both operands f8                                           */ \
+    X(OP_CMPI,   "cmpi",   "o",   2, 1)   /* Any two integers, pushes a dword 0 or 1                    */ \
+    X(OP_CMPF4,  "cmpf4",  "o",   2, 1)                                                                    \
+    X(OP_CMPF8,  "cmpf8",  "o",   2, 1)                                                                    \
+    X(OP_NEG,    "neg",    "c",   1, 1)                                                                    \
+    X(OP_NOT,    "not",    "c",   1, 1)   /* Bitwise                                                    */ \
+    X(OP_CONV,   "conv",   "cc",  1, 1)   /* From, to                                                   */ \
+    X(OP_CONSTB, "constb", "1",   0, 1)                                                                    \
+    X(OP_CONSTW, "constw", "2",   0, 1)                                                                    \
+    X(OP_CONSTD, "constd", "4",   0, 1)   /* Also f4 bit patterns                                       */ \
+    X(OP_CONSTQ, "constq", "8",   0, 1)   /* Also f8 bit patterns and function values                   */ \
+    X(OP_CONSTK, "constk", "v",   0, 1)   /* Constant pool entry                                        */ \
+    X(OP_POP,    "pop",    "",    1, 0)                                                                    \
+    X(OP_DUP,    "dup",    "",    1, 2)                                                                    \
+    X(OP_LOADL,  "loadl",  "2",   0, 1)   /* Frame slot                                                 */ \
+    X(OP_STOREL, "storel", "2",   1, 0)                                                                    \
+    X(OP_LOADG,  "loadg",  "4",   0, 1)   /* Global index                                               */ \
+    X(OP_STOREG, "storeg", "4",   1, 0)                                                                    \
+    X(OP_JMP,    "jmp",    "a",   0, 0)                                                                    \
+    X(OP_JZ,     "jz",     "a",   1, 0)   /* Jump if the popped integer is 0                            */ \
+    X(OP_JNZ,    "jnz",    "a",   1, 0)                                                                    \
+    X(OP_CALL,   "call",   "a11", CLB_VARIES, CLB_VARIES) /* Function, argument count, results (0/1)   */ \
+    X(OP_CALLI,  "calli",  "11",  CLB_VARIES, CLB_VARIES) /* Function value below the arguments         */ \
+    X(OP_JSYM,   "jsym",   "11s", CLB_VARIES, CLB_VARIES) /* Call a VM symbol                           */ \
+    X(OP_ENTER,  "enter",  "2",   0, 0)   /* First instruction of a function: frame size in slots       */ \
+    X(OP_RET,    "ret",    "",    0, 0)                                                                    \
+    X(OP_RETV,   "retv",   "",    1, 0)                                                                    \
+    X(OP_ASM,    "asm",    "n11", CLB_VARIES, CLB_VARIES) /* Native code entry, argument count, results    */
+
+#define CLASP_OPCODE_ENTRY(op, name, operands, pops, pushes) op,
+typedef enum {
+    CLASP_OPCODES(CLASP_OPCODE_ENTRY)
+
+    CLASP_NUM_OPCODES
+} ClaspOpcode;
+#undef CLASP_OPCODE_ENTRY
+
+/**
+ * Platforms native code can be written for, the `arch` of a blob. Only ever appended to, the IDs are stored in files.
+*/
+#define CLASP_ARCHES(X)                         \
+    X(CLB_ARCH_NONE,           "none")          \
+    X(CLB_ARCH_X86_64_LINUX,   "x86_64-linux")  \
+    X(CLB_ARCH_AARCH64_LINUX,  "aarch64-linux") \
+    X(CLB_ARCH_X86_64_WINDOWS, "x86_64-windows")
+
+#define CLASP_ARCH_ENTRY(arch, name) arch,
+typedef enum {
+    CLASP_ARCHES(CLASP_ARCH_ENTRY)
+
+    CLASP_NUM_ARCHES
+} ClaspArch;
+#undef CLASP_ARCH_ENTRY
+
+/**
+ * Static info about an opcode, from CLASP_OPCODES.
+*/
+typedef struct ClaspOpcodeInfo {
+    const char *name;
+    const char *operands;
+    int8_t pops;
+    int8_t pushes;
+} ClaspOpcodeInfo;
+
+/**
+ * A decoded instruction.
+*/
+typedef struct ClaspBytecodeInst {
+    uint8_t op;                 // ClaspOpcode
+    uint64_t args[3];           // Numeric operands in order, the symbol excluded
+    const char *sym;            // The 's' operand, points into the code
+    size_t size;                // Encoded size in bytes
+} ClaspBytecodeInst;
+
+typedef struct ClaspBytecodeSymbol {
+    char *name;
+    uint64_t addr;              // Address table index
+} ClaspBytecodeSymbol;
+
+/**
+ * Machine code for one platform. It's position independent, starts at its first byte and is called like a
+ * ClaspVMNativeFn (see clasp/vm.h): a pointer to the first argument cell in, the result cell out.
+*/
+typedef struct ClaspBytecodeBlob {
+    uint16_t arch;                              // ClaspArch
+    cvector(uint8_t) code;
+} ClaspBytecodeBlob;
+
+/**
+ * What an `asm` instruction calls: the same function written for any number of platforms.
+*/
+typedef struct ClaspBytecodeNative {
+    int64_t fallback;                           // Address table index of a bytecode function doing the same, -1 if none
+    cvector(ClaspBytecodeBlob) blobs;           // At most one per platform
+} ClaspBytecodeNative;
+
+/**
+ * A bytecode module.
+*/
+typedef struct ClaspBytecode {
+    int64_t start;                              // Address table index of the entry point, -1 for libraries
+    cvector(uint64_t) atable;                   // Code offsets
+    cvector(ClaspBytecodeSymbol) symbols;
+    uint64_t globals;                           // Number of global cells
+    cvector(uint64_t) constants;                // Cells constk pushes
+    cvector(uint8_t) code;
+    cvector(ClaspBytecodeNative) natives;       // Entries asm calls
+} ClaspBytecode;
+
+/**
+ * Get the info of an opcode, or NULL if it isn't one.
+*/
+const ClaspOpcodeInfo *bytecode_opcode(uint8_t op);
+
+const char *bytecode_class_name(ClaspValueClass cls);
+
+const char *bytecode_math_name(ClaspMathOp op);
+
+const char *bytecode_arch_name(uint16_t arch);
+
+/**
+ * Get the value class of a type, CLB_VOID for void. Function values are CLB_Q.
+ * @param type An interned type.
+*/
+ClaspValueClass bytecode_class(ClaspASTNode *type);
+
+/**
+ * Get the `math` opcode for two integer classes, or the float one for two equal float classes.
+*/
+ClaspOpcode bytecode_math_op(ClaspValueClass a, ClaspValueClass b);
+
+/**
+ * Create an empty module.
+*/
+ClaspBytecode *bytecode_new(void);
+
+/**
+ * Append an opcode to the code section.
+*/
+void bytecode_op(ClaspBytecode *bc, ClaspOpcode op);
+
+/**
+ * Append a little endian operand of `size` bytes to the code section.
+*/
+void bytecode_put(ClaspBytecode *bc, uint64_t value, size_t size);
+
+/**
+ * Read a little endian operand of `size` bytes.
+*/
+uint64_t bytecode_get(const uint8_t *p, size_t size);
+
+/**
+ * Append an unsigned LEB128 varint to the code section.
+*/
+void bytecode_put_varint(ClaspBytecode *bc, uint64_t value);
+
+/**
+ * Read an unsigned LEB128 varint of at most 10 bytes, none past `end`.
+ * @param size Receives the encoded size, 0 if the varint is invalid.
+*/
+uint64_t bytecode_get_varint(const uint8_t *p, const uint8_t *end, size_t *size);
+
+/**
+ * Push the cheapest instruction that loads a cell: constb or constw if the cell is a small sign extended integer,
+ * otherwise constk with an entry of the constant pool, shared with every other use of the same cell.
+ * @param pool Maps cells to pool indices + 1, to share entries. Destroy it with bytecode_pool_free().
+*/
+void bytecode_const(ClaspBytecode *bc, hashmap_t *pool, uint64_t cell);
+
+/**
+ * Free a map made by bytecode_const().
+*/
+void bytecode_pool_free(hashmap_t *pool);
+
+/**
+ * Add an address table entry that isn't placed yet.
+ * @return Its index.
+*/
+uint64_t bytecode_label(ClaspBytecode *bc);
+
+/**
+ * Point an address table entry at the end of the code section.
+*/
+void bytecode_place(ClaspBytecode *bc, uint64_t label);
+
+/**
+ * Add a native code entry with no blobs yet.
+ * @param fallback Address table index of the function to call where there's no blob for the platform, -1 if none.
+ * @return Its index, the operand of asm.
+*/
+uint64_t bytecode_native(ClaspBytecode *bc, int64_t fallback);
+
+/**
+ * Set an entry's machine code for one platform, replacing any it had.
+*/
+void bytecode_native_blob(ClaspBytecode *bc, uint64_t native, ClaspArch arch, const void *code, size_t size);
+
+/**
+ * Find an entry's machine code for a platform, NULL if it has none.
+*/
+const ClaspBytecodeBlob *bytecode_native_find(const ClaspBytecodeNative *native, ClaspArch arch);
+
+/**
+ * Decode the instruction at `pc`.
+ * @return The instruction's size, 0 if it's invalid or runs past `size`.
+*/
+size_t bytecode_decode(const uint8_t *code, size_t size, size_t pc, ClaspBytecodeInst *out);
+
+/**
+ * Write a module as a `.clb` file.
+ * @return true on success.
+*/
+bool bytecode_write(ClaspBytecode *bc, const char *filename);
+
+/**
+ * Read a `.clb` file.
+ * @return The module, or NULL if the file is missing or invalid.
+*/
+ClaspBytecode *bytecode_read(const char *filename);
+
+/**
+ * Print a module's tables and a listing of its code.
+*/
+void bytecode_disassemble(ClaspBytecode *bc, FILE *out);
+
+void bytecode_free(ClaspBytecode *bc);
+
+#endif // BYTECODE_H
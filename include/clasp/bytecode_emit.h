@@ -0,0 +1,44 @@
+/**
+ * Clasp bytecode emitter declaration
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Header Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BYTECODE_EMIT_H
+#define BYTECODE_EMIT_H
+
+#include <clasp/bytecode.h>
+#include <clasp/resolve.h>
+
+/**
+ * Compile a type checked, lowered and resolved tree to bytecode (see spec/bytecode.md).
+ * Function i of the resolution starts at address table entry i and is exported under its name (`name.N` for the
+ * N-th repeat of a name), the top level statements follow as the entry point. Names the program never declares are
+ * reached with jsym.
+ * Math picks the width variant from the operand types, so mixed integer widths need no conversions.
+ * @param ast The tree, after lower_pow() and ast_resolve().
+ * @param res The resolution of the tree.
+ * @return The module, or NULL after reporting errors (functions using locals of an enclosing function).
+*/
+ClaspBytecode *bytecode_emit(ClaspASTNode *ast, ClaspResolution *res);
+
+#endif // BYTECODE_EMIT_H
@@ -0,0 +1,81 @@
+/**
+ * Clasp call graph declaration
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Header Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef CALLGRAPH_H
+#define CALLGRAPH_H
+
+#include <clasp/ast.h>
+#include <sheredom-hashmap/hashmap.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * A top-level function and what it calls.
+*/
+typedef struct ClaspCallGraphNode {
+    ClaspASTNode *fn;                                   // The AST_FN_DECL_STMT
+    cvector(struct ClaspCallGraphNode *) callees;       // Each callee once, in order of first call or reference
+    size_t call_sites;                                  // Calls to this function anywhere in the tree
+    bool shadowed;   // The name is declared again somewhere, so calls by name can't be resolved to this function
+    bool recursive;  // The function can reach itself through its callees
+    bool pure;       // Assigns nothing but its own locals, and only calls pure functions
+    bool halts;      // Has no loops or divisions that might trap, isn't recursive and only calls functions that halt
+
+    unsigned _mark;
+} ClaspCallGraphNode;
+
+/**
+ * The functions declared at the top level of a tree. Nested functions aren't part of the graph;
+ * calling one (or any other callee that isn't in the graph, like a builtin) counts as a call to an impure function.
+ * Naming a function other than to call it counts as calling it from there, since the value can be called later.
+*/
+typedef struct ClaspCallGraph {
+    hashmap_t names;                        // name -> ClaspCallGraphNode
+    cvector(ClaspCallGraphNode *) nodes;    // Callees before their callers, except within a cycle
+    cvector(ClaspCallGraphNode *) roots;    // Functions called from outside of any top-level function
+} ClaspCallGraph;
+
+/**
+ * Build the call graph of a type checked tree.
+ * @param ast The tree, usually the program's top level block.
+ * @return The call graph. The nodes point into ast, which must outlive it.
+*/
+ClaspCallGraph *callgraph_build(ClaspASTNode *ast);
+
+/**
+ * Find the function a call goes to.
+ * @param graph The call graph.
+ * @param call An AST_EXPR_FN_CALL node.
+ * @return The callee, or NULL if it isn't a top-level function called by an unambiguous name.
+*/
+ClaspCallGraphNode *callgraph_callee(ClaspCallGraph *graph, ClaspASTNode *call);
+
+/**
+ * Free a call graph. The tree it was built from is untouched.
+ * @param graph The graph to free.
+*/
+void callgraph_free(ClaspCallGraph *graph);
+
+#endif // CALLGRAPH_H
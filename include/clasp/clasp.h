@@ -4,4 +4,6 @@
 #include "err.h"
 #include "lexer.h"
 #include "parser.h"
-#include "target.h"
\ No newline at end of file
+#include "target.h"
+#include "typecheck.h"
+#include "types.h"
\ No newline at end of file
@@ -0,0 +1,50 @@
+/**
+ * Clasp common subexpression elimination declaration
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Header Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef CSE_H
+#define CSE_H
+
+#include <clasp/ast.h>
+
+/**
+ * Prefix of the temporaries ast_cse() declares, followed by a per-tree counter.
+*/
+#define CLASP_CSE_PREFIX "__cse"
+
+/**
+ * Compute repeated side effect free expressions once per basic block, in a type checked tree.
+ * A basic block here is a run of statements in one block that are declarations, returns, or expression statements
+ * whose only side effect is assigning one variable. Any other statement ends it.
+ *
+ * Expressions are compared with ast_hash()/ast_equal() (see clasp/hashcons.h). An expression is available from its
+ * first evaluation until a statement assigns or redeclares a name it reads. Each maximal expression that is evaluated
+ * again while available becomes `let __cseN: T = expr;` before the statement that first evaluates it.
+ * Expressions without variables are left to ast_fold().
+ * @param ast The tree to optimize.
+ * @return The optimized tree, which may be a different node than ast.
+*/
+ClaspASTNode *ast_cse(ClaspASTNode *ast);
+
+#endif // CSE_H
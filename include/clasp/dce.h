@@ -0,0 +1,47 @@
+/**
+ * Clasp dead code elimination declaration
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Header Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef DCE_H
+#define DCE_H
+
+#include <clasp/ast.h>
+
+// The function targets without top-level code start the program from, which is always kept.
+#define CLASP_DCE_ENTRY "main"
+
+/**
+ * Remove code that can never run or whose result is never used, from a type checked (and ideally folded) tree:
+ *  - statements after a `return` in the same block (function declarations stay, they're visible to the whole block);
+ *  - `if`/`while` statements whose condition is the literal 0, and `if` statements whose condition is any other literal
+ *    lose the condition; `for` loops with a literal 0 condition keep only their init;
+ *  - expression statements without side effects, where calls only count as none if they surely return;
+ *  - top-level functions that can't be reached from the top-level code or CLASP_DCE_ENTRY (see clasp/callgraph.h).
+ * A removed statement that isn't directly in a block is replaced by an empty block.
+ * @param ast The tree to clean up.
+ * @return The cleaned up tree, which may be a different node than ast.
+*/
+ClaspASTNode *ast_dce(ClaspASTNode *ast);
+
+#endif // DCE_H
@@ -41,4 +41,11 @@ void general_err(const char *fmt, ...);
 */
 void token_err(ClaspToken *tok, char *err);
 
+/**
+ * Raise a semantic (type/name) error on a token. This does NOT exit the program.
+ * @param tok The token in error, or NULL if there is no source location.
+ * @param fmt The format string to use.
+*/
+void semantic_err(ClaspToken *tok, const char *fmt, ...);
+
 #endif // ERR_H
\ No newline at end of file
@@ -0,0 +1,48 @@
+/**
+ * Clasp constant folding declaration
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Header Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef FOLD_H
+#define FOLD_H
+
+#include <clasp/ast.h>
+
+/**
+ * Fold constants and simplify arithmetic identities in a type checked tree (see clasp/typecheck.h).
+ *
+ *  - Operators on number literals are evaluated with the width and signedness of their cached type,
+ *    so `2147483647 + 1` wraps the same way it would at runtime.
+ *  - References to `const` declarations with a constant initializer are replaced by the value.
+ *  - x*1, 1*x, x/1, x^1, x-0 and (for integers) x+0 become x; integer x*0 and x^0 become a literal when x has no side effects.
+ *  - Integer multiplies by a power of two become left shifts (targets where shifting a negative number
+ *    isn't defined, like C, have to print them back as multiplies).
+ *
+ * Division by zero and results a literal can't spell (inf, nan) are left for runtime.
+ * Nodes are rewritten in place; folded subtrees are dropped, not freed.
+ * @param ast The tree to fold.
+ * @return The folded tree, which may be a different node than ast.
+*/
+ClaspASTNode *ast_fold(ClaspASTNode *ast);
+
+#endif // FOLD_H
@@ -0,0 +1,103 @@
+/**
+ * Clasp expression hash-consing declaration
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Header Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HASHCONS_H
+#define HASHCONS_H
+
+#include <clasp/ast.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Structural hash of an expression. Only side effect free expressions are hashed: number literals, variable
+ * references, unary operations and non-assigning binary operations. Cached types take part, so `1` as an int and
+ * `1` as a long hash differently.
+ * @param node The root of the expression.
+ * @return The hash, or 0 if the expression contains anything else.
+*/
+uint64_t ast_hash(ClaspASTNode *node);
+
+/**
+ * Whether two expressions have the same structure, operators, names, literals and types.
+ * Expressions that ast_hash() doesn't cover are only equal to themselves.
+*/
+bool ast_equal(ClaspASTNode *a, ClaspASTNode *b);
+
+/**
+ * An expression in a hash-cons table, with a value for the table's owner.
+*/
+typedef struct ClaspHashConsEntry {
+    uint64_t hash;
+    ClaspASTNode *node;
+    void *value;
+    struct ClaspHashConsEntry *next;
+} ClaspHashConsEntry;
+
+/**
+ * A set of structurally distinct expressions.
+*/
+typedef struct ClaspHashCons {
+    ClaspHashConsEntry **buckets;
+    size_t n_buckets;
+    size_t count;
+} ClaspHashCons;
+
+void hashcons_init(ClaspHashCons *table);
+void hashcons_free(ClaspHashCons *table);
+
+/**
+ * Empty a table, keeping its buckets.
+*/
+void hashcons_clear(ClaspHashCons *table);
+
+/**
+ * Find an expression structurally equal to node.
+ * @return The entry, or NULL if there isn't one or node can't be hashed.
+*/
+ClaspHashConsEntry *hashcons_find(ClaspHashCons *table, ClaspASTNode *node);
+
+/**
+ * Add an expression. The caller should check that no equal expression is in the table already.
+ * @return The new entry, or NULL if node can't be hashed.
+*/
+ClaspHashConsEntry *hashcons_add(ClaspHashCons *table, ClaspASTNode *node, void *value);
+
+/**
+ * Remove every entry pred returns true for.
+*/
+void hashcons_remove_if(ClaspHashCons *table, bool (*pred)(ClaspHashConsEntry *entry, void *args), void *args);
+
+/**
+ * Deduplicate an expression: its children are deduplicated first, then the canonical copy of the node is returned,
+ * adding it if it's new. Equal subtrees become the same node, so the result is a DAG and must not be rewritten in place.
+ * Expressions that can't be hashed are returned as they are.
+ * @param table The canonical expressions.
+ * @param node The expression to deduplicate.
+ * @return The canonical node.
+*/
+ClaspASTNode *ast_hashcons(ClaspHashCons *table, ClaspASTNode *node);
+
+#endif // HASHCONS_H
@@ -0,0 +1,67 @@
+/**
+ * Clasp function inliner declaration
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Header Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef INLINE_H
+#define INLINE_H
+
+#include <clasp/ast.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Default size limit for inlined functions, in AST nodes (not counting type nodes).
+*/
+#define CLASP_INLINE_BUDGET 24
+
+/**
+ * Prefix of the temporaries ast_inline() declares for arguments and locals.
+*/
+#define CLASP_INLINE_PREFIX "__inl"
+
+typedef struct ClaspInlineOptions {
+    size_t budget;  // Largest function to inline at a call outside of any loop, 0 disables inlining
+    bool report;    // Print every inlined call to stderr
+} ClaspInlineOptions;
+
+/**
+ * Inline calls to small functions in a type checked tree.
+ *
+ * A function can be inlined if it is declared at the top level, isn't recursive, is pure (see clasp/callgraph.h),
+ * and its body is zero or more initialized declarations followed by a single `return`.
+ * A call is inlined if its arguments are side effect free and the function fits its budget: opts->budget outside of
+ * loops, scaled up by the depth of loops around the call (up to 4x), and at least 4x for a function with one caller.
+ *
+ * Functions without locals are substituted right into the expression when no argument conversion is needed and no
+ * argument expression would be duplicated. Otherwise the arguments and locals become `let __inlN_name` temporaries
+ * declared before the statement holding the call, which requires the rest of that statement to be side effect free,
+ * and the call not to be in a loop condition.
+ * Callees are inlined into before their callers, so chains of small helpers flatten completely.
+ * @param ast The tree to inline calls in.
+ * @param opts The budget and reporting options, NULL for the defaults.
+ * @return The rewritten tree, which may be a different node than ast.
+*/
+ClaspASTNode *ast_inline(ClaspASTNode *ast, const ClaspInlineOptions *opts);
+
+#endif // INLINE_H
@@ -0,0 +1,216 @@
+/**
+ * Clasp SSA IR declaration
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Header Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef IR_H
+#define IR_H
+
+#include <clasp/ast.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * A mid-level IR in SSA form, between the AST and the backends (see spec/ir.md).
+ * A function is a flat array of instructions and a list of basic blocks, each block is a list of instruction indices:
+ * phis first, then the body, then exactly one terminator. An instruction's index is also the value it defines.
+*/
+
+/**
+ * Index of an instruction (and of the value it defines) in its function, or of a block for branch targets.
+*/
+typedef uint32_t ClaspIRValue;
+
+#define CLASP_IR_NONE UINT32_MAX
+
+/**
+ * Name of the function that holds top level statements.
+*/
+#define CLASP_IR_INIT "__init"
+
+/**
+ * Value types. Every Clasp primitive maps to one, function values are pointers.
+*/
+#define CLASP_IR_TYPES(X) \
+    X(IR_VOID, "void")    \
+    X(IR_I8,   "i8")      \
+    X(IR_I16,  "i16")     \
+    X(IR_I32,  "i32")     \
+    X(IR_I64,  "i64")     \
+    X(IR_F32,  "f32")     \
+    X(IR_F64,  "f64")     \
+    X(IR_PTR,  "ptr")
+
+#define CLASP_IR_TYPE_ENTRY(type, name) type,
+typedef enum {
+    CLASP_IR_TYPES(CLASP_IR_TYPE_ENTRY)
+} ClaspIRType;
+#undef CLASP_IR_TYPE_ENTRY
+
+/**
+ * Opcodes, with the fields each one uses. `a`/`b` are values unless noted otherwise, `list` is a run of values in
+ * the function's operand array.
+*/
+#define CLASP_IR_OPCODES(X)                                                           \
+    X(IR_CONST,  "const")   /* imm.i or imm.f                                      */ \
+    X(IR_UNDEF,  "undef")   /* A value that is never written                       */ \
+    X(IR_PARAM,  "param")   /* imm.index: parameter number                         */ \
+    X(IR_FUNC,   "func")    /* imm.index: module function                          */ \
+    X(IR_LOAD,   "load")    /* imm.index: module global                            */ \
+    X(IR_STORE,  "store")   /* imm.index: module global, a: value                  */ \
+    X(IR_ADD,    "add")     /* a, b, same type as the result                       */ \
+    X(IR_SUB,    "sub")                                                               \
+    X(IR_MUL,    "mul")                                                               \
+    X(IR_DIV,    "div")                                                               \
+    X(IR_REM,    "rem")                                                               \
+    X(IR_POW,    "pow")                                                               \
+    X(IR_SHL,    "shl")                                                               \
+    X(IR_XOR,    "xor")                                                               \
+    X(IR_NEG,    "neg")     /* a                                                   */ \
+    X(IR_NOT,    "not")     /* a, bitwise                                          */ \
+    X(IR_EQ,     "eq")      /* a, b of the same type, the result is i32 0 or 1     */ \
+    X(IR_NE,     "ne")                                                                \
+    X(IR_LT,     "lt")                                                                \
+    X(IR_LE,     "le")                                                                \
+    X(IR_GT,     "gt")                                                                \
+    X(IR_GE,     "ge")                                                                \
+    X(IR_CONV,   "conv")    /* a, converted to the result type                     */ \
+    X(IR_CALL,   "call")    /* a: callee, list: arguments                          */ \
+    X(IR_PHI,    "phi")     /* list: one value per predecessor, in the same order  */ \
+    X(IR_BR,     "br")      /* a: target block                                     */ \
+    X(IR_CBR,    "cbr")     /* a: condition, b: block if nonzero, imm.index: else  */ \
+    X(IR_RET,    "ret")     /* a: value, or CLASP_IR_NONE in void functions        */
+
+#define CLASP_IR_OP_ENTRY(op, name) op,
+typedef enum {
+    CLASP_IR_OPCODES(CLASP_IR_OP_ENTRY)
+
+    CLASP_IR_NUM_OPS
+} ClaspIROp;
+#undef CLASP_IR_OP_ENTRY
+
+typedef struct ClaspIRInst {
+    uint8_t op;
+    uint8_t type;           // ClaspIRType of the result
+    uint16_t _pad;
+    uint32_t block;
+    ClaspIRValue a, b;
+    union {
+        int64_t i;
+        double f;
+        uint32_t index;
+        struct {
+            uint32_t first;
+            uint32_t count;
+        } list;
+    } imm;
+} ClaspIRInst;
+
+typedef struct ClaspIRBlock {
+    cvector(ClaspIRValue) insts;
+    cvector(uint32_t) preds;
+} ClaspIRBlock;
+
+/**
+ * A function. External functions (built-ins like println) have no blocks.
+*/
+typedef struct ClaspIRFunction {
+    char *name;
+    ClaspASTNode *sig;                  // Interned function type
+    cvector(ClaspIRInst) insts;
+    cvector(ClaspIRValue) operands;     // Phi incoming values and call arguments
+    cvector(ClaspIRBlock) blocks;       // blocks[0] is the entry
+} ClaspIRFunction;
+
+typedef struct ClaspIRGlobal {
+    char *name;
+    uint8_t type;
+} ClaspIRGlobal;
+
+/**
+ * A whole program. fns[0] is CLASP_IR_INIT, which runs the top level statements.
+*/
+typedef struct ClaspIRModule {
+    cvector(ClaspIRFunction *) fns;
+    cvector(ClaspIRGlobal) globals;
+} ClaspIRModule;
+
+/**
+ * Get the IR type of an interned Clasp type.
+*/
+ClaspIRType ir_type(ClaspASTNode *type);
+
+/**
+ * Get the name of an IR type ("i32") or opcode ("add").
+*/
+const char *ir_type_name(ClaspIRType type);
+const char *ir_op_name(ClaspIROp op);
+
+/**
+ * Check if an opcode ends a block.
+*/
+bool ir_is_terminator(ClaspIROp op);
+
+/**
+ * Get the blocks an instruction branches to.
+ * @param inst The instruction.
+ * @param out Filled with up to two block indices.
+ * @return The number of successors, 0 for anything that isn't a branch.
+*/
+size_t ir_successors(ClaspIRInst *inst, uint32_t out[2]);
+
+/**
+ * Add an empty function to a module.
+ * @param name The function's name, which is copied.
+ * @param sig The function's interned type.
+ * @return The new function.
+*/
+ClaspIRFunction *ir_function(ClaspIRModule *m, const char *name, ClaspASTNode *sig);
+
+/**
+ * Add an instruction to the end of a block.
+ * @return The new instruction's value.
+*/
+ClaspIRValue ir_emit(ClaspIRFunction *fn, uint32_t block, ClaspIRInst inst);
+
+/**
+ * Check the structural and SSA invariants of a module: every block ends in a terminator, phis match their
+ * predecessors, operands are in range and of the right type, and every use is dominated by its definition.
+ * @param m The module to check.
+ * @param out Where to describe the problems found, may be NULL.
+ * @return The number of problems found.
+*/
+size_t ir_verify(ClaspIRModule *m, FILE *out);
+
+/**
+ * Print a module in textual form.
+*/
+void ir_dump(ClaspIRModule *m, FILE *out);
+
+/**
+ * Free a module and everything it owns.
+*/
+void ir_free(ClaspIRModule *m);
+
+#endif // IR_H
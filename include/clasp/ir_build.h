@@ -0,0 +1,46 @@
+/**
+ * Clasp SSA IR construction declaration
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Header Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef IR_BUILD_H
+#define IR_BUILD_H
+
+#include <clasp/ast.h>
+#include <clasp/ir.h>
+
+/**
+ * Lower a type checked tree to SSA form, using the construction of Braun et al. ("Simple and Efficient Construction
+ * of Static Single Assignment Form", CC 2013): variables are read and written per block while the tree is walked,
+ * phis are only placed where a read reaches a join, and trivial ones are removed as soon as they're complete.
+ *
+ * Top level statements become CLASP_IR_INIT. Top level variables that a function refers to become module globals,
+ * every other variable only exists as SSA values. Names the tree uses without declaring (println, runtime helpers
+ * added by lowering) become external functions.
+ * @param ast The tree to lower.
+ * @return The module, or NULL if the tree does something the IR can't express yet (a function using a local of an
+ *         enclosing function).
+*/
+ClaspIRModule *ir_build(ClaspASTNode *ast);
+
+#endif // IR_BUILD_H
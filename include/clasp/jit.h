@@ -0,0 +1,102 @@
+/**
+ * Clasp bytecode JIT declaration
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Header Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef JIT_H
+#define JIT_H
+
+#include <clasp/vm.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The template JIT translates verified functions into machine code, one fixed sequence per instruction, when
+ * CLASP_VM_JIT runs call them `jit_threshold` times. It only exists for x86-64 Linux, and its traps and fallbacks go
+ * through the threaded loops, so it needs CLASP_VM_COMPUTED_GOTO too; elsewhere nothing is compiled and CLASP_VM_JIT
+ * interprets like CLASP_VM_CACHED (or, in the switch-only build, like CLASP_VM_SWITCH).
+*/
+#if CLASP_VM_COMPUTED_GOTO && defined(__x86_64__) && defined(__linux__) && !defined(CLASP_VM_NO_JIT)
+#define CLASP_VM_HAS_JIT 1
+#else
+#define CLASP_VM_HAS_JIT 0
+#endif
+
+#define CLASP_JIT_THRESHOLD 64  // Default calls before a function is compiled
+
+/**
+ * Why compiled code stopped. Returned with the index of the instruction that trapped, `index << 8 | trap`, so the
+ * VM can report it like the interpreter would have.
+*/
+typedef enum {
+    CLASP_JIT_OK,
+    CLASP_JIT_DIVISION,         // Division by zero
+    CLASP_JIT_STACK,            // The frame doesn't fit on the stack
+    CLASP_JIT_FRAMES,           // Too many calls deep
+    CLASP_JIT_SYMBOL,           // A jsym whose symbol isn't defined the way the code calls it
+} ClaspJitTrap;
+
+typedef struct ClaspJitResult {
+    ClaspVMCell value;          // What the function returned, if anything
+    uint64_t trap;              // 0, or the index of the instruction that trapped << 8 | ClaspJitTrap
+} ClaspJitResult;
+
+/**
+ * A compiled function, entered like the interpreter enters a function: `fp` is its frame with the arguments in
+ * the first slots, `sp` is past them, and `frames` is how many more calls deep it may go.
+*/
+typedef ClaspJitResult (*ClaspJitCode)(ClaspVMCell *fp, ClaspVMCell *sp, uint64_t frames);
+
+typedef struct ClaspJitFunction {
+    ClaspJitCode code;          // NULL until compiled
+    uint32_t calls;             // Counted up to the VM's jit_threshold, then compilation is tried once
+} ClaspJitFunction;
+
+typedef struct ClaspJit {
+    ClaspJitFunction *fns;      // By instruction index, only enters are used
+    size_t _count;              // Instructions
+    cvector(void *) _maps;      // The executable pages, with their sizes in _sizes
+    cvector(size_t) _sizes;
+} ClaspJit;
+
+/**
+ * Set up a VM's JIT, which compiles nothing until it's asked to.
+*/
+ClaspJit *jit_new(ClaspVM *vm);
+
+/**
+ * Compile a function and every function it calls directly that isn't compiled yet, into one block of executable
+ * memory. Functions that use an instruction the JIT has no template for (calli, whose target is only known when it
+ * runs) are left to the interpreter, as are their callers.
+ * @param enter The function's enter.
+ * @return true if it's compiled.
+*/
+bool jit_compile(ClaspVM *vm, const ClaspVMInst *enter);
+
+/**
+ * Free a JIT and the code it compiled.
+*/
+void jit_free(ClaspJit *jit);
+
+#endif // JIT_H
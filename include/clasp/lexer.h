@@ -26,6 +26,8 @@
 #ifndef LEXER_H
 #define LEXER_H
 
+#include <stdbool.h>
+
 /**
  * Function to read a character from a stream
 */
@@ -69,7 +71,10 @@ typedef enum {
     TOKEN_RIGHT_POINT,TOKEN_LEFT_POINT,
     TOKEN_COMMA, TOKEN_SEMICOLON,
 
-    TOKEN_EOF, TOKEN_UNKNOWN
+    TOKEN_EOF, TOKEN_UNKNOWN,
+
+        // Internal operators, only produced by passes over the AST (never scanned).
+    TOKEN_LESS_LESS,
 } ClaspTokenType;
 
 /**
@@ -131,6 +136,20 @@ ClaspToken *lexer_scan(ClaspLexer *lexer);
 */
 int lexer_has(ClaspLexer *lexer, ClaspTokenType type);
 
+/**
+ * Create a token that doesn't come from source, for nodes built by passes.
+ * @param type The token type.
+ * @param data The token string, copied.
+ * @param at A token to take the source location from for error messages, or NULL.
+*/
+ClaspToken *token_synth(ClaspTokenType type, const char *data, ClaspToken *at);
+
+/**
+ * Check if a token type is an assignment operator (=, +=, ...).
+ * @param type The type to check.
+*/
+bool tktyp_is_assignment(ClaspTokenType type);
+
 /**
  * Helper function to convert a token type to a string.
  * @param type The type to stringify.
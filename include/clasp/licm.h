@@ -0,0 +1,50 @@
+/**
+ * Clasp loop-invariant code motion declaration
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Header Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef LICM_H
+#define LICM_H
+
+#include <clasp/ast.h>
+
+/**
+ * Prefix of the temporaries ast_licm() declares, followed by a per-tree counter.
+*/
+#define CLASP_LICM_PREFIX "__licm"
+
+/**
+ * Hoist loop-invariant expressions out of while and for loops in a type checked tree.
+ * An expression is invariant if it has no side effects and every name it reads is neither assigned nor declared in the
+ * loop. If the loop calls a function, only `let`/`const` bindings count, since the callee may assign any `var`.
+ * Integer `/` and `%` are only hoisted by a nonzero literal: the loop may never run, and hoisting must not add a trap.
+ *
+ * Each maximal invariant expression becomes `let __licmN: T = expr;` right before the loop and the loop reads the
+ * temporary instead. Temporaries hoisted out of an inner loop are hoisted again out of the outer loop when they can be.
+ * A loop that isn't directly inside a block is wrapped in one to hold its temporaries.
+ * @param ast The tree to optimize.
+ * @return The optimized tree, which may be a different node than ast.
+*/
+ClaspASTNode *ast_licm(ClaspASTNode *ast);
+
+#endif // LICM_H
@@ -0,0 +1,56 @@
+/**
+ * Clasp lowering pass declaration
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Header Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef LOWER_H
+#define LOWER_H
+
+#include <clasp/ast.h>
+
+/**
+ * Largest constant exponent that lower_pow() unrolls into multiplies.
+*/
+#define CLASP_POW_UNROLL_LIMIT 8
+
+/**
+ * Lower the `^` (exponentiation) operator in a type checked tree, so targets never see it:
+ *  - constant exponents 0..CLASP_POW_UNROLL_LIMIT on a variable become a balanced multiply chain (x^5 -> ((x*x)*(x*x))*x),
+ *    other side effect free bases are only unrolled for ^2;
+ *  - the remaining integer powers call clasp_ipow (see clasp/runtime.h);
+ *  - the remaining floating point powers call pow.
+ * `x ^= e` becomes `x = x ^ e` first.
+ * @param ast The tree to lower.
+ * @return The lowered tree, which may be a different node than ast.
+*/
+ClaspASTNode *lower_pow(ClaspASTNode *ast);
+
+/**
+ * Rewrite every for loop as `{ init; while (cond) { body; step } }`, for targets that only understand while loops.
+ * Loops are kept as AST_FOR_STMT through the rest of the pipeline so targets that can use the loop shape see it.
+ * @param ast The tree to lower.
+ * @return The lowered tree, which may be a different node than ast.
+*/
+ClaspASTNode *lower_for(ClaspASTNode *ast);
+
+#endif // LOWER_H
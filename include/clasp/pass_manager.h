@@ -0,0 +1,127 @@
+/**
+ * Clasp pass manager declaration
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Header Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PASS_MANAGER_H
+#define PASS_MANAGER_H
+
+#include <clasp/ast.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * A pass over the whole tree. Returns the new root, which may be a different node.
+*/
+typedef ClaspASTNode *(*ClaspTreePass)(ClaspASTNode *ast);
+typedef ClaspASTNode *(*ClaspTreePassWith)(ClaspASTNode *ast, void *args);
+
+typedef struct ClaspPassEntry {
+    const char *name;
+    ClaspTreePass run;
+    ClaspTreePassWith run_with;         // Used instead of run when set
+    void *args;
+    bool enabled;
+} ClaspPassEntry;
+
+/**
+ * What one pass or phase cost.
+*/
+typedef struct ClaspPassStats {
+    const char *name;
+    double ms;
+    uint64_t nodes_in;                  // Tree size before, 0 if there was no tree yet
+    uint64_t nodes_out;
+    int64_t bytes;                      // Change in heap memory in use, 0 where the C library can't tell
+
+    uint64_t _start_ns;
+    int64_t _start_bytes;
+} ClaspPassStats;
+
+typedef enum {
+    CLASP_REPORT_TABLE,
+    CLASP_REPORT_JSON,
+} ClaspReportFormat;
+
+/**
+ * Runs registered passes in order and, if `measure` is set, records what each one cost.
+ * Work that isn't a tree pass (parsing, the target) can be measured too with pass_manager_begin()/pass_manager_end().
+*/
+typedef struct ClaspPassManager {
+    cvector(ClaspPassEntry) passes;
+    cvector(ClaspPassStats) stats;
+    bool measure;
+} ClaspPassManager;
+
+/**
+ * Initialize an empty pass manager.
+ * @param measure Whether to record timings, node counts and memory. Counting nodes walks the tree, so leave this off
+ *                unless a report is wanted.
+*/
+void pass_manager_init(ClaspPassManager *pm, bool measure);
+
+/**
+ * Free a pass manager's tables.
+*/
+void pass_manager_free(ClaspPassManager *pm);
+
+/**
+ * Register a pass at the end of the order.
+*/
+void pass_manager_add(ClaspPassManager *pm, const char *name, ClaspTreePass run);
+void pass_manager_add_with(ClaspPassManager *pm, const char *name, ClaspTreePassWith run, void *args);
+
+/**
+ * Choose which registered passes run, and in what order.
+ * @param list Comma separated pass names, for example "fold,dce,fold". A pass may be listed more than once.
+ *             An empty list disables every pass.
+ * @return false if the list names a pass that isn't registered, in which case nothing changes.
+*/
+bool pass_manager_select(ClaspPassManager *pm, const char *list);
+
+/**
+ * Run the enabled passes over a tree.
+ * @return The final tree.
+*/
+ClaspASTNode *pass_manager_run(ClaspPassManager *pm, ClaspASTNode *ast);
+
+/**
+ * Start measuring a phase that isn't a registered pass.
+ * @param ast The tree going in, or NULL if there is none yet.
+ * @return A handle for pass_manager_end().
+*/
+size_t pass_manager_begin(ClaspPassManager *pm, const char *name, ClaspASTNode *ast);
+
+/**
+ * Finish measuring a phase.
+ * @param ast The tree coming out, or NULL.
+*/
+void pass_manager_end(ClaspPassManager *pm, size_t phase, ClaspASTNode *ast);
+
+/**
+ * Print what every measured pass and phase cost, in the order they ran.
+*/
+void pass_manager_report(ClaspPassManager *pm, FILE *out, ClaspReportFormat format);
+
+#endif // PASS_MANAGER_H
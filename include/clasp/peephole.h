@@ -0,0 +1,44 @@
+/**
+ * Clasp bytecode peephole optimizer declaration
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Header Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PEEPHOLE_H
+#define PEEPHOLE_H
+
+#include <clasp/bytecode.h>
+
+/**
+ * Remove instructions that only move values around from emitted bytecode:
+ *  - `dup; store; pop` and `dup; push; math; store; pop` (assignments and increments used as statements) lose their
+ *    `dup` and `pop`;
+ *  - a push (`const*`, `loadl`, `loadg`, `dup`) straight followed by `pop` is removed;
+ *  - `jmp` to the instruction after it is removed.
+ * A pattern never starts in the middle of a jump target, so every path into it still sees the same code. The address
+ * table is moved to match, nothing else in the module refers to code offsets.
+ * @param bc The module, left alone if its code doesn't decode.
+ * @return The number of instructions removed.
+*/
+size_t bytecode_peephole(ClaspBytecode *bc);
+
+#endif // PEEPHOLE_H
@@ -0,0 +1,155 @@
+/**
+ * Clasp register bytecode declaration
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Header Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef REGCODE_H
+#define REGCODE_H
+
+#include <clasp/bytecode.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <cvector/cvector.h>
+
+/**
+ * Register code: the three-address counterpart of the stack bytecode (see spec/bytecode.md, "Register code").
+ * Every function has a frame of 8 byte registers, laid out like the stack VM's cells: its resolved local slots
+ * (parameters first), then the temporaries the emitter needs for intermediate values. Instructions name the registers
+ * they read and write, so a variable is used where it lives instead of being loaded and stored around every use.
+ * Register code only lives in memory; modules are emitted from the tree and run by the register VM (clasp/regvm.h).
+ *
+ * Operands, in the order the disassembler prints them:
+ *  i   Integer value class of the result, which it is truncated to (in `x`)
+ *  f   Any value class (in `x`)
+ *  m   Float math operation, add to rem (in `x`)
+ *  o   Comparison, eq to ge (in `x`)
+ *  v   Conversion, from class in the low nibble and to class in the high one (in `x`)
+ *  n   Argument count (in `x`)
+ *  1   Register `a`, the destination of instructions that write one
+ *  2   Register `b`
+ *  3   Register `c`
+ *  H   `b` as a signed 16 bit constant
+ *  K   `k`, a constant cell
+ *  G   `k`, a global index
+ *  T   `k`, an instruction index in the same function
+ *  F   `k`, a function index
+ *  S   `k`, a symbol index
+ * Calls pass the `n` registers from `b` on as the callee's first registers, and its result arrives in `a`.
+*/
+#define CLASP_REG_OPCODES(X)                                                                         \
+    X(ROP_ADD,     "add",     "i123") /* a = b + c                                                */ \
+    X(ROP_SUB,     "sub",     "i123")                                                                \
+    X(ROP_MUL,     "mul",     "i123")                                                                \
+    X(ROP_DIV,     "div",     "i123") /* Traps on division by zero, like rem                      */ \
+    X(ROP_REM,     "rem",     "i123")                                                                \
+    X(ROP_SHL,     "shl",     "i123")                                                                \
+    X(ROP_XOR,     "xor",     "i123")                                                                \
+    X(ROP_ADDK,    "addk",    "i12K") /* a = b + k                                                */ \
+    X(ROP_SUBK,    "subk",    "i12K")                                                                \
+    X(ROP_MULK,    "mulk",    "i12K")                                                                \
+    X(ROP_DIVK,    "divk",    "i12K") /* k is never zero                                          */ \
+    X(ROP_REMK,    "remk",    "i12K")                                                                \
+    X(ROP_SHLK,    "shlk",    "i12K")                                                                \
+    X(ROP_XORK,    "xork",    "i12K")                                                                \
+    X(ROP_MATHF4,  "mathf4",  "m123")                                                                \
+    X(ROP_MATHF8,  "mathf8",  "m123")                                                                \
+    X(ROP_MATHF8K, "mathf8k", "m12K") /* a = b <op> k, k holding a double's bits                  */ \
+    X(ROP_CMP,     "cmp",     "o123") /* a = b <op> c ? 1 : 0, integers                           */ \
+    X(ROP_CMPF4,   "cmpf4",   "o123")                                                                \
+    X(ROP_CMPF8,   "cmpf8",   "o123")                                                                \
+    X(ROP_NEG,     "neg",     "f12")                                                                 \
+    X(ROP_NOT,     "not",     "i12")                                                                 \
+    X(ROP_CONV,    "conv",    "v12")                                                                 \
+    X(ROP_MOV,     "mov",     "12")                                                                  \
+    X(ROP_CONST,   "const",   "1K")                                                                  \
+    X(ROP_LOADG,   "loadg",   "1G")                                                                  \
+    X(ROP_STOREG,  "storeg",  "1G")   /* globals[k] = a                                           */ \
+    X(ROP_JMP,     "jmp",     "T")                                                                   \
+    X(ROP_JZ,      "jz",      "1T")                                                                  \
+    X(ROP_JNZ,     "jnz",     "1T")                                                                  \
+    X(ROP_JCMP,    "jcmp",    "o12T") /* Jump if a <op> b, integers                               */ \
+    X(ROP_JCMPK,   "jcmpk",   "o1HT")                                                                \
+    X(ROP_CALL,    "call",    "n12F")                                                                \
+    X(ROP_CALLI,   "calli",   "n123") /* The function value is in c                               */ \
+    X(ROP_NATIVE,  "native",  "n12S")                                                                \
+    X(ROP_RET,     "ret",     "")                                                                    \
+    X(ROP_RETV,    "retv",    "1")
+
+#define CLASP_REG_OPCODE_ENTRY(op, name, operands) op,
+typedef enum {
+    CLASP_REG_OPCODES(CLASP_REG_OPCODE_ENTRY)
+
+    CLASP_NUM_REG_OPCODES
+} ClaspRegOpcode;
+#undef CLASP_REG_OPCODE_ENTRY
+
+/**
+ * One instruction, 16 bytes.
+*/
+typedef struct ClaspRegInst {
+    uint8_t op;                 // ClaspRegOpcode
+    uint8_t x;                  // Value class, operation, conversion or argument count
+    uint16_t a, b, c;           // Registers
+    int64_t k;                  // Constant, global, instruction, function or symbol index
+} ClaspRegInst;
+
+_Static_assert(sizeof(ClaspRegInst) == 16, "register instructions must be 16 bytes");
+
+typedef struct ClaspRegFunction {
+    char *name;                 // Exported name, as bytecode_emit() names it; NULL for the entry point
+    uint32_t entry;             // Index of the first instruction
+    uint32_t size;              // Instructions, the last one never falls through
+    uint16_t params;
+    uint16_t registers;         // Parameters, other locals, then temporaries
+    uint8_t results;            // 0 or 1
+} ClaspRegFunction;
+
+/**
+ * A register code module.
+*/
+typedef struct ClaspRegModule {
+    cvector(ClaspRegInst) code;
+    cvector(ClaspRegFunction) fns;  // The tree's functions by function index, then the entry point
+    cvector(char *) symbols;        // Names native calls, the ones the program uses without declaring
+    uint64_t globals;               // Number of global cells
+    int64_t start;                  // Function index of the entry point
+} ClaspRegModule;
+
+/**
+ * Get the name of an opcode, or NULL if it isn't one.
+*/
+const char *regcode_opcode_name(uint8_t op);
+
+/**
+ * Get the operands of an opcode (see CLASP_REG_OPCODES), or NULL if it isn't one.
+*/
+const char *regcode_operands(uint8_t op);
+
+/**
+ * Print a module as a listing, one function after another.
+*/
+void regcode_disassemble(ClaspRegModule *m, FILE *out);
+
+void regcode_free(ClaspRegModule *m);
+
+#endif // REGCODE_H
@@ -0,0 +1,45 @@
+/**
+ * Clasp register bytecode emitter declaration
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Header Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef REGCODE_EMIT_H
+#define REGCODE_EMIT_H
+
+#include <clasp/regcode.h>
+#include <clasp/resolve.h>
+
+/**
+ * Compile a type checked, lowered and resolved tree to register code, the same trees bytecode_emit() takes.
+ * A function's locals are its registers, so reading a variable costs nothing and an expression computes straight
+ * into the variable it is assigned to. Temporaries are handed out above the locals in stack order, one per value
+ * that is still needed, and arguments are computed into the registers the callee's frame starts at.
+ * Integer comparisons in conditions become compare-and-branch instructions.
+ * @param ast The tree, after lower_pow() and ast_resolve().
+ * @param res The resolution of the tree.
+ * @return The module, or NULL after reporting errors (functions using locals of an enclosing function, frames of
+ * more than 65535 registers).
+*/
+ClaspRegModule *regcode_emit(ClaspASTNode *ast, ClaspResolution *res);
+
+#endif // REGCODE_EMIT_H
@@ -0,0 +1,132 @@
+/**
+ * Clasp register VM declaration
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Header Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef REGVM_H
+#define REGVM_H
+
+#include <clasp/regcode.h>
+#include <clasp/vm.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The sentinel after the translated code.
+*/
+#define CLASP_REGVM_END CLASP_NUM_REG_OPCODES
+
+struct ClaspRegVMFunction;
+
+/**
+ * A pre-decoded instruction, like the stack VM's ClaspVMInst: operands unpacked, instruction and function indices
+ * resolved to what they point at and symbols to their definitions.
+*/
+typedef struct ClaspRegVMInst {
+    const void *handler;                        // The threaded loop's code for `op`
+    union {
+        int64_t i;                              // Constants
+        uint64_t u;                             // Global indices
+        const struct ClaspRegVMInst *target;    // Jumps
+        const struct ClaspRegVMFunction *fn;    // call
+        ClaspVMSymbol *sym;                     // native
+    } arg;
+    uint16_t a, b, c;
+    uint8_t op;                                 // ClaspRegOpcode
+    uint8_t x;                                  // As in the module, except that integer results keep the shift
+                                                // that truncates them to their class instead of the class
+} ClaspRegVMInst;
+
+typedef struct ClaspRegVMFunction {
+    const ClaspRegVMInst *entry;
+    uint16_t params;
+    uint16_t registers;
+} ClaspRegVMFunction;
+
+typedef struct ClaspRegVMFrame {
+    const ClaspRegVMInst *ret;  // Where the caller continues, NULL to return to regvm_call()
+    ClaspVMCell *fp;            // The caller's frame
+    ClaspVMCell *result;        // The caller's register the result goes to
+} ClaspRegVMFrame;
+
+/**
+ * Dynamic opcode counts of the runs made with CLASP_VM_PROFILE.
+*/
+typedef struct ClaspRegVMProfile {
+    uint64_t total;                             // Dispatches, which are also instructions
+    uint64_t ops[CLASP_NUM_REG_OPCODES];
+} ClaspRegVMProfile;
+
+/**
+ * A register VM with one loaded module. Frames live on one stack of cells, a callee's frame starting at the first
+ * argument register of its caller. Registers, jump targets, globals, functions and symbols are checked once when
+ * the module is loaded; the code only checks that frames fit on the stack, division by zero, and calli and native
+ * targets.
+*/
+typedef struct ClaspRegVM {
+    ClaspRegModule *m;
+    ClaspRegVMInst *code;               // The translated code, ending with a CLASP_REGVM_END sentinel
+    ClaspRegVMFunction *fns;            // By function index, like the module's
+    ClaspVMSymbol *symbols;             // By symbol index, like the module's
+    ClaspVMCell *globals;
+    ClaspVMCell *stack;                 // CLASP_VM_STACK_CELLS cells, cache line aligned
+    ClaspRegVMFrame *frames;            // CLASP_VM_MAX_FRAMES entries
+    ClaspVMDispatch dispatch;
+    ClaspRegVMProfile *profile;         // Allocated by regvm_init(), only filled by CLASP_VM_PROFILE runs
+    char error[160];                    // Why the last run failed
+} ClaspRegVM;
+
+/**
+ * Load a module into a VM: define the runtime symbols (println, clasp_ipow, pow) it uses, then translate and check
+ * its code. The module must outlive the VM.
+ * @return false if the code is invalid, with the reason in vm->error. The VM must still be freed.
+*/
+bool regvm_init(ClaspRegVM *vm, ClaspRegModule *m);
+
+/**
+ * Free a VM. The module is left alone.
+*/
+void regvm_free(ClaspRegVM *vm);
+
+/**
+ * Define or replace a native symbol the module uses. Names it doesn't use are ignored.
+*/
+void regvm_define(ClaspRegVM *vm, const char *name, ClaspVMNativeFn fn, uint8_t argc, uint8_t results);
+
+/**
+ * Call a function of the module.
+ * @param fn Its function index.
+ * @param args The arguments, as many as it has parameters.
+ * @param result Receives the return value, if there is one. May be NULL.
+ * @return false if the program trapped, with the reason in vm->error.
+*/
+bool regvm_call(ClaspRegVM *vm, uint64_t fn, ClaspVMCell *args, size_t argc, ClaspVMCell *result);
+
+/**
+ * Run the module's entry point.
+ * @return false if the program trapped, with the reason in vm->error.
+*/
+bool regvm_run(ClaspRegVM *vm);
+
+#endif // REGVM_H
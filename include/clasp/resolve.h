@@ -0,0 +1,60 @@
+/**
+ * Clasp name resolution declaration
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Header Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef RESOLVE_H
+#define RESOLVE_H
+
+#include <clasp/ast.h>
+#include <stdint.h>
+
+/**
+ * The tables ast_resolve() numbers names into.
+*/
+typedef struct ClaspResolution {
+    cvector(ClaspASTNode *) globals;    // Top level declarations, by global index
+    cvector(ClaspASTNode *) fns;        // Function declarations, by function index
+    cvector(ClaspToken *) builtins;     // Names used but never declared (println, runtime helpers), by builtin index
+    uint32_t frame_size;                // Slots the top level statements need
+} ClaspResolution;
+
+/**
+ * Give every name in a type checked tree a runtime location, so backends never look names up by string.
+ * Declarations directly in the top level block become globals, functions are numbered in declaration order, and every
+ * other variable gets a slot in its function's frame. Parameters take the first slots, and blocks that end give their
+ * slots back, so a frame is only as large as the most variables alive at once (fn_decl_stmt.frame_size).
+ * A use of a local of an enclosing function is CLASP_SLOT_OUTER, with `depth` counting the functions in between.
+ *
+ * Run this after every pass that adds or moves declarations; references they create afterwards are unresolved.
+ * @param ast The tree to annotate.
+ * @param out Filled with the tables. Free with resolution_free().
+*/
+void ast_resolve(ClaspASTNode *ast, ClaspResolution *out);
+
+/**
+ * Free the tables of a resolution. The tree is left alone.
+*/
+void resolution_free(ClaspResolution *res);
+
+#endif // RESOLVE_H
@@ -0,0 +1,45 @@
+/**
+ * Clasp runtime helper declaration
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Header Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef RUNTIME_H
+#define RUNTIME_H
+
+#include <stdint.h>
+
+/**
+ * Helpers that lowered code calls at runtime. Targets either link against these or emit an equivalent.
+ * The names are also the symbols bytecode uses to reach them (see spec/bytecode.md).
+*/
+
+/**
+ * Integer exponentiation by squaring, wrapping on overflow.
+ * Negative exponents truncate towards zero like integer division: 1 and -1 keep their magnitude, 0 stays 0
+ * (instead of dividing by zero) and everything else becomes 0.
+ * @param base The base.
+ * @param exp The exponent.
+*/
+int64_t clasp_ipow(int64_t base, int64_t exp);
+
+#endif // RUNTIME_H
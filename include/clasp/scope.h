@@ -0,0 +1,89 @@
+/**
+ * Clasp lexical scope declaration
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Header Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef SCOPE_H
+#define SCOPE_H
+
+#include <clasp/ast.h>
+#include <sheredom-hashmap/hashmap.h>
+
+/**
+ * A name bound in a scope. Bindings of the same name chain through `shadowed`, innermost first.
+*/
+typedef struct ClaspBinding {
+    const char *name;
+    ClaspASTNode *type;
+    ClaspTypeFlag flag;
+    void *value;          // Free for the pass that owns the scope to use.
+
+    unsigned int depth;
+    struct ClaspBinding *shadowed;
+} ClaspBinding;
+
+/**
+ * Lexical scopes for passes over the AST. Lookups are a single hashmap probe no matter how deep the nesting is,
+ * popping a scope restores whatever its bindings shadowed.
+*/
+typedef struct ClaspScope {
+    hashmap_t names;                      // name -> innermost binding
+    cvector(ClaspBinding *) bindings;     // live bindings in declaration order
+    unsigned int depth;
+} ClaspScope;
+
+/**
+ * Initialize an empty scope stack.
+ * @param scope The scope stack to initialize.
+*/
+void scope_init(ClaspScope *scope);
+
+/**
+ * Free a scope stack and all of its bindings.
+ * @param scope The scope stack to free.
+*/
+void scope_free(ClaspScope *scope);
+
+/**
+ * Enter a new scope.
+*/
+void scope_push(ClaspScope *scope);
+
+/**
+ * Leave the innermost scope, dropping its bindings.
+*/
+void scope_pop(ClaspScope *scope);
+
+/**
+ * Bind a name in the innermost scope. The name is not copied and must outlive the binding.
+ * @return The new binding.
+*/
+ClaspBinding *scope_bind(ClaspScope *scope, const char *name, ClaspASTNode *type, ClaspTypeFlag flag, void *value);
+
+/**
+ * Find the innermost binding of a name.
+ * @return The binding, or NULL if the name isn't bound.
+*/
+ClaspBinding *scope_lookup(ClaspScope *scope, const char *name);
+
+#endif // SCOPE_H
@@ -0,0 +1,67 @@
+/**
+ * Clasp compile-time specialized visitor declaration
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Header Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef STATIC_VISITOR_H
+#define STATIC_VISITOR_H
+
+#include <clasp/ast.h>
+
+/**
+ * Switch-dispatched visitors for passes compiled into the core.
+ *
+ * CLASP_STATIC_VISITOR(name, prefix) declares a static handler prefix_<visitor> for every entry in
+ * CLASP_AST_NODE_TYPES and defines `static inline void *name(ClaspASTNode *node, void *args)`, which
+ * switches on the node type and calls the handler directly. Handlers recurse by calling name() instead
+ * of visit(), so the compiler can inline the dispatch and there is no table lookup per node.
+ * Every handler must be defined, a missing one is a compile error rather than a NULL call at runtime.
+ *
+ * Build targets loaded from .cbt files keep using ClaspASTVisitor tables and visit().
+ *
+ * Example:
+ *     CLASP_STATIC_VISITOR(count_nodes, count)
+ *     static void *count_binop(ClaspASTNode *node, void *args) { ... count_nodes(node->data.binop.left, args); ... }
+ *     ...
+*/
+#define CLASP_STATIC_VISITOR(name, prefix)                               \
+    CLASP_AST_NODE_TYPES(CLASP_STATIC_VISITOR_DECL_, prefix)             \
+    static inline void *name(ClaspASTNode *node, void *args) {           \
+        if (!node) return NULL;                                          \
+        switch (node->type) {                                            \
+            CLASP_AST_NODE_TYPES(CLASP_STATIC_VISITOR_CASE_, prefix)     \
+            default: visit_unknown(node); return NULL;                   \
+        }                                                                \
+    }
+
+/**
+ * Build a ClaspASTVisitor table from the handlers of a static visitor, for APIs that still take tables.
+*/
+#define CLASP_STATIC_VISITOR_TABLE(prefix) { CLASP_AST_NODE_TYPES(CLASP_STATIC_VISITOR_ENTRY_, prefix) }
+
+// Internal, used by the macros above.
+#define CLASP_STATIC_VISITOR_DECL_(type, visitor, prefix)  static void *prefix##_##visitor(ClaspASTNode *node, void *args);
+#define CLASP_STATIC_VISITOR_CASE_(type, visitor, prefix)  case type: return prefix##_##visitor(node, args);
+#define CLASP_STATIC_VISITOR_ENTRY_(type, visitor, prefix) [type] = &prefix##_##visitor,
+
+#endif // STATIC_VISITOR_H
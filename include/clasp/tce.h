@@ -0,0 +1,51 @@
+/**
+ * Clasp tail call elimination declaration
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Header Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TCE_H
+#define TCE_H
+
+#include <clasp/ast.h>
+
+/**
+ * Prefix of the names ast_tce() declares.
+*/
+#define CLASP_TCE_PREFIX "__tce"
+
+/**
+ * Turn self tail calls into loops, in a type checked tree, so deep recursion runs in constant stack on every target.
+ * A tail call is `return f(args)` in f's own body, or `f(args);` as the last thing a void f does.
+ *
+ * The body of a function with tail calls is wrapped in `while (1) { ... }`. Each tail call assigns the new argument
+ * values to the parameters (through `let` temporaries when more than one parameter changes), then the rest of the
+ * iteration is skipped with an `__tce_again` flag where needed, so the loop starts over. Other returns stay as they are.
+ *
+ * Functions are left alone if a tail call is inside a loop, if a non-void function can reach the end of its body,
+ * or if the body declares a function or a name that hides a parameter or the function itself.
+ * @param ast The tree to rewrite.
+ * @return The rewritten tree, which may be a different node than ast.
+*/
+ClaspASTNode *ast_tce(ClaspASTNode *ast);
+
+#endif // TCE_H
@@ -0,0 +1,45 @@
+/**
+ * Clasp static type checker declaration
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Header Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TYPECHECK_H
+#define TYPECHECK_H
+
+#include <clasp/ast.h>
+
+/**
+ * Resolve and cache the type of every expression in a tree.
+ *
+ * After a successful check every expression node has exprType->type set to an interned type (see clasp/types.h),
+ * var_ref flags reflect the binding they refer to, declarations without a typename have their inferred type filled in,
+ * and function declarations carry their function type in exprType. Backends should read these instead of recomputing types.
+ * The check is a single walk over the tree.
+ *
+ * Built-in functions (println) are in scope at the top level.
+ * @param ast The tree to check.
+ * @return The number of errors found, 0 if the tree is well typed.
+*/
+int typecheck(ClaspASTNode *ast);
+
+#endif // TYPECHECK_H
@@ -0,0 +1,108 @@
+/**
+ * Clasp interned type declaration
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Header Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TYPES_H
+#define TYPES_H
+
+#include <clasp/ast.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Type nodes returned by these functions are interned: there is exactly one node per distinct type,
+ * so two types are equal if and only if their pointers are equal. Interned nodes must never be modified or freed.
+*/
+
+/**
+ * Primitive type info.
+*/
+typedef struct ClaspPrimitive {
+    const char *name;
+    uint8_t size;   // Size in bytes, selects the b/w/d/q bytecode variants. 0 for void.
+    bool is_float;
+} ClaspPrimitive;
+
+/**
+ * Get the interned single type with the given name.
+ * @param name The typename.
+*/
+ClaspASTNode *type_intern(const char *name);
+
+/**
+ * Get the interned function type with the given signature.
+ * @param args A cvector of interned argument types.
+ * @param ret The interned return type.
+*/
+ClaspASTNode *type_intern_fn(cvector(ClaspASTNode *) args, ClaspASTNode *ret);
+
+/**
+ * Intern a type node parsed from source.
+ * @param type The parsed type node.
+ * @return The interned equivalent, or NULL if type is NULL or an array, template or pointer type, which aren't supported.
+*/
+ClaspASTNode *type_resolve(ClaspASTNode *type);
+
+/**
+ * Get the primitive info of a type.
+ * @param type An interned type.
+ * @return The primitive info, or NULL if the type isn't a primitive.
+*/
+const ClaspPrimitive *type_primitive(ClaspASTNode *type);
+
+/**
+ * Get the size of a value of the given type in bytes. Function types are the size of a pointer.
+ * @param type An interned type.
+ * @return The size, or 0 for void and unknown types.
+*/
+size_t type_size(ClaspASTNode *type);
+
+/**
+ * Check if a type is a floating point primitive.
+*/
+bool type_is_float(ClaspASTNode *type);
+
+/**
+ * Check if a type is an integer primitive.
+*/
+bool type_is_integer(ClaspASTNode *type);
+
+/**
+ * Get the result type of arithmetic on two numeric types: any float operand makes the result floating point
+ * (double if either operand is a double), otherwise the wider integer wins.
+*/
+ClaspASTNode *type_promote(ClaspASTNode *a, ClaspASTNode *b);
+
+/**
+ * Get the type of a number literal: float if it contains a decimal point, otherwise int, or long if it doesn't fit.
+ * @param literal The literal token.
+*/
+ClaspASTNode *type_of_literal(ClaspToken *literal);
+
+/**
+ * Get the name of a type, for error messages.
+*/
+const char *type_name(ClaspASTNode *type);
+
+#endif // TYPES_H
@@ -47,6 +47,7 @@ void *visit_fn_decl(ClaspASTNode *fn, void *args);
 
 void *visit_if(ClaspASTNode *stmt, void *args);
 void *visit_while(ClaspASTNode *stmt, void *args);
+void *visit_for(ClaspASTNode *stmt, void *args);
 
 void *visit_single_type(ClaspASTNode *type, void *args);
 
@@ -69,6 +70,7 @@ ClaspASTVisitor self_visitor = {
 
     [AST_IF_STMT        ] = &visit_if,
     [AST_WHILE_STMT     ] = &visit_while,
+    [AST_FOR_STMT       ] = &visit_for,
 
     [AST_TYPE_SINGLE    ] = &visit_single_type,
 };
@@ -0,0 +1,244 @@
+/**
+ * Clasp bytecode VM declaration
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Header Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef VM_H
+#define VM_H
+
+#include <clasp/bytecode.h>
+#include <sheredom-hashmap/hashmap.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Operand stack size, in cells. The stack also holds every frame's local slots.
+*/
+#define CLASP_VM_STACK_CELLS (1 << 16)
+
+/**
+ * Deepest call nesting.
+*/
+#define CLASP_VM_MAX_FRAMES (1 << 14)
+
+/**
+ * Computed goto dispatch needs GCC's labels as values. Define CLASP_VM_NO_COMPUTED_GOTO to build only the switch.
+*/
+#if defined(__GNUC__) && !defined(CLASP_VM_NO_COMPUTED_GOTO)
+#define CLASP_VM_COMPUTED_GOTO 1
+#else
+#define CLASP_VM_COMPUTED_GOTO 0
+#endif
+
+/**
+ * The platform whose blobs asm runs (see ClaspBytecodeNative), loaded into executable memory by vm_init(). Elsewhere
+ * every asm calls its fallback. Define CLASP_VM_NO_NATIVE to always use the fallbacks.
+*/
+#if defined(__x86_64__) && defined(__linux__) && !defined(CLASP_VM_NO_NATIVE)
+#define CLASP_VM_HAS_NATIVE 1
+#define CLASP_VM_HOST_ARCH  CLB_ARCH_X86_64_LINUX
+#else
+#define CLASP_VM_HAS_NATIVE 0
+#define CLASP_VM_HOST_ARCH  CLB_ARCH_NONE
+#endif
+
+/**
+ * Superinstructions: runs of instructions vm_init() fuses into one dispatch, picked from the most frequent opcode
+ * pairs of vm_bench's profile. X(op, name, length), `length` instructions become one. The fused instruction takes the
+ * place of the first, the others stay where they are for it to read their operands and are skipped.
+*/
+#define CLASP_VM_SUPERINSTRUCTIONS(X)                                                                   \
+    X(OP_MATHK,      "mathk",      2)   /* const, integer math                                      */ \
+    X(OP_MATHF8K,    "mathf8k",    2)   /* const, mathf8                                            */ \
+    X(OP_LOADLMATHK, "loadlmathk", 3)   /* loadl, const, integer math                               */ \
+    X(OP_CMPJZ,      "cmpjz",      2)   /* cmpi, jz                                                 */ \
+    X(OP_CMPJNZ,     "cmpjnz",     2)   /* cmpi, jnz                                                */ \
+    X(OP_CMPKJZ,     "cmpkjz",     3)   /* const, cmpi, jz                                          */ \
+    X(OP_CMPKJNZ,    "cmpkjnz",    3)   /* const, cmpi, jnz                                         */
+
+#define CLASP_VM_OP_ENTRY(op, name, length) op,
+typedef enum {
+    CLASP_VM_BEFORE_SUPER = CLASP_NUM_OPCODES - 1,
+    CLASP_VM_SUPERINSTRUCTIONS(CLASP_VM_OP_ENTRY)
+    CLASP_VM_END,                       // The sentinel after the code
+    CLASP_VM_NUM_OPS
+} ClaspVMOp;
+#undef CLASP_VM_OP_ENTRY
+
+/**
+ * One stack slot. Integers are sign extended to 64 bits, floats are stored as their bits in the low half
+ * (see vm_cell_f4()), doubles and function values fill the cell.
+*/
+typedef union ClaspVMCell {
+    int64_t i;
+    uint64_t u;
+    double f;
+} ClaspVMCell;
+
+_Static_assert(sizeof(ClaspVMCell) == 8, "VM cells must be 8 bytes");
+
+/**
+ * A function the VM provides to bytecode through jsym. `args` points at the first of the call's arguments.
+*/
+typedef ClaspVMCell (*ClaspVMNativeFn)(ClaspVMCell *args);
+
+/**
+ * What a jsym symbol names: a native function, or a function of the module.
+*/
+typedef struct ClaspVMSymbol {
+    ClaspVMNativeFn native;     // NULL for module functions and names that aren't defined yet
+    uint64_t addr;              // Address table index of a module function, UINT64_MAX if undefined
+    uint8_t argc;
+    uint8_t results;
+} ClaspVMSymbol;
+
+/**
+ * A pre-decoded instruction. vm_init() translates a module's code into an array of these, with operands unpacked,
+ * address table indices resolved to the instructions they point at and jsym names resolved to symbols, so the loop
+ * never touches the address or symbol tables. Jumps to module functions through jsym become calls, and so do asm
+ * instructions without a blob for this platform, to their fallback.
+*/
+typedef struct ClaspVMInst {
+    const void *handler;                    // The threaded loop's code for `op`
+    union {
+        int64_t i;                          // Constants
+        uint64_t u;                         // Slots, global indices
+        struct {
+            uint32_t size;                  // Local slots
+            uint32_t room;                  // Cells the frame can use, its slots and its deepest operand stack
+        } frame;                            // enter
+        const struct ClaspVMInst *target;   // Jumps and calls
+        ClaspVMSymbol *sym;                 // Native jsym
+        ClaspVMNativeFn native;             // asm, the loaded blob
+    } arg;
+    uint8_t op;                             // ClaspOpcode or ClaspVMOp
+    uint8_t a;                              // Math operation, value class or argument count
+    uint8_t b;                              // Second value class or result count, for enter what the function returns
+    uint8_t depth;                          // Operand cells under it, at most 255, filled in by the verifier
+    uint32_t offset;                        // Where the instruction is in the module's code, for errors
+} ClaspVMInst;
+
+typedef struct ClaspVMFrame {
+    const ClaspVMInst *ret;     // Where the caller continues, NULL to return to vm_call()
+    ClaspVMCell *fp;            // The caller's frame
+    ClaspVMCell *result;        // Where the callee's result goes
+} ClaspVMFrame;
+
+typedef enum {
+    CLASP_VM_THREADED,          // Computed goto, the switch where unavailable
+    CLASP_VM_CACHED,            // Computed goto keeping the top of the operand stack in a register, the default
+    CLASP_VM_JIT,               // CLASP_VM_CACHED, compiling functions to machine code once they're called enough
+    CLASP_VM_SWITCH,
+    CLASP_VM_PROFILE,           // The switch, counting every opcode and opcode pair into `profile`
+} ClaspVMDispatch;
+
+/**
+ * Dynamic opcode counts of the runs made with CLASP_VM_PROFILE, superinstructions counted as one.
+*/
+typedef struct ClaspVMProfile {
+    uint64_t total;                                         // Dispatches
+    uint64_t instructions;                                  // Bytecode instructions, superinstructions count theirs
+    uint64_t ops[CLASP_VM_NUM_OPS];
+    uint64_t pairs[CLASP_VM_NUM_OPS][CLASP_VM_NUM_OPS];     // [first][second]
+} ClaspVMProfile;
+
+/**
+ * A VM with one loaded module. Addresses, symbols, globals, operands, local slots and the depth of the operand stack
+ * are all checked once when the module is loaded, so the code only checks what can't be known before it runs: that
+ * frames fit on the stack, division by zero, and the targets of calli and jsym.
+*/
+typedef struct ClaspVM {
+    ClaspBytecode *bc;
+    ClaspVMInst *code;                  // The translated code, ending with a CLASP_VM_END sentinel
+    const ClaspVMInst **entries;        // Address table index -> the function starting there, NULL if none
+    ClaspVMCell *globals;
+    ClaspVMCell *stack;                 // CLASP_VM_STACK_CELLS cells, cache line aligned
+    ClaspVMFrame *frames;               // CLASP_VM_MAX_FRAMES entries
+    hashmap_t symbols;                  // Name -> ClaspVMSymbol *
+    cvector(ClaspVMSymbol *) _owned;
+    ClaspVMNativeFn *natives;           // Native code entry -> its loaded blob, NULL where there's none for the platform
+    void *_native_map;                  // The blobs, one read-only executable mapping
+    size_t _native_size;
+    ClaspVMDispatch dispatch;
+    const void *const *_labels;         // Handler table of the threaded loop the code was last prepared for
+    uint32_t jit_threshold;             // Calls before CLASP_VM_JIT compiles a function, CLASP_JIT_THRESHOLD
+    struct ClaspJit *jit;               // Made by the first CLASP_VM_JIT run, see clasp/jit.h
+    ClaspVMProfile *profile;            // Allocated by vm_init(), only filled by CLASP_VM_PROFILE runs
+    char error[160];                    // Why the last run failed
+} ClaspVM;
+
+/**
+ * Load a module into a VM: define the runtime symbols (println, clasp_ipow, pow) and the module's exports, map its
+ * native code for this platform, then translate and verify its code and fuse superinstructions. Symbols the module uses that aren't defined yet may still be defined with vm_define().
+ * The module must outlive the VM.
+ * @return false if the code is invalid, with the reason in vm->error. The VM must still be freed.
+*/
+bool vm_init(ClaspVM *vm, ClaspBytecode *bc);
+
+/**
+ * Free a VM. The module is left alone.
+*/
+void vm_free(ClaspVM *vm);
+
+/**
+ * Define or replace a native symbol. Code already translated sees the new definition.
+ * @param name The symbol, which must outlive the VM.
+*/
+void vm_define(ClaspVM *vm, const char *name, ClaspVMNativeFn fn, uint8_t argc, uint8_t results);
+
+/**
+ * Call a function of the module.
+ * @param addr Its address table index.
+ * @param args The arguments.
+ * @param result Receives the return value, if there is one. May be NULL.
+ * @return false if the program trapped, with the reason in vm->error.
+*/
+bool vm_call(ClaspVM *vm, uint64_t addr, ClaspVMCell *args, size_t argc, ClaspVMCell *result);
+
+/**
+ * Run the module from its start address.
+ * @return false if the program trapped or the module isn't runnable, with the reason in vm->error.
+*/
+bool vm_run(ClaspVM *vm);
+
+/**
+ * The name of an opcode or superinstruction, for profiles.
+*/
+const char *vm_op_name(uint8_t op);
+
+static inline float vm_cell_f4(ClaspVMCell c) {
+    uint32_t bits = (uint32_t) c.u;
+    float f;
+    memcpy(&f, &bits, 4);
+    return f;
+}
+
+static inline ClaspVMCell vm_f4_cell(float f) {
+    uint32_t bits;
+    memcpy(&bits, &f, 4);
+    return (ClaspVMCell) { .u = bits };
+}
+
+#endif // VM_H
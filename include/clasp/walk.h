@@ -0,0 +1,80 @@
+/**
+ * Clasp fused AST walker declaration
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Header Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef WALK_H
+#define WALK_H
+
+#include <clasp/ast.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A pass run by ast_walk().
+ * Unlike a ClaspASTVisitor, hooks don't recurse themselves; the walker visits every child and calls the hooks
+ * around it, so several passes can share one traversal of the tree.
+ * Either hook table may be NULL, as may individual entries. Hook return values are ignored.
+*/
+typedef struct ClaspASTPass {
+    ClaspVisitorFn *pre;  // ClaspASTVisitor, called before a node's children are walked
+    ClaspVisitorFn *post; // ClaspASTVisitor, called after a node's children are walked
+    void *args;           // Passed to every hook of this pass
+} ClaspASTPass;
+
+/**
+ * Walk a tree once, running all of the given passes on each node.
+ * At every node the pre hooks run in pass order, then the children are walked, then the post hooks run in pass order.
+ * Expression type annotations (exprType) are not walked.
+ * @param node The root of the tree to walk.
+ * @param passes The passes to run.
+ * @param n_passes The number of passes.
+*/
+void ast_walk(ClaspASTNode *node, ClaspASTPass *passes, size_t n_passes);
+
+/**
+ * Replace each statement/expression child of a node with fn(child, args), for passes that rewrite the tree.
+ * NULL children are skipped, as are type nodes, so fn only ever sees code. This does not recurse; fn decides whether to.
+ * @param node The node whose children to rewrite.
+ * @param fn Called on every child, returns the node to put in its place.
+ * @param args Passed to every call of fn.
+*/
+void ast_map_children(ClaspASTNode *node, ClaspVisitorFn fn, void *args);
+
+/**
+ * Node statistics collected by the stats pass.
+*/
+typedef struct ClaspASTStats {
+    uint64_t counts[CLASP_NUM_VISITORS];
+    uint64_t total;
+    uint32_t depth;
+    uint32_t max_depth;
+} ClaspASTStats;
+
+/**
+ * Create a pass that counts nodes by type and records the maximum tree depth.
+ * @param stats The stats to fill in. These should be zeroed before walking.
+*/
+ClaspASTPass ast_stats_pass(ClaspASTStats *stats);
+
+#endif // WALK_H
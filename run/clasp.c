@@ -1,29 +1,250 @@
 #include <clasp/clasp.h>
+#include <clasp/ast_cache.h>
+#include <clasp/bytecode_emit.h>
+#include <clasp/cse.h>
+#include <clasp/dce.h>
+#include <clasp/fold.h>
+#include <clasp/inline.h>
+#include <clasp/ir_build.h>
+#include <clasp/licm.h>
+#include <clasp/lower.h>
+#include <clasp/pass_manager.h>
+#include <clasp/peephole.h>
+#include <clasp/regcode_emit.h>
+#include <clasp/regvm.h>
+#include <clasp/resolve.h>
+#include <clasp/tce.h>
+#include <clasp/vm.h>
 #include <clasp/fstream.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bool has_extension(char *filename, const char *ext) {
+    size_t len = strlen(filename), ext_len = strlen(ext);
+    return len >= ext_len && !strcmp(filename + len - ext_len, ext);
+}
+
+static ClaspASTNode *inline_pass(ClaspASTNode *ast, void *opts) {
+    return ast_inline(ast, opts);
+}
+
+static ClaspPassManager pm;
+static int report = -1; // ClaspReportFormat, -1 for none
+static bool jit = false;
+
+static int finish(int status) {
+    if (report >= 0) pass_manager_report(&pm, stderr, report);
+    pass_manager_free(&pm);
+    return status;
+}
+
+// Run a module in the bytecode VM. Loading it translates and verifies the code, see clasp/vm.h.
+static int run_bytecode(ClaspBytecode *bc, ClaspASTNode *ast) {
+    ClaspVM vm;
+    size_t phase = pass_manager_begin(&pm, "verify", ast);
+    bool ok = vm_init(&vm, bc);
+    if (jit) vm.dispatch = CLASP_VM_JIT;
+    pass_manager_end(&pm, phase, ast);
+    if (!ok) {
+        fprintf(stderr, "Error: %s\n", vm.error);
+        vm_free(&vm);
+        return -1;
+    }
+    phase = pass_manager_begin(&pm, "vm", ast);
+    ok = vm_run(&vm);
+    fflush(stdout);
+    pass_manager_end(&pm, phase, ast);
+    if (!ok) fprintf(stderr, "Runtime error %s\n", vm.error);
+    vm_free(&vm);
+    return ok ? 0 : -1;
+}
+
+// Run a module in the register VM, see clasp/regvm.h.
+static int run_regcode(ClaspRegModule *m, ClaspASTNode *ast) {
+    ClaspRegVM vm;
+    size_t phase = pass_manager_begin(&pm, "verify", ast);
+    bool ok = regvm_init(&vm, m);
+    pass_manager_end(&pm, phase, ast);
+    if (!ok) {
+        fprintf(stderr, "Error: %s\n", vm.error);
+        regvm_free(&vm);
+        return -1;
+    }
+    phase = pass_manager_begin(&pm, "regvm", ast);
+    ok = regvm_run(&vm);
+    fflush(stdout);
+    pass_manager_end(&pm, phase, ast);
+    if (!ok) fprintf(stderr, "Runtime error %s\n", vm.error);
+    regvm_free(&vm);
+    return ok ? 0 : -1;
+}
 
 int main(int argc, char **argv) {
     if (argc < 3) {
-        printf("Usage: %s <filename> <target>\n", argv[0]);
+        printf("Usage: %s <filename> <target> [options]\n", argv[0]);
+        printf("       %s <filename> --emit-ast <output.clast>\n", argv[0]);
+        printf("       %s <filename> --emit-bytecode <output.clb>   (- lists the bytecode instead)\n", argv[0]);
+        printf("       %s <filename> --vm   Run in the bytecode VM, filename may be a .clb file\n", argv[0]);
+        printf("       %s <filename> --regvm   Run in the register VM (--regvm - lists the register code instead)\n", argv[0]);
+        printf("Options:\n");
+        printf("  --inline=<nodes>    Largest function to inline, 0 disables inlining (default %d)\n", CLASP_INLINE_BUDGET);
+        printf("  --inline-report     List inlined calls on stderr\n");
+        printf("  --emit-ir           Print the optimized program as SSA IR instead of running the target\n");
+        printf("  --passes=<a,b,...>  Optimization passes to run, in order (default inline,tce,fold,dce,cse,licm)\n");
+        printf("  --time-report[=json]  Print the time, tree size and memory of every phase on stderr\n");
+        printf("  --jit               Compile hot functions to machine code when running with --vm\n");
         return -1;
     }
 
+    ClaspInlineOptions inline_opts = { CLASP_INLINE_BUDGET, false };
+    bool emit_ir = false;
+    const char *passes = NULL;
+    for (int i = 3; i < argc; ++i) {
+        if (!strncmp(argv[i], "--inline=", 9)) inline_opts.budget = strtoul(argv[i] + 9, NULL, 10);
+        else if (!strcmp(argv[i], "--inline-report")) inline_opts.report = true;
+        else if (!strcmp(argv[i], "--emit-ir")) emit_ir = true;
+        else if (!strncmp(argv[i], "--passes=", 9)) passes = argv[i] + 9;
+        else if (!strcmp(argv[i], "--time-report")) report = CLASP_REPORT_TABLE;
+        else if (!strcmp(argv[i], "--time-report=json")) report = CLASP_REPORT_JSON;
+        else if (!strcmp(argv[i], "--jit")) jit = true;
+    }
+
+    pass_manager_init(&pm, report >= 0);
+    pass_manager_add_with(&pm, "inline", &inline_pass, &inline_opts);
+    pass_manager_add(&pm, "tce", &ast_tce);
+    pass_manager_add(&pm, "fold", &ast_fold);
+    pass_manager_add(&pm, "dce", &ast_dce);
+    pass_manager_add(&pm, "cse", &ast_cse);
+    pass_manager_add(&pm, "licm", &ast_licm);
+    if (passes && !pass_manager_select(&pm, passes)) {
+        fprintf(stderr, "Error: unknown pass in --passes=%s.\n", passes);
+        return finish(-1);
+    }
+
     char *filename = argv[1];
-    FileStream *stream = new_fstream(filename);
-    if (!stream) return -1;
+    if (has_extension(filename, ".clb")) { // Already compiled, see spec/bytecode.md
+        if (strcmp(argv[2], "--vm")) {
+            fprintf(stderr, "Error: bytecode files can only be run with --vm.\n");
+            return finish(-1);
+        }
+        size_t phase = pass_manager_begin(&pm, "load", NULL);
+        ClaspBytecode *bc = bytecode_read(filename);
+        pass_manager_end(&pm, phase, NULL);
+        if (!bc) return finish(-1);
+        int status = run_bytecode(bc, NULL);
+        bytecode_free(bc);
+        return finish(status);
+    }
+
+    ClaspASTNode *ast;
+    if (has_extension(filename, ".clast")) { // Pre-parsed module, see spec/ast_cache.md
+        size_t phase = pass_manager_begin(&pm, "load", NULL);
+        ClaspASTCache *cache = ast_cache_load(filename);
+        if (!cache) return finish(-1);
+        ast = cache->root;
+        pass_manager_end(&pm, phase, ast);
+    } else {
+        FileStream *stream = new_fstream(filename);
+        if (!stream) return finish(-1);
 
-    ClaspLexer *lexer = malloc(sizeof(ClaspLexer));
-    new_lexer(lexer, (StreamReadFn)&fstream_read, stream);
-    ClaspParser *parser = malloc(sizeof(ClaspParser));
-    new_parser(parser, lexer);
+        size_t phase = pass_manager_begin(&pm, "parse", NULL); // Includes lexing, which the parser drives
+        ClaspLexer *lexer = malloc(sizeof(ClaspLexer));
+        new_lexer(lexer, (StreamReadFn)&fstream_read, stream);
+        ClaspParser *parser = malloc(sizeof(ClaspParser));
+        new_parser(parser, lexer);
+
+        ast = parser_compile(parser);
+        pass_manager_end(&pm, phase, ast);
+    }
+
+    size_t phase = pass_manager_begin(&pm, "typecheck", ast);
+    int errors = typecheck(ast);
+    pass_manager_end(&pm, phase, ast);
+    if (errors > 0) return finish(-1);
+
+    if (!strcmp(argv[2], "--emit-ast")) {
+        if (argc < 4) {
+            fprintf(stderr, "Error: --emit-ast requires an output filename.\n");
+            return finish(-1);
+        }
+        phase = pass_manager_begin(&pm, "emit-ast", ast);
+        bool ok = ast_cache_write(ast, argv[3]);
+        pass_manager_end(&pm, phase, ast);
+        return finish(ok ? 0 : -1);
+    }
+
+    ast = pass_manager_run(&pm, ast);
+
+    phase = pass_manager_begin(&pm, "lower", ast);
+    ast = lower_pow(ast);
+    pass_manager_end(&pm, phase, ast);
+
+    if (emit_ir) {
+        phase = pass_manager_begin(&pm, "ir", ast);
+        ClaspIRModule *ir = ir_build(ast);
+        pass_manager_end(&pm, phase, ast);
+        if (!ir) return finish(-1);
+        ir_dump(ir, stdout);
+        size_t ir_errors = ir_verify(ir, stderr);
+        ir_free(ir);
+        return finish(ir_errors ? -1 : 0);
+    }
+
+    phase = pass_manager_begin(&pm, "resolve", ast);
+    ClaspResolution names;
+    ast_resolve(ast, &names);
+    pass_manager_end(&pm, phase, ast);
+
+    if (!strcmp(argv[2], "--regvm")) {
+        phase = pass_manager_begin(&pm, "regcode", ast);
+        ClaspRegModule *m = regcode_emit(ast, &names);
+        pass_manager_end(&pm, phase, ast);
+        resolution_free(&names);
+        if (!m) return finish(-1);
+        int status = 0;
+        if (argc > 3 && !strcmp(argv[3], "-")) regcode_disassemble(m, stdout);
+        else status = run_regcode(m, ast);
+        regcode_free(m);
+        return finish(status);
+    }
+
+    bool vm = !strcmp(argv[2], "--vm");
+    if (vm || !strcmp(argv[2], "--emit-bytecode")) {
+        if (!vm && argc < 4) {
+            fprintf(stderr, "Error: --emit-bytecode requires an output filename.\n");
+            return finish(-1);
+        }
+        phase = pass_manager_begin(&pm, "bytecode", ast);
+        ClaspBytecode *bc = bytecode_emit(ast, &names);
+        pass_manager_end(&pm, phase, ast);
+        resolution_free(&names);
+        if (!bc) return finish(-1);
+        phase = pass_manager_begin(&pm, "peephole", ast);
+        bytecode_peephole(bc);
+        pass_manager_end(&pm, phase, ast);
+        bool ok = true;
+        if (vm) {
+            ok = run_bytecode(bc, ast) == 0;
+        } else if (!strcmp(argv[3], "-")) {
+            bytecode_disassemble(bc, stdout);
+        } else {
+            ok = bytecode_write(bc, argv[3]);
+        }
+        bytecode_free(bc);
+        return finish(ok ? 0 : -1);
+    }
 
-    ClaspASTNode *ast = parser_compile(parser);
     ClaspTarget *target = new_target(argv[2]);
 
     if (target->type != TARGET_VISITOR) {
         fprintf(stderr, "Error: only AST visitor targets are currently supported.\n");
-        return -1;
+        return finish(-1);
     }
+    phase = pass_manager_begin(&pm, "target", ast);
     target->run(ast);
+    fflush(stdout); // Count writing the output
+    pass_manager_end(&pm, phase, ast);
+    resolution_free(&names);
 
-    return 0;
-}
\ No newline at end of file
+    return finish(0);
+}
@@ -27,6 +27,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <clasp/variable.h>
+#include <clasp/types.h>
 
 ClaspASTNode *new_AST_node(ClaspASTNodeType t, union ASTNodeData *data) {
     ClaspASTNode *node = malloc(sizeof(ClaspASTNode));
@@ -120,12 +121,7 @@ ClaspASTNode *lit_num(ClaspToken *n) {
     }
 
     struct ClaspType *type = malloc(sizeof(struct ClaspType));
-
-    union ASTNodeData *typeData = malloc(sizeof(union ASTNodeData));
-    typeData->single.name = malloc(sizeof(ClaspToken));
-    typeData->single.name->data = "int"; // TODO: floats
-    ClaspASTNode *typename = new_AST_node(AST_TYPE_SINGLE, typeData);
-    type->type = typename;
+    type->type = type_of_literal(n);
     type->flag = TYPE_CONST;
 
     data->lit_num.value = n;
@@ -150,6 +146,24 @@ ClaspASTNode *var_ref(hashmap_t *vars, ClaspToken *n) {
     if (var) type->type = var->type->type;
 
     data->var_ref.varname = n;
+    data->var_ref.slot = (ClaspSlot) { CLASP_SLOT_NONE, 0, 0 };
+
+    return new_expr_node(AST_EXPR_VAR_REF, data, type);
+}
+
+ClaspASTNode *typed_var_ref(ClaspToken *n, ClaspASTNode *vtype, ClaspTypeFlag flag) {
+    union ASTNodeData *data = malloc(sizeof(union ASTNodeData));
+    if (data == NULL) {
+        fprintf(stderr, "Memory allocation error in typed_var_ref function\n");
+        return NULL;
+    }
+
+    struct ClaspType *type = malloc(sizeof(struct ClaspType));
+    type->type = vtype;
+    type->flag = flag;
+
+    data->var_ref.varname = n;
+    data->var_ref.slot = (ClaspSlot) { CLASP_SLOT_NONE, 0, 0 };
 
     return new_expr_node(AST_EXPR_VAR_REF, data, type);
 }
@@ -219,6 +233,7 @@ ClaspASTNode *var_decl(ClaspToken *name, ClaspASTNode *type, ClaspASTNode *value
     data->var_decl_stmt.name = name;
     data->var_decl_stmt.type = type;
     data->var_decl_stmt.initializer = value;
+    data->var_decl_stmt.slot = (ClaspSlot) { CLASP_SLOT_NONE, 0, 0 };
 
     return new_AST_node(AST_VAR_DECL_STMT, data);
 }
@@ -233,6 +248,7 @@ ClaspASTNode *let_decl(ClaspToken *name, ClaspASTNode *type, ClaspASTNode *value
     data->var_decl_stmt.name = name;
     data->var_decl_stmt.type = type;
     data->var_decl_stmt.initializer = value;
+    data->var_decl_stmt.slot = (ClaspSlot) { CLASP_SLOT_NONE, 0, 0 };
 
     return new_AST_node(AST_LET_DECL_STMT, data);
 }
@@ -247,6 +263,7 @@ ClaspASTNode *const_decl(ClaspToken *name, ClaspASTNode *type, ClaspASTNode *val
     data->var_decl_stmt.name = name;
     data->var_decl_stmt.type = type;
     data->var_decl_stmt.initializer = value;
+    data->var_decl_stmt.slot = (ClaspSlot) { CLASP_SLOT_NONE, 0, 0 };
 
     return new_AST_node(AST_CONST_DECL_STMT, data);
 }
@@ -262,6 +279,8 @@ ClaspASTNode *fn_decl(ClaspToken *name, ClaspASTNode *ret_type, struct ClaspArg
     data->fn_decl_stmt.ret_type = ret_type;
     data->fn_decl_stmt.body = body;
     data->fn_decl_stmt.args = args;
+    data->fn_decl_stmt.slot = (ClaspSlot) { CLASP_SLOT_NONE, 0, 0 };
+    data->fn_decl_stmt.frame_size = 0;
 
     return new_AST_node(AST_FN_DECL_STMT, data);
 }
@@ -292,6 +311,21 @@ ClaspASTNode *while_stmt(ClaspASTNode *cond, ClaspASTNode *body) {
     return new_AST_node(AST_WHILE_STMT, data);
 }
 
+ClaspASTNode *for_stmt(ClaspASTNode *init, ClaspASTNode *cond, ClaspASTNode *step, ClaspASTNode *body) {
+    union ASTNodeData *data = malloc(sizeof(union ASTNodeData));
+    if (data == NULL) {
+        fprintf(stderr, "Memory allocation error in for_stmt function\n");
+        return NULL;
+    }
+
+    data->for_stmt.init = init;
+    data->for_stmt.cond = cond;
+    data->for_stmt.step = step;
+    data->for_stmt.body = body;
+
+    return new_AST_node(AST_FOR_STMT, data);
+}
+
 ClaspASTNode *type_single(ClaspToken *name) {
     union ASTNodeData *data = malloc(sizeof(union ASTNodeData));
     if (data == NULL) {
@@ -304,11 +338,76 @@ ClaspASTNode *type_single(ClaspToken *name) {
     return new_AST_node(AST_TYPE_SINGLE, data);
 }
 
-void *visit(ClaspASTNode *node, void *args, ClaspASTVisitor v) {
+static cvector(ClaspASTNode *) clone_list(cvector(ClaspASTNode *) list) {
+    cvector(ClaspASTNode *) out = NULL;
+    for (size_t i = 0; i < cvector_size(list); ++i) cvector_push_back(out, ast_clone(list[i]));
+    return out;
+}
+
+ClaspASTNode *ast_clone(ClaspASTNode *node) {
     if (!node) return NULL;
-    if (node->type < 0 || node->type > CLASP_NUM_VISITORS) {
-        fprintf(stderr, "Internal error, please report this message: \n\n\"Unknown AST node type: %d\"\n", node->type);
-        exit(1);
+    if (node->type >= AST_TYPE_SINGLE) return node; // Types are shared
+
+    ClaspASTNode *out = new_AST_node(node->type, &node->data);
+    if (node->exprType) {
+        out->exprType = malloc(sizeof(struct ClaspType));
+        *out->exprType = *node->exprType;
     }
+
+    union ASTNodeData *d = &out->data;
+    switch (node->type) {
+        case AST_EXPR_BINOP:
+            d->binop.left  = ast_clone(d->binop.left);
+            d->binop.right = ast_clone(d->binop.right);
+            break;
+        case AST_EXPR_UNOP:    d->unop.right = ast_clone(d->unop.right);     break;
+        case AST_EXPR_POSTFIX: d->postfix.left = ast_clone(d->postfix.left); break;
+        case AST_EXPR_FN_CALL:
+            d->fn_call.referencer = ast_clone(d->fn_call.referencer);
+            d->fn_call.args = clone_list(d->fn_call.args);
+            break;
+        case AST_RETURN_STMT: d->return_stmt.retval = ast_clone(d->return_stmt.retval); break;
+        case AST_EXPR_STMT:   d->expr_stmt.expr = ast_clone(d->expr_stmt.expr);         break;
+        case AST_BLOCK_STMT:  d->block_stmt.body = clone_list(d->block_stmt.body);     break;
+        case AST_VAR_DECL_STMT:
+        case AST_LET_DECL_STMT:
+        case AST_CONST_DECL_STMT:
+            d->var_decl_stmt.initializer = ast_clone(d->var_decl_stmt.initializer);
+            break;
+        case AST_FN_DECL_STMT: {
+            struct ClaspArg **args = NULL;
+            for (size_t i = 0; i < cvector_size(d->fn_decl_stmt.args); ++i) {
+                struct ClaspArg *arg = malloc(sizeof(struct ClaspArg));
+                *arg = *d->fn_decl_stmt.args[i];
+                cvector_push_back(args, arg);
+            }
+            d->fn_decl_stmt.args = args;
+            d->fn_decl_stmt.body = ast_clone(d->fn_decl_stmt.body);
+            break;
+        }
+        case AST_IF_STMT:
+        case AST_WHILE_STMT:
+            d->cond_stmt.cond = ast_clone(d->cond_stmt.cond);
+            d->cond_stmt.body = ast_clone(d->cond_stmt.body);
+            break;
+        case AST_FOR_STMT:
+            d->for_stmt.init = ast_clone(d->for_stmt.init);
+            d->for_stmt.cond = ast_clone(d->for_stmt.cond);
+            d->for_stmt.step = ast_clone(d->for_stmt.step);
+            d->for_stmt.body = ast_clone(d->for_stmt.body);
+            break;
+        default: break;
+    }
+    return out;
+}
+
+void visit_unknown(ClaspASTNode *node) {
+    fprintf(stderr, "Internal error, please report this message: \n\n\"Unknown AST node type: %d\"\n", node->type);
+    exit(1);
+}
+
+void *visit(ClaspASTNode *node, void *args, ClaspASTVisitor v) {
+    if (!node) return NULL;
+    if (node->type < 0 || node->type >= CLASP_NUM_VISITORS) visit_unknown(node);
     return v[node->type](node, args);
 }
\ No newline at end of file
@@ -0,0 +1,586 @@
+/**
+ * Clasp binary AST cache implementation
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/ast_cache.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cvector/cvector.h>
+#include <sheredom-hashmap/hashmap.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Address -> id map. Nodes and tokens are numbered by address so shared subtrees (mostly type nodes) are stored once.
+*/
+typedef struct {
+    uintptr_t *keys;
+    uint32_t *vals;
+    size_t cap;
+    size_t size;
+} PtrMap;
+
+static size_t ptrmap_slot(PtrMap *m, uintptr_t key) {
+    size_t i = (key >> 4) * 0x9E3779B97F4A7C15ull & (m->cap - 1);
+    while (m->keys[i] && m->keys[i] != key) i = (i + 1) & (m->cap - 1);
+    return i;
+}
+
+static void ptrmap_put(PtrMap *m, void *ptr, uint32_t val) {
+    if ((m->size + 1) * 2 > m->cap) {
+        PtrMap grown = { calloc(m->cap ? m->cap * 2 : 64, sizeof(uintptr_t)), NULL, m->cap ? m->cap * 2 : 64, 0 };
+        grown.vals = calloc(grown.cap, sizeof(uint32_t));
+        for (size_t i = 0; i < m->cap; ++i)
+            if (m->keys[i]) ptrmap_put(&grown, (void *) m->keys[i], m->vals[i]);
+        free(m->keys);
+        free(m->vals);
+        *m = grown;
+    }
+    size_t i = ptrmap_slot(m, (uintptr_t) ptr);
+    if (!m->keys[i]) m->size++;
+    m->keys[i] = (uintptr_t) ptr;
+    m->vals[i] = val;
+}
+
+// Returns the id + 1, or 0 if the address isn't in the map.
+static uint32_t ptrmap_get(PtrMap *m, void *ptr) {
+    if (!m->cap) return 0;
+    size_t i = ptrmap_slot(m, (uintptr_t) ptr);
+    return m->keys[i] ? m->vals[i] + 1 : 0;
+}
+
+typedef struct {
+    PtrMap node_ids;
+    PtrMap token_ids;
+    hashmap_t strings;
+
+    cvector(ClaspASTNode *) nodes;
+    cvector(ClaspToken *) tokens;
+    cvector(char) string_data;
+} CacheWriter;
+
+static uint32_t writer_node_id(CacheWriter *w, ClaspASTNode *node) {
+    return ptrmap_get(&w->node_ids, node) - 1;
+}
+
+// Token indices are stored off by one, 0 means "no token".
+static uint32_t writer_token(CacheWriter *w, ClaspToken *tok) {
+    if (!tok) return 0;
+    uint32_t id = ptrmap_get(&w->token_ids, tok);
+    if (id) return id;
+
+    ptrmap_put(&w->token_ids, tok, cvector_size(w->tokens));
+    cvector_push_back(w->tokens, tok);
+    return cvector_size(w->tokens);
+}
+
+// Strings are keyed by the tree's own token data, which outlives the writer.
+static uint32_t writer_string(CacheWriter *w, char *str) {
+    if (!str) str = "";
+    size_t len = strlen(str);
+    uintptr_t off = (uintptr_t) hashmap_get(&w->strings, str, len);
+    if (off) return off - 1;
+
+    off = cvector_size(w->string_data);
+    for (size_t i = 0; i <= len; ++i) cvector_push_back(w->string_data, str[i]);
+    hashmap_put(&w->strings, str, len, (void *)(off + 1));
+    return off;
+}
+
+static void writer_add(CacheWriter *w, ClaspASTNode *node);
+
+static void writer_add_type(CacheWriter *w, struct ClaspType *type) {
+    if (type) writer_add(w, type->type);
+}
+
+static void writer_add(CacheWriter *w, ClaspASTNode *node) {
+    if (!node) return;
+    if (ptrmap_get(&w->node_ids, node)) return;
+
+    ptrmap_put(&w->node_ids, node, cvector_size(w->nodes));
+    cvector_push_back(w->nodes, node);
+
+    union ASTNodeData *d = &node->data;
+    switch (node->type) {
+        case AST_EXPR_BINOP:
+            writer_add(w, d->binop.left);
+            writer_add(w, d->binop.right);
+            break;
+        case AST_EXPR_UNOP:    writer_add(w, d->unop.right);   break;
+        case AST_EXPR_POSTFIX: writer_add(w, d->postfix.left); break;
+        case AST_EXPR_FN_CALL:
+            writer_add(w, d->fn_call.referencer);
+            for (size_t i = 0; i < cvector_size(d->fn_call.args); ++i) writer_add(w, d->fn_call.args[i]);
+            break;
+        case AST_RETURN_STMT: writer_add(w, d->return_stmt.retval); break;
+        case AST_EXPR_STMT:   writer_add(w, d->expr_stmt.expr);     break;
+        case AST_BLOCK_STMT:
+            for (size_t i = 0; i < cvector_size(d->block_stmt.body); ++i) writer_add(w, d->block_stmt.body[i]);
+            break;
+        case AST_VAR_DECL_STMT:
+        case AST_LET_DECL_STMT:
+        case AST_CONST_DECL_STMT:
+            writer_add(w, d->var_decl_stmt.type);
+            writer_add(w, d->var_decl_stmt.initializer);
+            break;
+        case AST_FN_DECL_STMT:
+            writer_add(w, d->fn_decl_stmt.ret_type);
+            writer_add(w, d->fn_decl_stmt.body);
+            for (size_t i = 0; i < cvector_size(d->fn_decl_stmt.args); ++i) writer_add(w, d->fn_decl_stmt.args[i]->type);
+            break;
+        case AST_IF_STMT:
+        case AST_WHILE_STMT:
+            writer_add(w, d->cond_stmt.cond);
+            writer_add(w, d->cond_stmt.body);
+            break;
+        case AST_FOR_STMT:
+            writer_add(w, d->for_stmt.init);
+            writer_add(w, d->for_stmt.cond);
+            writer_add(w, d->for_stmt.step);
+            writer_add(w, d->for_stmt.body);
+            break;
+        case AST_TYPE_ARRAY: writer_add(w, d->array.enclosed); break;
+        case AST_TYPE_FN:
+            for (size_t i = 0; i < cvector_size(d->function.args); ++i) writer_add(w, d->function.args[i]);
+            writer_add(w, d->function.ret);
+            break;
+        case AST_TYPE_TEMPLATE:
+            for (size_t i = 0; i < cvector_size(d->template.template); ++i) writer_add(w, d->template.template[i]);
+            break;
+        case AST_TYPE_PTR: writer_add(w, d->pointer.pointed); break;
+        default: break;
+    }
+    writer_add_type(w, node->exprType);
+}
+
+static int32_t writer_link(CacheWriter *w, uint32_t self, ClaspASTNode *node) {
+    if (!node) return 0;
+    return (int32_t)writer_node_id(w, node) - (int32_t)self;
+}
+
+static void writer_list(CacheWriter *w, cvector(int32_t) *lists, ClaspASTCacheNode *rec, uint32_t self, cvector(ClaspASTNode *) nodes) {
+    rec->list = cvector_size(*lists);
+    rec->list_len = cvector_size(nodes);
+    for (size_t i = 0; i < cvector_size(nodes); ++i) cvector_push_back(*lists, writer_link(w, self, nodes[i]));
+}
+
+bool ast_cache_write(ClaspASTNode *ast, char *fname) {
+    CacheWriter w = { 0 };
+    hashmap_create(64, &w.strings);
+
+    writer_add(&w, ast);
+
+    cvector(ClaspASTCacheNode) records = NULL;
+    cvector(int32_t) lists = NULL;
+    cvector_reserve(records, cvector_size(w.nodes));
+
+    for (uint32_t i = 0; i < cvector_size(w.nodes); ++i) {
+        ClaspASTNode *node = w.nodes[i];
+        union ASTNodeData *d = &node->data;
+        ClaspASTCacheNode rec = { 0 };
+        rec.kind = node->type;
+        if (node->exprType) {
+            rec.has_type = 1;
+            rec.flag = node->exprType->flag;
+            rec.type = writer_link(&w, i, node->exprType->type);
+        }
+
+        switch (node->type) {
+            case AST_EXPR_BINOP:
+                rec.a = writer_link(&w, i, d->binop.left);
+                rec.b = writer_link(&w, i, d->binop.right);
+                rec.token = writer_token(&w, d->binop.op);
+                break;
+            case AST_EXPR_UNOP:
+                rec.a = writer_link(&w, i, d->unop.right);
+                rec.token = writer_token(&w, d->unop.op);
+                break;
+            case AST_EXPR_POSTFIX:
+                rec.a = writer_link(&w, i, d->postfix.left);
+                rec.token = writer_token(&w, d->postfix.op);
+                break;
+            case AST_EXPR_LIT_NUMBER: rec.token = writer_token(&w, d->lit_num.value);  break;
+            case AST_EXPR_VAR_REF:    rec.token = writer_token(&w, d->var_ref.varname); break;
+            case AST_EXPR_FN_CALL:
+                rec.a = writer_link(&w, i, d->fn_call.referencer);
+                writer_list(&w, &lists, &rec, i, d->fn_call.args);
+                break;
+            case AST_RETURN_STMT: rec.a = writer_link(&w, i, d->return_stmt.retval); break;
+            case AST_EXPR_STMT:   rec.a = writer_link(&w, i, d->expr_stmt.expr);     break;
+            case AST_BLOCK_STMT:  writer_list(&w, &lists, &rec, i, d->block_stmt.body); break;
+            case AST_VAR_DECL_STMT:
+            case AST_LET_DECL_STMT:
+            case AST_CONST_DECL_STMT:
+                rec.a = writer_link(&w, i, d->var_decl_stmt.type);
+                rec.b = writer_link(&w, i, d->var_decl_stmt.initializer);
+                rec.token = writer_token(&w, d->var_decl_stmt.name);
+                break;
+            case AST_FN_DECL_STMT:
+                rec.a = writer_link(&w, i, d->fn_decl_stmt.ret_type);
+                rec.b = writer_link(&w, i, d->fn_decl_stmt.body);
+                rec.token = writer_token(&w, d->fn_decl_stmt.name);
+                // Arguments are stored as (token, type link) pairs.
+                rec.list = cvector_size(lists);
+                rec.list_len = cvector_size(d->fn_decl_stmt.args);
+                for (size_t j = 0; j < cvector_size(d->fn_decl_stmt.args); ++j) {
+                    cvector_push_back(lists, (int32_t) writer_token(&w, d->fn_decl_stmt.args[j]->name));
+                    cvector_push_back(lists, writer_link(&w, i, d->fn_decl_stmt.args[j]->type));
+                }
+                break;
+            case AST_IF_STMT:
+            case AST_WHILE_STMT:
+                rec.a = writer_link(&w, i, d->cond_stmt.cond);
+                rec.b = writer_link(&w, i, d->cond_stmt.body);
+                break;
+            case AST_FOR_STMT:
+                rec.a = writer_link(&w, i, d->for_stmt.init);
+                rec.b = writer_link(&w, i, d->for_stmt.cond);
+                rec.list = cvector_size(lists);
+                rec.list_len = 2;
+                cvector_push_back(lists, writer_link(&w, i, d->for_stmt.step));
+                cvector_push_back(lists, writer_link(&w, i, d->for_stmt.body));
+                break;
+            case AST_TYPE_SINGLE: rec.token = writer_token(&w, d->single.name);   break;
+            case AST_TYPE_ARRAY:  rec.a = writer_link(&w, i, d->array.enclosed); break;
+            case AST_TYPE_FN:
+                rec.a = writer_link(&w, i, d->function.ret);
+                writer_list(&w, &lists, &rec, i, d->function.args);
+                break;
+            case AST_TYPE_TEMPLATE:
+                rec.token = writer_token(&w, d->template.typename);
+                writer_list(&w, &lists, &rec, i, d->template.template);
+                break;
+            case AST_TYPE_PTR: rec.a = writer_link(&w, i, d->pointer.pointed); break;
+            default: break;
+        }
+        cvector_push_back(records, rec);
+    }
+
+    cvector(ClaspASTCacheToken) tokens = NULL;
+    for (size_t i = 0; i < cvector_size(w.tokens); ++i) {
+        ClaspToken *tok = w.tokens[i];
+        ClaspASTCacheToken rec = { 0 };
+        rec.data = writer_string(&w, tok->data);
+        rec.type = tok->type;
+        rec.lineno = tok->lineno;
+        rec.where = tok->where;
+        cvector_push_back(tokens, rec);
+    }
+
+    ClaspASTCacheHeader head = { 0 };
+    memcpy(head.magic, CLASP_AST_CACHE_MAGIC, sizeof(head.magic));
+    head.version = CLASP_AST_CACHE_VERSION;
+    head.endian = CLASP_AST_CACHE_ENDIAN;
+    head.node_count = cvector_size(records);
+    head.token_count = cvector_size(tokens);
+    head.list_count = cvector_size(lists);
+    head.string_size = cvector_size(w.string_data);
+    head.root = 0;
+
+    bool ok = false;
+    FILE *f = fopen(fname, "wb");
+    if (!f) {
+        fprintf(stderr, "Failed to open AST cache file %s for writing.\n", fname);
+    } else {
+        ok = fwrite(&head, sizeof(head), 1, f) == 1;
+        if (ok && head.node_count)  ok = fwrite(records, sizeof(ClaspASTCacheNode), head.node_count, f) == head.node_count;
+        if (ok && head.token_count) ok = fwrite(tokens, sizeof(ClaspASTCacheToken), head.token_count, f) == head.token_count;
+        if (ok && head.list_count)  ok = fwrite(lists, sizeof(int32_t), head.list_count, f) == head.list_count;
+        if (ok && head.string_size) ok = fwrite(w.string_data, 1, head.string_size, f) == head.string_size;
+        if (!ok) fprintf(stderr, "Failed to write AST cache file %s.\n", fname);
+        fclose(f);
+    }
+
+    free(w.node_ids.keys);
+    free(w.node_ids.vals);
+    free(w.token_ids.keys);
+    free(w.token_ids.vals);
+    hashmap_destroy(&w.strings);
+    cvector_free(w.nodes);
+    cvector_free(w.tokens);
+    cvector_free(w.string_data);
+    cvector_free(records);
+    cvector_free(tokens);
+    cvector_free(lists);
+    return ok;
+}
+
+static void *map_file(char *fname, size_t *size) {
+#ifdef _WIN32
+    FILE *f = fopen(fname, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    *size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    void *buf = malloc(*size);
+    if (fread(buf, 1, *size, f) != *size) {
+        free(buf);
+        buf = NULL;
+    }
+    fclose(f);
+    return buf;
+#else
+    int fd = open(fname, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+    *size = st.st_size;
+    void *map = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    return map == MAP_FAILED ? NULL : map;
+#endif
+}
+
+static void unmap_file(void *map, size_t size) {
+#ifdef _WIN32
+    free(map);
+#else
+    munmap(map, size);
+#endif
+}
+
+// Resolve a relative link, checking it stays inside the node section.
+static bool load_link(const ClaspASTCacheHeader *head, uint32_t self, int32_t link, ClaspASTNode *nodes, ClaspASTNode **out) {
+    if (link == 0) {
+        *out = NULL;
+        return true;
+    }
+    int64_t target = (int64_t)self + link;
+    if (target < 0 || target >= head->node_count) return false;
+    *out = &nodes[target];
+    return true;
+}
+
+static bool load_token(const ClaspASTCacheHeader *head, uint32_t idx, ClaspToken *tokens, ClaspToken **out) {
+    if (idx > head->token_count) return false;
+    *out = idx ? &tokens[idx - 1] : NULL;
+    return true;
+}
+
+static bool load_list(const ClaspASTCacheHeader *head, const int32_t *entries, const ClaspASTCacheNode *rec, uint32_t self, ClaspASTNode *nodes, cvector(ClaspASTNode *) *out) {
+    *out = NULL;
+    if ((uint64_t)rec->list + rec->list_len > head->list_count) return false;
+    if (rec->list_len == 0) return true;
+
+    cvector_reserve(*out, rec->list_len);
+    for (uint32_t i = 0; i < rec->list_len; ++i) {
+        ClaspASTNode *node;
+        if (!load_link(head, self, entries[rec->list + i], nodes, &node)) return false;
+        cvector_push_back(*out, node);
+    }
+    return true;
+}
+
+ClaspASTCache *ast_cache_load(char *fname) {
+    size_t size = 0;
+    char *map = map_file(fname, &size);
+    if (!map) {
+        fprintf(stderr, "Failed to open AST cache file %s\n", fname);
+        return NULL;
+    }
+
+    const ClaspASTCacheHeader *head = (const ClaspASTCacheHeader *) map;
+    if (size < sizeof(*head) || memcmp(head->magic, CLASP_AST_CACHE_MAGIC, sizeof(head->magic))) {
+        fprintf(stderr, "Invalid header in AST cache file: %s\n", fname);
+        unmap_file(map, size);
+        return NULL;
+    }
+    if (head->version != CLASP_AST_CACHE_VERSION || head->endian != CLASP_AST_CACHE_ENDIAN) {
+        fprintf(stderr, "AST cache file %s was written by an incompatible compiler (version %d).\n", fname, head->version);
+        unmap_file(map, size);
+        return NULL;
+    }
+
+    uint64_t expected = sizeof(*head)
+        + (uint64_t)head->node_count  * sizeof(ClaspASTCacheNode)
+        + (uint64_t)head->token_count * sizeof(ClaspASTCacheToken)
+        + (uint64_t)head->list_count  * sizeof(int32_t)
+        + head->string_size;
+    if (expected != size || head->node_count == 0 || head->root >= head->node_count
+        || (head->string_size && map[size - 1] != '\0')) {
+        fprintf(stderr, "AST cache file %s is truncated or corrupt.\n", fname);
+        unmap_file(map, size);
+        return NULL;
+    }
+
+    const ClaspASTCacheNode  *recs    = (const ClaspASTCacheNode *)(map + sizeof(*head));
+    const ClaspASTCacheToken *trecs   = (const ClaspASTCacheToken *)(recs + head->node_count);
+    const int32_t            *entries = (const int32_t *)(trecs + head->token_count);
+    char                     *strings = (char *)(entries + head->list_count);
+
+    // Everything except node lists shares one allocation.
+    size_t n_args = 0;
+    for (uint32_t i = 0; i < head->node_count; ++i)
+        if (recs[i].kind == AST_FN_DECL_STMT) n_args += recs[i].list_len;
+
+    size_t nodes_size  = head->node_count  * sizeof(ClaspASTNode);
+    size_t types_size  = head->node_count  * sizeof(struct ClaspType);
+    size_t tokens_size = head->token_count * sizeof(ClaspToken);
+    char *arena = calloc(1, nodes_size + types_size + tokens_size + n_args * sizeof(struct ClaspArg) + 1);
+
+    ClaspASTNode     *nodes  = (ClaspASTNode *) arena;
+    struct ClaspType *types  = (struct ClaspType *)(arena + nodes_size);
+    ClaspToken       *tokens = (ClaspToken *)(arena + nodes_size + types_size);
+    struct ClaspArg  *args   = (struct ClaspArg *)(arena + nodes_size + types_size + tokens_size);
+
+    ClaspASTCache *cache = malloc(sizeof(ClaspASTCache));
+    cache->_map = map;
+    cache->_map_size = size;
+    cache->_arena = arena;
+    cache->_node_count = head->node_count;
+    cache->root = &nodes[head->root];
+
+    for (uint32_t i = 0; i < head->token_count; ++i) {
+        if (trecs[i].data >= head->string_size) goto corrupt;
+        tokens[i].data = strings + trecs[i].data;
+        tokens[i].type = trecs[i].type;
+        tokens[i].line = "";
+        tokens[i].lineno = trecs[i].lineno;
+        tokens[i].where = trecs[i].where;
+    }
+
+    for (uint32_t i = 0; i < head->node_count; ++i) {
+        const ClaspASTCacheNode *rec = &recs[i];
+        ClaspASTNode *node = &nodes[i];
+        union ASTNodeData *d = &node->data;
+        if (rec->kind >= CLASP_NUM_VISITORS) goto corrupt;
+        node->type = rec->kind;
+
+        if (rec->has_type) {
+            node->exprType = &types[i];
+            node->exprType->flag = rec->flag;
+            if (!load_link(head, i, rec->type, nodes, &node->exprType->type)) goto corrupt;
+        }
+
+        bool ok = true;
+        switch (node->type) {
+            case AST_EXPR_BINOP:
+                ok = load_link(head, i, rec->a, nodes, &d->binop.left)
+                  && load_link(head, i, rec->b, nodes, &d->binop.right)
+                  && load_token(head, rec->token, tokens, &d->binop.op);
+                break;
+            case AST_EXPR_UNOP:
+                ok = load_link(head, i, rec->a, nodes, &d->unop.right)
+                  && load_token(head, rec->token, tokens, &d->unop.op);
+                break;
+            case AST_EXPR_POSTFIX:
+                ok = load_link(head, i, rec->a, nodes, &d->postfix.left)
+                  && load_token(head, rec->token, tokens, &d->postfix.op);
+                break;
+            case AST_EXPR_LIT_NUMBER: ok = load_token(head, rec->token, tokens, &d->lit_num.value);  break;
+            case AST_EXPR_VAR_REF:    ok = load_token(head, rec->token, tokens, &d->var_ref.varname); break;
+            case AST_EXPR_FN_CALL:
+                ok = load_link(head, i, rec->a, nodes, &d->fn_call.referencer)
+                  && load_list(head, entries, rec, i, nodes, &d->fn_call.args);
+                break;
+            case AST_RETURN_STMT: ok = load_link(head, i, rec->a, nodes, &d->return_stmt.retval); break;
+            case AST_EXPR_STMT:   ok = load_link(head, i, rec->a, nodes, &d->expr_stmt.expr);     break;
+            case AST_BLOCK_STMT:  ok = load_list(head, entries, rec, i, nodes, &d->block_stmt.body); break;
+            case AST_VAR_DECL_STMT:
+            case AST_LET_DECL_STMT:
+            case AST_CONST_DECL_STMT:
+                ok = load_link(head, i, rec->a, nodes, &d->var_decl_stmt.type)
+                  && load_link(head, i, rec->b, nodes, &d->var_decl_stmt.initializer)
+                  && load_token(head, rec->token, tokens, &d->var_decl_stmt.name);
+                break;
+            case AST_FN_DECL_STMT:
+                ok = load_link(head, i, rec->a, nodes, &d->fn_decl_stmt.ret_type)
+                  && load_link(head, i, rec->b, nodes, &d->fn_decl_stmt.body)
+                  && load_token(head, rec->token, tokens, &d->fn_decl_stmt.name)
+                  && (uint64_t)rec->list + 2 * (uint64_t)rec->list_len <= head->list_count;
+                d->fn_decl_stmt.args = NULL;
+                if (ok && rec->list_len) cvector_reserve(d->fn_decl_stmt.args, rec->list_len);
+                for (uint32_t j = 0; ok && j < rec->list_len; ++j) {
+                    struct ClaspArg *arg = args++;
+                    ok = load_token(head, entries[rec->list + 2*j], tokens, &arg->name)
+                      && load_link(head, i, entries[rec->list + 2*j + 1], nodes, &arg->type);
+                    cvector_push_back(d->fn_decl_stmt.args, arg);
+                }
+                break;
+            case AST_IF_STMT:
+            case AST_WHILE_STMT:
+                ok = load_link(head, i, rec->a, nodes, &d->cond_stmt.cond)
+                  && load_link(head, i, rec->b, nodes, &d->cond_stmt.body);
+                break;
+            case AST_FOR_STMT:
+                ok = rec->list_len == 2 && (uint64_t)rec->list + 2 <= head->list_count
+                  && load_link(head, i, rec->a, nodes, &d->for_stmt.init)
+                  && load_link(head, i, rec->b, nodes, &d->for_stmt.cond)
+                  && load_link(head, i, entries[rec->list],     nodes, &d->for_stmt.step)
+                  && load_link(head, i, entries[rec->list + 1], nodes, &d->for_stmt.body);
+                break;
+            case AST_TYPE_SINGLE: ok = load_token(head, rec->token, tokens, &d->single.name);  break;
+            case AST_TYPE_ARRAY:  ok = load_link(head, i, rec->a, nodes, &d->array.enclosed); break;
+            case AST_TYPE_FN:
+                ok = load_link(head, i, rec->a, nodes, &d->function.ret)
+                  && load_list(head, entries, rec, i, nodes, &d->function.args);
+                break;
+            case AST_TYPE_TEMPLATE:
+                ok = load_token(head, rec->token, tokens, &d->template.typename)
+                  && load_list(head, entries, rec, i, nodes, &d->template.template);
+                break;
+            case AST_TYPE_PTR: ok = load_link(head, i, rec->a, nodes, &d->pointer.pointed); break;
+            default: break;
+        }
+        if (!ok) goto corrupt;
+    }
+
+    return cache;
+
+corrupt:
+    fprintf(stderr, "AST cache file %s is truncated or corrupt.\n", fname);
+    ast_cache_free(cache);
+    return NULL;
+}
+
+void ast_cache_free(ClaspASTCache *cache) {
+    if (!cache) return;
+    // Lists are owned by their node and may have been grown by a pass, so they're freed through the tree.
+    ClaspASTNode *nodes = cache->_arena;
+    for (size_t i = 0; i < cache->_node_count; ++i) {
+        union ASTNodeData *d = &nodes[i].data;
+        switch (nodes[i].type) {
+            case AST_EXPR_FN_CALL:  cvector_free(d->fn_call.args);     break;
+            case AST_BLOCK_STMT:    cvector_free(d->block_stmt.body);  break;
+            case AST_FN_DECL_STMT:  cvector_free(d->fn_decl_stmt.args); break;
+            case AST_TYPE_FN:       cvector_free(d->function.args);    break;
+            case AST_TYPE_TEMPLATE: cvector_free(d->template.template); break;
+            default: break;
+        }
+    }
+    free(cache->_arena);
+    unmap_file(cache->_map, cache->_map_size);
+    free(cache);
+}
@@ -0,0 +1,434 @@
+/**
+ * Clasp bytecode implementation
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/bytecode.h>
+#include <clasp/types.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cvector/cvector.h>
+
+#define CLASP_OPCODE_INFO(op, name, operands, pops, pushes) { name, operands, pops, pushes },
+static const ClaspOpcodeInfo OPCODES[] = { CLASP_OPCODES(CLASP_OPCODE_INFO) };
+#undef CLASP_OPCODE_INFO
+
+#define CLASP_NAME_ENTRY(value, name) name,
+static const char *CLASS_NAMES[] = { CLASP_VALUE_CLASSES(CLASP_NAME_ENTRY) };
+static const char *MATH_NAMES[] = { CLASP_MATH_OPS(CLASP_NAME_ENTRY) };
+static const char *ARCH_NAMES[] = { CLASP_ARCHES(CLASP_NAME_ENTRY) };
+#undef CLASP_NAME_ENTRY
+
+const ClaspOpcodeInfo *bytecode_opcode(uint8_t op) {
+    return op < CLASP_NUM_OPCODES ? &OPCODES[op] : NULL;
+}
+
+const char *bytecode_class_name(ClaspValueClass cls) {
+    return cls <= CLB_VOID ? CLASS_NAMES[cls] : "?";
+}
+
+const char *bytecode_math_name(ClaspMathOp op) {
+    return op < CLASP_NUM_MATH_OPS ? MATH_NAMES[op] : "?";
+}
+
+const char *bytecode_arch_name(uint16_t arch) {
+    return arch < CLASP_NUM_ARCHES ? ARCH_NAMES[arch] : "?";
+}
+
+ClaspValueClass bytecode_class(ClaspASTNode *type) {
+    if (type && type->type == AST_TYPE_FN) return CLB_Q;
+    bool is_float = type_is_float(type);
+    switch (type_size(type)) {
+        case 1:  return CLB_B;
+        case 2:  return CLB_W;
+        case 4:  return is_float ? CLB_F4 : CLB_D;
+        case 8:  return is_float ? CLB_F8 : CLB_Q;
+        default: return CLB_VOID;
+    }
+}
+
+ClaspOpcode bytecode_math_op(ClaspValueClass a, ClaspValueClass b) {
+    if (a == CLB_F4 || a == CLB_F8) return a == CLB_F4 ? OP_MATHF4 : OP_MATHF8;
+    return OP_MATHBB + a * 4 + b; // Laid out as math<a><b> in CLASP_OPCODES
+}
+
+// ---- Building ----
+
+ClaspBytecode *bytecode_new(void) {
+    ClaspBytecode *bc = calloc(1, sizeof(ClaspBytecode));
+    bc->start = -1;
+    return bc;
+}
+
+void bytecode_op(ClaspBytecode *bc, ClaspOpcode op) {
+    cvector_push_back(bc->code, (uint8_t) op);
+}
+
+void bytecode_put(ClaspBytecode *bc, uint64_t value, size_t size) {
+    for (size_t i = 0; i < size; ++i) cvector_push_back(bc->code, (uint8_t) (value >> (i * 8)));
+}
+
+uint64_t bytecode_get(const uint8_t *p, size_t size) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; ++i) value |= (uint64_t) p[i] << (i * 8);
+    return value;
+}
+
+uint64_t bytecode_label(ClaspBytecode *bc) {
+    cvector_push_back(bc->atable, UINT64_MAX);
+    return cvector_size(bc->atable) - 1;
+}
+
+void bytecode_put_varint(ClaspBytecode *bc, uint64_t value) {
+    do {
+        uint8_t byte = value & 0x7f;
+        value >>= 7;
+        cvector_push_back(bc->code, (uint8_t) (byte | (value ? 0x80 : 0)));
+    } while (value);
+}
+
+uint64_t bytecode_get_varint(const uint8_t *p, const uint8_t *end, size_t *size) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < 10 && p + i < end; ++i) {
+        value |= (uint64_t) (p[i] & 0x7f) << (i * 7);
+        if (!(p[i] & 0x80)) {
+            *size = i + 1;
+            return value;
+        }
+    }
+    *size = 0;
+    return 0;
+}
+
+void bytecode_const(ClaspBytecode *bc, hashmap_t *pool, uint64_t cell) {
+    int64_t i = (int64_t) cell;
+    if (i >= INT8_MIN && i <= INT8_MAX) {
+        bytecode_op(bc, OP_CONSTB);
+        bytecode_put(bc, cell, 1);
+        return;
+    }
+    if (i >= INT16_MIN && i <= INT16_MAX) {
+        bytecode_op(bc, OP_CONSTW);
+        bytecode_put(bc, cell, 2);
+        return;
+    }
+    uintptr_t index = (uintptr_t) hashmap_get(pool, &cell, sizeof(cell));
+    if (!index) { // Keys must outlive the call, so the pool owns a copy
+        uint64_t *key = malloc(sizeof(cell));
+        *key = cell;
+        cvector_push_back(bc->constants, cell);
+        index = cvector_size(bc->constants);
+        hashmap_put(pool, key, sizeof(cell), (void *) index);
+    }
+    bytecode_op(bc, OP_CONSTK);
+    bytecode_put_varint(bc, index - 1);
+}
+
+static int free_key(void *context, struct hashmap_element_s *e) {
+    (void) context;
+    free((void *) e->key);
+    return -1;
+}
+
+void bytecode_pool_free(hashmap_t *pool) {
+    hashmap_iterate_pairs(pool, &free_key, NULL);
+    hashmap_destroy(pool);
+}
+
+void bytecode_place(ClaspBytecode *bc, uint64_t label) {
+    bc->atable[label] = cvector_size(bc->code);
+}
+
+uint64_t bytecode_native(ClaspBytecode *bc, int64_t fallback) {
+    cvector_push_back(bc->natives, ((ClaspBytecodeNative) { fallback, NULL }));
+    return cvector_size(bc->natives) - 1;
+}
+
+const ClaspBytecodeBlob *bytecode_native_find(const ClaspBytecodeNative *native, ClaspArch arch) {
+    for (size_t i = 0; i < cvector_size(native->blobs); ++i)
+        if (native->blobs[i].arch == arch) return &native->blobs[i];
+    return NULL;
+}
+
+void bytecode_native_blob(ClaspBytecode *bc, uint64_t native, ClaspArch arch, const void *code, size_t size) {
+    ClaspBytecodeNative *n = &bc->natives[native];
+    ClaspBytecodeBlob *blob = (ClaspBytecodeBlob *) bytecode_native_find(n, arch);
+    if (!blob) {
+        cvector_push_back(n->blobs, ((ClaspBytecodeBlob) { arch, NULL }));
+        blob = &n->blobs[cvector_size(n->blobs) - 1];
+    }
+    cvector_clear(blob->code);
+    for (size_t i = 0; i < size; ++i) cvector_push_back(blob->code, ((const uint8_t *) code)[i]);
+}
+
+static size_t operand_size(char kind) {
+    switch (kind) {
+        case '1': case 'o': case 'c': return 1;
+        case '2': return 2;
+        case '4': return 4;
+        default:  return 8;
+    }
+}
+
+size_t bytecode_decode(const uint8_t *code, size_t size, size_t pc, ClaspBytecodeInst *out) {
+    if (pc >= size || code[pc] >= CLASP_NUM_OPCODES) return 0;
+    *out = (ClaspBytecodeInst) { .op = code[pc] };
+    size_t at = pc + 1, arg = 0;
+    for (const char *kind = OPCODES[code[pc]].operands; *kind; ++kind) {
+        if (*kind == 's') {
+            const uint8_t *end = memchr(code + at, 0, size - at);
+            if (!end) return 0;
+            out->sym = (const char *) code + at;
+            at = end - code + 1;
+            continue;
+        }
+        if (*kind == 'v') {
+            size_t n;
+            out->args[arg++] = bytecode_get_varint(code + at, code + size, &n);
+            if (!n) return 0;
+            at += n;
+            continue;
+        }
+        size_t n = operand_size(*kind);
+        if (at + n > size) return 0;
+        out->args[arg++] = bytecode_get(code + at, n);
+        at += n;
+    }
+    return out->size = at - pc;
+}
+
+// ---- Files ----
+
+typedef struct Writer {
+    cvector(uint8_t) buf;
+} Writer;
+
+static void put(Writer *w, uint64_t value, size_t size) {
+    for (size_t i = 0; i < size; ++i) cvector_push_back(w->buf, (uint8_t) (value >> (i * 8)));
+}
+
+static void put_bytes(Writer *w, const void *data, size_t size) {
+    for (size_t i = 0; i < size; ++i) cvector_push_back(w->buf, ((const uint8_t *) data)[i]);
+}
+
+bool bytecode_write(ClaspBytecode *bc, const char *filename) {
+    Writer w = { NULL };
+    put_bytes(&w, CLASP_BYTECODE_MAGIC, 3);
+    put(&w, (uint64_t) bc->start, 8);
+    put(&w, cvector_size(bc->atable), 8);
+    for (size_t i = 0; i < cvector_size(bc->atable); ++i) put(&w, bc->atable[i], 8);
+    put(&w, cvector_size(bc->symbols), 8);
+    for (size_t i = 0; i < cvector_size(bc->symbols); ++i) {
+        size_t len = strlen(bc->symbols[i].name);
+        put(&w, len, 8);
+        put_bytes(&w, bc->symbols[i].name, len);
+        put(&w, bc->symbols[i].addr, 8);
+    }
+    put(&w, bc->globals, 8);
+    put(&w, cvector_size(bc->constants), 8);
+    for (size_t i = 0; i < cvector_size(bc->constants); ++i) put(&w, bc->constants[i], 8);
+    put(&w, cvector_size(bc->code), 8);
+    put_bytes(&w, bc->code, cvector_size(bc->code));
+    put(&w, cvector_size(bc->natives), 8);
+    for (size_t i = 0; i < cvector_size(bc->natives); ++i) {
+        ClaspBytecodeNative *n = &bc->natives[i];
+        put(&w, (uint64_t) n->fallback, 8);
+        put(&w, cvector_size(n->blobs), 8);
+        for (size_t j = 0; j < cvector_size(n->blobs); ++j) {
+            put(&w, n->blobs[j].arch, 2);
+            put(&w, cvector_size(n->blobs[j].code), 8);
+            put_bytes(&w, n->blobs[j].code, cvector_size(n->blobs[j].code));
+        }
+    }
+
+    FILE *f = fopen(filename, "wb");
+    if (!f) {
+        fprintf(stderr, "Failed to open bytecode file %s for writing.\n", filename);
+        cvector_free(w.buf);
+        return false;
+    }
+    bool ok = fwrite(w.buf, 1, cvector_size(w.buf), f) == cvector_size(w.buf);
+    ok = !fclose(f) && ok;
+    if (!ok) fprintf(stderr, "Failed to write bytecode file %s.\n", filename);
+    cvector_free(w.buf);
+    return ok;
+}
+
+typedef struct Reader {
+    const uint8_t *data;
+    size_t size, at;
+    bool ok;
+} Reader;
+
+static uint64_t get(Reader *r, size_t size) {
+    if (!r->ok || r->size - r->at < size) {
+        r->ok = false;
+        return 0;
+    }
+    uint64_t value = bytecode_get(r->data + r->at, size);
+    r->at += size;
+    return value;
+}
+
+// A count of `unit` sized records that must fit in the rest of the file.
+static uint64_t get_count(Reader *r, size_t unit) {
+    uint64_t n = get(r, 8);
+    if (r->ok && n > (r->size - r->at) / unit) r->ok = false;
+    return r->ok ? n : 0;
+}
+
+ClaspBytecode *bytecode_read(const char *filename) {
+    FILE *f = fopen(filename, "rb");
+    if (!f) {
+        fprintf(stderr, "Failed to open bytecode file %s.\n", filename);
+        return NULL;
+    }
+    cvector(uint8_t) data = NULL;
+    uint8_t chunk[4096];
+    for (size_t n; (n = fread(chunk, 1, sizeof(chunk), f)) > 0;)
+        for (size_t i = 0; i < n; ++i) cvector_push_back(data, chunk[i]);
+    fclose(f);
+
+    Reader r = { data, cvector_size(data), 3, cvector_size(data) >= 3 && !memcmp(data, CLASP_BYTECODE_MAGIC, 3) };
+    ClaspBytecode *bc = bytecode_new();
+    bc->start = (int64_t) get(&r, 8);
+    for (uint64_t i = 0, n = get_count(&r, 8); i < n; ++i) cvector_push_back(bc->atable, get(&r, 8));
+    for (uint64_t i = 0, n = get_count(&r, 16); r.ok && i < n; ++i) {
+        uint64_t len = get_count(&r, 1);
+        if (!r.ok) break;
+        ClaspBytecodeSymbol sym = { malloc(len + 1), 0 };
+        memcpy(sym.name, r.data + r.at, len);
+        sym.name[len] = '\0';
+        r.at += len;
+        sym.addr = get(&r, 8);
+        cvector_push_back(bc->symbols, sym);
+    }
+    bc->globals = get(&r, 8);
+    if (bc->globals > CLASP_BYTECODE_MAX_GLOBALS) r.ok = false;
+    for (uint64_t i = 0, n = get_count(&r, 8); i < n; ++i) cvector_push_back(bc->constants, get(&r, 8));
+    uint64_t code_size = get_count(&r, 1);
+    for (uint64_t i = 0; r.ok && i < code_size; ++i) cvector_push_back(bc->code, r.data[r.at + i]);
+    r.at += r.ok ? code_size : 0;
+    // Files written before native code existed end here
+    for (uint64_t i = 0, n = r.at < r.size ? get_count(&r, 16) : 0; r.ok && i < n; ++i) {
+        ClaspBytecodeNative native = { (int64_t) get(&r, 8), NULL };
+        for (uint64_t j = 0, blobs = get_count(&r, 10); r.ok && j < blobs; ++j) {
+            uint16_t arch = get(&r, 2);
+            uint64_t size = get_count(&r, 1);
+            if (!r.ok || bytecode_native_find(&native, arch)) {
+                r.ok = false;
+                break;
+            }
+            cvector_push_back(native.blobs, ((ClaspBytecodeBlob) { arch, NULL }));
+            for (uint64_t k = 0; k < size; ++k) cvector_push_back(native.blobs[j].code, r.data[r.at + k]);
+            r.at += size;
+        }
+        cvector_push_back(bc->natives, native); // Even when broken, so bytecode_free() gets its blobs
+    }
+    r.ok &= r.at == r.size;
+    cvector_free(data);
+
+    if (r.ok) { // Addresses must land in the code, and the entry point must exist
+        for (size_t i = 0; i < cvector_size(bc->atable); ++i) r.ok &= bc->atable[i] < code_size;
+        for (size_t i = 0; i < cvector_size(bc->symbols); ++i) r.ok &= bc->symbols[i].addr < cvector_size(bc->atable);
+        r.ok &= bc->start == -1 || (bc->start >= 0 && (uint64_t) bc->start < cvector_size(bc->atable));
+        for (size_t i = 0; i < cvector_size(bc->natives); ++i)
+            r.ok &= bc->natives[i].fallback == -1 ||
+                    (bc->natives[i].fallback >= 0 && (uint64_t) bc->natives[i].fallback < cvector_size(bc->atable));
+    }
+    if (!r.ok) {
+        fprintf(stderr, "Bytecode file %s is truncated or corrupt.\n", filename);
+        bytecode_free(bc);
+        return NULL;
+    }
+    return bc;
+}
+
+// ---- Listing ----
+
+void bytecode_disassemble(ClaspBytecode *bc, FILE *out) {
+    fprintf(out, "start %" PRId64 ", %" PRIu64 " globals\n", bc->start, bc->globals);
+    for (size_t i = 0; i < cvector_size(bc->symbols); ++i)
+        fprintf(out, "symbol %s = @%" PRIu64 "\n", bc->symbols[i].name, bc->symbols[i].addr);
+    for (size_t i = 0; i < cvector_size(bc->constants); ++i)
+        fprintf(out, "const #%zu = %" PRId64 " (0x%016" PRIx64 ")\n", i, (int64_t) bc->constants[i], bc->constants[i]);
+    for (size_t i = 0; i < cvector_size(bc->natives); ++i) {
+        fprintf(out, "native #%zu", i);
+        if (bc->natives[i].fallback >= 0) fprintf(out, " else @%" PRId64, bc->natives[i].fallback);
+        for (size_t j = 0; j < cvector_size(bc->natives[i].blobs); ++j)
+            fprintf(out, ", %s %zu bytes", bytecode_arch_name(bc->natives[i].blobs[j].arch),
+                    cvector_size(bc->natives[i].blobs[j].code));
+        fputc('\n', out);
+    }
+
+    size_t size = cvector_size(bc->code);
+    for (size_t pc = 0; pc < size;) {
+        for (size_t i = 0; i < cvector_size(bc->atable); ++i)
+            if (bc->atable[i] == pc) fprintf(out, "@%zu:\n", i);
+
+        ClaspBytecodeInst inst;
+        if (!bytecode_decode(bc->code, size, pc, &inst)) {
+            fprintf(out, "%6zu  <invalid %u>\n", pc, bc->code[pc]);
+            break;
+        }
+        fprintf(out, "%6zu  %s", pc, OPCODES[inst.op].name);
+        size_t arg = 0;
+        for (const char *kind = OPCODES[inst.op].operands; *kind; ++kind) {
+            if (*kind == 's') {
+                fprintf(out, " %s", inst.sym);
+                continue;
+            }
+            uint64_t v = inst.args[arg++];
+            switch (*kind) {
+                case 'o': fprintf(out, " %s", bytecode_math_name(v)); break;
+                case 'c': fprintf(out, " %s", bytecode_class_name(v)); break;
+                case 'a': fprintf(out, " @%" PRIu64, v); break;
+                case 'v':
+                case 'n': fprintf(out, " #%" PRIu64, v); break;
+                default: { // Constants are shown sign extended, like the VM loads them
+                    unsigned bits = operand_size(*kind) * 8;
+                    fprintf(out, " %" PRId64, bits == 64 ? (int64_t) v : (int64_t) (v << (64 - bits)) >> (64 - bits));
+                    break;
+                }
+            }
+        }
+        fputc('\n', out);
+        pc += inst.size;
+    }
+}
+
+void bytecode_free(ClaspBytecode *bc) {
+    if (!bc) return;
+    for (size_t i = 0; i < cvector_size(bc->symbols); ++i) free(bc->symbols[i].name);
+    cvector_free(bc->symbols);
+    cvector_free(bc->atable);
+    cvector_free(bc->constants);
+    cvector_free(bc->code);
+    for (size_t i = 0; i < cvector_size(bc->natives); ++i) {
+        for (size_t j = 0; j < cvector_size(bc->natives[i].blobs); ++j) cvector_free(bc->natives[i].blobs[j].code);
+        cvector_free(bc->natives[i].blobs);
+    }
+    cvector_free(bc->natives);
+    free(bc);
+}
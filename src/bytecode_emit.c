@@ -0,0 +1,400 @@
+/**
+ * Clasp bytecode emitter implementation
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/bytecode_emit.h>
+#include <clasp/err.h>
+#include <clasp/types.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cvector/cvector.h>
+
+typedef struct Emitter {
+    ClaspBytecode *bc;
+    ClaspValueClass ret;        // Return class of the function being emitted
+    bool live;                  // Whether the next instruction can be reached
+    hashmap_t pool;             // Wide constant -> pool index + 1
+    size_t errors;
+} Emitter;
+
+static bool is_float(ClaspValueClass cls) {
+    return cls == CLB_F4 || cls == CLB_F8;
+}
+
+static ClaspValueClass class_of(ClaspASTNode *node) {
+    return bytecode_class(node->exprType->type);
+}
+
+static void op(Emitter *e, ClaspOpcode o) {
+    bytecode_op(e->bc, o);
+}
+
+static void op_arg(Emitter *e, ClaspOpcode o, uint64_t arg, size_t size) {
+    bytecode_op(e->bc, o);
+    bytecode_put(e->bc, arg, size);
+}
+
+static void jump(Emitter *e, ClaspOpcode o, uint64_t label) {
+    op_arg(e, o, label, 8);
+    if (o == OP_JMP) e->live = false;
+}
+
+static void place(Emitter *e, uint64_t label) {
+    bytecode_place(e->bc, label);
+    e->live = true;
+}
+
+// Constants are loaded as the cell the VM keeps them in, see bytecode_const().
+static void push_const(Emitter *e, ClaspValueClass cls, int64_t i, double f) {
+    uint64_t cell;
+    switch (cls) {
+        case CLB_B:  cell = (int8_t) i; break;
+        case CLB_W:  cell = (int16_t) i; break;
+        case CLB_D:  cell = (int32_t) i; break;
+        case CLB_F4: {
+            float v = f;
+            uint32_t bits;
+            memcpy(&bits, &v, 4);
+            cell = bits;
+            break;
+        }
+        case CLB_F8: memcpy(&cell, &f, 8); break;
+        default: cell = i; break;
+    }
+    bytecode_const(e->bc, &e->pool, cell);
+}
+
+// Integers are kept sign extended, so only narrowing them takes an instruction.
+static void conv(Emitter *e, ClaspValueClass from, ClaspValueClass to) {
+    if (from == to || from == CLB_VOID || to == CLB_VOID) return;
+    if (!is_float(from) && !is_float(to) && to > from) return;
+    op(e, OP_CONV);
+    bytecode_put(e->bc, from, 1);
+    bytecode_put(e->bc, to, 1);
+}
+
+static void math(Emitter *e, ClaspOpcode o, ClaspMathOp m) {
+    op_arg(e, o, m, 1);
+}
+
+static bool bad_slot(Emitter *e, ClaspToken *name, ClaspSlot slot) {
+    if (slot.kind == CLASP_SLOT_LOCAL || slot.kind == CLASP_SLOT_GLOBAL) return false;
+    if (slot.kind == CLASP_SLOT_OUTER) semantic_err(name, "Functions cannot use '%s' from an enclosing function yet.", name->data);
+    else semantic_err(name, "'%s' cannot be used as a value in bytecode.", name->data);
+    e->errors++;
+    return true;
+}
+
+static void store(Emitter *e, ClaspToken *name, ClaspSlot slot) {
+    if (bad_slot(e, name, slot)) return;
+    if (slot.kind == CLASP_SLOT_LOCAL) op_arg(e, OP_STOREL, slot.index, 2);
+    else op_arg(e, OP_STOREG, slot.index, 4);
+}
+
+// ---- Expressions ----
+
+static void emit_expr(Emitter *e, ClaspASTNode *node);
+
+static ClaspMathOp math_op(ClaspTokenType op) {
+    switch (op) {
+        case TOKEN_PLUS:    case TOKEN_PLUS_EQ:    case TOKEN_PLUS_PLUS:   return CLB_ADD;
+        case TOKEN_MINUS:   case TOKEN_MINUS_EQ:   case TOKEN_MINUS_MINUS: return CLB_SUB;
+        case TOKEN_ASTERIX: case TOKEN_ASTERIX_EQ: return CLB_MUL;
+        case TOKEN_SLASH:   case TOKEN_SLASH_EQ:   return CLB_DIV;
+        case TOKEN_PERC:    case TOKEN_PERC_EQ:    return CLB_REM;
+        case TOKEN_TILDE_EQ:                       return CLB_XOR;
+        case TOKEN_LESS_LESS:                      return CLB_SHL;
+        case TOKEN_EQ_EQ:      return CLB_EQ;
+        case TOKEN_BANG_EQ:    return CLB_NE;
+        case TOKEN_LESS:       return CLB_LT;
+        case TOKEN_LESS_EQ:    return CLB_LE;
+        case TOKEN_GREATER:    return CLB_GT;
+        case TOKEN_GREATER_EQ: return CLB_GE;
+        default:               return CLASP_NUM_MATH_OPS;
+    }
+}
+
+// Push both operands and apply `m`, giving a result of class `t`.
+static void emit_arith(Emitter *e, ClaspMathOp m, ClaspASTNode *left, ClaspASTNode *right, ClaspValueClass t) {
+    ClaspValueClass lc = class_of(left), rc = class_of(right);
+    if (is_float(t)) {
+        emit_expr(e, left);
+        conv(e, lc, t);
+        emit_expr(e, right);
+        conv(e, rc, t);
+        math(e, bytecode_math_op(t, t), m);
+        return;
+    }
+    emit_expr(e, left);
+    emit_expr(e, right);
+    math(e, bytecode_math_op(lc, rc), m);
+    conv(e, lc > rc ? lc : rc, t);
+}
+
+static void emit_compare(Emitter *e, ClaspMathOp m, ClaspASTNode *left, ClaspASTNode *right) {
+    ClaspValueClass t = bytecode_class(type_promote(left->exprType->type, right->exprType->type));
+    if (!is_float(t)) { // Sign extended integers compare the same whatever their width
+        emit_expr(e, left);
+        emit_expr(e, right);
+        math(e, OP_CMPI, m);
+        return;
+    }
+    emit_expr(e, left);
+    conv(e, class_of(left), t);
+    emit_expr(e, right);
+    conv(e, class_of(right), t);
+    math(e, t == CLB_F4 ? OP_CMPF4 : OP_CMPF8, m);
+}
+
+static void emit_binop(Emitter *e, ClaspASTNode *node) {
+    ClaspASTNode *left = node->data.binop.left, *right = node->data.binop.right;
+    ClaspTokenType tok = node->data.binop.op->type;
+    ClaspValueClass lc = class_of(left);
+    ClaspMathOp m = math_op(tok);
+    if (tok != TOKEN_EQ && m == CLASP_NUM_MATH_OPS) {
+        semantic_err(node->data.binop.op, "Operator '%s' is not supported in bytecode.", node->data.binop.op->data);
+        e->errors++;
+        return;
+    }
+
+    if (m >= CLB_EQ && m < CLASP_NUM_MATH_OPS) return emit_compare(e, m, left, right);
+    if (m == CLB_SHL) {
+        emit_expr(e, left);
+        emit_expr(e, right);
+        conv(e, class_of(right), lc);
+        math(e, bytecode_math_op(lc, lc), CLB_SHL);
+        return;
+    }
+    if (!tktyp_is_assignment(tok)) return emit_arith(e, m, left, right, class_of(node));
+
+    if (left->type != AST_EXPR_VAR_REF) return; // The type check rejects assigning to anything else
+    if (tok == TOKEN_EQ) {
+        emit_expr(e, right);
+        conv(e, class_of(right), lc);
+    } else { // Compound assignment: compute in the promoted type, store in the variable's
+        ClaspValueClass t = bytecode_class(type_promote(left->exprType->type, right->exprType->type));
+        emit_arith(e, m, left, right, t);
+        conv(e, t, lc);
+    }
+    op(e, OP_DUP);
+    store(e, left->data.var_ref.varname, left->data.var_ref.slot);
+}
+
+static void emit_call(Emitter *e, ClaspASTNode *node) {
+    ClaspASTNode *callee = node->data.fn_call.referencer;
+    ClaspASTNode *sig = callee->exprType->type;
+    size_t argc = cvector_size(node->data.fn_call.args);
+    bool results = bytecode_class(sig->data.function.ret) != CLB_VOID;
+    ClaspSlot slot = callee->type == AST_EXPR_VAR_REF ? callee->data.var_ref.slot : (ClaspSlot) { CLASP_SLOT_NONE };
+    bool direct = slot.kind == CLASP_SLOT_FN || slot.kind == CLASP_SLOT_BUILTIN;
+
+    if (!direct) emit_expr(e, callee);
+    for (size_t i = 0; i < argc; ++i) {
+        emit_expr(e, node->data.fn_call.args[i]);
+        conv(e, class_of(node->data.fn_call.args[i]), bytecode_class(sig->data.function.args[i]));
+    }
+    if (slot.kind == CLASP_SLOT_FN) {
+        op_arg(e, OP_CALL, slot.index, 8); // Function i is address table entry i
+    } else if (slot.kind == CLASP_SLOT_BUILTIN) {
+        op(e, OP_JSYM);
+    } else {
+        op(e, OP_CALLI);
+    }
+    bytecode_put(e->bc, argc, 1);
+    bytecode_put(e->bc, results, 1);
+    if (slot.kind == CLASP_SLOT_BUILTIN) {
+        const char *name = callee->data.var_ref.varname->data;
+        for (size_t i = 0; i <= strlen(name); ++i) bytecode_put(e->bc, (uint8_t) name[i], 1);
+    }
+    if (results) conv(e, bytecode_class(sig->data.function.ret), class_of(node)); // Lowered calls may be typed otherwise, see lower_pow
+}
+
+static void emit_expr(Emitter *e, ClaspASTNode *node) {
+    switch (node->type) {
+        case AST_EXPR_LIT_NUMBER: {
+            const char *text = node->data.lit_num.value->data;
+            push_const(e, class_of(node), strtoll(text, NULL, 10), strtod(text, NULL));
+            break;
+        }
+        case AST_EXPR_VAR_REF: {
+            ClaspSlot slot = node->data.var_ref.slot;
+            if (slot.kind == CLASP_SLOT_FN) bytecode_const(e->bc, &e->pool, slot.index);
+            else if (bad_slot(e, node->data.var_ref.varname, slot)) break;
+            else if (slot.kind == CLASP_SLOT_LOCAL) op_arg(e, OP_LOADL, slot.index, 2);
+            else op_arg(e, OP_LOADG, slot.index, 4);
+            break;
+        }
+        case AST_EXPR_BINOP: emit_binop(e, node); break;
+        case AST_EXPR_UNOP: {
+            ClaspValueClass t = class_of(node->data.unop.right);
+            emit_expr(e, node->data.unop.right);
+            switch (node->data.unop.op->type) {
+                case TOKEN_MINUS: op_arg(e, OP_NEG, t, 1); break;
+                case TOKEN_TILDE: op_arg(e, OP_NOT, t, 1); break;
+                case TOKEN_BANG:
+                    push_const(e, t, 0, 0);
+                    math(e, t == CLB_F4 ? OP_CMPF4 : t == CLB_F8 ? OP_CMPF8 : OP_CMPI, CLB_EQ);
+                    break;
+                default: break;
+            }
+            break;
+        }
+        case AST_EXPR_POSTFIX: {
+            ClaspASTNode *target = node->data.postfix.left;
+            ClaspValueClass t = class_of(target);
+            emit_expr(e, target);
+            op(e, OP_DUP);
+            push_const(e, t, 1, 1);
+            math(e, bytecode_math_op(t, t), math_op(node->data.postfix.op->type));
+            if (target->type == AST_EXPR_VAR_REF) store(e, target->data.var_ref.varname, target->data.var_ref.slot);
+            break;
+        }
+        case AST_EXPR_FN_CALL: emit_call(e, node); break;
+        default: break;
+    }
+}
+
+// Push a branch condition as an integer, floats compare against zero.
+static void emit_cond(Emitter *e, ClaspASTNode *cond) {
+    ClaspValueClass t = class_of(cond);
+    emit_expr(e, cond);
+    if (!is_float(t)) return;
+    push_const(e, t, 0, 0);
+    math(e, t == CLB_F4 ? OP_CMPF4 : OP_CMPF8, CLB_NE);
+}
+
+// ---- Statements ----
+
+static void emit_stmt(Emitter *e, ClaspASTNode *node);
+
+/**
+ * Loops are rotated, so an iteration is the body and one conditional jump:
+ *   jmp cond; body: <body> <step>; cond: <cond> jnz body
+*/
+static void emit_loop(Emitter *e, ClaspASTNode *cond, ClaspASTNode *body, ClaspASTNode *step) {
+    uint64_t top = bytecode_label(e->bc), test = cond ? bytecode_label(e->bc) : top;
+    if (cond) jump(e, OP_JMP, test);
+    place(e, top);
+    emit_stmt(e, body);
+    emit_stmt(e, step);
+    if (!cond) return jump(e, OP_JMP, top);
+    place(e, test);
+    emit_cond(e, cond);
+    jump(e, OP_JNZ, top);
+}
+
+static void emit_stmt(Emitter *e, ClaspASTNode *node) {
+    if (!node || !e->live || node->type == AST_FN_DECL_STMT) return; // Functions are emitted on their own
+
+    switch (node->type) {
+        case AST_BLOCK_STMT:
+            for (size_t i = 0; i < cvector_size(node->data.block_stmt.body); ++i) emit_stmt(e, node->data.block_stmt.body[i]);
+            break;
+        case AST_RETURN_STMT:
+            if (node->data.return_stmt.retval && e->ret != CLB_VOID) {
+                emit_expr(e, node->data.return_stmt.retval);
+                conv(e, class_of(node->data.return_stmt.retval), e->ret);
+                op(e, OP_RETV);
+            } else {
+                op(e, OP_RET);
+            }
+            e->live = false;
+            break;
+        case AST_VAR_DECL_STMT:
+        case AST_LET_DECL_STMT:
+        case AST_CONST_DECL_STMT: {
+            ClaspASTNode *init = node->data.var_decl_stmt.initializer;
+            ClaspValueClass t = bytecode_class(node->data.var_decl_stmt.type);
+            if (init) {
+                emit_expr(e, init);
+                conv(e, class_of(init), t);
+            } else {
+                push_const(e, t, 0, 0);
+            }
+            store(e, node->data.var_decl_stmt.name, node->data.var_decl_stmt.slot);
+            break;
+        }
+        case AST_IF_STMT: {
+            uint64_t end = bytecode_label(e->bc);
+            emit_cond(e, node->data.cond_stmt.cond);
+            jump(e, OP_JZ, end);
+            emit_stmt(e, node->data.cond_stmt.body);
+            place(e, end);
+            break;
+        }
+        case AST_WHILE_STMT: emit_loop(e, node->data.cond_stmt.cond, node->data.cond_stmt.body, NULL); break;
+        case AST_FOR_STMT:
+            emit_stmt(e, node->data.for_stmt.init);
+            emit_loop(e, node->data.for_stmt.cond, node->data.for_stmt.body, node->data.for_stmt.step);
+            break;
+        default: { // Expression statements, and bare expressions such as for loop steps
+            ClaspASTNode *expr = node->type == AST_EXPR_STMT ? node->data.expr_stmt.expr : node;
+            emit_expr(e, expr);
+            if (class_of(expr) != CLB_VOID) op(e, OP_POP);
+            break;
+        }
+    }
+}
+
+static void emit_fn(Emitter *e, uint64_t label, ClaspASTNode *body, uint32_t frame_size, ClaspValueClass ret) {
+    e->ret = ret;
+    place(e, label);
+    op_arg(e, OP_ENTER, frame_size, 2);
+    emit_stmt(e, body);
+    if (!e->live) return;
+    if (ret == CLB_VOID) return op(e, OP_RET);
+    push_const(e, ret, 0, 0); // Falling off the end of a function that returns a value
+    op(e, OP_RETV);
+}
+
+ClaspBytecode *bytecode_emit(ClaspASTNode *ast, ClaspResolution *res) {
+    Emitter e = { .bc = bytecode_new() };
+    hashmap_create(16, &e.pool);
+    size_t nfns = cvector_size(res->fns);
+    for (size_t i = 0; i <= nfns; ++i) bytecode_label(e.bc); // The functions, then the entry point
+    e.bc->start = nfns;
+    e.bc->globals = cvector_size(res->globals);
+
+    emit_fn(&e, nfns, ast, res->frame_size, CLB_VOID);
+    for (size_t i = 0; i < nfns; ++i) {
+        ClaspASTNode *fn = res->fns[i];
+        emit_fn(&e, i, fn->data.fn_decl_stmt.body, fn->data.fn_decl_stmt.frame_size,
+                bytecode_class(fn->exprType->type->data.function.ret));
+
+        const char *name = fn->data.fn_decl_stmt.name->data;
+        size_t repeats = 0; // Nested functions may reuse a name
+        for (size_t j = 0; j < i; ++j) repeats += !strcmp(res->fns[j]->data.fn_decl_stmt.name->data, name);
+        ClaspBytecodeSymbol sym = { malloc(strlen(name) + 24), i };
+        if (repeats) sprintf(sym.name, "%s.%zu", name, repeats);
+        else strcpy(sym.name, name);
+        cvector_push_back(e.bc->symbols, sym);
+    }
+
+    bytecode_pool_free(&e.pool);
+    if (e.errors) {
+        bytecode_free(e.bc);
+        return NULL;
+    }
+    return e.bc;
+}
@@ -0,0 +1,267 @@
+/**
+ * Clasp call graph implementation
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/callgraph.h>
+#include <clasp/scope.h>
+#include <clasp/walk.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cvector/cvector.h>
+
+static ClaspCallGraphNode *lookup(ClaspCallGraph *graph, const char *name) {
+    return hashmap_get(&graph->names, name, strlen(name));
+}
+
+ClaspCallGraphNode *callgraph_callee(ClaspCallGraph *graph, ClaspASTNode *call) {
+    ClaspASTNode *ref = call->data.fn_call.referencer;
+    if (ref->type != AST_EXPR_VAR_REF) return NULL;
+    ClaspCallGraphNode *node = lookup(graph, ref->data.var_ref.varname->data);
+    return node && !node->shadowed ? node : NULL;
+}
+
+static void shadow(ClaspCallGraph *graph, ClaspToken *name) {
+    ClaspCallGraphNode *node = lookup(graph, name->data);
+    if (node) node->shadowed = true;
+}
+
+// Any declaration other than the top-level functions themselves hides a function's name from the code around it.
+static void *find_shadows(ClaspASTNode *node, void *args) {
+    ClaspCallGraph *graph = args;
+    switch (node->type) {
+        case AST_VAR_DECL_STMT:
+        case AST_LET_DECL_STMT:
+        case AST_CONST_DECL_STMT: shadow(graph, node->data.var_decl_stmt.name); break;
+        case AST_FN_DECL_STMT:
+            if (!lookup(graph, node->data.fn_decl_stmt.name->data) || lookup(graph, node->data.fn_decl_stmt.name->data)->fn != node)
+                shadow(graph, node->data.fn_decl_stmt.name);
+            for (size_t i = 0; i < cvector_size(node->data.fn_decl_stmt.args); ++i) shadow(graph, node->data.fn_decl_stmt.args[i]->name);
+            break;
+        default: break;
+    }
+    ast_map_children(node, &find_shadows, args);
+    return node;
+}
+
+/**
+ * State for scanning one function body (or the top level, with fn NULL).
+*/
+typedef struct Scan {
+    ClaspCallGraph *graph;
+    ClaspCallGraphNode *fn;
+    ClaspScope scope;       // The function's locals live at the point being scanned
+} Scan;
+
+static void bind(Scan *s, ClaspToken *name) {
+    scope_bind(&s->scope, name->data, NULL, 0, NULL);
+}
+
+static void assigns(Scan *s, ClaspASTNode *target) {
+    if (!s->fn) return;
+    if (target->type != AST_EXPR_VAR_REF || !scope_lookup(&s->scope, target->data.var_ref.varname->data)) s->fn->pure = false;
+}
+
+// Integer division by zero traps, so only a nonzero literal divisor is known not to.
+static bool may_trap(ClaspASTNode *binop) {
+    switch (binop->data.binop.op->type) {
+        case TOKEN_SLASH: case TOKEN_SLASH_EQ:
+        case TOKEN_PERC:  case TOKEN_PERC_EQ: break;
+        default: return false;
+    }
+    ClaspASTNode *divisor = binop->data.binop.right;
+    return divisor->type != AST_EXPR_LIT_NUMBER || strtod(divisor->data.lit_num.value->data, NULL) == 0;
+}
+
+static void add_edge(Scan *s, ClaspCallGraphNode *callee) {
+    cvector(ClaspCallGraphNode *) *list = s->fn ? &s->fn->callees : &s->graph->roots;
+    for (size_t i = 0; i < cvector_size(*list); ++i) if ((*list)[i] == callee) return;
+    cvector_push_back(*list, callee);
+}
+
+static void *find_calls(ClaspASTNode *node, void *args);
+
+static void scan_fn(Scan *s, ClaspASTNode *fn) {
+    scope_push(&s->scope);
+    for (size_t i = 0; i < cvector_size(fn->data.fn_decl_stmt.args); ++i) bind(s, fn->data.fn_decl_stmt.args[i]->name);
+    find_calls(fn->data.fn_decl_stmt.body, s);
+    scope_pop(&s->scope);
+}
+
+static void *find_calls(ClaspASTNode *node, void *args) {
+    Scan *s = args;
+    switch (node->type) {
+        case AST_BLOCK_STMT:
+            scope_push(&s->scope);
+                // Functions are visible to the whole block they're declared in, like in ast_resolve
+            for (size_t i = 0; i < cvector_size(node->data.block_stmt.body); ++i) {
+                ClaspASTNode *stmt = node->data.block_stmt.body[i];
+                if (stmt && stmt->type == AST_FN_DECL_STMT) bind(s, stmt->data.fn_decl_stmt.name);
+            }
+            ast_map_children(node, &find_calls, args);
+            scope_pop(&s->scope);
+            return node;
+        case AST_FOR_STMT: // The init declaration belongs to the loop
+            if (s->fn) s->fn->halts = false;
+            scope_push(&s->scope);
+            ast_map_children(node, &find_calls, args);
+            scope_pop(&s->scope);
+            return node;
+        case AST_VAR_DECL_STMT:
+        case AST_LET_DECL_STMT:
+        case AST_CONST_DECL_STMT:
+            if (node->data.var_decl_stmt.initializer) find_calls(node->data.var_decl_stmt.initializer, s); // Before the name is bound
+            if (s->fn) bind(s, node->data.var_decl_stmt.name);
+            return node;
+        case AST_FN_DECL_STMT:
+            if (s->fn) bind(s, node->data.fn_decl_stmt.name);
+            scan_fn(s, node);
+            return node;
+        case AST_EXPR_FN_CALL: {
+            ClaspCallGraphNode *callee = callgraph_callee(s->graph, node);
+            if (callee) {
+                callee->call_sites++;
+                add_edge(s, callee);
+            } else {
+                if (s->fn) s->fn->pure = false;
+                find_calls(node->data.fn_call.referencer, s);
+            }
+            for (size_t i = 0; i < cvector_size(node->data.fn_call.args); ++i) find_calls(node->data.fn_call.args[i], s);
+            return node;
+        }
+        case AST_EXPR_VAR_REF: {
+            ClaspCallGraphNode *fn = lookup(s->graph, node->data.var_ref.varname->data);
+            if (fn && !fn->shadowed) add_edge(s, fn);
+            break;
+        }
+        case AST_WHILE_STMT:
+            if (s->fn) s->fn->halts = false;
+            break;
+        case AST_EXPR_BINOP:
+            if (tktyp_is_assignment(node->data.binop.op->type)) assigns(s, node->data.binop.left);
+            if (s->fn && may_trap(node)) s->fn->halts = false;
+            break;
+        case AST_EXPR_POSTFIX: assigns(s, node->data.postfix.left); break;
+        default: break;
+    }
+    ast_map_children(node, &find_calls, args);
+    return node;
+}
+
+static void scan(ClaspCallGraph *graph, ClaspCallGraphNode *fn, ClaspASTNode *node) {
+    Scan s = { graph, fn };
+    scope_init(&s.scope);
+    if (fn) scan_fn(&s, fn->fn);
+    else find_calls(node, &s);
+    scope_free(&s.scope);
+}
+
+static bool reaches(ClaspCallGraphNode *from, ClaspCallGraphNode *target) {
+    for (size_t i = 0; i < cvector_size(from->callees); ++i) {
+        ClaspCallGraphNode *callee = from->callees[i];
+        if (callee == target) return true;
+        if (callee->_mark) continue;
+        callee->_mark = 1;
+        if (reaches(callee, target)) return true;
+    }
+    return false;
+}
+
+static void post_order(ClaspCallGraphNode *node, cvector(ClaspCallGraphNode *) *out) {
+    if (node->_mark) return;
+    node->_mark = 1;
+    for (size_t i = 0; i < cvector_size(node->callees); ++i) post_order(node->callees[i], out);
+    cvector_push_back(*out, node);
+}
+
+ClaspCallGraph *callgraph_build(ClaspASTNode *ast) {
+    ClaspCallGraph *graph = calloc(1, sizeof(ClaspCallGraph));
+    hashmap_create(16, &graph->names);
+    if (!ast) return graph;
+
+    cvector(ClaspASTNode *) top = NULL;
+    if (ast->type == AST_BLOCK_STMT) {
+        for (size_t i = 0; i < cvector_size(ast->data.block_stmt.body); ++i) cvector_push_back(top, ast->data.block_stmt.body[i]);
+    } else cvector_push_back(top, ast);
+
+    for (size_t i = 0; i < cvector_size(top); ++i) {
+        if (!top[i] || top[i]->type != AST_FN_DECL_STMT) continue;
+        ClaspCallGraphNode *node = calloc(1, sizeof(ClaspCallGraphNode));
+        node->fn = top[i];
+        node->pure = true;
+        node->halts = true;
+        ClaspToken *name = top[i]->data.fn_decl_stmt.name;
+        if (lookup(graph, name->data)) {
+            lookup(graph, name->data)->shadowed = true;
+            node->shadowed = true;
+        } else hashmap_put(&graph->names, name->data, strlen(name->data), node);
+        cvector_push_back(graph->nodes, node);
+    }
+    find_shadows(ast, graph);
+
+    for (size_t i = 0; i < cvector_size(top); ++i) {
+        if (!top[i]) continue;
+        if (top[i]->type != AST_FN_DECL_STMT) scan(graph, NULL, top[i]);
+    }
+    for (size_t i = 0; i < cvector_size(graph->nodes); ++i) scan(graph, graph->nodes[i], NULL);
+    cvector_free(top);
+
+    size_t n = cvector_size(graph->nodes);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) graph->nodes[j]->_mark = 0;
+        graph->nodes[i]->recursive = reaches(graph->nodes[i], graph->nodes[i]);
+        if (graph->nodes[i]->recursive) graph->nodes[i]->halts = false; // It might never stop recursing
+    }
+
+        // A function is only pure if everything it calls is, which can take a few rounds to settle. Same for halting.
+    for (bool changed = true; changed; ) {
+        changed = false;
+        for (size_t i = 0; i < n; ++i) {
+            ClaspCallGraphNode *node = graph->nodes[i];
+            for (size_t j = 0; j < cvector_size(node->callees); ++j) {
+                ClaspCallGraphNode *callee = node->callees[j];
+                if ((node->pure && !callee->pure) || (node->halts && !callee->halts)) changed = true;
+                node->pure &= callee->pure;
+                node->halts &= callee->halts;
+            }
+        }
+    }
+
+    cvector(ClaspCallGraphNode *) order = NULL;
+    for (size_t i = 0; i < n; ++i) graph->nodes[i]->_mark = 0;
+    for (size_t i = 0; i < n; ++i) post_order(graph->nodes[i], &order);
+    cvector_free(graph->nodes);
+    graph->nodes = order;
+    return graph;
+}
+
+void callgraph_free(ClaspCallGraph *graph) {
+    for (size_t i = 0; i < cvector_size(graph->nodes); ++i) {
+        cvector_free(graph->nodes[i]->callees);
+        free(graph->nodes[i]);
+    }
+    cvector_free(graph->nodes);
+    cvector_free(graph->roots);
+    hashmap_destroy(&graph->names);
+    free(graph);
+}
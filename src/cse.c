@@ -0,0 +1,227 @@
+/**
+ * Clasp common subexpression elimination implementation
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/cse.h>
+#include <clasp/hashcons.h>
+#include <clasp/walk.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <cvector/cvector.h>
+
+/**
+ * One basic block. Expressions are numbered in a first walk, then a second walk over the same expressions in the same
+ * order makes temporaries for the numbers that came up more than once.
+*/
+typedef struct Block {
+    ClaspHashCons available;            // Walk 1: expression -> number + 1
+    cvector(size_t) visits;             // Number * 2 + repeated, for every candidate in walk order
+    cvector(size_t) counts;             // Evaluations of each number
+    cvector(ClaspASTNode *) temps;      // Walk 2: reference to each number's temporary, NULL until it's made
+    size_t visit;                       // Walk 2: position in visits
+    cvector(ClaspASTNode *) *out;       // Walk 2: the statement list temporaries go into
+    unsigned *next;                     // Temporary counter, shared by the whole tree
+} Block;
+
+static bool is_assign(ClaspASTNode *node) {
+    return node->type == AST_EXPR_BINOP && tktyp_is_assignment(node->data.binop.op->type);
+}
+
+static bool pure(ClaspASTNode *node) {
+    switch (node->type) {
+        case AST_EXPR_LIT_NUMBER:
+        case AST_EXPR_VAR_REF: return true;
+        case AST_EXPR_UNOP:    return pure(node->data.unop.right);
+        case AST_EXPR_BINOP:   return !is_assign(node) && pure(node->data.binop.left) && pure(node->data.binop.right);
+        default: return false;
+    }
+}
+
+static bool has_var(ClaspASTNode *node) {
+    switch (node->type) {
+        case AST_EXPR_VAR_REF: return true;
+        case AST_EXPR_UNOP:    return has_var(node->data.unop.right);
+        case AST_EXPR_BINOP:   return has_var(node->data.binop.left) || has_var(node->data.binop.right);
+        default: return false;
+    }
+}
+
+static bool mentions(ClaspASTNode *node, const char *name) {
+    switch (node->type) {
+        case AST_EXPR_VAR_REF: return !strcmp(node->data.var_ref.varname->data, name);
+        case AST_EXPR_UNOP:    return mentions(node->data.unop.right, name);
+        case AST_EXPR_BINOP:   return mentions(node->data.binop.left, name) || mentions(node->data.binop.right, name);
+        default: return false;
+    }
+}
+
+static bool candidate(ClaspASTNode *node) {
+    if (!node->exprType || !node->exprType->type) return false; // Not type checked
+    if (node->type == AST_EXPR_UNOP) { // Not worth a temporary for `-x`
+        ClaspASTNode *right = node->data.unop.right;
+        if (right->type == AST_EXPR_VAR_REF || right->type == AST_EXPR_LIT_NUMBER) return false;
+    } else if (node->type != AST_EXPR_BINOP) return false;
+    return ast_hash(node) && has_var(node);
+}
+
+// The expression a clean statement evaluates, or NULL if the statement isn't part of a basic block.
+// A clean statement evaluates one side effect free expression, then assigns or declares at most one name.
+static ClaspASTNode **clean(ClaspASTNode *stmt, ClaspToken **assigns) {
+    ClaspASTNode **expr = NULL;
+    *assigns = NULL;
+    switch (stmt->type) {
+        case AST_EXPR_STMT:   expr = &stmt->data.expr_stmt.expr; break;
+        case AST_RETURN_STMT: expr = &stmt->data.return_stmt.retval; break;
+        case AST_VAR_DECL_STMT:
+        case AST_LET_DECL_STMT:
+        case AST_CONST_DECL_STMT:
+            expr = &stmt->data.var_decl_stmt.initializer;
+            *assigns = stmt->data.var_decl_stmt.name;
+            break;
+        default: return NULL;
+    }
+    if (!*expr) return expr;
+    if (is_assign(*expr) && (*expr)->data.binop.left->type == AST_EXPR_VAR_REF) {
+        *assigns = (*expr)->data.binop.left->data.var_ref.varname;
+        expr = &(*expr)->data.binop.right;
+    }
+    return pure(*expr) ? expr : NULL;
+}
+
+static void *number(ClaspASTNode *node, void *args) {
+    Block *b = args;
+    if (!candidate(node)) {
+        ast_map_children(node, &number, args);
+        return node;
+    }
+    ClaspHashConsEntry *e = hashcons_find(&b->available, node);
+    if (e) {
+        size_t n = (uintptr_t) e->value - 1;
+        b->counts[n]++;
+        cvector_push_back(b->visits, n * 2 + 1);
+        return node; // Its subexpressions are covered by the first evaluation
+    }
+    size_t n = cvector_size(b->counts);
+    cvector_push_back(b->counts, 1);
+    cvector_push_back(b->visits, n * 2);
+    hashcons_add(&b->available, node, (void *) (uintptr_t) (n + 1));
+    ast_map_children(node, &number, args);
+    return node;
+}
+
+static bool reads(ClaspHashConsEntry *e, void *name) {
+    return mentions(e->node, name);
+}
+
+static void *rewrite(ClaspASTNode *node, void *args) {
+    Block *b = args;
+    if (!candidate(node)) {
+        ast_map_children(node, &rewrite, args);
+        return node;
+    }
+    size_t visit = b->visits[b->visit++], n = visit / 2;
+    if (visit & 1) return b->temps[n] ? ast_clone(b->temps[n]) : node;
+
+    ast_map_children(node, &rewrite, args);
+    if (b->counts[n] < 2) return node;
+
+    char name[32];
+    snprintf(name, sizeof(name), CLASP_CSE_PREFIX "%u", (*b->next)++);
+    ClaspToken *tok = token_synth(TOKEN_ID, name, NULL);
+    cvector_push_back(*b->out, let_decl(tok, node->exprType->type, node));
+    b->temps[n] = typed_var_ref(tok, node->exprType->type, TYPE_IMMUTABLE);
+    return ast_clone(b->temps[n]);
+}
+
+static ClaspASTNode *cse_nested(ClaspASTNode *stmt, unsigned *next);
+
+static cvector(ClaspASTNode *) cse_list(cvector(ClaspASTNode *) stmts, unsigned *next) {
+    Block b = { .next = next };
+    hashcons_init(&b.available);
+    for (size_t i = 0; i < cvector_size(stmts); ++i) {
+        if (!stmts[i]) continue;
+        ClaspToken *assigns;
+        ClaspASTNode **expr = clean(stmts[i], &assigns);
+        if (!expr) {
+            hashcons_clear(&b.available);
+            continue;
+        }
+        if (*expr) number(*expr, &b);
+        if (assigns) hashcons_remove_if(&b.available, &reads, assigns->data);
+    }
+    hashcons_free(&b.available);
+
+    cvector(ClaspASTNode *) out = NULL;
+    b.out = &out;
+    for (size_t i = 0; i < cvector_size(b.counts); ++i) cvector_push_back(b.temps, NULL);
+    for (size_t i = 0; i < cvector_size(stmts); ++i) {
+        ClaspASTNode *stmt = stmts[i];
+        ClaspToken *assigns;
+        ClaspASTNode **expr = stmt ? clean(stmt, &assigns) : NULL;
+        if (expr && *expr) *expr = rewrite(*expr, &b);
+        else if (stmt && !expr) stmt = cse_nested(stmt, next);
+        cvector_push_back(out, stmt);
+    }
+    cvector_free(b.visits);
+    cvector_free(b.counts);
+    cvector_free(b.temps);
+    return out;
+}
+
+// Statements that aren't directly in a block get one when they need temporaries.
+static ClaspASTNode *cse_nested(ClaspASTNode *stmt, unsigned *next) {
+    if (!stmt) return NULL;
+    switch (stmt->type) {
+        case AST_BLOCK_STMT: {
+            cvector(ClaspASTNode *) body = cse_list(stmt->data.block_stmt.body, next);
+            cvector_free(stmt->data.block_stmt.body);
+            stmt->data.block_stmt.body = body;
+            return stmt;
+        }
+        case AST_IF_STMT:
+        case AST_WHILE_STMT:  stmt->data.cond_stmt.body = cse_nested(stmt->data.cond_stmt.body, next); return stmt;
+        case AST_FOR_STMT:    stmt->data.for_stmt.body = cse_nested(stmt->data.for_stmt.body, next); return stmt;
+        case AST_FN_DECL_STMT: stmt->data.fn_decl_stmt.body = cse_nested(stmt->data.fn_decl_stmt.body, next); return stmt;
+        default: {
+            ClaspToken *assigns;
+            if (!clean(stmt, &assigns)) return stmt;
+            cvector(ClaspASTNode *) single = NULL;
+            cvector_push_back(single, stmt);
+            cvector(ClaspASTNode *) out = cse_list(single, next);
+            cvector_free(single);
+            if (cvector_size(out) == 1) {
+                cvector_free(out);
+                return stmt;
+            }
+            return block_stmt(out);
+        }
+    }
+}
+
+ClaspASTNode *ast_cse(ClaspASTNode *ast) {
+    unsigned next = 0;
+    return cse_nested(ast, &next);
+}
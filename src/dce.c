@@ -0,0 +1,170 @@
+/**
+ * Clasp dead code elimination implementation
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/dce.h>
+#include <clasp/callgraph.h>
+#include <clasp/walk.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cvector/cvector.h>
+
+// A literal condition: 1 if it's always true, 0 if always false, -1 if it isn't a literal.
+static int const_cond(ClaspASTNode *cond) {
+    if (!cond) return 1; // A for loop without a condition
+    if (cond->type != AST_EXPR_LIT_NUMBER) return -1;
+    return strtod(cond->data.lit_num.value->data, NULL) != 0;
+}
+
+// Whether evaluating an expression does anything. Calls are kept unless they go to a pure function that halts.
+static bool pure(ClaspASTNode *node, ClaspCallGraph *graph) {
+    switch (node->type) {
+        case AST_EXPR_LIT_NUMBER:
+        case AST_EXPR_VAR_REF: return true;
+        case AST_EXPR_UNOP:    return pure(node->data.unop.right, graph);
+        case AST_EXPR_BINOP:
+            return !tktyp_is_assignment(node->data.binop.op->type) && pure(node->data.binop.left, graph) && pure(node->data.binop.right, graph);
+        case AST_EXPR_FN_CALL: {
+            ClaspCallGraphNode *callee = callgraph_callee(graph, node);
+            if (!callee || !callee->pure || !callee->halts) return false;
+            for (size_t i = 0; i < cvector_size(node->data.fn_call.args); ++i)
+                if (!pure(node->data.fn_call.args[i], graph)) return false;
+            return true;
+        }
+        default: return false;
+    }
+}
+
+// Whether control never falls off the end of a statement.
+static bool returns(ClaspASTNode *stmt) {
+    if (!stmt) return false;
+    if (stmt->type == AST_RETURN_STMT) return true;
+    if (stmt->type != AST_BLOCK_STMT) return false;
+    for (size_t i = 0; i < cvector_size(stmt->data.block_stmt.body); ++i)
+        if (returns(stmt->data.block_stmt.body[i])) return true;
+    return false;
+}
+
+static ClaspASTNode *dce_stmt(ClaspASTNode *stmt, ClaspCallGraph *graph);
+
+// Statements that aren't directly in a block can't just disappear.
+static ClaspASTNode *dce_nested(ClaspASTNode *stmt, ClaspCallGraph *graph) {
+    if (!stmt) return NULL;
+    ClaspASTNode *out = dce_stmt(stmt, graph);
+    return out ? out : block_stmt(NULL);
+}
+
+// Returns the statement to keep in place of stmt, or NULL to drop it.
+static ClaspASTNode *dce_stmt(ClaspASTNode *stmt, ClaspCallGraph *graph) {
+    switch (stmt->type) {
+        case AST_BLOCK_STMT: {
+            cvector(ClaspASTNode *) out = NULL;
+            bool dead = false;
+            for (size_t i = 0; i < cvector_size(stmt->data.block_stmt.body); ++i) {
+                ClaspASTNode *s = stmt->data.block_stmt.body[i];
+                if (!s) {
+                    cvector_push_back(out, NULL);
+                    continue;
+                }
+                if (dead && s->type != AST_FN_DECL_STMT) continue;
+                s = dce_stmt(s, graph);
+                if (!s) continue;
+                cvector_push_back(out, s);
+                dead |= returns(s);
+            }
+            cvector_free(stmt->data.block_stmt.body);
+            stmt->data.block_stmt.body = out;
+            return stmt;
+        }
+        case AST_EXPR_STMT:
+            return pure(stmt->data.expr_stmt.expr, graph) ? NULL : stmt;
+        case AST_IF_STMT:
+            switch (const_cond(stmt->data.cond_stmt.cond)) {
+                case 0:  return NULL;
+                case 1:  return dce_stmt(stmt->data.cond_stmt.body, graph);
+                default: break;
+            }
+            stmt->data.cond_stmt.body = dce_nested(stmt->data.cond_stmt.body, graph);
+            return stmt;
+        case AST_WHILE_STMT:
+            if (const_cond(stmt->data.cond_stmt.cond) == 0) return NULL;
+            stmt->data.cond_stmt.body = dce_nested(stmt->data.cond_stmt.body, graph);
+            return stmt;
+        case AST_FOR_STMT:
+            if (const_cond(stmt->data.for_stmt.cond) == 0) {
+                if (!stmt->data.for_stmt.init) return NULL;
+                cvector(ClaspASTNode *) init = NULL; // Keeps the init's names scoped the way the loop did
+                cvector_push_back(init, stmt->data.for_stmt.init);
+                return block_stmt(init);
+            }
+            if (stmt->data.for_stmt.step) stmt->data.for_stmt.step = dce_stmt(stmt->data.for_stmt.step, graph);
+            stmt->data.for_stmt.body = dce_nested(stmt->data.for_stmt.body, graph);
+            return stmt;
+        case AST_FN_DECL_STMT:
+            stmt->data.fn_decl_stmt.body = dce_nested(stmt->data.fn_decl_stmt.body, graph);
+            return stmt;
+        default:
+            return stmt;
+    }
+}
+
+static void mark_reachable(ClaspCallGraphNode *node) {
+    if (node->_mark) return;
+    node->_mark = 1;
+    for (size_t i = 0; i < cvector_size(node->callees); ++i) mark_reachable(node->callees[i]);
+}
+
+ClaspASTNode *ast_dce(ClaspASTNode *ast) {
+    if (!ast) return NULL;
+
+    ClaspCallGraph *graph = callgraph_build(ast);
+    ast = dce_nested(ast, graph);
+    callgraph_free(graph);
+    if (ast->type != AST_BLOCK_STMT) return ast;
+
+        // Statements are gone first, since they may have held the only calls to a function.
+    graph = callgraph_build(ast);
+    for (size_t i = 0; i < cvector_size(graph->nodes); ++i) graph->nodes[i]->_mark = 0;
+    for (size_t i = 0; i < cvector_size(graph->roots); ++i) mark_reachable(graph->roots[i]);
+    ClaspCallGraphNode *entry = hashmap_get(&graph->names, CLASP_DCE_ENTRY, strlen(CLASP_DCE_ENTRY));
+    if (entry) mark_reachable(entry); // Targets like transpile_gcc call it themselves
+    for (size_t i = 0; i < cvector_size(graph->nodes); ++i)
+        if (graph->nodes[i]->shadowed) mark_reachable(graph->nodes[i]); // Calls to it can't be told apart
+
+    cvector(ClaspASTNode *) out = NULL;
+    for (size_t i = 0; i < cvector_size(ast->data.block_stmt.body); ++i) {
+        ClaspASTNode *stmt = ast->data.block_stmt.body[i];
+        if (stmt && stmt->type == AST_FN_DECL_STMT) {
+            ClaspToken *name = stmt->data.fn_decl_stmt.name;
+            ClaspCallGraphNode *node = hashmap_get(&graph->names, name->data, strlen(name->data));
+            if (node && !node->_mark) continue;
+        }
+        cvector_push_back(out, stmt);
+    }
+    cvector_free(ast->data.block_stmt.body);
+    ast->data.block_stmt.body = out;
+    callgraph_free(graph);
+    return ast;
+}
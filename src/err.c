@@ -86,4 +86,18 @@ void token_err(ClaspToken *tok, char *err) {
 
     fprintf(stderr, "\n%s\n", err);
 
-}
\ No newline at end of file
+}
+
+void semantic_err(ClaspToken *tok, const char *fmt, ...) {
+    bool col = term_does_color();
+
+    if (tok) fprintf(stderr, "Error in file %s, line %d:%d: ", "TODO", tok->lineno + 1, tok->where + 1);
+    else     fprintf(stderr, "Error: ");
+    if (col) fprintf(stderr, "\033[1;31m");
+    va_list args;
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+    if (col) fprintf(stderr, "\033[0m");
+    fprintf(stderr, "\n");
+}
@@ -0,0 +1,398 @@
+/**
+ * Clasp constant folding implementation
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/fold.h>
+#include <clasp/types.h>
+#include <clasp/scope.h>
+#include <clasp/runtime.h>
+#include <clasp/static_visitor.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cvector/cvector.h>
+
+/**
+ * A constant. Integers are kept sign-extended from their type's width.
+*/
+typedef struct Value {
+    bool is_float;
+    int64_t i;
+    double f;
+} Value;
+
+static ClaspASTNode *type_of(ClaspASTNode *node) {
+    return node && node->exprType ? node->exprType->type : NULL;
+}
+
+static bool is_lit(ClaspASTNode *node) {
+    return node && node->type == AST_EXPR_LIT_NUMBER;
+}
+
+static double as_float(Value v) {
+    return v.is_float ? v.f : (double) v.i;
+}
+
+static Value lit_value(ClaspASTNode *lit) {
+    const char *data = lit->data.lit_num.value->data;
+    ClaspASTNode *type = type_of(lit);
+    if (type ? type_is_float(type) : strchr(data, '.') != NULL) return (Value) { true, 0, strtod(data, NULL) };
+    return (Value) { false, strtoll(data, NULL, 10), 0 };
+}
+
+static int64_t wrap(uint64_t v, size_t size) {
+    if (size == 0 || size >= 8) return (int64_t) v;
+    uint64_t range = (uint64_t) 1 << (size * 8);
+    v &= range - 1;
+    return (v & (range >> 1)) ? -(int64_t) (range - v) : (int64_t) v;
+}
+
+// Convert a value to a type, false if the conversion would be undefined.
+static bool convert(Value *v, ClaspASTNode *type) {
+    if (type_is_float(type)) {
+        double f = as_float(*v);
+        if (type_size(type) == 4) f = (float) f;
+        *v = (Value) { true, 0, f };
+        return true;
+    }
+    if (!type_is_integer(type)) return false;
+    if (v->is_float && !(v->f > -9.2e18 && v->f < 9.2e18)) return false;
+    int64_t i = v->is_float ? (int64_t) v->f : v->i;
+    *v = (Value) { false, wrap((uint64_t) i, type_size(type)), 0 };
+    return true;
+}
+
+// Build a literal node for a value, NULL if it can't be written as a Clasp number.
+static ClaspASTNode *make_literal(Value v, ClaspASTNode *type, ClaspToken *at) {
+    char buf[64];
+    if (v.is_float) {
+        if (!isfinite(v.f)) return NULL;
+        snprintf(buf, sizeof(buf), type_size(type) == 4 ? "%.9g" : "%.17g", v.f);
+        if (strchr(buf, 'e')) return NULL;
+        if (!strchr(buf, '.')) strcat(buf, ".0");
+    } else {
+        snprintf(buf, sizeof(buf), "%lld", (long long) v.i);
+    }
+    ClaspASTNode *lit = lit_num(token_synth(TOKEN_NUMBER, buf, at));
+    lit->exprType->type = type;
+    return lit;
+}
+
+static bool is_value(ClaspASTNode *node, int k) {
+    return is_lit(node) && as_float(lit_value(node)) == k;
+}
+
+// k if node is the integer literal 2^k (k > 0), otherwise 0.
+static int log2_lit(ClaspASTNode *node) {
+    if (!is_lit(node)) return 0;
+    Value v = lit_value(node);
+    if (v.is_float || v.i < 2 || (v.i & (v.i - 1))) return 0;
+    int k = 0;
+    while ((v.i >> k) != 1) k++;
+    return k;
+}
+
+// Whether dropping an expression would change the program.
+static bool pure(ClaspASTNode *node) {
+    if (!node) return true;
+    switch (node->type) {
+        case AST_EXPR_LIT_NUMBER:
+        case AST_EXPR_VAR_REF: return true;
+        case AST_EXPR_UNOP:    return pure(node->data.unop.right);
+        case AST_EXPR_BINOP:
+            return !tktyp_is_assignment(node->data.binop.op->type) && pure(node->data.binop.left) && pure(node->data.binop.right);
+        default: return false;
+    }
+}
+
+static bool eval_binop(ClaspTokenType op, Value a, Value b, ClaspASTNode *type, Value *out) {
+    switch (op) {
+        case TOKEN_EQ_EQ: case TOKEN_BANG_EQ:
+        case TOKEN_LESS:  case TOKEN_LESS_EQ:
+        case TOKEN_GREATER: case TOKEN_GREATER_EQ: {
+            int cmp;
+            if (a.is_float || b.is_float) cmp = (as_float(a) > as_float(b)) - (as_float(a) < as_float(b));
+            else cmp = (a.i > b.i) - (a.i < b.i);
+            bool unordered = (a.is_float || b.is_float) && (isnan(as_float(a)) || isnan(as_float(b)));
+            bool r;
+            switch (op) {
+                case TOKEN_EQ_EQ:      r = !unordered && cmp == 0; break;
+                case TOKEN_BANG_EQ:    r =  unordered || cmp != 0; break;
+                case TOKEN_LESS:       r = !unordered && cmp <  0; break;
+                case TOKEN_LESS_EQ:    r = !unordered && cmp <= 0; break;
+                case TOKEN_GREATER:    r = !unordered && cmp >  0; break;
+                default:               r = !unordered && cmp >= 0; break;
+            }
+            *out = (Value) { false, r, 0 };
+            return convert(out, type);
+        }
+        default: break;
+    }
+
+    if (!convert(&a, type) || !convert(&b, type)) return false;
+    if (a.is_float) {
+        double r;
+        switch (op) {
+            case TOKEN_PLUS:    r = a.f + b.f; break;
+            case TOKEN_MINUS:   r = a.f - b.f; break;
+            case TOKEN_ASTERIX: r = a.f * b.f; break;
+            case TOKEN_SLASH:   r = a.f / b.f; break;
+            case TOKEN_CARAT:   r = pow(a.f, b.f); break;
+            default: return false;
+        }
+        *out = (Value) { true, 0, r };
+        return convert(out, type);
+    }
+
+    uint64_t x = (uint64_t) a.i, y = (uint64_t) b.i, r;
+    switch (op) {
+        case TOKEN_PLUS:    r = x + y; break;
+        case TOKEN_MINUS:   r = x - y; break;
+        case TOKEN_ASTERIX: r = x * y; break;
+        case TOKEN_SLASH:
+            if (b.i == 0) return false;
+            r = b.i == -1 ? -x : (uint64_t) (a.i / b.i);
+            break;
+        case TOKEN_PERC:
+            if (b.i == 0) return false;
+            r = b.i == -1 ? 0 : (uint64_t) (a.i % b.i);
+            break;
+        case TOKEN_CARAT:   r = (uint64_t) clasp_ipow(a.i, b.i); break;
+        case TOKEN_LESS_LESS:
+            if (b.i < 0 || b.i >= 64) return false;
+            r = x << y;
+            break;
+        default: return false;
+    }
+    *out = (Value) { false, wrap(r, type_size(type)), 0 };
+    return true;
+}
+
+static bool eval_unop(ClaspTokenType op, Value a, ClaspASTNode *type, Value *out) {
+    if (op == TOKEN_BANG) {
+        *out = (Value) { false, as_float(a) == 0, 0 };
+        return convert(out, type);
+    }
+    if (!convert(&a, type)) return false;
+    switch (op) {
+        case TOKEN_PLUS:  *out = a; return true;
+        case TOKEN_MINUS:
+            if (a.is_float) *out = (Value) { true, 0, -a.f };
+            else *out = (Value) { false, wrap(-(uint64_t) a.i, type_size(type)), 0 };
+            return true;
+        case TOKEN_TILDE:
+            if (a.is_float) return false;
+            *out = (Value) { false, wrap(~(uint64_t) a.i, type_size(type)), 0 };
+            return true;
+        default: return false;
+    }
+}
+
+static ClaspASTNode *shift(ClaspASTNode *x, int k, ClaspASTNode *type, ClaspToken *at) {
+    ClaspASTNode *amount = make_literal((Value) { false, k, 0 }, type_intern("int"), at);
+    ClaspASTNode *out = binop(x, amount, token_synth(TOKEN_LESS_LESS, "<<", at));
+    out->exprType->type = type;
+    return out;
+}
+
+// Algebraic identities for a binop that isn't constant.
+static ClaspASTNode *simplify(ClaspASTNode *node, ClaspASTNode *l, ClaspASTNode *r, ClaspASTNode *type) {
+    ClaspToken *op = node->data.binop.op;
+    bool integer = type_is_integer(type);
+    int k;
+    switch (op->type) {
+        case TOKEN_PLUS: // -0.0 + 0 is +0.0, so only for integers
+            if (integer && is_value(r, 0) && type_of(l) == type) return l;
+            if (integer && is_value(l, 0) && type_of(r) == type) return r;
+            break;
+        case TOKEN_MINUS:
+            if (is_value(r, 0) && type_of(l) == type) return l;
+            break;
+        case TOKEN_ASTERIX:
+            if (is_value(r, 1) && type_of(l) == type) return l;
+            if (is_value(l, 1) && type_of(r) == type) return r;
+            if (!integer) break;
+            if (is_value(r, 0) && pure(l)) return make_literal((Value) { false, 0, 0 }, type, op);
+            if (is_value(l, 0) && pure(r)) return make_literal((Value) { false, 0, 0 }, type, op);
+            if ((k = log2_lit(r)) && type_of(l) == type) return shift(l, k, type, op);
+            if ((k = log2_lit(l)) && type_of(r) == type) return shift(r, k, type, op);
+            break;
+        case TOKEN_SLASH:
+            if (is_value(r, 1) && type_of(l) == type) return l;
+            break;
+        case TOKEN_CARAT:
+            if (is_value(r, 1) && type_of(l) == type) return l;
+            if (is_value(r, 0) && pure(l)) {
+                Value one = { false, 1, 0 };
+                if (convert(&one, type)) return make_literal(one, type, op);
+            }
+            break;
+        default: break;
+    }
+    return node;
+}
+
+CLASP_STATIC_VISITOR(fold_node, fold)
+
+static void *fold_binop(ClaspASTNode *binop, void *args) {
+    ClaspToken *op = binop->data.binop.op;
+    bool assign = tktyp_is_assignment(op->type);
+    if (!assign) binop->data.binop.left = fold_node(binop->data.binop.left, args);
+    binop->data.binop.right = fold_node(binop->data.binop.right, args);
+
+    ClaspASTNode *l = binop->data.binop.left, *r = binop->data.binop.right, *type = type_of(binop);
+    if (assign || !l || !r || !type) return binop;
+
+    if (is_lit(l) && is_lit(r)) {
+        Value v;
+        ClaspASTNode *lit;
+        if (eval_binop(op->type, lit_value(l), lit_value(r), type, &v) && (lit = make_literal(v, type, op))) return lit;
+        return binop;
+    }
+    return simplify(binop, l, r, type);
+}
+
+static void *fold_unop(ClaspASTNode *unop, void *args) {
+    ClaspToken *op = unop->data.unop.op;
+    ClaspASTNode *r = unop->data.unop.right = fold_node(unop->data.unop.right, args);
+    ClaspASTNode *type = type_of(unop);
+    if (!r || !type) return unop;
+
+    if (is_lit(r)) {
+        Value v;
+        ClaspASTNode *lit;
+        if (eval_unop(op->type, lit_value(r), type, &v) && (lit = make_literal(v, type, op))) return lit;
+        return unop;
+    }
+    if (op->type == TOKEN_PLUS && type_of(r) == type) return r;
+    if (op->type == TOKEN_MINUS && r->type == AST_EXPR_UNOP && r->data.unop.op->type == TOKEN_MINUS && type_of(r->data.unop.right) == type)
+        return r->data.unop.right;
+    return unop;
+}
+
+static void *fold_postfix(ClaspASTNode *post, void *args) {
+    return post; // The operand is a variable being modified, there is nothing to fold.
+}
+
+static void *fold_lit_num(ClaspASTNode *lit, void *args) {
+    return lit;
+}
+
+static void *fold_var_ref(ClaspASTNode *var, void *args) {
+    ClaspBinding *b = scope_lookup(args, var->data.var_ref.varname->data);
+    if (!b || !b->value) return var;
+
+    ClaspASTNode *type = type_of(var) ? type_of(var) : b->type;
+    Value v = lit_value(b->value);
+    if (!type || !convert(&v, type)) return var;
+    ClaspASTNode *lit = make_literal(v, type, var->data.var_ref.varname);
+    return lit ? lit : var;
+}
+
+static void *fold_fn_call(ClaspASTNode *call, void *args) {
+    for (size_t i = 0; i < cvector_size(call->data.fn_call.args); ++i)
+        call->data.fn_call.args[i] = fold_node(call->data.fn_call.args[i], args);
+    return call;
+}
+
+static void *fold_return_stmt(ClaspASTNode *stmt, void *args) {
+    stmt->data.return_stmt.retval = fold_node(stmt->data.return_stmt.retval, args);
+    return stmt;
+}
+
+static void *fold_expr_stmt(ClaspASTNode *stmt, void *args) {
+    stmt->data.expr_stmt.expr = fold_node(stmt->data.expr_stmt.expr, args);
+    return stmt;
+}
+
+static void *fold_block_stmt(ClaspASTNode *block, void *args) {
+    ClaspScope *scope = args;
+    scope_push(scope);
+        // Hoisted functions shadow outer constants for the whole block.
+    for (size_t i = 0; i < cvector_size(block->data.block_stmt.body); ++i) {
+        ClaspASTNode *stmt = block->data.block_stmt.body[i];
+        if (stmt && stmt->type == AST_FN_DECL_STMT) scope_bind(scope, stmt->data.fn_decl_stmt.name->data, NULL, TYPE_CONST, NULL);
+    }
+    for (size_t i = 0; i < cvector_size(block->data.block_stmt.body); ++i)
+        block->data.block_stmt.body[i] = fold_node(block->data.block_stmt.body[i], args);
+    scope_pop(scope);
+    return block;
+}
+
+static void *fold_var_decl(ClaspASTNode *var, void *args) {
+    ClaspASTNode *init = var->data.var_decl_stmt.initializer = fold_node(var->data.var_decl_stmt.initializer, args);
+    bool constant = var->type == AST_CONST_DECL_STMT && is_lit(init);
+    scope_bind(args, var->data.var_decl_stmt.name->data, type_resolve(var->data.var_decl_stmt.type), 0, constant ? init : NULL);
+    return var;
+}
+
+static void *fold_fn_decl(ClaspASTNode *fn, void *args) {
+    ClaspScope *scope = args;
+    ClaspBinding *b = scope_lookup(scope, fn->data.fn_decl_stmt.name->data);
+    if (!b || b->depth != scope->depth) scope_bind(scope, fn->data.fn_decl_stmt.name->data, NULL, TYPE_CONST, NULL);
+
+    scope_push(scope);
+    for (size_t i = 0; i < cvector_size(fn->data.fn_decl_stmt.args); ++i)
+        scope_bind(scope, fn->data.fn_decl_stmt.args[i]->name->data, NULL, TYPE_MUTABLE, NULL);
+    fn->data.fn_decl_stmt.body = fold_node(fn->data.fn_decl_stmt.body, args);
+    scope_pop(scope);
+    return fn;
+}
+
+static void *fold_if(ClaspASTNode *stmt, void *args) {
+    stmt->data.cond_stmt.cond = fold_node(stmt->data.cond_stmt.cond, args);
+    stmt->data.cond_stmt.body = fold_node(stmt->data.cond_stmt.body, args);
+    return stmt;
+}
+
+static void *fold_while(ClaspASTNode *stmt, void *args) {
+    return fold_if(stmt, args);
+}
+
+static void *fold_for(ClaspASTNode *stmt, void *args) {
+    scope_push(args);
+    stmt->data.for_stmt.init = fold_node(stmt->data.for_stmt.init, args);
+    stmt->data.for_stmt.cond = fold_node(stmt->data.for_stmt.cond, args);
+    stmt->data.for_stmt.step = fold_node(stmt->data.for_stmt.step, args);
+    stmt->data.for_stmt.body = fold_node(stmt->data.for_stmt.body, args);
+    scope_pop(args);
+    return stmt;
+}
+
+static void *fold_single_type(ClaspASTNode *type, void *args)   { return type; }
+static void *fold_array_type(ClaspASTNode *type, void *args)    { return type; }
+static void *fold_fn_type(ClaspASTNode *type, void *args)       { return type; }
+static void *fold_template_type(ClaspASTNode *type, void *args) { return type; }
+static void *fold_ptr_type(ClaspASTNode *type, void *args)      { return type; }
+
+ClaspASTNode *ast_fold(ClaspASTNode *ast) {
+    ClaspScope scope;
+    scope_init(&scope);
+    ClaspASTNode *out = fold_node(ast, &scope);
+    scope_free(&scope);
+    return out;
+}
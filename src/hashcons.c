@@ -0,0 +1,180 @@
+/**
+ * Clasp expression hash-consing implementation
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/hashcons.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INITIAL_BUCKETS 64
+
+static uint64_t mix(uint64_t h, uint64_t v) {
+    h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    return h;
+}
+
+static uint64_t hash_str(uint64_t h, const char *s) {
+    for (; *s; ++s) h = (h ^ (uint8_t) *s) * 0x100000001b3ULL; // FNV-1a
+    return h;
+}
+
+uint64_t ast_hash(ClaspASTNode *node) {
+    if (!node) return 0;
+    uint64_t h = mix(0xcbf29ce484222325ULL, node->type);
+    if (node->exprType) h = mix(h, (uintptr_t) node->exprType->type);
+    switch (node->type) {
+        case AST_EXPR_LIT_NUMBER: h = hash_str(h, node->data.lit_num.value->data); break;
+        case AST_EXPR_VAR_REF:    h = hash_str(h, node->data.var_ref.varname->data); break;
+        case AST_EXPR_UNOP: {
+            uint64_t r = ast_hash(node->data.unop.right);
+            if (!r) return 0;
+            h = mix(mix(h, node->data.unop.op->type), r);
+            break;
+        }
+        case AST_EXPR_BINOP: {
+            if (tktyp_is_assignment(node->data.binop.op->type)) return 0;
+            uint64_t l = ast_hash(node->data.binop.left), r = ast_hash(node->data.binop.right);
+            if (!l || !r) return 0;
+            h = mix(mix(mix(h, node->data.binop.op->type), l), r);
+            break;
+        }
+        default: return 0;
+    }
+    return h ? h : 1;
+}
+
+bool ast_equal(ClaspASTNode *a, ClaspASTNode *b) {
+    if (a == b) return true;
+    if (!a || !b || a->type != b->type) return false;
+    if ((a->exprType ? a->exprType->type : NULL) != (b->exprType ? b->exprType->type : NULL)) return false;
+    switch (a->type) {
+        case AST_EXPR_LIT_NUMBER: return !strcmp(a->data.lit_num.value->data, b->data.lit_num.value->data);
+        case AST_EXPR_VAR_REF:    return !strcmp(a->data.var_ref.varname->data, b->data.var_ref.varname->data);
+        case AST_EXPR_UNOP:
+            return a->data.unop.op->type == b->data.unop.op->type && ast_equal(a->data.unop.right, b->data.unop.right);
+        case AST_EXPR_BINOP:
+            return a->data.binop.op->type == b->data.binop.op->type && !tktyp_is_assignment(a->data.binop.op->type) &&
+                ast_equal(a->data.binop.left, b->data.binop.left) && ast_equal(a->data.binop.right, b->data.binop.right);
+        default: return false;
+    }
+}
+
+void hashcons_init(ClaspHashCons *table) {
+    table->n_buckets = INITIAL_BUCKETS;
+    table->buckets = calloc(table->n_buckets, sizeof(ClaspHashConsEntry *));
+    table->count = 0;
+}
+
+void hashcons_clear(ClaspHashCons *table) {
+    for (size_t i = 0; i < table->n_buckets; ++i) {
+        for (ClaspHashConsEntry *e = table->buckets[i], *next; e; e = next) {
+            next = e->next;
+            free(e);
+        }
+        table->buckets[i] = NULL;
+    }
+    table->count = 0;
+}
+
+void hashcons_free(ClaspHashCons *table) {
+    hashcons_clear(table);
+    free(table->buckets);
+    table->buckets = NULL;
+    table->n_buckets = 0;
+}
+
+static ClaspHashConsEntry *find(ClaspHashCons *table, ClaspASTNode *node, uint64_t h) {
+    for (ClaspHashConsEntry *e = table->buckets[h & (table->n_buckets - 1)]; e; e = e->next)
+        if (e->hash == h && ast_equal(e->node, node)) return e;
+    return NULL;
+}
+
+ClaspHashConsEntry *hashcons_find(ClaspHashCons *table, ClaspASTNode *node) {
+    uint64_t h = ast_hash(node);
+    return h ? find(table, node, h) : NULL;
+}
+
+static void grow(ClaspHashCons *table) {
+    size_t n = table->n_buckets * 2;
+    ClaspHashConsEntry **buckets = calloc(n, sizeof(ClaspHashConsEntry *));
+    for (size_t i = 0; i < table->n_buckets; ++i) {
+        for (ClaspHashConsEntry *e = table->buckets[i], *next; e; e = next) {
+            next = e->next;
+            e->next = buckets[e->hash & (n - 1)];
+            buckets[e->hash & (n - 1)] = e;
+        }
+    }
+    free(table->buckets);
+    table->buckets = buckets;
+    table->n_buckets = n;
+}
+
+static ClaspHashConsEntry *add(ClaspHashCons *table, ClaspASTNode *node, uint64_t h, void *value) {
+    if (table->count >= table->n_buckets) grow(table);
+    ClaspHashConsEntry *e = malloc(sizeof(ClaspHashConsEntry));
+    e->hash = h;
+    e->node = node;
+    e->value = value;
+    e->next = table->buckets[h & (table->n_buckets - 1)];
+    table->buckets[h & (table->n_buckets - 1)] = e;
+    table->count++;
+    return e;
+}
+
+ClaspHashConsEntry *hashcons_add(ClaspHashCons *table, ClaspASTNode *node, void *value) {
+    uint64_t h = ast_hash(node);
+    return h ? add(table, node, h, value) : NULL;
+}
+
+void hashcons_remove_if(ClaspHashCons *table, bool (*pred)(ClaspHashConsEntry *entry, void *args), void *args) {
+    for (size_t i = 0; i < table->n_buckets; ++i) {
+        for (ClaspHashConsEntry **link = &table->buckets[i]; *link; ) {
+            ClaspHashConsEntry *e = *link;
+            if (!pred(e, args)) {
+                link = &e->next;
+                continue;
+            }
+            *link = e->next;
+            free(e);
+            table->count--;
+        }
+    }
+}
+
+ClaspASTNode *ast_hashcons(ClaspHashCons *table, ClaspASTNode *node) {
+    uint64_t h = ast_hash(node);
+    if (!h) return node;
+    ClaspHashConsEntry *e = find(table, node, h);
+    if (e) return e->node;
+
+    switch (node->type) {
+        case AST_EXPR_UNOP: node->data.unop.right = ast_hashcons(table, node->data.unop.right); break;
+        case AST_EXPR_BINOP:
+            node->data.binop.left = ast_hashcons(table, node->data.binop.left);
+            node->data.binop.right = ast_hashcons(table, node->data.binop.right);
+            break;
+        default: break;
+    }
+    return add(table, node, h, NULL)->node;
+}
@@ -0,0 +1,418 @@
+/**
+ * Clasp function inliner implementation
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/inline.h>
+#include <clasp/callgraph.h>
+#include <clasp/types.h>
+#include <clasp/walk.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cvector/cvector.h>
+
+#define LOOP_SCALE_MAX 4    // Budget multiplier cap for calls inside loops
+#define SOLE_CALLER_SCALE 4 // Budget multiplier for functions with a single call site
+
+/**
+ * State for inlining into one caller.
+*/
+typedef struct Inliner {
+    ClaspCallGraph *graph;
+    ClaspInlineOptions opts;
+    const char *caller;                     // For the report, NULL at the top level
+    hashmap_t locals;                       // Names the caller declares below the top level, which could capture a global
+    unsigned loops;                         // Loops around the current statement
+    cvector(ClaspASTNode *) *prelude;       // Temporaries for the current statement, NULL if it can't have any
+    unsigned next;                          // Temporary counter, shared by the whole tree
+} Inliner;
+
+static ClaspASTNode *type_of(ClaspASTNode *node) {
+    return node && node->exprType ? node->exprType->type : NULL;
+}
+
+static bool is_trivial(ClaspASTNode *node) {
+    return node->type == AST_EXPR_LIT_NUMBER || node->type == AST_EXPR_VAR_REF;
+}
+
+static bool is_decl(ClaspASTNode *node) {
+    return node->type == AST_VAR_DECL_STMT || node->type == AST_LET_DECL_STMT || node->type == AST_CONST_DECL_STMT;
+}
+
+// Whether an expression has no side effects, counting calls to pure functions.
+static bool pure(ClaspASTNode *node, Inliner *in) {
+    switch (node->type) {
+        case AST_EXPR_LIT_NUMBER:
+        case AST_EXPR_VAR_REF: return true;
+        case AST_EXPR_UNOP:    return pure(node->data.unop.right, in);
+        case AST_EXPR_BINOP:
+            return !tktyp_is_assignment(node->data.binop.op->type) && pure(node->data.binop.left, in) && pure(node->data.binop.right, in);
+        case AST_EXPR_FN_CALL: {
+            ClaspCallGraphNode *callee = callgraph_callee(in->graph, node);
+            if (!callee || !callee->pure || !callee->halts) return false; // Substituting can drop it
+            for (size_t i = 0; i < cvector_size(node->data.fn_call.args); ++i)
+                if (!pure(node->data.fn_call.args[i], in)) return false;
+            return true;
+        }
+        default: return false;
+    }
+}
+
+// Whether a statement does nothing but (at most) assign one variable, so temporaries can run before it.
+static bool can_prelude(ClaspASTNode *stmt, Inliner *in) {
+    ClaspASTNode *expr = NULL;
+    switch (stmt->type) {
+        case AST_EXPR_STMT:   expr = stmt->data.expr_stmt.expr; break;
+        case AST_RETURN_STMT: expr = stmt->data.return_stmt.retval; break;
+        case AST_IF_STMT:     expr = stmt->data.cond_stmt.cond; break;
+        case AST_VAR_DECL_STMT:
+        case AST_LET_DECL_STMT:
+        case AST_CONST_DECL_STMT: expr = stmt->data.var_decl_stmt.initializer; break;
+        default: return false;
+    }
+    if (!expr) return true;
+    if (expr->type == AST_EXPR_BINOP && tktyp_is_assignment(expr->data.binop.op->type) && expr->data.binop.left->type == AST_EXPR_VAR_REF)
+        expr = expr->data.binop.right;
+    return pure(expr, in);
+}
+
+static void *count(ClaspASTNode *node, void *args) {
+    ++*(size_t *)args;
+    ast_map_children(node, &count, args);
+    return node;
+}
+
+static size_t size(ClaspASTNode *node) {
+    size_t n = 0;
+    count(node, &n);
+    return n;
+}
+
+static size_t uses(ClaspASTNode *node, const char *name) {
+    switch (node->type) {
+        case AST_EXPR_VAR_REF: return !strcmp(node->data.var_ref.varname->data, name);
+        case AST_EXPR_UNOP:    return uses(node->data.unop.right, name);
+        case AST_EXPR_BINOP:   return uses(node->data.binop.left, name) + uses(node->data.binop.right, name);
+        case AST_EXPR_FN_CALL: {
+            size_t n = uses(node->data.fn_call.referencer, name);
+            for (size_t i = 0; i < cvector_size(node->data.fn_call.args); ++i) n += uses(node->data.fn_call.args[i], name);
+            return n;
+        }
+        default: return 0;
+    }
+}
+
+/**
+ * The parts of an inlinable function body.
+*/
+typedef struct Body {
+    cvector(ClaspASTNode *) decls;
+    ClaspASTNode *ret;
+    hashmap_t names;    // Parameters and locals, everything else the body reads is a global
+} Body;
+
+static bool split_body(ClaspASTNode *fn, Body *body) {
+    ClaspASTNode *stmt = fn->data.fn_decl_stmt.body;
+    cvector(ClaspASTNode *) stmts = NULL;
+    if (stmt && stmt->type == AST_BLOCK_STMT) {
+        for (size_t i = 0; i < cvector_size(stmt->data.block_stmt.body); ++i)
+            if (stmt->data.block_stmt.body[i]) cvector_push_back(stmts, stmt->data.block_stmt.body[i]);
+    } else if (stmt) cvector_push_back(stmts, stmt);
+
+    size_t n = cvector_size(stmts);
+    bool ok = n > 0 && stmts[n - 1]->type == AST_RETURN_STMT && stmts[n - 1]->data.return_stmt.retval;
+    for (size_t i = 0; ok && i + 1 < n; ++i) ok = is_decl(stmts[i]) && stmts[i]->data.var_decl_stmt.initializer;
+    if (!ok) {
+        cvector_free(stmts);
+        return false;
+    }
+
+    body->ret = stmts[n - 1]->data.return_stmt.retval;
+    body->decls = NULL;
+    hashmap_create(16, &body->names);
+    for (size_t i = 0; i + 1 < n; ++i) {
+        cvector_push_back(body->decls, stmts[i]);
+        ClaspToken *name = stmts[i]->data.var_decl_stmt.name;
+        hashmap_put(&body->names, name->data, strlen(name->data), name);
+    }
+    for (size_t i = 0; i < cvector_size(fn->data.fn_decl_stmt.args); ++i) {
+        ClaspToken *name = fn->data.fn_decl_stmt.args[i]->name;
+        hashmap_put(&body->names, name->data, strlen(name->data), name);
+    }
+    cvector_free(stmts);
+    return true;
+}
+
+static void free_body(Body *body) {
+    cvector_free(body->decls);
+    hashmap_destroy(&body->names);
+}
+
+// Whether a global the body reads is hidden by one of the caller's own names.
+static bool captured(ClaspASTNode *node, Body *body, Inliner *in) {
+    if (node->type == AST_EXPR_VAR_REF) {
+        const char *name = node->data.var_ref.varname->data;
+        return !hashmap_get(&body->names, name, strlen(name)) && hashmap_get(&in->locals, name, strlen(name));
+    }
+    switch (node->type) {
+        case AST_EXPR_UNOP:  return captured(node->data.unop.right, body, in);
+        case AST_EXPR_BINOP: return captured(node->data.binop.left, body, in) || captured(node->data.binop.right, body, in);
+        case AST_EXPR_FN_CALL:
+            if (captured(node->data.fn_call.referencer, body, in)) return true;
+            for (size_t i = 0; i < cvector_size(node->data.fn_call.args); ++i)
+                if (captured(node->data.fn_call.args[i], body, in)) return true;
+            return false;
+        default: return false;
+    }
+}
+
+static bool body_captured(Body *body, Inliner *in) {
+    if (captured(body->ret, body, in)) return true;
+    for (size_t i = 0; i < cvector_size(body->decls); ++i)
+        if (captured(body->decls[i]->data.var_decl_stmt.initializer, body, in)) return true;
+    return false;
+}
+
+/**
+ * Parameter and local substitutions for one inlined call.
+*/
+typedef struct Subst {
+    hashmap_t names;    // name -> expression to copy in its place
+} Subst;
+
+static void *substitute(ClaspASTNode *node, void *args) {
+    Subst *s = args;
+    if (node->type == AST_EXPR_VAR_REF) {
+        const char *name = node->data.var_ref.varname->data;
+        ClaspASTNode *with = hashmap_get(&s->names, name, strlen(name));
+        return with ? ast_clone(with) : node;
+    }
+    ast_map_children(node, &substitute, args);
+    return node;
+}
+
+static ClaspASTNode *temporary(Inliner *in, unsigned id, const char *name, ClaspASTNode *type, ClaspASTNode *value, ClaspToken *at) {
+    char buf[256];
+    snprintf(buf, sizeof(buf), CLASP_INLINE_PREFIX "%u_%s", id, name);
+    ClaspToken *tok = token_synth(TOKEN_ID, buf, at);
+    cvector_push_back(*in->prelude, let_decl(tok, type, value));
+    return typed_var_ref(tok, type, TYPE_IMMUTABLE);
+}
+
+static ClaspASTNode *try_inline(ClaspASTNode *call, Inliner *in) {
+    ClaspCallGraphNode *callee = callgraph_callee(in->graph, call);
+    if (!callee || callee->recursive || !callee->pure) return call;
+    ClaspASTNode *fn = callee->fn, *sig = type_of(fn);
+    if (!sig || sig->type != AST_TYPE_FN || !type_of(call)) return call; // Not type checked
+
+    cvector(ClaspASTNode *) args = call->data.fn_call.args;
+    size_t argc = cvector_size(args);
+    if (argc != cvector_size(fn->data.fn_decl_stmt.args)) return call;
+    for (size_t i = 0; i < argc; ++i) if (!pure(args[i], in)) return call;
+
+    size_t limit = in->opts.budget * (1 + (in->loops < LOOP_SCALE_MAX - 1 ? in->loops : LOOP_SCALE_MAX - 1));
+    if (callee->call_sites == 1 && limit < in->opts.budget * SOLE_CALLER_SCALE) limit = in->opts.budget * SOLE_CALLER_SCALE;
+    size_t cost = size(fn->data.fn_decl_stmt.body);
+    if (cost > limit) return call;
+
+    Body body;
+    if (!split_body(fn, &body)) return call;
+    if (body_captured(&body, in)) {
+        free_body(&body);
+        return call;
+    }
+
+        // Substitute into the expression directly when that doesn't change what gets evaluated.
+    ClaspASTNode *ret_type = sig->data.function.ret;
+    bool direct = !cvector_size(body.decls) && type_of(body.ret) == ret_type;
+    for (size_t i = 0; direct && i < argc; ++i) {
+        const char *param = fn->data.fn_decl_stmt.args[i]->name->data;
+        direct = type_of(args[i]) == sig->data.function.args[i] && (is_trivial(args[i]) || uses(body.ret, param) <= 1);
+    }
+    if (!direct && !in->prelude) {
+        free_body(&body);
+        return call;
+    }
+
+    unsigned id = in->next++;
+    ClaspToken *at = call->data.fn_call.referencer->data.var_ref.varname;
+    Subst s;
+    hashmap_create(16, &s.names);
+    for (size_t i = 0; i < argc; ++i) {
+        ClaspToken *param = fn->data.fn_decl_stmt.args[i]->name;
+        ClaspASTNode *ptype = sig->data.function.args[i], *value = args[i];
+        if (!direct && (!is_trivial(value) || type_of(value) != ptype)) value = temporary(in, id, param->data, ptype, value, at);
+        hashmap_put(&s.names, param->data, strlen(param->data), value);
+    }
+    for (size_t i = 0; i < cvector_size(body.decls); ++i) {
+        ClaspASTNode *decl = body.decls[i];
+        ClaspToken *name = decl->data.var_decl_stmt.name;
+        ClaspASTNode *init = substitute(ast_clone(decl->data.var_decl_stmt.initializer), &s);
+        ClaspASTNode *type = type_resolve(decl->data.var_decl_stmt.type);
+        hashmap_put(&s.names, name->data, strlen(name->data), temporary(in, id, name->data, type, init, at));
+    }
+    ClaspASTNode *out = substitute(ast_clone(body.ret), &s);
+    if (type_of(out) != ret_type) out = temporary(in, id, "ret", ret_type, out, at);
+
+    if (in->opts.report) {
+        fprintf(stderr, "inline: %s (%zu nodes%s) into %s, line %u\n", fn->data.fn_decl_stmt.name->data, cost,
+            direct ? "" : ", with temporaries", in->caller ? in->caller : "the top level", at->lineno);
+    }
+    hashmap_destroy(&s.names);
+    free_body(&body);
+    return out;
+}
+
+// Rewrite the calls in an expression, innermost first.
+static void *inline_expr(ClaspASTNode *node, void *args) {
+    ast_map_children(node, &inline_expr, args);
+    return node->type == AST_EXPR_FN_CALL ? try_inline(node, args) : node;
+}
+
+static ClaspASTNode *inline_stmt(ClaspASTNode *stmt, Inliner *in, cvector(ClaspASTNode *) *prelude);
+
+// A statement that isn't directly in a block gets its own block when it needs temporaries.
+static ClaspASTNode *inline_nested(ClaspASTNode *stmt, Inliner *in) {
+    if (!stmt) return NULL;
+    cvector(ClaspASTNode *) prelude = NULL;
+    stmt = inline_stmt(stmt, in, &prelude);
+    if (!prelude) return stmt;
+    cvector_push_back(prelude, stmt);
+    return block_stmt(prelude);
+}
+
+static ClaspASTNode *inline_cond(ClaspASTNode *cond, Inliner *in, cvector(ClaspASTNode *) *prelude) {
+    if (!cond) return NULL;
+    cvector(ClaspASTNode *) *saved = in->prelude;
+    in->prelude = prelude;
+    cond = inline_expr(cond, in);
+    in->prelude = saved;
+    return cond;
+}
+
+static ClaspASTNode *inline_stmt(ClaspASTNode *stmt, Inliner *in, cvector(ClaspASTNode *) *prelude) {
+    switch (stmt->type) {
+        case AST_BLOCK_STMT: {
+            cvector(ClaspASTNode *) out = NULL;
+            for (size_t i = 0; i < cvector_size(stmt->data.block_stmt.body); ++i) {
+                ClaspASTNode *s = stmt->data.block_stmt.body[i];
+                if (s) s = inline_stmt(s, in, &out);
+                cvector_push_back(out, s);
+            }
+            cvector_free(stmt->data.block_stmt.body);
+            stmt->data.block_stmt.body = out;
+            return stmt;
+        }
+        case AST_IF_STMT:
+            stmt->data.cond_stmt.cond = inline_cond(stmt->data.cond_stmt.cond, in, can_prelude(stmt, in) ? prelude : NULL);
+            stmt->data.cond_stmt.body = inline_nested(stmt->data.cond_stmt.body, in);
+            return stmt;
+        case AST_WHILE_STMT:
+            in->loops++;
+            stmt->data.cond_stmt.cond = inline_cond(stmt->data.cond_stmt.cond, in, NULL);
+            stmt->data.cond_stmt.body = inline_nested(stmt->data.cond_stmt.body, in);
+            in->loops--;
+            return stmt;
+        case AST_FOR_STMT:
+            if (stmt->data.for_stmt.init) stmt->data.for_stmt.init = inline_stmt(stmt->data.for_stmt.init, in, prelude);
+            in->loops++;
+            stmt->data.for_stmt.cond = inline_cond(stmt->data.for_stmt.cond, in, NULL);
+            if (stmt->data.for_stmt.step) stmt->data.for_stmt.step = inline_stmt(stmt->data.for_stmt.step, in, NULL);
+            stmt->data.for_stmt.body = inline_nested(stmt->data.for_stmt.body, in);
+            in->loops--;
+            return stmt;
+        case AST_FN_DECL_STMT: // Nested functions, top-level ones are done by ast_inline()
+            stmt->data.fn_decl_stmt.body = inline_nested(stmt->data.fn_decl_stmt.body, in);
+            return stmt;
+        default: {
+            cvector(ClaspASTNode *) *saved = in->prelude;
+            in->prelude = prelude && can_prelude(stmt, in) ? prelude : NULL;
+            ast_map_children(stmt, &inline_expr, in);
+            in->prelude = saved;
+            return stmt;
+        }
+    }
+}
+
+static void *find_locals(ClaspASTNode *node, void *args) {
+    Inliner *in = args;
+    ClaspToken *name = NULL;
+    switch (node->type) {
+        case AST_VAR_DECL_STMT:
+        case AST_LET_DECL_STMT:
+        case AST_CONST_DECL_STMT: name = node->data.var_decl_stmt.name; break;
+        case AST_FN_DECL_STMT:
+            name = node->data.fn_decl_stmt.name;
+            for (size_t i = 0; i < cvector_size(node->data.fn_decl_stmt.args); ++i) {
+                ClaspToken *arg = node->data.fn_decl_stmt.args[i]->name;
+                hashmap_put(&in->locals, arg->data, strlen(arg->data), arg);
+            }
+            break;
+        default: break;
+    }
+    if (name) hashmap_put(&in->locals, name->data, strlen(name->data), name);
+    ast_map_children(node, &find_locals, args);
+    return node;
+}
+
+ClaspASTNode *ast_inline(ClaspASTNode *ast, const ClaspInlineOptions *opts) {
+    ClaspInlineOptions defaults = { CLASP_INLINE_BUDGET, false };
+    if (!opts) opts = &defaults;
+    if (!ast || opts->budget == 0) return ast;
+
+    Inliner in = { .graph = callgraph_build(ast), .opts = *opts };
+
+    for (size_t i = 0; i < cvector_size(in.graph->nodes); ++i) {
+        ClaspASTNode *fn = in.graph->nodes[i]->fn;
+        in.caller = fn->data.fn_decl_stmt.name->data;
+        hashmap_create(16, &in.locals);
+        find_locals(fn, &in);
+        fn->data.fn_decl_stmt.body = inline_nested(fn->data.fn_decl_stmt.body, &in);
+        hashmap_destroy(&in.locals);
+    }
+
+        // The top level itself: its own declarations are the globals, anything nested can capture.
+    in.caller = NULL;
+    hashmap_create(16, &in.locals);
+    if (ast->type != AST_BLOCK_STMT) {
+        find_locals(ast, &in);
+        ast = inline_nested(ast, &in);
+    } else {
+        cvector(ClaspASTNode *) out = NULL;
+        for (size_t i = 0; i < cvector_size(ast->data.block_stmt.body); ++i) {
+            ClaspASTNode *stmt = ast->data.block_stmt.body[i];
+            if (stmt && stmt->type != AST_FN_DECL_STMT) {
+                if (is_decl(stmt)) ast_map_children(stmt, &find_locals, &in);
+                else find_locals(stmt, &in);
+                stmt = inline_stmt(stmt, &in, &out);
+            }
+            cvector_push_back(out, stmt);
+        }
+        cvector_free(ast->data.block_stmt.body);
+        ast->data.block_stmt.body = out;
+    }
+    hashmap_destroy(&in.locals);
+    callgraph_free(in.graph);
+    return ast;
+}
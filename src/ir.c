@@ -0,0 +1,481 @@
+/**
+ * Clasp SSA IR implementation
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/ir.h>
+#include <clasp/types.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cvector/cvector.h>
+
+#define CLASP_IR_NAME_ENTRY(entry, name) name,
+static const char *TYPE_NAMES[] = { CLASP_IR_TYPES(CLASP_IR_NAME_ENTRY) };
+static const char *OP_NAMES[] = { CLASP_IR_OPCODES(CLASP_IR_NAME_ENTRY) };
+#undef CLASP_IR_NAME_ENTRY
+
+ClaspIRType ir_type(ClaspASTNode *type) {
+    if (type && type->type == AST_TYPE_FN) return IR_PTR;
+    bool is_float = type_is_float(type);
+    switch (type_size(type)) {
+        case 1:  return IR_I8;
+        case 2:  return IR_I16;
+        case 4:  return is_float ? IR_F32 : IR_I32;
+        case 8:  return is_float ? IR_F64 : IR_I64;
+        default: return IR_VOID;
+    }
+}
+
+const char *ir_type_name(ClaspIRType type) {
+    return type <= IR_PTR ? TYPE_NAMES[type] : "?";
+}
+
+const char *ir_op_name(ClaspIROp op) {
+    return op < CLASP_IR_NUM_OPS ? OP_NAMES[op] : "?";
+}
+
+bool ir_is_terminator(ClaspIROp op) {
+    return op == IR_BR || op == IR_CBR || op == IR_RET;
+}
+
+size_t ir_successors(ClaspIRInst *inst, uint32_t out[2]) {
+    switch (inst->op) {
+        case IR_BR:  out[0] = inst->a; return 1;
+        case IR_CBR: out[0] = inst->b; out[1] = inst->imm.index; return 2;
+        default:     return 0;
+    }
+}
+
+ClaspIRFunction *ir_function(ClaspIRModule *m, const char *name, ClaspASTNode *sig) {
+    ClaspIRFunction *fn = calloc(1, sizeof(ClaspIRFunction));
+    fn->name = malloc(strlen(name) + 1);
+    strcpy(fn->name, name);
+    fn->sig = sig;
+    cvector_push_back(m->fns, fn);
+    return fn;
+}
+
+ClaspIRValue ir_emit(ClaspIRFunction *fn, uint32_t block, ClaspIRInst inst) {
+    ClaspIRValue v = cvector_size(fn->insts);
+    inst.block = block;
+    cvector_push_back(fn->insts, inst);
+    cvector_push_back(fn->blocks[block].insts, v);
+    return v;
+}
+
+void ir_free(ClaspIRModule *m) {
+    if (!m) return;
+    for (size_t i = 0; i < cvector_size(m->fns); ++i) {
+        ClaspIRFunction *fn = m->fns[i];
+        for (size_t b = 0; b < cvector_size(fn->blocks); ++b) {
+            cvector_free(fn->blocks[b].insts);
+            cvector_free(fn->blocks[b].preds);
+        }
+        cvector_free(fn->blocks);
+        cvector_free(fn->insts);
+        cvector_free(fn->operands);
+        free(fn->name);
+        free(fn);
+    }
+    for (size_t i = 0; i < cvector_size(m->globals); ++i) free(m->globals[i].name);
+    cvector_free(m->fns);
+    cvector_free(m->globals);
+    free(m);
+}
+
+// ---- Verifier ----
+
+typedef struct Verifier {
+    ClaspIRModule *m;
+    ClaspIRFunction *fn;
+    FILE *out;
+    size_t errors;
+
+    uint32_t *pos;      // Value -> position in its block, CLASP_IR_NONE if it isn't in one
+    uint32_t *idom;     // Block -> immediate dominator, CLASP_IR_NONE if unreachable
+    uint32_t *order;    // Block -> reverse post-order number
+} Verifier;
+
+static void fail(Verifier *v, ClaspIRValue at, const char *fmt, ...) {
+    v->errors++;
+    if (!v->out) return;
+    if (at != CLASP_IR_NONE) fprintf(v->out, "IR error in %s at %%%u: ", v->fn->name, at);
+    else                     fprintf(v->out, "IR error in %s: ", v->fn->name);
+    va_list args;
+    va_start(args, fmt);
+    vfprintf(v->out, fmt, args);
+    va_end(args);
+    fputc('\n', v->out);
+}
+
+static void post_order(ClaspIRFunction *fn, uint32_t b, bool *seen, cvector(uint32_t) *out) {
+    seen[b] = true;
+    ClaspIRBlock *block = &fn->blocks[b];
+    uint32_t succ[2];
+    size_t n = cvector_size(block->insts) ? ir_successors(&fn->insts[block->insts[cvector_size(block->insts) - 1]], succ) : 0;
+    for (size_t i = 0; i < n; ++i)
+        if (succ[i] < cvector_size(fn->blocks) && !seen[succ[i]]) post_order(fn, succ[i], seen, out);
+    cvector_push_back(*out, b);
+}
+
+// Cooper, Harvey and Kennedy, "A Simple, Fast Dominance Algorithm".
+static void dominators(Verifier *v) {
+    ClaspIRFunction *fn = v->fn;
+    size_t nblocks = cvector_size(fn->blocks);
+    bool *seen = calloc(nblocks, sizeof(bool));
+    cvector(uint32_t) po = NULL;
+    post_order(fn, 0, seen, &po);
+    free(seen);
+
+    v->idom = realloc(v->idom, nblocks * sizeof(uint32_t));
+    v->order = realloc(v->order, nblocks * sizeof(uint32_t));
+    for (size_t i = 0; i < nblocks; ++i) v->idom[i] = v->order[i] = CLASP_IR_NONE;
+    for (size_t i = 0; i < cvector_size(po); ++i) v->order[po[i]] = cvector_size(po) - 1 - i;
+    v->idom[0] = 0;
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = cvector_size(po) - 1; i-- > 0;) { // Reverse post-order, skipping the entry
+            uint32_t b = po[i], dom = CLASP_IR_NONE;
+            for (size_t p = 0; p < cvector_size(fn->blocks[b].preds); ++p) {
+                uint32_t pred = fn->blocks[b].preds[p];
+                if (pred >= nblocks || v->idom[pred] == CLASP_IR_NONE) continue;
+                if (dom == CLASP_IR_NONE) { dom = pred; continue; }
+                uint32_t x = pred, y = dom;
+                while (x != y) {
+                    while (v->order[x] > v->order[y]) x = v->idom[x];
+                    while (v->order[y] > v->order[x]) y = v->idom[y];
+                }
+                dom = x;
+            }
+            if (dom != v->idom[b]) {
+                v->idom[b] = dom;
+                changed = true;
+            }
+        }
+    }
+    cvector_free(po);
+}
+
+static bool dominates(Verifier *v, uint32_t a, uint32_t b) {
+    if (v->idom[b] == CLASP_IR_NONE) return true; // Nothing to prove in unreachable code
+    while (b != a && b != 0) b = v->idom[b];
+    return b == a;
+}
+
+// Check that a value is defined and usable at position `at` of `block`.
+static ClaspIRType use(Verifier *v, ClaspIRValue user, ClaspIRValue value, uint32_t block, uint32_t at) {
+    ClaspIRFunction *fn = v->fn;
+    if (value >= cvector_size(fn->insts) || v->pos[value] == CLASP_IR_NONE) {
+        fail(v, user, "operand %%%d is not an instruction in a block.", (int) value);
+        return IR_VOID;
+    }
+    ClaspIRInst *def = &fn->insts[value];
+    bool ok = def->block == block ? v->pos[value] < at : dominates(v, def->block, block);
+    if (!ok) fail(v, user, "operand %%%u does not dominate its use.", value);
+    if (def->type == IR_VOID) fail(v, user, "operand %%%u has no value.", value);
+    return def->type;
+}
+
+static void expect(Verifier *v, ClaspIRValue at, ClaspIRType got, ClaspIRType want) {
+    if (got != want) fail(v, at, "expected a %s operand, got %s.", ir_type_name(want), ir_type_name(got));
+}
+
+static bool is_int(ClaspIRType type) { return type >= IR_I8 && type <= IR_I64; }
+static bool is_num(ClaspIRType type) { return type >= IR_I8 && type <= IR_F64; }
+
+static ClaspIRValue *list(ClaspIRFunction *fn, ClaspIRInst *inst) {
+    return fn->operands + inst->imm.list.first;
+}
+
+static void verify_inst(Verifier *v, ClaspIRValue value) {
+    ClaspIRFunction *fn = v->fn;
+    ClaspIRInst *inst = &fn->insts[value];
+    ClaspIRBlock *block = &fn->blocks[inst->block];
+    uint32_t at = v->pos[value], nblocks = cvector_size(fn->blocks);
+    ClaspIRType type = inst->type;
+
+    if ((inst->op == IR_PHI || inst->op == IR_CALL) && inst->imm.list.first + inst->imm.list.count > cvector_size(fn->operands)) {
+        fail(v, value, "operand list out of range.");
+        return;
+    }
+    switch (inst->op) {
+        case IR_CONST:
+        case IR_UNDEF:
+            if (type == IR_VOID) fail(v, value, "void %s.", ir_op_name(inst->op));
+            break;
+        case IR_PARAM:
+            if (inst->imm.index >= cvector_size(fn->sig->data.function.args)) fail(v, value, "no parameter %u.", inst->imm.index);
+            else expect(v, value, type, ir_type(fn->sig->data.function.args[inst->imm.index]));
+            break;
+        case IR_FUNC:
+            if (inst->imm.index >= cvector_size(v->m->fns)) fail(v, value, "no function %u.", inst->imm.index);
+            expect(v, value, type, IR_PTR);
+            break;
+        case IR_LOAD:
+        case IR_STORE:
+            if (inst->imm.index >= cvector_size(v->m->globals)) {
+                fail(v, value, "no global %u.", inst->imm.index);
+                break;
+            }
+            if (inst->op == IR_LOAD) expect(v, value, type, v->m->globals[inst->imm.index].type);
+            else expect(v, value, use(v, value, inst->a, inst->block, at), v->m->globals[inst->imm.index].type);
+            break;
+        case IR_ADD: case IR_SUB: case IR_MUL: case IR_DIV:
+        case IR_REM: case IR_POW: case IR_SHL: case IR_XOR: {
+            bool integral = inst->op == IR_REM || inst->op == IR_SHL || inst->op == IR_XOR;
+            if (integral ? !is_int(type) : !is_num(type)) fail(v, value, "%s on %s.", ir_op_name(inst->op), ir_type_name(type));
+            expect(v, value, use(v, value, inst->a, inst->block, at), type);
+            expect(v, value, use(v, value, inst->b, inst->block, at), type);
+            break;
+        }
+        case IR_NEG:
+        case IR_NOT:
+            if (inst->op == IR_NOT ? !is_int(type) : !is_num(type)) fail(v, value, "%s on %s.", ir_op_name(inst->op), ir_type_name(type));
+            expect(v, value, use(v, value, inst->a, inst->block, at), type);
+            break;
+        case IR_EQ: case IR_NE: case IR_LT:
+        case IR_LE: case IR_GT: case IR_GE: {
+            ClaspIRType a = use(v, value, inst->a, inst->block, at);
+            expect(v, value, use(v, value, inst->b, inst->block, at), a);
+            if (!is_num(a)) fail(v, value, "comparison of %s.", ir_type_name(a));
+            expect(v, value, type, IR_I32);
+            break;
+        }
+        case IR_CONV:
+            if (!is_num(type) || !is_num(use(v, value, inst->a, inst->block, at))) fail(v, value, "conversion between non-numbers.");
+            break;
+        case IR_CALL: {
+            expect(v, value, use(v, value, inst->a, inst->block, at), IR_PTR);
+            for (uint32_t i = 0; i < inst->imm.list.count; ++i) use(v, value, list(fn, inst)[i], inst->block, at);
+            if (inst->a >= cvector_size(fn->insts) || fn->insts[inst->a].op != IR_FUNC) break;
+            uint32_t callee = fn->insts[inst->a].imm.index;
+            if (callee >= cvector_size(v->m->fns)) break;
+            ClaspASTNode *sig = v->m->fns[callee]->sig;
+            if (cvector_size(sig->data.function.args) != inst->imm.list.count) {
+                fail(v, value, "%s takes %zu arguments, got %u.", v->m->fns[callee]->name, cvector_size(sig->data.function.args), inst->imm.list.count);
+                break;
+            }
+            for (uint32_t i = 0; i < inst->imm.list.count; ++i) {
+                ClaspIRValue arg = list(fn, inst)[i];
+                if (arg < cvector_size(fn->insts)) expect(v, value, fn->insts[arg].type, ir_type(sig->data.function.args[i]));
+            }
+            expect(v, value, type, ir_type(sig->data.function.ret));
+            break;
+        }
+        case IR_PHI:
+            if (inst->imm.list.count != cvector_size(block->preds)) {
+                fail(v, value, "phi has %u operands for %zu predecessors.", inst->imm.list.count, cvector_size(block->preds));
+                break;
+            }
+            for (uint32_t i = 0; i < inst->imm.list.count; ++i) {
+                uint32_t pred = block->preds[i];
+                if (pred >= nblocks) continue; // Reported with the block
+                uint32_t end = cvector_size(fn->blocks[pred].insts);
+                expect(v, value, use(v, value, list(fn, inst)[i], pred, end), type);
+            }
+            break;
+        case IR_BR:
+            if (inst->a >= nblocks) fail(v, value, "branch to missing block b%u.", inst->a);
+            break;
+        case IR_CBR:
+            if (!is_int(use(v, value, inst->a, inst->block, at))) fail(v, value, "branch condition is not an integer.");
+            if (inst->b >= nblocks || inst->imm.index >= nblocks) fail(v, value, "branch to a missing block.");
+            break;
+        case IR_RET: {
+            ClaspIRType ret = ir_type(fn->sig->data.function.ret);
+            if (inst->a == CLASP_IR_NONE) {
+                if (ret != IR_VOID) fail(v, value, "missing return value.");
+            } else {
+                expect(v, value, use(v, value, inst->a, inst->block, at), ret);
+            }
+            break;
+        }
+        default:
+            fail(v, value, "unknown opcode %u.", inst->op);
+            break;
+    }
+}
+
+static void verify_fn(Verifier *v) {
+    ClaspIRFunction *fn = v->fn;
+    size_t ninsts = cvector_size(fn->insts), nblocks = cvector_size(fn->blocks);
+    if (!nblocks) return; // External
+
+    v->pos = realloc(v->pos, (ninsts + 1) * sizeof(uint32_t));
+    for (size_t i = 0; i < ninsts; ++i) v->pos[i] = CLASP_IR_NONE;
+
+    // Block structure
+    for (uint32_t b = 0; b < nblocks; ++b) {
+        ClaspIRBlock *block = &fn->blocks[b];
+        size_t n = cvector_size(block->insts);
+        if (!n) {
+            fail(v, CLASP_IR_NONE, "block b%u is empty.", b);
+            continue;
+        }
+        bool body = false;
+        for (uint32_t i = 0; i < n; ++i) {
+            ClaspIRValue value = block->insts[i];
+            if (value >= ninsts) {
+                fail(v, CLASP_IR_NONE, "block b%u lists missing instruction %%%u.", b, value);
+                continue;
+            }
+            ClaspIRInst *inst = &fn->insts[value];
+            if (v->pos[value] != CLASP_IR_NONE) fail(v, value, "instruction is in more than one block.");
+            if (inst->block != b) fail(v, value, "instruction thinks it is in b%u, not b%u.", inst->block, b);
+            if (inst->op == IR_PHI && body) fail(v, value, "phi after the start of b%u.", b);
+            if (inst->op != IR_PHI) body = true;
+            if (ir_is_terminator(inst->op) != (i + 1 == n))
+                fail(v, value, i + 1 == n ? "b%u does not end in a terminator." : "terminator in the middle of b%u.", b);
+            v->pos[value] = i;
+        }
+    }
+
+    // Predecessor lists match the branches
+    for (uint32_t b = 0; b < nblocks; ++b) {
+        ClaspIRBlock *block = &fn->blocks[b];
+        if (!cvector_size(block->insts)) continue;
+        uint32_t succ[2];
+        size_t n = ir_successors(&fn->insts[block->insts[cvector_size(block->insts) - 1]], succ);
+        for (size_t i = 0; i < n; ++i) {
+            if (succ[i] >= nblocks) continue;
+            size_t edges = 0, listed = 0;
+            for (size_t j = 0; j < n; ++j) edges += succ[j] == succ[i];
+            for (size_t j = 0; j < cvector_size(fn->blocks[succ[i]].preds); ++j) listed += fn->blocks[succ[i]].preds[j] == b;
+            if (edges != listed) fail(v, CLASP_IR_NONE, "b%u branches to b%u %zu times but is listed %zu times.", b, succ[i], edges, listed);
+        }
+    }
+    for (uint32_t b = 0; b < nblocks; ++b) {
+        for (size_t j = 0; j < cvector_size(fn->blocks[b].preds); ++j) {
+            uint32_t pred = fn->blocks[b].preds[j], succ[2];
+            ClaspIRBlock *from = pred < nblocks ? &fn->blocks[pred] : NULL;
+            size_t n = from && cvector_size(from->insts) ? ir_successors(&fn->insts[from->insts[cvector_size(from->insts) - 1]], succ) : 0;
+            bool found = false;
+            for (size_t i = 0; i < n; ++i) found |= succ[i] == b;
+            if (!found) fail(v, CLASP_IR_NONE, "b%u lists b%u as a predecessor, which doesn't branch to it.", b, pred);
+        }
+    }
+    if (cvector_size(fn->blocks[0].preds)) fail(v, CLASP_IR_NONE, "the entry block has predecessors.");
+    if (v->errors) return; // Dominators need a sound graph
+
+    dominators(v);
+    for (uint32_t b = 0; b < nblocks; ++b)
+        for (size_t i = 0; i < cvector_size(fn->blocks[b].insts); ++i) verify_inst(v, fn->blocks[b].insts[i]);
+}
+
+size_t ir_verify(ClaspIRModule *m, FILE *out) {
+    Verifier v = { .m = m, .out = out };
+    for (size_t i = 0; i < cvector_size(m->fns); ++i) {
+        v.fn = m->fns[i];
+        size_t before = v.errors;
+        v.errors = 0;
+        verify_fn(&v);
+        v.errors += before;
+    }
+    free(v.pos);
+    free(v.idom);
+    free(v.order);
+    return v.errors;
+}
+
+// ---- Dump ----
+
+static void dump_sig(ClaspIRFunction *fn, FILE *out) {
+    fprintf(out, "%s(", fn->name);
+    for (size_t i = 0; i < cvector_size(fn->sig->data.function.args); ++i)
+        fprintf(out, "%s%s", i ? ", " : "", ir_type_name(ir_type(fn->sig->data.function.args[i])));
+    fprintf(out, ") -> %s", ir_type_name(ir_type(fn->sig->data.function.ret)));
+}
+
+static void dump_inst(ClaspIRModule *m, ClaspIRFunction *fn, ClaspIRValue value, FILE *out) {
+    ClaspIRInst *inst = &fn->insts[value];
+    fprintf(out, "    ");
+    if (inst->type != IR_VOID) fprintf(out, "%%%u = ", value);
+    fprintf(out, "%s", ir_op_name(inst->op));
+    if (inst->type != IR_VOID) fprintf(out, " %s", ir_type_name(inst->type));
+
+    switch (inst->op) {
+        case IR_CONST:
+            if (inst->type == IR_F32 || inst->type == IR_F64) fprintf(out, " %g", inst->imm.f);
+            else fprintf(out, " %lld", (long long) inst->imm.i);
+            break;
+        case IR_PARAM: fprintf(out, " %u", inst->imm.index); break;
+        case IR_FUNC:
+            fprintf(out, " @%s", inst->imm.index < cvector_size(m->fns) ? m->fns[inst->imm.index]->name : "?");
+            break;
+        case IR_LOAD:
+        case IR_STORE:
+            fprintf(out, " @%s", inst->imm.index < cvector_size(m->globals) ? m->globals[inst->imm.index].name : "?");
+            if (inst->op == IR_STORE) fprintf(out, ", %%%u", inst->a);
+            break;
+        case IR_NEG: case IR_NOT: case IR_CONV: fprintf(out, " %%%u", inst->a); break;
+        case IR_CALL:
+            fprintf(out, " %%%u(", inst->a);
+            for (uint32_t i = 0; i < inst->imm.list.count; ++i) fprintf(out, "%s%%%u", i ? ", " : "", list(fn, inst)[i]);
+            fprintf(out, ")");
+            break;
+        case IR_PHI:
+            for (uint32_t i = 0; i < inst->imm.list.count; ++i) {
+                uint32_t pred = i < cvector_size(fn->blocks[inst->block].preds) ? fn->blocks[inst->block].preds[i] : CLASP_IR_NONE;
+                fprintf(out, "%s [%%%u, b%d]", i ? "," : "", list(fn, inst)[i], (int) pred);
+            }
+            break;
+        case IR_BR:  fprintf(out, " b%u", inst->a); break;
+        case IR_CBR: fprintf(out, " %%%u, b%u, b%u", inst->a, inst->b, inst->imm.index); break;
+        case IR_RET: if (inst->a != CLASP_IR_NONE) fprintf(out, " %%%u", inst->a); break;
+        case IR_UNDEF: break;
+        default: fprintf(out, " %%%u, %%%u", inst->a, inst->b); break;
+    }
+    fputc('\n', out);
+}
+
+void ir_dump(ClaspIRModule *m, FILE *out) {
+    bool any = false;
+    for (size_t i = 0; i < cvector_size(m->globals); ++i, any = true)
+        fprintf(out, "global %s @%s\n", ir_type_name(m->globals[i].type), m->globals[i].name);
+    for (size_t i = 0; i < cvector_size(m->fns); ++i) {
+        if (cvector_size(m->fns[i]->blocks)) continue;
+        fprintf(out, "extern fn ");
+        dump_sig(m->fns[i], out);
+        fputc('\n', out);
+        any = true;
+    }
+    for (size_t i = 0; i < cvector_size(m->fns); ++i) {
+        ClaspIRFunction *fn = m->fns[i];
+        if (!cvector_size(fn->blocks)) continue;
+        fprintf(out, "%sfn ", any ? "\n" : "");
+        dump_sig(fn, out);
+        fprintf(out, " {\n");
+        for (size_t b = 0; b < cvector_size(fn->blocks); ++b) {
+            ClaspIRBlock *block = &fn->blocks[b];
+            fprintf(out, "b%zu:", b);
+            for (size_t p = 0; p < cvector_size(block->preds); ++p) fprintf(out, "%s b%u", p ? "," : " ; preds", block->preds[p]);
+            fputc('\n', out);
+            for (size_t j = 0; j < cvector_size(block->insts); ++j) dump_inst(m, fn, block->insts[j], out);
+        }
+        fprintf(out, "}\n");
+        any = true;
+    }
+}
@@ -0,0 +1,714 @@
+/**
+ * Clasp SSA IR construction implementation
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/ir_build.h>
+#include <clasp/err.h>
+#include <clasp/scope.h>
+#include <clasp/types.h>
+#include <clasp/walk.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cvector/cvector.h>
+#include <sheredom-hashmap/hashmap.h>
+
+typedef struct Pending {
+    uint32_t var;
+    ClaspIRValue phi;
+} Pending;
+
+/**
+ * Construction state of a block, alongside the ClaspIRBlock it becomes.
+*/
+typedef struct Block {
+    cvector(ClaspIRValue) defs;         // Variable -> its value at the end of the block so far, CLASP_IR_NONE if unset
+    cvector(ClaspIRValue) phis;         // Live phis, placed in front of the block when the function is finished
+    cvector(Pending) incomplete;        // Phis waiting for the block's predecessors to be known
+    bool sealed;                        // Whether all predecessors are known
+} Block;
+
+typedef struct Func {
+    ClaspIRFunction *ir;
+    cvector(Block) blocks;
+    cvector(uint8_t) vars;              // Variable -> ClaspIRType
+    cvector(ClaspIRValue) fwd;          // Value -> what replaced it (removed phis), CLASP_IR_NONE if it stands
+    ClaspIRValue undef[IR_PTR + 1];
+    uint32_t cur;                       // Block being filled, CLASP_IR_NONE after a return
+    bool init;
+} Func;
+
+typedef enum { NAME_LOCAL, NAME_GLOBAL, NAME_FUNC } NameKind;
+
+typedef struct Name {
+    NameKind kind;
+    uint32_t index;                     // Variable, global or function
+    Func *owner;                        // For locals
+    ClaspASTNode *decl;                 // For functions
+} Name;
+
+typedef struct Builder {
+    ClaspIRModule *m;
+    ClaspScope scope;
+    cvector(Name *) names;
+    hashmap_t captured;                 // Names referred to inside functions
+    hashmap_t externs;                  // Undeclared name -> function index + 1
+    Func *fn;
+    size_t errors;
+} Builder;
+
+#define PENDING CLASP_IR_NONE           // imm.list.first of a phi whose operands aren't known yet
+
+// ---- Values ----
+
+static ClaspIRValue find(Func *f, ClaspIRValue v) {
+    while (v < cvector_size(f->fwd) && f->fwd[v] != CLASP_IR_NONE) v = f->fwd[v];
+    return v;
+}
+
+static ClaspIRInst *inst(Func *f, ClaspIRValue v) {
+    return &f->ir->insts[v];
+}
+
+static ClaspIRValue emit(Func *f, ClaspIROp op, ClaspIRType type, ClaspIRValue a, ClaspIRValue b) {
+    return ir_emit(f->ir, f->cur, (ClaspIRInst) { .op = op, .type = type, .a = a, .b = b });
+}
+
+static ClaspIRValue emit_int(Func *f, ClaspIRType type, int64_t i) {
+    ClaspIRInst c = { .op = IR_CONST, .type = type };
+    if (type == IR_F32 || type == IR_F64) c.imm.f = i;
+    else c.imm.i = i;
+    return ir_emit(f->ir, f->cur, c);
+}
+
+static ClaspIRValue emit_list(Func *f, ClaspIROp op, ClaspIRType type, ClaspIRValue a, cvector(ClaspIRValue) list) {
+    ClaspIRInst c = { .op = op, .type = type, .a = a };
+    c.imm.list.first = cvector_size(f->ir->operands);
+    c.imm.list.count = cvector_size(list);
+    for (size_t i = 0; i < cvector_size(list); ++i) cvector_push_back(f->ir->operands, list[i]);
+    return ir_emit(f->ir, f->cur, c);
+}
+
+static ClaspIRValue undef(Func *f, ClaspIRType type) {
+    if (f->undef[type] != CLASP_IR_NONE) return f->undef[type];
+    ClaspIRValue v = cvector_size(f->ir->insts);
+    cvector_push_back(f->ir->insts, ((ClaspIRInst) { .op = IR_UNDEF, .type = type, .block = 0 }));
+    cvector_insert(f->ir->blocks[0].insts, 0, v); // Before the entry's terminator, wherever the builder is
+    return f->undef[type] = v;
+}
+
+static ClaspIRValue conv(Func *f, ClaspIRValue v, ClaspIRType to) {
+    if (inst(f, v)->type == to) return v;
+    return emit(f, IR_CONV, to, v, CLASP_IR_NONE);
+}
+
+// ---- Blocks and SSA construction ----
+
+static uint32_t new_block(Func *f) {
+    cvector_push_back(f->ir->blocks, ((ClaspIRBlock) { NULL, NULL }));
+    cvector_push_back(f->blocks, ((Block) { NULL, NULL, NULL, false }));
+    return cvector_size(f->blocks) - 1;
+}
+
+static void edge(Func *f, uint32_t from, uint32_t to) {
+    cvector_push_back(f->ir->blocks[to].preds, from);
+}
+
+static void branch(Func *f, uint32_t to) {
+    emit(f, IR_BR, IR_VOID, to, CLASP_IR_NONE);
+    edge(f, f->cur, to);
+}
+
+static void cbranch(Func *f, ClaspIRValue cond, uint32_t then, uint32_t other) {
+    ClaspIRInst c = { .op = IR_CBR, .type = IR_VOID, .a = cond, .b = then };
+    c.imm.index = other;
+    ir_emit(f->ir, f->cur, c);
+    edge(f, f->cur, then);
+    edge(f, f->cur, other);
+}
+
+static void write_var(Func *f, uint32_t var, uint32_t block, ClaspIRValue value) {
+    Block *b = &f->blocks[block];
+    while (cvector_size(b->defs) <= var) cvector_push_back(b->defs, CLASP_IR_NONE);
+    b->defs[var] = value;
+}
+
+static ClaspIRValue new_phi(Func *f, uint32_t block, ClaspIRType type) {
+    ClaspIRValue v = cvector_size(f->ir->insts);
+    ClaspIRInst phi = { .op = IR_PHI, .type = type, .block = block };
+    phi.imm.list.first = PENDING;
+    cvector_push_back(f->ir->insts, phi);
+    cvector_push_back(f->blocks[block].phis, v);
+    return v;
+}
+
+static ClaspIRValue try_remove_trivial(Func *f, ClaspIRValue phi);
+
+static ClaspIRValue read_var(Func *f, uint32_t var, uint32_t block);
+
+static ClaspIRValue add_phi_operands(Func *f, uint32_t var, ClaspIRValue phi) {
+    uint32_t block = inst(f, phi)->block;
+    cvector(ClaspIRValue) ops = NULL;
+    for (size_t i = 0; i < cvector_size(f->ir->blocks[block].preds); ++i)
+        cvector_push_back(ops, read_var(f, var, f->ir->blocks[block].preds[i]));
+
+    // Reading may have added other phis' operands, so this phi's list starts here
+    inst(f, phi)->imm.list.first = cvector_size(f->ir->operands);
+    inst(f, phi)->imm.list.count = cvector_size(ops);
+    for (size_t i = 0; i < cvector_size(ops); ++i) cvector_push_back(f->ir->operands, ops[i]);
+    cvector_free(ops);
+    return try_remove_trivial(f, phi);
+}
+
+// A phi that only merges itself and one other value is that value.
+static ClaspIRValue try_remove_trivial(Func *f, ClaspIRValue phi) {
+    if (find(f, phi) != phi) return find(f, phi);
+    ClaspIRInst *p = inst(f, phi);
+    ClaspIRValue same = CLASP_IR_NONE;
+    for (uint32_t i = 0; i < p->imm.list.count; ++i) {
+        ClaspIRValue op = find(f, f->ir->operands[p->imm.list.first + i]);
+        if (op == same || op == phi) continue;
+        if (same != CLASP_IR_NONE) return phi;
+        same = op;
+    }
+    if (same == CLASP_IR_NONE) same = undef(f, p->type); // Unreachable, or only reads itself
+
+    while (cvector_size(f->fwd) <= phi) cvector_push_back(f->fwd, CLASP_IR_NONE);
+    f->fwd[phi] = same;
+    Block *b = &f->blocks[p->block];
+    for (size_t i = 0; i < cvector_size(b->phis); ++i) {
+        if (b->phis[i] != phi) continue;
+        cvector_erase(b->phis, i);
+        break;
+    }
+
+    // Phis that used this one may have become trivial too
+    cvector(ClaspIRValue) users = NULL;
+    for (size_t bi = 0; bi < cvector_size(f->blocks); ++bi) {
+        for (size_t i = 0; i < cvector_size(f->blocks[bi].phis); ++i) {
+            ClaspIRInst *q = inst(f, f->blocks[bi].phis[i]);
+            if (q->imm.list.first == PENDING) continue;
+            for (uint32_t j = 0; j < q->imm.list.count; ++j) {
+                ClaspIRValue op = f->ir->operands[q->imm.list.first + j];
+                if (op != phi && find(f, op) != same) continue;
+                cvector_push_back(users, f->blocks[bi].phis[i]);
+                break;
+            }
+        }
+    }
+    for (size_t i = 0; i < cvector_size(users); ++i) try_remove_trivial(f, users[i]);
+    cvector_free(users);
+    return same;
+}
+
+static ClaspIRValue read_var(Func *f, uint32_t var, uint32_t block) {
+    Block *b = &f->blocks[block];
+    if (var < cvector_size(b->defs) && b->defs[var] != CLASP_IR_NONE) return find(f, b->defs[var]);
+
+    ClaspIRValue value;
+    ClaspIRType type = f->vars[var];
+    if (!b->sealed) { // Not all predecessors are known yet
+        value = new_phi(f, block, type);
+        cvector_push_back(f->blocks[block].incomplete, ((Pending) { var, value }));
+    } else if (cvector_size(f->ir->blocks[block].preds) == 0) {
+        value = undef(f, type);
+    } else if (cvector_size(f->ir->blocks[block].preds) == 1) {
+        value = read_var(f, var, f->ir->blocks[block].preds[0]);
+    } else { // Break cycles by writing the phi before looking at the predecessors
+        value = new_phi(f, block, type);
+        write_var(f, var, block, value);
+        value = add_phi_operands(f, var, value);
+    }
+    write_var(f, var, block, value);
+    return value;
+}
+
+static void seal(Func *f, uint32_t block) {
+    cvector(Pending) pending = f->blocks[block].incomplete;
+    f->blocks[block].incomplete = NULL;
+    f->blocks[block].sealed = true;
+    for (size_t i = 0; i < cvector_size(pending); ++i) add_phi_operands(f, pending[i].var, pending[i].phi);
+    cvector_free(pending);
+}
+
+// Place the live phis, drop blocks nothing reaches, and number values in block order.
+static void finish(Func *f) {
+    ClaspIRFunction *fn = f->ir;
+    size_t nblocks = cvector_size(fn->blocks), ninsts = cvector_size(fn->insts);
+    uint32_t *block_map = malloc(nblocks * sizeof(uint32_t));
+    uint32_t *value_map = malloc((ninsts + 1) * sizeof(uint32_t));
+    for (size_t i = 0; i < ninsts; ++i) value_map[i] = CLASP_IR_NONE;
+
+    cvector(ClaspIRBlock) blocks = NULL;
+    cvector(ClaspIRInst) insts = NULL;
+    for (size_t b = 0; b < nblocks; ++b) {
+        ClaspIRBlock *old = &fn->blocks[b];
+        if (b && !cvector_size(old->preds) && !cvector_size(old->insts)) {
+            block_map[b] = CLASP_IR_NONE;
+            continue;
+        }
+        block_map[b] = cvector_size(blocks);
+        ClaspIRBlock block = { NULL, old->preds };
+        cvector(ClaspIRValue) order = NULL;
+        for (size_t i = 0; i < cvector_size(f->blocks[b].phis); ++i) cvector_push_back(order, f->blocks[b].phis[i]);
+        for (size_t i = 0; i < cvector_size(old->insts); ++i) cvector_push_back(order, old->insts[i]);
+        for (size_t i = 0; i < cvector_size(order); ++i) {
+            value_map[order[i]] = cvector_size(insts);
+            cvector_push_back(block.insts, (ClaspIRValue) cvector_size(insts));
+            cvector_push_back(insts, fn->insts[order[i]]);
+        }
+        cvector_free(order);
+        cvector_free(old->insts);
+        cvector_push_back(blocks, block);
+    }
+
+    cvector(ClaspIRValue) operands = NULL;
+#define VALUE(v) ((v) == CLASP_IR_NONE ? CLASP_IR_NONE : value_map[find(f, v)])
+    for (size_t i = 0; i < cvector_size(insts); ++i) {
+        ClaspIRInst *in = &insts[i];
+        in->block = block_map[in->block];
+        switch (in->op) {
+            case IR_BR: in->a = block_map[in->a]; break;
+            case IR_CBR:
+                in->a = VALUE(in->a);
+                in->b = block_map[in->b];
+                in->imm.index = block_map[in->imm.index];
+                break;
+            case IR_PHI:
+            case IR_CALL: {
+                uint32_t first = cvector_size(operands);
+                for (uint32_t j = 0; j < in->imm.list.count; ++j)
+                    cvector_push_back(operands, VALUE(fn->operands[in->imm.list.first + j]));
+                in->imm.list.first = first;
+                in->a = VALUE(in->a);
+                break;
+            }
+            default:
+                in->a = VALUE(in->a);
+                in->b = VALUE(in->b);
+                break;
+        }
+    }
+#undef VALUE
+    for (size_t b = 0; b < cvector_size(blocks); ++b)
+        for (size_t i = 0; i < cvector_size(blocks[b].preds); ++i) blocks[b].preds[i] = block_map[blocks[b].preds[i]];
+
+    cvector_free(fn->blocks);
+    cvector_free(fn->insts);
+    cvector_free(fn->operands);
+    fn->blocks = blocks;
+    fn->insts = insts;
+    fn->operands = operands;
+    free(block_map);
+    free(value_map);
+
+    for (size_t b = 0; b < cvector_size(f->blocks); ++b) {
+        cvector_free(f->blocks[b].defs);
+        cvector_free(f->blocks[b].phis);
+        cvector_free(f->blocks[b].incomplete);
+    }
+    cvector_free(f->blocks);
+    cvector_free(f->vars);
+    cvector_free(f->fwd);
+}
+
+// ---- Names ----
+
+static Name *bind(Builder *b, const char *name, NameKind kind, uint32_t index, ClaspASTNode *decl) {
+    Name *n = malloc(sizeof(Name));
+    *n = (Name) { kind, index, b->fn, decl };
+    cvector_push_back(b->names, n);
+    scope_bind(&b->scope, name, NULL, 0, n);
+    return n;
+}
+
+static Name *lookup(Builder *b, const char *name) {
+    ClaspBinding *binding = scope_lookup(&b->scope, name);
+    return binding ? binding->value : NULL;
+}
+
+static uint32_t declare_fn(Builder *b, ClaspASTNode *decl) {
+    uint32_t index = cvector_size(b->m->fns);
+    ir_function(b->m, decl->data.fn_decl_stmt.name->data, decl->exprType->type);
+    bind(b, decl->data.fn_decl_stmt.name->data, NAME_FUNC, index, decl);
+    return index;
+}
+
+static uint32_t extern_fn(Builder *b, ClaspToken *name, ClaspASTNode *type) {
+    uintptr_t index = (uintptr_t) hashmap_get(&b->externs, name->data, strlen(name->data));
+    if (index) return index - 1;
+    index = cvector_size(b->m->fns);
+    ClaspIRFunction *fn = ir_function(b->m, name->data, type);
+    hashmap_put(&b->externs, fn->name, strlen(fn->name), (void *) (index + 1));
+    return index;
+}
+
+static uint32_t new_var(Func *f, ClaspIRType type) {
+    cvector_push_back(f->vars, type);
+    return cvector_size(f->vars) - 1;
+}
+
+// ---- Expressions ----
+
+static ClaspIRValue lower_expr(Builder *b, ClaspASTNode *node);
+
+static ClaspIRType type_of(ClaspASTNode *node) {
+    return ir_type(node->exprType->type);
+}
+
+static ClaspIRValue read_name(Builder *b, ClaspASTNode *ref) {
+    Func *f = b->fn;
+    ClaspToken *name = ref->data.var_ref.varname;
+    Name *n = lookup(b, name->data);
+    if (!n) {
+        ClaspIRInst c = { .op = IR_FUNC, .type = IR_PTR };
+        c.imm.index = extern_fn(b, name, ref->exprType->type);
+        return ir_emit(f->ir, f->cur, c);
+    }
+    switch (n->kind) {
+        case NAME_LOCAL:
+            if (n->owner != f) {
+                semantic_err(name, "Functions cannot use '%s' from an enclosing function yet.", name->data);
+                b->errors++;
+                return undef(f, type_of(ref));
+            }
+            return read_var(f, n->index, f->cur);
+        case NAME_GLOBAL: {
+            ClaspIRInst c = { .op = IR_LOAD, .type = b->m->globals[n->index].type };
+            c.imm.index = n->index;
+            return ir_emit(f->ir, f->cur, c);
+        }
+        default: {
+            ClaspIRInst c = { .op = IR_FUNC, .type = IR_PTR };
+            c.imm.index = n->index;
+            return ir_emit(f->ir, f->cur, c);
+        }
+    }
+}
+
+static void assign(Builder *b, ClaspASTNode *ref, ClaspIRValue value) {
+    Func *f = b->fn;
+    Name *n = lookup(b, ref->data.var_ref.varname->data);
+    if (!n) return; // The type check rejects assigning to anything that isn't a variable
+    if (n->kind == NAME_GLOBAL) {
+        ClaspIRInst c = { .op = IR_STORE, .type = IR_VOID, .a = value, .b = CLASP_IR_NONE };
+        c.imm.index = n->index;
+        ir_emit(f->ir, f->cur, c);
+    } else if (n->kind == NAME_LOCAL && n->owner == f) {
+        write_var(f, n->index, f->cur, value);
+    } else if (n->kind == NAME_LOCAL) {
+        semantic_err(ref->data.var_ref.varname, "Functions cannot use '%s' from an enclosing function yet.", ref->data.var_ref.varname->data);
+        b->errors++;
+    }
+}
+
+static ClaspIROp arith_op(ClaspTokenType op) {
+    switch (op) {
+        case TOKEN_PLUS:    case TOKEN_PLUS_EQ:    case TOKEN_PLUS_PLUS:   return IR_ADD;
+        case TOKEN_MINUS:   case TOKEN_MINUS_EQ:   case TOKEN_MINUS_MINUS: return IR_SUB;
+        case TOKEN_ASTERIX: case TOKEN_ASTERIX_EQ: return IR_MUL;
+        case TOKEN_SLASH:   case TOKEN_SLASH_EQ:   return IR_DIV;
+        case TOKEN_PERC:    case TOKEN_PERC_EQ:    return IR_REM;
+        case TOKEN_CARAT:   case TOKEN_CARAT_EQ:   return IR_POW;
+        case TOKEN_TILDE_EQ:                       return IR_XOR;
+        case TOKEN_LESS_LESS:                      return IR_SHL;
+        case TOKEN_EQ_EQ:      return IR_EQ;
+        case TOKEN_BANG_EQ:    return IR_NE;
+        case TOKEN_LESS:       return IR_LT;
+        case TOKEN_LESS_EQ:    return IR_LE;
+        case TOKEN_GREATER:    return IR_GT;
+        case TOKEN_GREATER_EQ: return IR_GE;
+        default:               return CLASP_IR_NUM_OPS;
+    }
+}
+
+static ClaspIRValue lower_binop(Builder *b, ClaspASTNode *node) {
+    Func *f = b->fn;
+    ClaspASTNode *left = node->data.binop.left, *right = node->data.binop.right;
+    ClaspTokenType op = node->data.binop.op->type;
+    ClaspIRType lt = type_of(left);
+
+    if (op == TOKEN_EQ) {
+        ClaspIRValue value = conv(f, lower_expr(b, right), lt);
+        assign(b, left, value);
+        return value;
+    }
+
+    ClaspIRValue l = lower_expr(b, left), r = lower_expr(b, right);
+    ClaspIROp ir_op = arith_op(op);
+    if (ir_op >= IR_EQ && ir_op <= IR_GE) {
+        ClaspIRType t = ir_type(type_promote(left->exprType->type, right->exprType->type));
+        return emit(f, ir_op, IR_I32, conv(f, l, t), conv(f, r, t));
+    }
+    if (ir_op == IR_SHL) return emit(f, IR_SHL, lt, l, conv(f, r, lt));
+    if (tktyp_is_assignment(op)) { // Compound assignment: compute in the promoted type, store in the variable's
+        ClaspIRType t = ir_type(type_promote(left->exprType->type, right->exprType->type));
+        ClaspIRValue value = conv(f, emit(f, ir_op, t, conv(f, l, t), conv(f, r, t)), lt);
+        assign(b, left, value);
+        return value;
+    }
+    ClaspIRType t = type_of(node);
+    return emit(f, ir_op, t, conv(f, l, t), conv(f, r, t));
+}
+
+static ClaspIRValue lower_expr(Builder *b, ClaspASTNode *node) {
+    Func *f = b->fn;
+    switch (node->type) {
+        case AST_EXPR_LIT_NUMBER: {
+            ClaspIRType t = type_of(node);
+            ClaspIRInst c = { .op = IR_CONST, .type = t };
+            if (t == IR_F32 || t == IR_F64) c.imm.f = strtod(node->data.lit_num.value->data, NULL);
+            else c.imm.i = strtoll(node->data.lit_num.value->data, NULL, 10);
+            return ir_emit(f->ir, f->cur, c);
+        }
+        case AST_EXPR_VAR_REF: return read_name(b, node);
+        case AST_EXPR_BINOP:   return lower_binop(b, node);
+        case AST_EXPR_UNOP: {
+            ClaspIRValue v = lower_expr(b, node->data.unop.right);
+            ClaspIRType t = inst(f, v)->type;
+            switch (node->data.unop.op->type) {
+                case TOKEN_MINUS: return emit(f, IR_NEG, t, v, CLASP_IR_NONE);
+                case TOKEN_TILDE: return emit(f, IR_NOT, t, v, CLASP_IR_NONE);
+                case TOKEN_BANG:  return emit(f, IR_EQ, IR_I32, v, emit_int(f, t, 0));
+                default:          return v;
+            }
+        }
+        case AST_EXPR_POSTFIX: {
+            ClaspASTNode *target = node->data.postfix.left;
+            ClaspIRValue old = lower_expr(b, target);
+            ClaspIRType t = inst(f, old)->type;
+            assign(b, target, emit(f, arith_op(node->data.postfix.op->type), t, old, emit_int(f, t, 1)));
+            return old;
+        }
+        case AST_EXPR_FN_CALL: {
+            ClaspASTNode *sig = node->data.fn_call.referencer->exprType->type;
+            ClaspIRValue callee = lower_expr(b, node->data.fn_call.referencer);
+            cvector(ClaspIRValue) args = NULL;
+            for (size_t i = 0; i < cvector_size(node->data.fn_call.args); ++i) {
+                ClaspIRValue arg = lower_expr(b, node->data.fn_call.args[i]);
+                cvector_push_back(args, conv(f, arg, ir_type(sig->data.function.args[i])));
+            }
+            ClaspIRValue call = emit_list(f, IR_CALL, ir_type(sig->data.function.ret), callee, args);
+            cvector_free(args);
+            return call;
+        }
+        default: return undef(f, IR_I32);
+    }
+}
+
+// Branch conditions are integers, floats compare against zero.
+static ClaspIRValue lower_cond(Builder *b, ClaspASTNode *cond) {
+    Func *f = b->fn;
+    ClaspIRValue v = lower_expr(b, cond);
+    ClaspIRType t = inst(f, v)->type;
+    if (t == IR_F32 || t == IR_F64) v = emit(f, IR_NE, IR_I32, v, emit_int(f, t, 0));
+    return v;
+}
+
+// ---- Statements ----
+
+static void lower_stmt(Builder *b, ClaspASTNode *node);
+
+static void lower_fn(Builder *b, ClaspASTNode *decl, ClaspASTNode *body, uint32_t index);
+
+static void lower_body(Builder *b, ClaspASTNode *body) {
+    if (!body) return;
+    if (body->type != AST_BLOCK_STMT) return lower_stmt(b, body);
+    scope_push(&b->scope);
+        // Functions are visible to the whole block they're declared in, like in the type check
+    for (size_t i = 0; i < cvector_size(body->data.block_stmt.body); ++i) {
+        ClaspASTNode *stmt = body->data.block_stmt.body[i];
+        if (stmt && stmt->type == AST_FN_DECL_STMT) declare_fn(b, stmt);
+    }
+    for (size_t i = 0; i < cvector_size(body->data.block_stmt.body); ++i) lower_stmt(b, body->data.block_stmt.body[i]);
+    scope_pop(&b->scope);
+}
+
+static void lower_decl(Builder *b, ClaspASTNode *node) {
+    Func *f = b->fn;
+    ClaspToken *name = node->data.var_decl_stmt.name;
+    ClaspIRType t = ir_type(node->data.var_decl_stmt.type);
+    ClaspIRValue value = node->data.var_decl_stmt.initializer ? conv(f, lower_expr(b, node->data.var_decl_stmt.initializer), t) : undef(f, t);
+
+    if (f->init && hashmap_get(&b->captured, name->data, strlen(name->data))) {
+        ClaspIRGlobal global = { malloc(strlen(name->data) + 24), t };
+        size_t shadows = 0; // Keep globals of the same name apart
+        for (size_t i = 0; i < cvector_size(b->m->globals); ++i) {
+            const char *other = b->m->globals[i].name;
+            shadows += !strncmp(other, name->data, strlen(name->data)) && (!other[strlen(name->data)] || other[strlen(name->data)] == '.');
+        }
+        if (shadows) sprintf(global.name, "%s.%zu", name->data, shadows);
+        else strcpy(global.name, name->data);
+        cvector_push_back(b->m->globals, global);
+        Name *n = bind(b, name->data, NAME_GLOBAL, cvector_size(b->m->globals) - 1, NULL);
+        ClaspIRInst c = { .op = IR_STORE, .type = IR_VOID, .a = value, .b = CLASP_IR_NONE };
+        c.imm.index = n->index;
+        ir_emit(f->ir, f->cur, c);
+        return;
+    }
+    uint32_t var = new_var(f, t);
+    write_var(f, var, f->cur, value);
+    bind(b, name->data, NAME_LOCAL, var, NULL);
+}
+
+static void lower_loop(Builder *b, ClaspASTNode *cond, ClaspASTNode *body, ClaspASTNode *step) {
+    Func *f = b->fn;
+    uint32_t header = new_block(f);
+    branch(f, header);
+    f->cur = header;
+
+    uint32_t inner = new_block(f), exit = new_block(f);
+    if (cond) cbranch(f, lower_cond(b, cond), inner, exit);
+    else branch(f, inner);
+    seal(f, inner);
+    seal(f, exit);
+
+    f->cur = inner;
+    lower_body(b, body);
+    if (f->cur != CLASP_IR_NONE && step) lower_stmt(b, step);
+    if (f->cur != CLASP_IR_NONE) branch(f, header);
+    seal(f, header);
+    f->cur = cvector_size(f->ir->blocks[exit].preds) ? exit : CLASP_IR_NONE;
+}
+
+static void lower_stmt(Builder *b, ClaspASTNode *node) {
+    Func *f = b->fn;
+    if (!node) return;
+    if (node->type == AST_FN_DECL_STMT) { // Hoisted, so it may be called even if it follows a return
+        Name *n = lookup(b, node->data.fn_decl_stmt.name->data);
+        lower_fn(b, node, node->data.fn_decl_stmt.body, n && n->kind == NAME_FUNC && n->decl == node ? n->index : declare_fn(b, node));
+        return;
+    }
+    if (f->cur == CLASP_IR_NONE) return; // Unreachable
+
+    switch (node->type) {
+        case AST_EXPR_STMT: lower_expr(b, node->data.expr_stmt.expr); break;
+        case AST_RETURN_STMT: {
+            ClaspIRValue v = CLASP_IR_NONE;
+            if (node->data.return_stmt.retval)
+                v = conv(f, lower_expr(b, node->data.return_stmt.retval), ir_type(f->ir->sig->data.function.ret));
+            emit(f, IR_RET, IR_VOID, v, CLASP_IR_NONE);
+            f->cur = CLASP_IR_NONE;
+            break;
+        }
+        case AST_BLOCK_STMT: lower_body(b, node); break;
+        case AST_VAR_DECL_STMT:
+        case AST_LET_DECL_STMT:
+        case AST_CONST_DECL_STMT: lower_decl(b, node); break;
+        case AST_IF_STMT: {
+            uint32_t then = new_block(f), join = new_block(f);
+            cbranch(f, lower_cond(b, node->data.cond_stmt.cond), then, join);
+            seal(f, then);
+            f->cur = then;
+            lower_body(b, node->data.cond_stmt.body);
+            if (f->cur != CLASP_IR_NONE) branch(f, join);
+            seal(f, join);
+            f->cur = join;
+            break;
+        }
+        case AST_WHILE_STMT: lower_loop(b, node->data.cond_stmt.cond, node->data.cond_stmt.body, NULL); break;
+        case AST_FOR_STMT:
+            scope_push(&b->scope); // The init declaration belongs to the loop
+            lower_stmt(b, node->data.for_stmt.init);
+            if (f->cur != CLASP_IR_NONE)
+                lower_loop(b, node->data.for_stmt.cond, node->data.for_stmt.body, node->data.for_stmt.step);
+            scope_pop(&b->scope);
+            break;
+        default: lower_expr(b, node); break;
+    }
+}
+
+static void lower_fn(Builder *b, ClaspASTNode *decl, ClaspASTNode *body, uint32_t index) {
+    Func *outer = b->fn;
+    Func f = { .ir = b->m->fns[index], .init = decl == NULL };
+    for (size_t i = 0; i <= IR_PTR; ++i) f.undef[i] = CLASP_IR_NONE;
+    b->fn = &f;
+    f.cur = new_block(&f);
+    seal(&f, f.cur);
+
+    scope_push(&b->scope);
+    for (size_t i = 0; decl && i < cvector_size(decl->data.fn_decl_stmt.args); ++i) {
+        ClaspIRType t = ir_type(f.ir->sig->data.function.args[i]);
+        ClaspIRInst param = { .op = IR_PARAM, .type = t };
+        param.imm.index = i;
+        uint32_t var = new_var(&f, t);
+        write_var(&f, var, f.cur, ir_emit(f.ir, f.cur, param));
+        bind(b, decl->data.fn_decl_stmt.args[i]->name->data, NAME_LOCAL, var, NULL);
+    }
+    lower_body(b, body);
+    scope_pop(&b->scope);
+
+    if (f.cur != CLASP_IR_NONE) { // Falling off the end
+        ClaspIRType ret = ir_type(f.ir->sig->data.function.ret);
+        emit(&f, IR_RET, IR_VOID, ret == IR_VOID ? CLASP_IR_NONE : undef(&f, ret), CLASP_IR_NONE);
+    }
+    finish(&f);
+    b->fn = outer;
+}
+
+// ---- Module ----
+
+typedef struct Capture {
+    hashmap_t *names;
+    int depth;              // Functions entered
+} Capture;
+
+static void *capture_enter(ClaspASTNode *node, void *args) { ((Capture *) args)->depth++; return NULL; }
+static void *capture_leave(ClaspASTNode *node, void *args) { ((Capture *) args)->depth--; return NULL; }
+
+static void *capture_var_ref(ClaspASTNode *node, void *args) {
+    Capture *c = args;
+    ClaspToken *name = node->data.var_ref.varname;
+    if (c->depth) hashmap_put(c->names, name->data, strlen(name->data), name);
+    return NULL;
+}
+
+ClaspIRModule *ir_build(ClaspASTNode *ast) {
+    Builder b = { .m = calloc(1, sizeof(ClaspIRModule)) };
+    scope_init(&b.scope);
+    hashmap_create(16, &b.captured);
+    hashmap_create(16, &b.externs);
+
+    // Find the names functions use, top level variables among them must outlive CLASP_IR_INIT's frame
+    Capture c = { &b.captured, 0 };
+    ClaspASTVisitor pre = { 0 }, post = { 0 };
+    pre[AST_FN_DECL_STMT] = &capture_enter;
+    pre[AST_EXPR_VAR_REF] = &capture_var_ref;
+    post[AST_FN_DECL_STMT] = &capture_leave;
+    ClaspASTPass capture = { pre, post, &c };
+    ast_walk(ast, &capture, 1);
+
+    ir_function(b.m, CLASP_IR_INIT, type_intern_fn(NULL, type_intern("void")));
+    lower_fn(&b, NULL, ast, 0);
+
+    for (size_t i = 0; i < cvector_size(b.names); ++i) free(b.names[i]);
+    cvector_free(b.names);
+    scope_free(&b.scope);
+    hashmap_destroy(&b.captured);
+    hashmap_destroy(&b.externs);
+    if (b.errors) {
+        ir_free(b.m);
+        return NULL;
+    }
+    return b.m;
+}
@@ -0,0 +1,701 @@
+/**
+ * Clasp bytecode JIT implementation
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/jit.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cvector/cvector.h>
+
+#if CLASP_VM_HAS_JIT
+#include <sys/mman.h>
+
+/**
+ * Each instruction becomes a fixed sequence of x86-64 code. The operand stack stays where the interpreter keeps it,
+ * after the frame's slots, but the verifier already knows its depth at every instruction, so each cell has a fixed
+ * address and there's no stack pointer. The top cell is kept in rax between instructions where possible and written
+ * back before jumps, labels and calls.
+ *  rbx     The frame, `fp`
+ *  r12     The globals
+ *  r13     How many more calls deep the code may go
+ *  rax     The top of the operand stack when `cached`, then results
+ *  rcx     The second operand
+ * Compiled functions return their value in rax and a ClaspJitTrap code in rdx, see ClaspJitResult.
+*/
+
+// ---- x86-64 encoding ----
+
+enum { RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+enum { XMM0, XMM1 };
+enum { CC_AE = 0x3, CC_E = 0x4, CC_NE = 0x5, CC_A = 0x7, CC_P = 0xA, CC_NP = 0xB, CC_L = 0xC, CC_GE = 0xD,
+       CC_LE = 0xE, CC_G = 0xF };
+
+typedef struct Fixup {
+    size_t at;                  // Where the rel32 or imm64 to fill in is
+    uint64_t to;                // The instruction index or trap it refers to
+} Fixup;
+
+typedef struct Emitter {
+    ClaspVM *vm;
+    cvector(uint8_t) code;
+    cvector(uint32_t) group;    // The enters being compiled together
+    cvector(Fixup) jumps;       // To an instruction of the function being emitted
+    cvector(Fixup) traps;       // To a trap stub of the function being emitted, `to` is the rdx it returns
+    cvector(size_t) exits;      // To the function's epilogue
+    cvector(Fixup) calls;       // Callee addresses, filled in once the group has its memory
+    int32_t *label;             // Code offset of each instruction emitted, -1 if none
+    bool *reached;
+    uint32_t size;              // The frame size of the function being emitted, where its operand stack starts
+    bool cached;                // rax holds the top of the operand stack, which isn't in its slot
+} Emitter;
+
+static void byte(Emitter *e, uint8_t b) {
+    cvector_push_back(e->code, b);
+}
+
+static void u32(Emitter *e, uint32_t v) {
+    for (int i = 0; i < 4; ++i) byte(e, v >> (8 * i));
+}
+
+static void u64(Emitter *e, uint64_t v) {
+    for (int i = 0; i < 8; ++i) byte(e, v >> (8 * i));
+}
+
+static void patch32(Emitter *e, size_t at, uint32_t v) {
+    for (int i = 0; i < 4; ++i) e->code[at + i] = v >> (8 * i);
+}
+
+// Legacy prefix (or 0), REX, then the opcode, 0x0Fxx for two bytes.
+static void opcode(Emitter *e, uint8_t prefix, bool w, uint16_t op, int reg, int rm) {
+    if (prefix) byte(e, prefix);
+    uint8_t rex = 0x40 | w << 3 | (reg >> 3) << 2 | rm >> 3;
+    if (rex != 0x40) byte(e, rex);
+    if (op > 0xFF) byte(e, op >> 8);
+    byte(e, op);
+}
+
+// An instruction on two registers, `reg` may also be an opcode extension.
+static void rr(Emitter *e, uint8_t prefix, bool w, uint16_t op, int reg, int rm) {
+    opcode(e, prefix, w, op, reg, rm);
+    byte(e, 0xC0 | (reg & 7) << 3 | (rm & 7));
+}
+
+// An instruction on a register and [base + disp].
+static void rm(Emitter *e, uint8_t prefix, bool w, uint16_t op, int reg, int base, int32_t disp) {
+    opcode(e, prefix, w, op, reg, base);
+    uint8_t mod = disp == 0 && (base & 7) != RBP ? 0 : disp == (int8_t) disp ? 1 : 2;
+    byte(e, mod << 6 | (reg & 7) << 3 | (base & 7));
+    if ((base & 7) == RSP) byte(e, 0x24); // SIB with no index
+    if (mod == 1) byte(e, disp);
+    if (mod == 2) u32(e, disp);
+}
+
+static void load(Emitter *e, int reg, int base, int32_t disp)  { rm(e, 0, true, 0x8B, reg, base, disp); }
+static void store(Emitter *e, int base, int32_t disp, int reg) { rm(e, 0, true, 0x89, reg, base, disp); }
+static void lea(Emitter *e, int reg, int base, int32_t disp)   { rm(e, 0, true, 0x8D, reg, base, disp); }
+static void mov(Emitter *e, int dst, int src)                  { rr(e, 0, true, 0x89, src, dst); }
+
+// mov with a 64 bit immediate, for addresses patched later. Returns where the immediate is.
+static size_t mov64(Emitter *e, int reg, uint64_t v) {
+    opcode(e, 0, true, 0xB8 + (reg & 7), 0, reg);
+    size_t at = cvector_size(e->code);
+    u64(e, v);
+    return at;
+}
+
+static void movi(Emitter *e, int reg, int64_t v) {
+    if (v != (int32_t) v) {
+        mov64(e, reg, v);
+        return;
+    }
+    rr(e, 0, true, 0xC7, 0, reg);
+    u32(e, v);
+}
+
+// A jump whose rel32 is filled in later. Returns where it is.
+static size_t jump(Emitter *e, int cc) {
+    if (cc < 0) byte(e, 0xE9);
+    else {
+        byte(e, 0x0F);
+        byte(e, 0x80 | cc);
+    }
+    size_t at = cvector_size(e->code);
+    u32(e, 0);
+    return at;
+}
+
+// Point a jump made with jump() at the current position.
+static void land(Emitter *e, size_t at) {
+    patch32(e, at, cvector_size(e->code) - (at + 4));
+}
+
+static void trap(Emitter *e, int cc, uint32_t index, ClaspJitTrap why) {
+    Fixup f = { jump(e, cc), (uint64_t) index << 8 | why };
+    cvector_push_back(e->traps, f);
+}
+
+// ---- Templates ----
+
+#define SLOT(k) ((int32_t) (8 * (e->size + (k))))
+
+// Write the cached top of a stack `depth` cells deep back to its slot.
+static void flush(Emitter *e, uint32_t depth) {
+    if (e->cached) store(e, RBX, SLOT(depth - 1), RAX);
+    e->cached = false;
+}
+
+// Get the top of a stack `depth` cells deep into rax.
+static void top(Emitter *e, uint32_t depth) {
+    if (!e->cached) load(e, RAX, RBX, SLOT(depth - 1));
+}
+
+// The two operands of math at `depth`: the first in rax and the second, the top, in rcx.
+static void operands(Emitter *e, uint32_t depth) {
+    top(e, depth);
+    mov(e, RCX, RAX);
+    load(e, RAX, RBX, SLOT(depth - 2));
+}
+
+// Truncate rax to an integer class and sign extend it back, like narrow().
+static void narrow(Emitter *e, uint8_t cls) {
+    switch (cls) {
+        case CLB_B: rr(e, 0, true, 0x0FBE, RAX, RAX); break;
+        case CLB_W: rr(e, 0, true, 0x0FBF, RAX, RAX); break;
+        case CLB_D: rr(e, 0, true, 0x63, RAX, RAX); break;
+        default: break;
+    }
+}
+
+// rax = rax `op` rcx, truncated to `cls`, like int_math(). `index` is the instruction, for division by zero.
+static void int_math(Emitter *e, uint8_t op, uint8_t cls, uint32_t index) {
+    switch (op) {
+        case CLB_ADD: rr(e, 0, true, 0x01, RCX, RAX); break;
+        case CLB_SUB: rr(e, 0, true, 0x29, RCX, RAX); break;
+        case CLB_MUL: rr(e, 0, true, 0x0FAF, RAX, RCX); break;
+        case CLB_SHL: rr(e, 0, true, 0xD3, 4, RAX); break;
+        case CLB_XOR: rr(e, 0, true, 0x31, RCX, RAX); break;
+        default: { // div and rem, where -1 is done apart because idiv faults on INT64_MIN / -1
+            rr(e, 0, true, 0x85, RCX, RCX);
+            trap(e, CC_E, index, CLASP_JIT_DIVISION);
+            rr(e, 0, true, 0x83, 7, RCX);
+            byte(e, 0xFF);
+            size_t not_minus_one = jump(e, CC_NE);
+            if (op == CLB_DIV) rr(e, 0, true, 0xF7, 3, RAX);    // neg rax
+            else rr(e, 0, false, 0x31, RAX, RAX);               // xor eax, eax
+            size_t done = jump(e, -1);
+            land(e, not_minus_one);
+            byte(e, 0x48);
+            byte(e, 0x99);                                      // cqo
+            rr(e, 0, true, 0xF7, 7, RCX);                       // idiv rcx
+            if (op == CLB_REM) mov(e, RAX, RDX);
+            land(e, done);
+            break;
+        }
+    }
+    narrow(e, cls);
+}
+
+// xmm0 = xmm0 `op` xmm1, like float_math().
+static void float_math(Emitter *e, uint8_t op) {
+    static const uint8_t SSE[] = { [CLB_ADD] = 0x58, [CLB_SUB] = 0x5C, [CLB_MUL] = 0x59, [CLB_DIV] = 0x5E };
+    if (op == CLB_REM) {
+        double (*fn)(double, double) = &fmod;
+        mov64(e, RAX, (uint64_t) (uintptr_t) fn);
+        rr(e, 0, false, 0xFF, 2, RAX);                          // call rax
+        return;
+    }
+    rr(e, 0xF2, false, 0x0F00 | SSE[op], XMM0, XMM1);
+}
+
+// Condition codes of the integer comparisons, CLB_EQ onwards
+static const uint8_t INT_CC[] = { CC_E, CC_NE, CC_L, CC_LE, CC_G, CC_GE };
+
+// Set rax to 0 or 1 from the flags.
+static void set(Emitter *e, int cc) {
+    rr(e, 0, false, 0x0F90 | cc, 0, RAX);
+    rr(e, 0, false, 0x0FB6, RAX, RAX);                          // movzx eax, al
+}
+
+// rax = xmm0 `op` xmm1 as 0 or 1, false when either is NaN except for ne, like COMPARE().
+static void float_compare(Emitter *e, uint8_t op) {
+    bool swap = op == CLB_LT || op == CLB_LE;                   // a < b is b > a, which is false when unordered
+    rr(e, 0x66, false, 0x0F2E, swap ? XMM1 : XMM0, swap ? XMM0 : XMM1);
+    switch (op) {
+        case CLB_EQ:
+        case CLB_NE:
+            rr(e, 0, false, 0x0F90 | (op == CLB_EQ ? CC_E : CC_NE), 0, RAX);
+            rr(e, 0, false, 0x0F90 | (op == CLB_EQ ? CC_NP : CC_P), 0, RCX);
+            rr(e, 0, false, op == CLB_EQ ? 0x20 : 0x08, RCX, RAX);  // and/or al, cl
+            rr(e, 0, false, 0x0FB6, RAX, RAX);
+            break;
+        case CLB_LT:
+        case CLB_GT: set(e, CC_A); break;
+        default:     set(e, CC_AE); break;
+    }
+}
+
+// A cell of class `cls`, f4 or f8, from a register into an xmm register as a double. f4 cells hold the float's bits
+// in their low half, see vm_cell_f4().
+static void double_from(Emitter *e, int xmm, int reg, uint8_t cls) {
+    rr(e, 0x66, cls == CLB_F8, 0x0F6E, xmm, reg);
+    if (cls == CLB_F4) rr(e, 0xF3, false, 0x0F5A, xmm, xmm);    // cvtss2sd
+}
+
+// xmm0 as a cell of class `cls` into rax, f4 rounded like vm_f4_cell() and the upper half cleared.
+static void double_to(Emitter *e, uint8_t cls) {
+    if (cls == CLB_F4) rr(e, 0xF2, false, 0x0F5A, XMM0, XMM0);  // cvtsd2ss
+    rr(e, 0x66, cls == CLB_F8, 0x0F7E, XMM0, RAX);
+}
+
+// The two operands of f4 or f8 math at `depth` as doubles in xmm0 and xmm1, which is how the interpreter does f4 too.
+static void float_operands(Emitter *e, uint32_t depth, uint8_t cls) {
+    top(e, depth);
+    double_from(e, XMM1, RAX, cls);
+    load(e, RCX, RBX, SLOT(depth - 2));
+    double_from(e, XMM0, RCX, cls);
+}
+
+static void jump_to(Emitter *e, int cc, const ClaspVMInst *target) {
+    Fixup f = { jump(e, cc), target - e->vm->code };
+    cvector_push_back(e->jumps, f);
+}
+
+static void leave(Emitter *e) {
+    rr(e, 0, false, 0x31, RDX, RDX);                            // xor edx, edx
+    cvector_push_back(e->exits, jump(e, -1));
+}
+
+// ---- Functions ----
+
+static const uint8_t op_length[CLASP_VM_NUM_OPS] = {
+#define CLASP_OP_LENGTH(op, name, operands, pops, pushes) [op] = 1,
+#define CLASP_SUPER_LENGTH(op, name, length) [op] = length,
+    CLASP_OPCODES(CLASP_OP_LENGTH)
+    CLASP_VM_SUPERINSTRUCTIONS(CLASP_SUPER_LENGTH)
+#undef CLASP_OP_LENGTH
+#undef CLASP_SUPER_LENGTH
+};
+
+// Whether there's a template for an instruction.
+static bool supported(const ClaspVMInst *in) {
+    switch (in->op) {
+        case OP_CALLI:
+        case OP_ENTER:  return false; // Enters are only compiled as the start of their function
+        default:        return true;
+    }
+}
+
+// Where an instruction may jump, NULL if it doesn't.
+static const ClaspVMInst *target_of(const ClaspVMInst *in) {
+    switch (in->op) {
+        case OP_JMP:
+        case OP_JZ:
+        case OP_JNZ:     return in->arg.target;
+        case OP_CMPJZ:
+        case OP_CMPJNZ:  return in[1].arg.target;
+        case OP_CMPKJZ:
+        case OP_CMPKJNZ: return in[2].arg.target;
+        default:         return NULL;
+    }
+}
+
+// Queue a callee that isn't compiled yet for this group.
+static void want(Emitter *e, uint32_t enter) {
+    if (e->vm->jit->fns[enter].code) return;
+    for (size_t i = 0; i < cvector_size(e->group); ++i)
+        if (e->group[i] == enter) return;
+    cvector_push_back(e->group, enter);
+}
+
+/**
+ * Mark what a function reaches from its enter and check every instruction has a template, then emit it.
+ * Verified code never lets a function's instructions be reached from another, so each is emitted once.
+*/
+static bool function(Emitter *e, uint32_t start) {
+    ClaspVMInst *code = e->vm->code;
+    const ClaspVMInst *enter = &code[start];
+    uint32_t end = start + 1;                                   // Past the last instruction it reaches
+    cvector(uint32_t) work = NULL;
+    cvector_push_back(work, start + 1);
+    e->reached[start] = true;
+    bool ok = true;
+    while (ok && !cvector_empty(work)) {
+        uint32_t n = work[cvector_size(work) - 1];
+        cvector_pop_back(work);
+        if (e->reached[n]) continue;
+        const ClaspVMInst *in = &code[n];
+        e->reached[n] = true;
+        if (n + op_length[in->op] > end) end = n + op_length[in->op];
+        const ClaspVMInst *target = target_of(in);
+        ok = n > start && supported(in) && in->depth < UINT8_MAX && target != enter;
+        if (target) cvector_push_back(work, target - code);
+        if (in->op != OP_JMP && in->op != OP_RET && in->op != OP_RETV) cvector_push_back(work, n + op_length[in->op]);
+    }
+    cvector_free(work);
+    if (!ok) return false;
+
+    e->size = enter->arg.frame.size;
+    e->cached = false;
+    e->label[start] = cvector_size(e->code);
+    cvector_clear(e->jumps);
+    cvector_clear(e->traps);
+    cvector_clear(e->exits);
+
+    // enter: save what the code keeps in registers, check the frame fits and clear the slots past the arguments
+    byte(e, 0x53);                                              // push rbx
+    byte(e, 0x41);
+    byte(e, 0x54);                                              // push r12
+    byte(e, 0x41);
+    byte(e, 0x55);                                              // push r13
+    mov(e, RBX, RDI);
+    mov(e, R13, RDX);
+    mov64(e, R12, (uint64_t) (uintptr_t) e->vm->globals);
+    lea(e, RAX, RBX, 8 * enter->arg.frame.room);
+    mov64(e, RCX, (uint64_t) (uintptr_t) (e->vm->stack + CLASP_VM_STACK_CELLS));
+    rr(e, 0, true, 0x39, RCX, RAX);
+    trap(e, CC_A, start, CLASP_JIT_STACK);
+    lea(e, RCX, RBX, SLOT(0));
+    size_t loop = cvector_size(e->code);
+    rr(e, 0, true, 0x39, RCX, RSI);
+    size_t cleared = jump(e, CC_AE);
+    rm(e, 0, true, 0xC7, 0, RSI, 0);                            // mov qword [rsi], 0
+    u32(e, 0);
+    rr(e, 0, true, 0x83, 0, RSI);                               // add rsi, 8
+    byte(e, 8);
+    size_t back = jump(e, -1);
+    patch32(e, back, loop - (back + 4));
+    land(e, cleared);
+
+    bool *target = calloc(end, sizeof(bool));
+    for (uint32_t n = start + 1; n < end; ++n)
+        if (e->reached[n] && target_of(&code[n])) target[target_of(&code[n]) - code] = true;
+
+    for (uint32_t n = start + 1; n < end; ++n) {
+        if (!e->reached[n]) continue;
+        const ClaspVMInst *in = &code[n];
+        uint32_t d = in->depth;
+        if (target[n]) flush(e, d);
+        e->label[n] = cvector_size(e->code);
+        switch (in->op) {
+            case OP_MATHBB: case OP_MATHBW: case OP_MATHBD: case OP_MATHBQ:
+            case OP_MATHWB: case OP_MATHWW: case OP_MATHWD: case OP_MATHWQ:
+            case OP_MATHDB: case OP_MATHDW: case OP_MATHDD: case OP_MATHDQ:
+            case OP_MATHQB: case OP_MATHQW: case OP_MATHQD: case OP_MATHQQ: {
+                uint8_t a = (in->op - OP_MATHBB) / 4, b = (in->op - OP_MATHBB) % 4;
+                operands(e, d);
+                int_math(e, in->a, a > b ? a : b, n);
+                e->cached = true;
+                break;
+            }
+            case OP_MATHK:
+                top(e, d);
+                movi(e, RCX, in->arg.i);
+                int_math(e, in->a, in->b, n);
+                e->cached = true;
+                break;
+            case OP_LOADLMATHK:
+                flush(e, d);
+                load(e, RAX, RBX, 8 * in->arg.u);
+                movi(e, RCX, in[1].arg.i);
+                int_math(e, in->a, in->b, n);
+                e->cached = true;
+                break;
+            case OP_MATHF4:
+            case OP_MATHF8: {
+                uint8_t cls = in->op == OP_MATHF4 ? CLB_F4 : CLB_F8;
+                float_operands(e, d, cls);
+                float_math(e, in->a);
+                double_to(e, cls);
+                e->cached = true;
+                break;
+            }
+            case OP_MATHF8K:
+                top(e, d);
+                double_from(e, XMM0, RAX, CLB_F8);
+                movi(e, RCX, in->arg.i);
+                double_from(e, XMM1, RCX, CLB_F8);
+                float_math(e, in->a);
+                double_to(e, CLB_F8);
+                e->cached = true;
+                break;
+            case OP_CMPI:
+                operands(e, d);
+                rr(e, 0, true, 0x39, RCX, RAX);
+                set(e, INT_CC[in->a - CLB_EQ]);
+                e->cached = true;
+                break;
+            case OP_CMPF4:
+            case OP_CMPF8:
+                float_operands(e, d, in->op == OP_CMPF4 ? CLB_F4 : CLB_F8);
+                float_compare(e, in->a);
+                e->cached = true;
+                break;
+            case OP_NEG:
+                top(e, d);
+                if (in->a == CLB_F4) {
+                    rr(e, 0, false, 0x81, 6, RAX);              // xor eax, sign bit
+                    u32(e, 0x80000000);
+                } else if (in->a == CLB_F8) {
+                    movi(e, RCX, INT64_MIN);
+                    rr(e, 0, true, 0x31, RCX, RAX);
+                } else {
+                    rr(e, 0, true, 0xF7, 3, RAX);
+                    narrow(e, in->a);
+                }
+                e->cached = true;
+                break;
+            case OP_NOT:
+                top(e, d);
+                rr(e, 0, true, 0xF7, 2, RAX);
+                narrow(e, in->a);
+                e->cached = true;
+                break;
+            case OP_CONV:
+                top(e, d); // Like convert(): integers go straight to the float class, floats through double
+                if (in->a <= CLB_Q && in->b <= CLB_Q) {
+                    narrow(e, in->b);
+                } else if (in->a <= CLB_Q) {
+                    rr(e, in->b == CLB_F4 ? 0xF3 : 0xF2, true, 0x0F2A, XMM0, RAX); // cvtsi2ss/sd xmm0, rax
+                    rr(e, 0x66, in->b == CLB_F8, 0x0F7E, XMM0, RAX);
+                } else if (in->b <= CLB_Q) {
+                    double_from(e, XMM0, RAX, in->a);
+                    rr(e, 0xF2, true, 0x0F2C, RAX, XMM0);       // cvttsd2si rax, xmm0
+                    narrow(e, in->b);
+                } else if (in->a != in->b) {
+                    double_from(e, XMM0, RAX, in->a);
+                    double_to(e, in->b);
+                }
+                e->cached = true;
+                break;
+            case OP_CONSTB:
+            case OP_CONSTW:
+            case OP_CONSTD:
+            case OP_CONSTQ:
+            case OP_CONSTK:
+                flush(e, d);
+                movi(e, RAX, in->arg.i);
+                e->cached = true;
+                break;
+            case OP_POP:
+                e->cached = false;
+                break;
+            case OP_DUP:
+                if (e->cached) store(e, RBX, SLOT(d - 1), RAX);
+                else load(e, RAX, RBX, SLOT(d - 1));
+                e->cached = true;
+                break;
+            case OP_LOADL:
+                flush(e, d);
+                load(e, RAX, RBX, 8 * in->arg.u);
+                e->cached = true;
+                break;
+            case OP_STOREL:
+                top(e, d);
+                store(e, RBX, 8 * in->arg.u, RAX);
+                e->cached = false;
+                break;
+            case OP_LOADG:
+                flush(e, d);
+                load(e, RAX, R12, 8 * in->arg.u);
+                e->cached = true;
+                break;
+            case OP_STOREG:
+                top(e, d);
+                store(e, R12, 8 * in->arg.u, RAX);
+                e->cached = false;
+                break;
+            case OP_JMP:
+                flush(e, d);
+                jump_to(e, -1, in->arg.target);
+                break;
+            case OP_JZ:
+            case OP_JNZ:
+                top(e, d);
+                e->cached = false;
+                rr(e, 0, true, 0x85, RAX, RAX);
+                jump_to(e, in->op == OP_JZ ? CC_E : CC_NE, in->arg.target);
+                break;
+            case OP_CMPJZ:
+            case OP_CMPJNZ:
+                operands(e, d);
+                e->cached = false;
+                rr(e, 0, true, 0x39, RCX, RAX);
+                jump_to(e, INT_CC[in->a - CLB_EQ] ^ (in->op == OP_CMPJZ), in[1].arg.target); // ^ 1 inverts
+                break;
+            case OP_CMPKJZ:
+            case OP_CMPKJNZ:
+                top(e, d);
+                e->cached = false;
+                movi(e, RCX, in->arg.i);
+                rr(e, 0, true, 0x39, RCX, RAX);
+                jump_to(e, INT_CC[in->a - CLB_EQ] ^ (in->op == OP_CMPKJZ), in[2].arg.target);
+                break;
+            case OP_CALL: {
+                uint32_t callee = in->arg.target - code;
+                flush(e, d);
+                rr(e, 0, true, 0x85, R13, R13);
+                trap(e, CC_E, n, CLASP_JIT_FRAMES);
+                lea(e, RDI, RBX, SLOT(d - in->a));
+                lea(e, RSI, RBX, SLOT(d));
+                lea(e, RDX, R13, -1);
+                Fixup f = { mov64(e, RAX, 0), callee };
+                cvector_push_back(e->calls, f);
+                want(e, callee);
+                rr(e, 0, false, 0xFF, 2, RAX);                  // call rax
+                rr(e, 0, true, 0x85, RDX, RDX);                 // a trap below returns as it is
+                cvector_push_back(e->exits, jump(e, CC_NE));
+                e->cached = in->b;
+                break;
+            }
+            case OP_JSYM: // Checked when it runs, like the interpreter does, as vm_define() may still change it
+                flush(e, d);
+                mov64(e, RAX, (uint64_t) (uintptr_t) in->arg.sym);
+                load(e, RCX, RAX, offsetof(ClaspVMSymbol, native));
+                rr(e, 0, true, 0x85, RCX, RCX);
+                trap(e, CC_E, n, CLASP_JIT_SYMBOL);
+                rm(e, 0, false, 0x80, 7, RAX, offsetof(ClaspVMSymbol, argc));
+                byte(e, in->a);
+                trap(e, CC_NE, n, CLASP_JIT_SYMBOL);
+                rm(e, 0, false, 0x80, 7, RAX, offsetof(ClaspVMSymbol, results));
+                byte(e, in->b);
+                trap(e, CC_NE, n, CLASP_JIT_SYMBOL);
+                lea(e, RDI, RBX, SLOT(d - in->a));
+                rr(e, 0, false, 0xFF, 2, RCX);                  // call rcx
+                e->cached = in->b;
+                break;
+            case OP_ASM: // A direct call to the loaded blob
+                flush(e, d);
+                lea(e, RDI, RBX, SLOT(d - in->a));
+                mov64(e, RCX, (uint64_t) (uintptr_t) in->arg.native);
+                rr(e, 0, false, 0xFF, 2, RCX);                  // call rcx
+                e->cached = in->b;
+                break;
+            case OP_RET:
+                leave(e);
+                e->cached = false;
+                break;
+            case OP_RETV:
+                top(e, d);
+                leave(e);
+                e->cached = false;
+                break;
+            default: break;
+        }
+    }
+    free(target);
+
+    for (size_t i = 0; i < cvector_size(e->jumps); ++i)
+        patch32(e, e->jumps[i].at, e->label[e->jumps[i].to] - (int64_t) (e->jumps[i].at + 4));
+    size_t exit = cvector_size(e->code);
+    for (size_t i = 0; i < cvector_size(e->exits); ++i) patch32(e, e->exits[i], exit - (e->exits[i] + 4));
+    byte(e, 0x41);
+    byte(e, 0x5D);                                              // pop r13
+    byte(e, 0x41);
+    byte(e, 0x5C);                                              // pop r12
+    byte(e, 0x5B);                                              // pop rbx
+    byte(e, 0xC3);                                              // ret
+    for (size_t i = 0; i < cvector_size(e->traps); ++i) {
+        land(e, e->traps[i].at);
+        mov64(e, RDX, e->traps[i].to);
+        size_t at = jump(e, -1);
+        patch32(e, at, exit - (at + 4));
+    }
+    return true;
+}
+
+// ---- Compiling ----
+
+bool jit_compile(ClaspVM *vm, const ClaspVMInst *enter) {
+    ClaspJit *jit = vm->jit;
+    Emitter e = { .vm = vm };
+    e.label = malloc(jit->_count * sizeof(int32_t));
+    for (size_t n = 0; n < jit->_count; ++n) e.label[n] = -1;
+    e.reached = calloc(jit->_count + 1, sizeof(bool));
+    cvector_push_back(e.group, enter - vm->code);
+
+    bool ok = true;
+    for (size_t g = 0; ok && g < cvector_size(e.group); ++g) ok = function(&e, e.group[g]);
+
+    size_t size = cvector_size(e.code);
+    uint8_t *map = ok ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) : MAP_FAILED;
+    if (map != MAP_FAILED) {
+        memcpy(map, e.code, size);
+        for (size_t i = 0; i < cvector_size(e.calls); ++i) {
+            uint32_t callee = e.calls[i].to;
+            uint64_t addr = e.label[callee] >= 0 ? (uint64_t) (uintptr_t) (map + e.label[callee])
+                                                 : (uint64_t) (uintptr_t) jit->fns[callee].code;
+            memcpy(map + e.calls[i].at, &addr, sizeof(addr));
+        }
+        ok = !mprotect(map, size, PROT_READ | PROT_EXEC);
+        cvector_push_back(jit->_maps, map);
+        cvector_push_back(jit->_sizes, size);
+        for (size_t g = 0; ok && g < cvector_size(e.group); ++g)
+            jit->fns[e.group[g]].code = (ClaspJitCode) (uintptr_t) (map + e.label[e.group[g]]);
+    } else {
+        ok = false;
+    }
+
+    cvector_free(e.code);
+    cvector_free(e.group);
+    cvector_free(e.jumps);
+    cvector_free(e.traps);
+    cvector_free(e.exits);
+    cvector_free(e.calls);
+    free(e.label);
+    free(e.reached);
+    return ok;
+}
+
+#else
+
+bool jit_compile(ClaspVM *vm, const ClaspVMInst *enter) {
+    (void) vm;
+    (void) enter;
+    return false;
+}
+
+#endif
+
+// ---- JIT ----
+
+ClaspJit *jit_new(ClaspVM *vm) {
+    size_t count = 0;
+    while (vm->code[count].op != CLASP_VM_END) count++;
+    ClaspJit *jit = calloc(1, sizeof(ClaspJit));
+    jit->fns = calloc(count + 1, sizeof(ClaspJitFunction));
+    jit->_count = count;
+    return jit;
+}
+
+void jit_free(ClaspJit *jit) {
+    if (!jit) return;
+#if CLASP_VM_HAS_JIT
+    for (size_t i = 0; i < cvector_size(jit->_maps); ++i) munmap(jit->_maps[i], jit->_sizes[i]);
+#endif
+    cvector_free(jit->_maps);
+    cvector_free(jit->_sizes);
+    free(jit->fns);
+    free(jit);
+}
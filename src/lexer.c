@@ -40,7 +40,6 @@ void new_lexer(ClaspLexer *lexer, StreamReadFn fn, void *args) {
     lexer->next     = NULL;
     lexer->previous = NULL;
     lexer->_stream_args = args;
-    (void) lexer_read(lexer);
 
     lexer->lineno = 0;
     lexer->col_idx = 0;
@@ -48,6 +47,7 @@ void new_lexer(ClaspLexer *lexer, StreamReadFn fn, void *args) {
     lexer->lines = NULL;
     lexer->current_line = NULL;
 
+    (void) lexer_read(lexer);
     (void) lexer_next(lexer);
 
     return;
@@ -92,10 +92,22 @@ static ClaspToken *new_token_const(ClaspLexer *l, const char *const data, ClaspT
     return new_token(l, buf, type);
 }
 
+ClaspToken *token_synth(ClaspTokenType type, const char *data, ClaspToken *at) {
+    ClaspToken *out = malloc(sizeof(ClaspToken));
+    out->data = malloc(strlen(data) + 1);
+    strcpy(out->data, data);
+    out->type = type;
+    out->line   = at ? at->line   : "";
+    out->lineno = at ? at->lineno : 0;
+    out->where  = at ? at->where  : 0;
+    return out;
+}
+
 static char lexer_read(ClaspLexer *l) {
     cvector_push_back(l->current_line, l->cCurrent);
     l->col_idx++;
     l->cCurrent = l->stream(l->_stream_args);
+    return l->cCurrent;
 }
 
 ClaspToken *lexer_scan(ClaspLexer *lexer) {
@@ -367,11 +379,25 @@ const char *tktyp_str(ClaspTokenType typ) {
         CASE(TOKEN_SEMICOLON)
         CASE(TOKEN_EOF)
         CASE(TOKEN_UNKNOWN)
+        CASE(TOKEN_LESS_LESS)
         default: return "unknown";
     }
 }
 #undef CASE
 
+bool tktyp_is_assignment(ClaspTokenType type) {
+    switch (type) {
+        case TOKEN_EQ:
+        case TOKEN_PLUS_EQ:    case TOKEN_MINUS_EQ:
+        case TOKEN_ASTERIX_EQ: case TOKEN_SLASH_EQ:
+        case TOKEN_PERC_EQ:    case TOKEN_CARAT_EQ:
+        case TOKEN_TILDE_EQ:
+            return true;
+        default:
+            return false;
+    }
+}
+
 void token_print(ClaspToken *token) {
     printf("Token(%s) { %s }\n", tktyp_str(token->type), token->data);
 }
\ No newline at end of file
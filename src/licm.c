@@ -0,0 +1,213 @@
+/**
+ * Clasp loop-invariant code motion implementation
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/licm.h>
+#include <clasp/types.h>
+#include <clasp/walk.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cvector/cvector.h>
+
+/**
+ * The loop being optimized.
+*/
+typedef struct Loop {
+    hashmap_t variant;                 // Names assigned or declared anywhere in the loop
+    bool calls;                        // Whether the loop calls a function
+    cvector(ClaspASTNode *) hoisted;   // Temporaries to declare before the loop
+    unsigned *next;                    // Temporary counter, shared by the whole tree
+} Loop;
+
+static bool is_loop(ClaspASTNode *node) {
+    return node && (node->type == AST_WHILE_STMT || node->type == AST_FOR_STMT);
+}
+
+static bool is_expr(ClaspASTNode *node) {
+    return node->type <= AST_EXPR_FN_CALL;
+}
+
+static bool is_temp(ClaspASTNode *stmt) {
+    return stmt && stmt->type == AST_LET_DECL_STMT &&
+        !strncmp(stmt->data.var_decl_stmt.name->data, CLASP_LICM_PREFIX, strlen(CLASP_LICM_PREFIX));
+}
+
+static void mark(Loop *l, ClaspToken *name) {
+    hashmap_put(&l->variant, name->data, strlen(name->data), name);
+}
+
+static bool variant(Loop *l, ClaspToken *name) {
+    return hashmap_get(&l->variant, name->data, strlen(name->data)) != NULL;
+}
+
+// Find every name the loop may change.
+static void *collect(ClaspASTNode *node, void *args) {
+    Loop *l = args;
+    switch (node->type) {
+        case AST_EXPR_BINOP:
+            if (tktyp_is_assignment(node->data.binop.op->type) && node->data.binop.left->type == AST_EXPR_VAR_REF)
+                mark(l, node->data.binop.left->data.var_ref.varname);
+            break;
+        case AST_EXPR_POSTFIX:
+            if (node->data.postfix.left->type == AST_EXPR_VAR_REF) mark(l, node->data.postfix.left->data.var_ref.varname);
+            break;
+        case AST_EXPR_FN_CALL: l->calls = true; break;
+        case AST_VAR_DECL_STMT:
+        case AST_LET_DECL_STMT:
+        case AST_CONST_DECL_STMT: mark(l, node->data.var_decl_stmt.name); break;
+        case AST_FN_DECL_STMT: mark(l, node->data.fn_decl_stmt.name); return node; // Its body runs somewhere else
+        default: break;
+    }
+    ast_map_children(node, &collect, args);
+    return node;
+}
+
+// Whether evaluating an expression before the loop, possibly when the loop would never have run it, is safe.
+static bool invariant(ClaspASTNode *node, Loop *l) {
+    if (!node->exprType || !node->exprType->type) return false; // Not type checked
+    switch (node->type) {
+        case AST_EXPR_LIT_NUMBER: return true;
+        case AST_EXPR_VAR_REF:
+            if (variant(l, node->data.var_ref.varname)) return false;
+            return !l->calls || !(node->exprType->flag & TYPE_MUTABLE);
+        case AST_EXPR_UNOP: return invariant(node->data.unop.right, l);
+        case AST_EXPR_BINOP: {
+            ClaspTokenType op = node->data.binop.op->type;
+            ClaspASTNode *right = node->data.binop.right;
+            if (tktyp_is_assignment(op)) return false;
+            if ((op == TOKEN_SLASH || op == TOKEN_PERC) && !type_is_float(node->exprType->type) &&
+                (right->type != AST_EXPR_LIT_NUMBER || strtod(right->data.lit_num.value->data, NULL) == 0))
+                return false; // May divide by zero
+            return invariant(node->data.binop.left, l) && invariant(right, l);
+        }
+        default: return false;
+    }
+}
+
+// Whether an invariant expression does enough work to be worth a temporary. Constants are left to ast_fold().
+static bool worth_hoisting(ClaspASTNode *node) {
+    switch (node->type) {
+        case AST_EXPR_VAR_REF:     return true;
+        case AST_EXPR_LIT_NUMBER:  return false;
+        case AST_EXPR_UNOP:        return worth_hoisting(node->data.unop.right);
+        case AST_EXPR_BINOP:       return worth_hoisting(node->data.binop.left) || worth_hoisting(node->data.binop.right);
+        default:                   return false;
+    }
+}
+
+static ClaspASTNode *hoist(ClaspASTNode *expr, Loop *l) {
+    char name[32];
+    snprintf(name, sizeof(name), CLASP_LICM_PREFIX "%u", (*l->next)++);
+    ClaspToken *at = expr->type == AST_EXPR_BINOP ? expr->data.binop.op : expr->type == AST_EXPR_UNOP ? expr->data.unop.op : NULL;
+    ClaspToken *tok = token_synth(TOKEN_ID, name, at);
+    ClaspASTNode *type = expr->exprType->type;
+    cvector_push_back(l->hoisted, let_decl(tok, type, expr));
+    return typed_var_ref(tok, type, TYPE_IMMUTABLE);
+}
+
+// Rewrite the inside of a loop, replacing maximal invariant expressions with temporaries.
+static void *in_loop(ClaspASTNode *node, void *args) {
+    Loop *l = args;
+    if (is_expr(node)) {
+        if (node->type != AST_EXPR_VAR_REF && node->type != AST_EXPR_LIT_NUMBER && invariant(node, l))
+            return worth_hoisting(node) ? hoist(node, l) : node;
+        ast_map_children(node, &in_loop, args);
+        return node;
+    }
+    if (node->type == AST_FN_DECL_STMT) return node;
+    if (node->type == AST_BLOCK_STMT) {
+        // Temporaries left here by an inner loop move out whole, and stop being variant for the code after them.
+        cvector(ClaspASTNode *) out = NULL;
+        for (size_t i = 0; i < cvector_size(node->data.block_stmt.body); ++i) {
+            ClaspASTNode *stmt = node->data.block_stmt.body[i];
+            if (is_temp(stmt) && invariant(stmt->data.var_decl_stmt.initializer, l)) {
+                ClaspToken *name = stmt->data.var_decl_stmt.name;
+                hashmap_remove(&l->variant, name->data, strlen(name->data));
+                cvector_push_back(l->hoisted, stmt);
+                continue;
+            }
+            cvector_push_back(out, stmt ? in_loop(stmt, l) : NULL);
+        }
+        cvector_free(node->data.block_stmt.body);
+        node->data.block_stmt.body = out;
+        return node;
+    }
+    ast_map_children(node, &in_loop, args);
+    return node;
+}
+
+// Optimize one loop, whose inner loops are already done. Returns the declarations to put before it.
+static cvector(ClaspASTNode *) hoist_loop(ClaspASTNode *loop, unsigned *next) {
+    Loop l = { .calls = false, .hoisted = NULL, .next = next };
+    hashmap_create(16, &l.variant);
+    collect(loop, &l);
+
+    if (loop->type == AST_WHILE_STMT) {
+        loop->data.cond_stmt.cond = in_loop(loop->data.cond_stmt.cond, &l);
+        loop->data.cond_stmt.body = in_loop(loop->data.cond_stmt.body, &l);
+    } else { // The init runs once anyway
+        if (loop->data.for_stmt.cond) loop->data.for_stmt.cond = in_loop(loop->data.for_stmt.cond, &l);
+        if (loop->data.for_stmt.step) loop->data.for_stmt.step = in_loop(loop->data.for_stmt.step, &l);
+        if (loop->data.for_stmt.body) loop->data.for_stmt.body = in_loop(loop->data.for_stmt.body, &l);
+    }
+
+    hashmap_destroy(&l.variant);
+    return l.hoisted;
+}
+
+static void *licm_node(ClaspASTNode *node, void *args) {
+    if (node->type == AST_BLOCK_STMT) { // Splice temporaries in before the loops that need them
+        cvector(ClaspASTNode *) out = NULL;
+        for (size_t i = 0; i < cvector_size(node->data.block_stmt.body); ++i) {
+            ClaspASTNode *stmt = node->data.block_stmt.body[i];
+            if (!stmt || !is_loop(stmt)) {
+                cvector_push_back(out, stmt ? licm_node(stmt, args) : NULL);
+                continue;
+            }
+            ast_map_children(stmt, &licm_node, args);
+            cvector(ClaspASTNode *) hoisted = hoist_loop(stmt, args);
+            for (size_t j = 0; j < cvector_size(hoisted); ++j) cvector_push_back(out, hoisted[j]);
+            cvector_free(hoisted);
+            cvector_push_back(out, stmt);
+        }
+        cvector_free(node->data.block_stmt.body);
+        node->data.block_stmt.body = out;
+        return node;
+    }
+
+    ast_map_children(node, &licm_node, args);
+    if (!is_loop(node)) return node;
+    cvector(ClaspASTNode *) hoisted = hoist_loop(node, args);
+    if (!hoisted) return node;
+    cvector_push_back(hoisted, node);
+    return block_stmt(hoisted);
+}
+
+ClaspASTNode *ast_licm(ClaspASTNode *ast) {
+    if (!ast) return NULL;
+    unsigned next = 0;
+    return licm_node(ast, &next);
+}
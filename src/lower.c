@@ -0,0 +1,157 @@
+/**
+ * Clasp lowering pass implementation
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/lower.h>
+#include <clasp/types.h>
+#include <clasp/walk.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cvector/cvector.h>
+
+static ClaspASTNode *type_of(ClaspASTNode *node) {
+    return node && node->exprType ? node->exprType->type : NULL;
+}
+
+static bool pure(ClaspASTNode *node) {
+    switch (node->type) {
+        case AST_EXPR_LIT_NUMBER:
+        case AST_EXPR_VAR_REF: return true;
+        case AST_EXPR_UNOP:    return pure(node->data.unop.right);
+        case AST_EXPR_BINOP:
+            return !tktyp_is_assignment(node->data.binop.op->type) && pure(node->data.binop.left) && pure(node->data.binop.right);
+        default: return false;
+    }
+}
+
+static ClaspASTNode *typed_binop(ClaspASTNode *left, ClaspASTNode *right, ClaspTokenType op, const char *spelling, ClaspASTNode *type, ClaspToken *at) {
+    ClaspASTNode *out = binop(left, right, token_synth(op, spelling, at));
+    out->exprType->type = type;
+    return out;
+}
+
+// base^n for n >= 1 by repeated squaring. Every use after the first is a copy of base.
+static ClaspASTNode *pow_chain(ClaspASTNode *base, long n, ClaspASTNode *type, ClaspToken *at) {
+    if (n == 1) return base;
+    ClaspASTNode *half = pow_chain(base, n / 2, type, at);
+    ClaspASTNode *square = typed_binop(half, ast_clone(half), TOKEN_ASTERIX, "*", type, at);
+    if (n & 1) return typed_binop(square, ast_clone(base), TOKEN_ASTERIX, "*", type, at);
+    return square;
+}
+
+/**
+ * Call an (argtype, argtype) -> argtype runtime helper. The call's own type is the type of the expression it replaces,
+ * the emitters convert what the helper returns to it.
+*/
+static ClaspASTNode *runtime_call(const char *name, ClaspASTNode *argtype, ClaspASTNode *a, ClaspASTNode *b, ClaspASTNode *type, ClaspToken *at) {
+    cvector(ClaspASTNode *) sig = NULL;
+    cvector_push_back(sig, argtype);
+    cvector_push_back(sig, argtype);
+
+    ClaspASTNode *ref = typed_var_ref(token_synth(TOKEN_ID, name, at), type_intern_fn(sig, argtype), TYPE_CONST);
+    cvector_free(sig);
+
+    cvector(ClaspASTNode *) args = NULL;
+    cvector_push_back(args, a);
+    cvector_push_back(args, b);
+    ClaspASTNode *call = fn_call(ref, args);
+    call->exprType->type = type;
+    return call;
+}
+
+// The exponent if it's a literal with an integer value, otherwise -1.
+static long const_exponent(ClaspASTNode *exp) {
+    if (exp->type != AST_EXPR_LIT_NUMBER) return -1;
+    double v = strtod(exp->data.lit_num.value->data, NULL);
+    if (v < 0 || v > CLASP_POW_UNROLL_LIMIT || v != (long) v) return -1;
+    return (long) v;
+}
+
+static ClaspASTNode *lower_power(ClaspASTNode *node, ClaspASTNode *type) {
+    ClaspASTNode *base = node->data.binop.left, *exp = node->data.binop.right;
+    ClaspToken *at = node->data.binop.op;
+
+    long n = const_exponent(exp);
+    bool cheap = base->type == AST_EXPR_VAR_REF || base->type == AST_EXPR_LIT_NUMBER;
+    if (n >= 0 && pure(base) && (cheap || n <= 2)) {
+        if (n == 0) {
+            ClaspASTNode *one = lit_num(token_synth(TOKEN_NUMBER, type_is_float(type) ? "1.0" : "1", at));
+            one->exprType->type = type;
+            return one;
+        }
+        // The multiplies compute in the type of their operands, so a base of a narrower type would wrap
+        if (type_of(base) == type) return pow_chain(base, n, type, at);
+    }
+
+    if (type_is_float(type)) return runtime_call("pow", type_intern("double"), base, exp, type, at);
+    return runtime_call("clasp_ipow", type_intern("long"), base, exp, type, at);
+}
+
+static void *lower_pow_node(ClaspASTNode *node, void *args) {
+    ast_map_children(node, &lower_pow_node, args);
+    if (node->type != AST_EXPR_BINOP) return node;
+
+    ClaspToken *op = node->data.binop.op;
+    ClaspASTNode *type = type_of(node);
+    if (!type || !type_of(node->data.binop.left) || !type_of(node->data.binop.right)) return node; // Not type checked
+
+    if (op->type == TOKEN_CARAT) return lower_power(node, type);
+    if (op->type == TOKEN_CARAT_EQ) {
+        ClaspASTNode *target = node->data.binop.left, *exp = node->data.binop.right;
+        ClaspASTNode *power = typed_binop(ast_clone(target), exp, TOKEN_CARAT, "^", type_promote(type_of(target), type_of(exp)), op);
+        node->data.binop.op = token_synth(TOKEN_EQ, "=", op);
+        node->data.binop.right = lower_power(power, type_of(power));
+    }
+    return node;
+}
+
+ClaspASTNode *lower_pow(ClaspASTNode *ast) {
+    if (!ast) return NULL;
+    return lower_pow_node(ast, NULL);
+}
+
+static void *lower_for_node(ClaspASTNode *node, void *args) {
+    ast_map_children(node, &lower_for_node, args);
+    if (node->type != AST_FOR_STMT) return node;
+
+    ClaspASTNode *cond = node->data.for_stmt.cond;
+    if (!cond) {
+        cond = lit_num(token_synth(TOKEN_NUMBER, "1", NULL));
+        cond->exprType->type = type_intern("int");
+    }
+
+    cvector(ClaspASTNode *) body = NULL;
+    if (node->data.for_stmt.body) cvector_push_back(body, node->data.for_stmt.body);
+    if (node->data.for_stmt.step) cvector_push_back(body, node->data.for_stmt.step);
+
+    cvector(ClaspASTNode *) out = NULL;
+    if (node->data.for_stmt.init) cvector_push_back(out, node->data.for_stmt.init);
+    cvector_push_back(out, while_stmt(cond, block_stmt(body)));
+    return block_stmt(out);
+}
+
+ClaspASTNode *lower_for(ClaspASTNode *ast) {
+    if (!ast) return NULL;
+    return lower_for_node(ast, NULL);
+}
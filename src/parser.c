@@ -291,7 +291,6 @@ ClaspASTNode *parser_stmt(ClaspParser *p) {
         if (!consume(p, NULL, TOKEN_LEFT_PAREN)) {
             ERROR("Expected opening parenthesis after for keyword.");
         }
-        cvector(ClaspASTNode *) out = NULL;
 
         ClaspASTNode *setup = parser_stmt(p); // The setup statement (eg. var i: int = 0)
         ClaspASTNode *cond = parser_expression(p); // The exit condition. (eg i < 10)
@@ -306,16 +305,8 @@ ClaspASTNode *parser_stmt(ClaspParser *p) {
         p->scope++;
         ClaspASTNode *body = parser_stmt(p); // The body of the loop.
         p->scope--;
-        cvector(ClaspASTNode *) bodyFull = NULL;
-        cvector_push_back(bodyFull, body);
-        cvector_push_back(bodyFull, inc );
-        ClaspASTNode *bodyFinal = block_stmt(bodyFull);
 
-        cvector_push_back(out, setup); // Setup statement
-        ClaspASTNode *loop = while_stmt(cond, bodyFinal);
-        cvector_push_back(out, loop);
-
-        return block_stmt(out);
+        return for_stmt(setup, cond, inc, body); // Kept as a loop, see lower_for() for targets that only handle while
     }
     
         // Fall-back to expression statements
@@ -0,0 +1,174 @@
+/**
+ * Clasp pass manager implementation
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/pass_manager.h>
+#include <clasp/walk.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <cvector/cvector.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+static uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static int64_t heap_bytes() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return (int64_t) (info.uordblks + info.hblkhd);
+#else
+    return 0;
+#endif
+}
+
+static uint64_t count_nodes(ClaspASTNode *ast) {
+    if (!ast) return 0;
+    ClaspASTStats stats = { 0 };
+    ClaspASTPass pass = ast_stats_pass(&stats);
+    ast_walk(ast, &pass, 1);
+    return stats.total;
+}
+
+void pass_manager_init(ClaspPassManager *pm, bool measure) {
+    *pm = (ClaspPassManager) { NULL, NULL, measure };
+}
+
+void pass_manager_free(ClaspPassManager *pm) {
+    cvector_free(pm->passes);
+    cvector_free(pm->stats);
+    pm->passes = NULL;
+    pm->stats = NULL;
+}
+
+void pass_manager_add(ClaspPassManager *pm, const char *name, ClaspTreePass run) {
+    cvector_push_back(pm->passes, ((ClaspPassEntry) { name, run, NULL, NULL, true }));
+}
+
+void pass_manager_add_with(ClaspPassManager *pm, const char *name, ClaspTreePassWith run, void *args) {
+    cvector_push_back(pm->passes, ((ClaspPassEntry) { name, NULL, run, args, true }));
+}
+
+static ClaspPassEntry *find(cvector(ClaspPassEntry) passes, const char *name, size_t len) {
+    for (size_t i = 0; i < cvector_size(passes); ++i)
+        if (strlen(passes[i].name) == len && !strncmp(passes[i].name, name, len)) return &passes[i];
+    return NULL;
+}
+
+bool pass_manager_select(ClaspPassManager *pm, const char *list) {
+    cvector(ClaspPassEntry) order = NULL;
+    for (const char *at = list; *at;) {
+        size_t len = strcspn(at, ",");
+        if (len) {
+            ClaspPassEntry *pass = find(pm->passes, at, len);
+            if (!pass) {
+                cvector_free(order);
+                return false;
+            }
+            ClaspPassEntry copy = *pass;
+            copy.enabled = true;
+            cvector_push_back(order, copy);
+        }
+        at += len + (at[len] == ',');
+    }
+
+    // Keep passes that weren't chosen registered, so a later selection can still name them
+    for (size_t i = 0; i < cvector_size(pm->passes); ++i) {
+        if (find(order, pm->passes[i].name, strlen(pm->passes[i].name))) continue;
+        ClaspPassEntry copy = pm->passes[i];
+        copy.enabled = false;
+        cvector_push_back(order, copy);
+    }
+    cvector_free(pm->passes);
+    pm->passes = order;
+    return true;
+}
+
+ClaspASTNode *pass_manager_run(ClaspPassManager *pm, ClaspASTNode *ast) {
+    for (size_t i = 0; i < cvector_size(pm->passes); ++i) {
+        ClaspPassEntry *pass = &pm->passes[i];
+        if (!pass->enabled) continue;
+        size_t phase = pass_manager_begin(pm, pass->name, ast);
+        ast = pass->run_with ? pass->run_with(ast, pass->args) : pass->run(ast);
+        pass_manager_end(pm, phase, ast);
+    }
+    return ast;
+}
+
+size_t pass_manager_begin(ClaspPassManager *pm, const char *name, ClaspASTNode *ast) {
+    if (!pm->measure) return 0;
+    ClaspPassStats stats = { name, 0, count_nodes(ast), 0, 0, 0, 0 };
+    stats._start_bytes = heap_bytes();
+    stats._start_ns = now_ns(); // Last, so the bookkeeping above isn't timed
+    cvector_push_back(pm->stats, stats);
+    return cvector_size(pm->stats) - 1;
+}
+
+void pass_manager_end(ClaspPassManager *pm, size_t phase, ClaspASTNode *ast) {
+    if (!pm->measure) return;
+    ClaspPassStats *stats = &pm->stats[phase];
+    stats->ms = (now_ns() - stats->_start_ns) / 1e6;
+    stats->bytes = heap_bytes() - stats->_start_bytes;
+    stats->nodes_out = count_nodes(ast);
+}
+
+static void json_string(FILE *out, const char *s) {
+    fputc('"', out);
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\') fputc('\\', out);
+        fputc(*s, out);
+    }
+    fputc('"', out);
+}
+
+void pass_manager_report(ClaspPassManager *pm, FILE *out, ClaspReportFormat format) {
+    double total = 0;
+    for (size_t i = 0; i < cvector_size(pm->stats); ++i) total += pm->stats[i].ms;
+
+    if (format == CLASP_REPORT_JSON) {
+        fprintf(out, "{\"total_ms\": %.3f, \"passes\": [", total);
+        for (size_t i = 0; i < cvector_size(pm->stats); ++i) {
+            ClaspPassStats *s = &pm->stats[i];
+            fprintf(out, "%s\n  {\"name\": ", i ? "," : "");
+            json_string(out, s->name);
+            fprintf(out, ", \"ms\": %.3f, \"nodes_in\": %llu, \"nodes_out\": %llu, \"bytes\": %lld}",
+                s->ms, (unsigned long long) s->nodes_in, (unsigned long long) s->nodes_out, (long long) s->bytes);
+        }
+        fprintf(out, "\n]}\n");
+        return;
+    }
+
+    fprintf(out, "%-12s %10s %6s %10s %10s %12s\n", "Pass", "Time (ms)", "%", "Nodes in", "Nodes out", "Memory (KiB)");
+    for (size_t i = 0; i < cvector_size(pm->stats); ++i) {
+        ClaspPassStats *s = &pm->stats[i];
+        fprintf(out, "%-12s %10.3f %6.1f %10llu %10llu %+12.1f\n", s->name, s->ms, total > 0 ? 100 * s->ms / total : 0,
+            (unsigned long long) s->nodes_in, (unsigned long long) s->nodes_out, s->bytes / 1024.0);
+    }
+    fprintf(out, "%-12s %10.3f\n", "Total", total);
+}
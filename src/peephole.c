@@ -0,0 +1,238 @@
+/**
+ * Clasp bytecode peephole optimizer implementation
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/peephole.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cvector/cvector.h>
+
+typedef struct Inst {
+    size_t pc;
+    ClaspBytecodeInst inst;
+    bool label;                 // Some path jumps or calls here
+    bool dead;
+    bool folded;                // A constant now loading `cell` instead
+    uint64_t cell;
+} Inst;
+
+typedef struct Peephole {
+    cvector(Inst) code;         // Ends with a CLASP_NUM_OPCODES sentinel at the end of the code
+    uint32_t *index;            // Code offset -> instruction, UINT32_MAX mid-instruction
+    ClaspBytecode *bc;
+} Peephole;
+
+static size_t next(Peephole *p, size_t i) {
+    do ++i; while (p->code[i].dead);
+    return i;
+}
+
+static uint8_t op_at(Peephole *p, size_t i) {
+    return p->code[i].inst.op;
+}
+
+// Paths that reached a dead instruction now reach the one after it.
+static void kill(Peephole *p, size_t i) {
+    size_t after = next(p, i);
+    p->code[after].label |= p->code[i].label;
+    p->code[i].dead = true;
+}
+
+static bool is_push(uint8_t op) {
+    return (op >= OP_CONSTB && op <= OP_CONSTK) || op == OP_LOADL || op == OP_LOADG;
+}
+
+static bool is_store(uint8_t op) {
+    return op == OP_STOREL || op == OP_STOREG;
+}
+
+static bool is_const(uint8_t op) {
+    return op >= OP_CONSTB && op <= OP_CONSTK;
+}
+
+static uint64_t const_cell(Peephole *p, size_t i) {
+    Inst *in = &p->code[i];
+    if (in->folded) return in->cell;
+    switch (in->inst.op) {
+        case OP_CONSTB: return (int8_t) in->inst.args[0];
+        case OP_CONSTW: return (int16_t) in->inst.args[0];
+        case OP_CONSTD: return (int32_t) in->inst.args[0];
+        case OP_CONSTK: return p->bc->constants[in->inst.args[0]];
+        default:        return in->inst.args[0];
+    }
+}
+
+static bool is_float(uint64_t cls) {
+    return cls == CLB_F4 || cls == CLB_F8;
+}
+
+// What conv does to a constant, as the VM does it. Floats to integers are left to the VM.
+static bool convert(uint64_t *cell, uint64_t from, uint64_t to) {
+    if (from > CLB_F8 || to > CLB_F8 || (is_float(from) && !is_float(to))) return false;
+    int64_t i = (int64_t) *cell;
+    uint32_t bits4;
+    double f8;
+    float f4;
+    if (from == CLB_F4) {
+        bits4 = *cell;
+        memcpy(&f4, &bits4, 4);
+    } else if (from == CLB_F8) {
+        memcpy(&f8, cell, 8);
+    }
+    switch (to) {
+        case CLB_B: *cell = (int8_t) i; break;
+        case CLB_W: *cell = (int16_t) i; break;
+        case CLB_D: *cell = (int32_t) i; break;
+        case CLB_Q: break;
+        case CLB_F4:
+            f4 = from == CLB_F4 ? f4 : from == CLB_F8 ? (float) f8 : (float) i;
+            memcpy(&bits4, &f4, 4);
+            *cell = bits4;
+            break;
+        default:
+            f8 = from == CLB_F4 ? (double) f4 : from == CLB_F8 ? f8 : (double) i;
+            memcpy(cell, &f8, 8);
+            break;
+    }
+    return true;
+}
+
+// Pops two cells and pushes one
+static bool is_binary(uint8_t op) {
+    return op >= OP_MATHBB && op <= OP_CMPF8;
+}
+
+// Try the patterns at instruction i, which is live.
+// @return The number of instructions removed.
+static size_t rewrite(Peephole *p, size_t i) {
+    size_t end = cvector_size(p->code) - 1;
+    size_t j = i < end ? next(p, i) : end, k = j < end ? next(p, j) : end;
+    size_t l = k < end ? next(p, k) : end, m = l < end ? next(p, l) : end;
+    Inst *c = p->code;
+
+    if (op_at(p, i) == OP_DUP && is_store(op_at(p, j)) && op_at(p, k) == OP_POP && !c[j].label && !c[k].label) {
+        kill(p, k);
+        kill(p, i);
+        return 2;
+    }
+    if (op_at(p, i) == OP_DUP && is_push(op_at(p, j)) && is_binary(op_at(p, k)) && is_store(op_at(p, l)) &&
+        op_at(p, m) == OP_POP && !c[j].label && !c[k].label && !c[l].label && !c[m].label) {
+        kill(p, m);
+        kill(p, i);
+        return 2;
+    }
+    if ((is_push(op_at(p, i)) || op_at(p, i) == OP_DUP) && op_at(p, j) == OP_POP && !c[j].label) {
+        kill(p, j);
+        kill(p, i);
+        return 2;
+    }
+    if (is_const(op_at(p, i)) && op_at(p, j) == OP_CONV && !c[j].label) {
+        uint64_t cell = const_cell(p, i);
+        if (convert(&cell, c[j].inst.args[0], c[j].inst.args[1])) {
+            c[i].folded = true;
+            c[i].cell = cell;
+            kill(p, j);
+            return 1;
+        }
+    }
+    if (op_at(p, i) == OP_JMP) {
+        size_t target = p->index[p->bc->atable[c[i].inst.args[0]]];
+        while (c[target].dead) target++;
+        if (target == j) {
+            kill(p, i);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+size_t bytecode_peephole(ClaspBytecode *bc) {
+    size_t size = cvector_size(bc->code);
+    Peephole p = { NULL, malloc((size + 1) * sizeof(uint32_t)), bc };
+    for (size_t pc = 0; pc <= size; ++pc) p.index[pc] = UINT32_MAX;
+
+    bool ok = true;
+    ClaspBytecodeInst inst;
+    for (size_t pc = 0; ok && pc < size; pc += inst.size) {
+        ok = bytecode_decode(bc->code, size, pc, &inst);
+        p.index[pc] = cvector_size(p.code);
+        cvector_push_back(p.code, ((Inst) { pc, inst, false, false }));
+    }
+    p.index[size] = cvector_size(p.code);
+    cvector_push_back(p.code, ((Inst) { size, { .op = CLASP_NUM_OPCODES }, false, false }));
+    for (size_t i = 0; ok && i < cvector_size(bc->atable); ++i) {
+        ok = bc->atable[i] < size && p.index[bc->atable[i]] != UINT32_MAX;
+        if (ok) p.code[p.index[bc->atable[i]]].label = true;
+    }
+    for (size_t i = 0; ok && i < cvector_size(p.code) - 1; ++i) {
+        uint8_t op = op_at(&p, i);
+        if (op == OP_JMP || op == OP_JZ || op == OP_JNZ) ok = p.code[i].inst.args[0] < cvector_size(bc->atable);
+        if (op == OP_CONSTK) ok = p.code[i].inst.args[0] < cvector_size(bc->constants);
+    }
+    if (!ok) { // Leave code the VM would reject to the VM
+        cvector_free(p.code);
+        free(p.index);
+        return 0;
+    }
+
+    size_t removed = 0;
+    for (size_t n = 1; n;) {
+        n = 0;
+        for (size_t i = 0; i < cvector_size(p.code) - 1; ++i)
+            if (!p.code[i].dead) n += rewrite(&p, i);
+        removed += n;
+    }
+
+    /**
+     * Reassemble into bc->code. Pooled and folded constants go through bytecode_const() like the emitter's, into a
+     * new pool, so entries only dead code used are dropped.
+    */
+    if (removed) {
+        for (size_t i = 0; i < cvector_size(p.code) - 1; ++i) {
+            if (p.code[i].dead || op_at(&p, i) != OP_CONSTK) continue;
+            p.code[i].cell = const_cell(&p, i);
+            p.code[i].folded = true;
+        }
+        cvector(uint8_t) old = bc->code;
+        bc->code = NULL;
+        cvector_clear(bc->constants);
+        hashmap_t pool;
+        hashmap_create(16, &pool);
+        size_t *moved = malloc(cvector_size(p.code) * sizeof(size_t));
+        for (size_t i = 0; i < cvector_size(p.code); ++i) {
+            Inst *in = &p.code[i];
+            moved[i] = cvector_size(bc->code);
+            if (in->dead || i == cvector_size(p.code) - 1) continue;
+            if (in->folded) bytecode_const(bc, &pool, in->cell);
+            else for (size_t b = 0; b < in->inst.size; ++b) cvector_push_back(bc->code, old[in->pc + b]);
+        }
+        for (size_t i = 0; i < cvector_size(bc->atable); ++i) bc->atable[i] = moved[p.index[bc->atable[i]]];
+        free(moved);
+        bytecode_pool_free(&pool);
+        cvector_free(old);
+    }
+    cvector_free(p.code);
+    free(p.index);
+    return removed;
+}
@@ -24,70 +24,81 @@
 */
 
 #include <clasp/print_ast.h>
+#include <clasp/static_visitor.h>
 #include <stdio.h>
 #include <cvector/cvector.h>
 
-void *_printBinop(ClaspASTNode *binop, void *args) {
+CLASP_STATIC_VISITOR(print_node, print)
+
+static void *print_binop(ClaspASTNode *binop, void *args) {
     printf("(binop: left=");
-    visit(binop->data.binop.left, args, clasp_ast_printer);
+    print_node(binop->data.binop.left, args);
     printf(" op=%s right=", binop->data.binop.op->data);
-    visit(binop->data.binop.right, args, clasp_ast_printer);
+    print_node(binop->data.binop.right, args);
     printf(")");
     return NULL;
 }
-void *_printUnop(ClaspASTNode *unop, void *args) {
+static void *print_unop(ClaspASTNode *unop, void *args) {
     printf("(unop: op=%s right=", unop->data.unop.op->data);
-    visit(unop->data.unop.right, args, clasp_ast_printer);
+    print_node(unop->data.unop.right, args);
     printf(")");
     return NULL;
 }
 
-void *_printPostfix(ClaspASTNode *post, void *args) {
+static void *print_postfix(ClaspASTNode *post, void *args) {
     printf("(postfix: left=");
-    visit(post->data.postfix.left, args, clasp_ast_printer);
+    print_node(post->data.postfix.left, args);
     printf(" op=%s)", post->data.postfix.op->data);
     return NULL;
 }
-void *_printNumLiteral(ClaspASTNode *lit, void *args) {
+static void *print_lit_num(ClaspASTNode *lit, void *args) {
     printf("(num_literal: val=%s)", lit->data.lit_num.value->data);
     return NULL;
 }
 
-void *_printVarRef(ClaspASTNode *var, void *args) {
+static void *print_var_ref(ClaspASTNode *var, void *args) {
     printf("(var_ref: name=%s)", var->data.var_ref.varname->data);
     return NULL;
 }
 
-void *_printFnCall(ClaspASTNode *fn, void *args) {
+static void *print_fn_call(ClaspASTNode *fn, void *args) {
     printf("(fn_call: ref=");
-    visit(fn->data.fn_call.referencer, args, clasp_ast_printer);
+    print_node(fn->data.fn_call.referencer, args);
     printf(" args=[  ");
 
     for (int i = 0; i < cvector_size(fn->data.fn_call.args); ++i) {
         printf("\b\b");
-        visit(fn->data.fn_call.args[i], args, clasp_ast_printer);
+        print_node(fn->data.fn_call.args[i], args);
         printf(",   ");
     }
     printf("\b\b\b\b])");
+    return NULL;
 }
 
-void *_printExprStmt(ClaspASTNode *ast, void *args) {
+static void *print_return_stmt(ClaspASTNode *ast, void *args) {
+    printf("(returnStmt: ");
+    print_node(ast->data.return_stmt.retval, args);
+    printf(")\n");
+    return NULL;
+}
+
+static void *print_expr_stmt(ClaspASTNode *ast, void *args) {
     printf("(exprStmt: ");
-    visit(ast->data.expr_stmt.expr, args, clasp_ast_printer);
+    print_node(ast->data.expr_stmt.expr, args);
     printf(")\n");
     return NULL;
 }
 
-void *_printBlockStmt(ClaspASTNode *ast, void *args) {
+static void *print_block_stmt(ClaspASTNode *ast, void *args) {
     printf("(blockStmt:\n");
     for (int i = 0; i < cvector_size(ast->data.block_stmt.body); ++i) {
-        visit(ast->data.block_stmt.body[i], args, clasp_ast_printer);
+        print_node(ast->data.block_stmt.body[i], args);
     }
     printf(")\n");
     return NULL;
 }
 
-void *_printVarDecl(ClaspASTNode *ast, void *args) {
+static void *print_var_decl(ClaspASTNode *ast, void *args) {
     switch (ast->type) {
         case AST_VAR_DECL_STMT:   printf("(varDecl:");   break;
         case AST_LET_DECL_STMT:   printf("(letDecl:");   break;
@@ -96,73 +107,107 @@ void *_printVarDecl(ClaspASTNode *ast, void *args) {
     printf(" name=\"%s\"", ast->data.var_decl_stmt.name->data);
     if (ast->data.var_decl_stmt.type) {
         printf(" type=");
-        visit(ast->data.var_decl_stmt.type, args, clasp_ast_printer);
+        print_node(ast->data.var_decl_stmt.type, args);
     }
 
     if (ast->data.var_decl_stmt.initializer) {
         printf(" initializer=");
-        visit(ast->data.var_decl_stmt.initializer, args, clasp_ast_printer);
+        print_node(ast->data.var_decl_stmt.initializer, args);
     }
     printf(")\n");
+    return NULL;
 }
 
-void *_printFnDecl(ClaspASTNode *ast, void *args) {
+static void *print_fn_decl(ClaspASTNode *ast, void *args) {
     printf("fnDecl: name=\"%s\" ret=", ast->data.fn_decl_stmt.name->data);
-    visit(ast->data.fn_decl_stmt.ret_type, args, clasp_ast_printer);
+    print_node(ast->data.fn_decl_stmt.ret_type, args);
     printf(" args=[  ");
     for (int i = 0; i < cvector_size(ast->data.fn_decl_stmt.args); ++i) {
         struct ClaspArg *arg = ast->data.fn_decl_stmt.args[i];
         printf("\b\b(%s ", arg->name->data);
-        visit(arg->type, args, clasp_ast_printer);
+        print_node(arg->type, args);
         printf("),   ");
     }
     printf("\b\b\b\b] body=");
-    visit(ast->data.fn_decl_stmt.body, args, clasp_ast_printer);
+    print_node(ast->data.fn_decl_stmt.body, args);
     printf(")\n");
+    return NULL;
 }
 
-void *_printIf(ClaspASTNode *ast, void *args) {
+static void *print_if(ClaspASTNode *ast, void *args) {
     printf("(ifStmt: cond=");
-    visit(ast->data.cond_stmt.cond, args, clasp_ast_printer);
+    print_node(ast->data.cond_stmt.cond, args);
     printf(" body=");
-    visit(ast->data.cond_stmt.body, args, clasp_ast_printer);
+    print_node(ast->data.cond_stmt.body, args);
     printf(")\n");
+    return NULL;
 }
 
-void *_printWhile(ClaspASTNode *ast, void *args) {
+static void *print_while(ClaspASTNode *ast, void *args) {
     printf("(whileStmt: cond=");
-    visit(ast->data.cond_stmt.cond, args, clasp_ast_printer);
+    print_node(ast->data.cond_stmt.cond, args);
+    printf(" body=");
+    print_node(ast->data.cond_stmt.body, args);
+    printf(")\n");
+    return NULL;
+}
+
+static void *print_for(ClaspASTNode *ast, void *args) {
+    printf("(forStmt: init=");
+    print_node(ast->data.for_stmt.init, args);
+    printf(" cond=");
+    print_node(ast->data.for_stmt.cond, args);
+    printf(" step=");
+    print_node(ast->data.for_stmt.step, args);
     printf(" body=");
-    visit(ast->data.cond_stmt.body, args, clasp_ast_printer);
+    print_node(ast->data.for_stmt.body, args);
     printf(")\n");
+    return NULL;
 }
 
-void *_printSingleType(ClaspASTNode *ast, void *args) {
+static void *print_single_type(ClaspASTNode *ast, void *args) {
     printf("[single name=\"%s\"]", ast->data.single.name->data);
+    return NULL;
 }
 
-void claspPrintAST(ClaspASTNode *ast) {
-    visit(ast, NULL, clasp_ast_printer);
+static void *print_array_type(ClaspASTNode *ast, void *args) {
+    printf("[array of=");
+    print_node(ast->data.array.enclosed, args);
+    printf("]");
+    return NULL;
 }
 
-ClaspASTVisitor clasp_ast_printer = {
-    [AST_EXPR_BINOP     ] = &_printBinop,
-    [AST_EXPR_UNOP      ] = &_printUnop,
-    [AST_EXPR_POSTFIX   ] = &_printPostfix,
-    [AST_EXPR_LIT_NUMBER] = &_printNumLiteral,
-    [AST_EXPR_VAR_REF   ] = &_printVarRef,
-    [AST_EXPR_FN_CALL   ] = &_printFnCall,
+static void *print_fn_type(ClaspASTNode *ast, void *args) {
+    printf("[fn args=(");
+    for (int i = 0; i < cvector_size(ast->data.function.args); ++i) {
+        if (i) printf(", ");
+        print_node(ast->data.function.args[i], args);
+    }
+    printf(") ret=");
+    print_node(ast->data.function.ret, args);
+    printf("]");
+    return NULL;
+}
 
-    [AST_EXPR_STMT      ] = &_printExprStmt,
-    [AST_BLOCK_STMT     ] = &_printBlockStmt,
-    [AST_VAR_DECL_STMT  ] = &_printVarDecl,
-    [AST_LET_DECL_STMT  ] = &_printVarDecl,
-    [AST_CONST_DECL_STMT] = &_printVarDecl,
+static void *print_template_type(ClaspASTNode *ast, void *args) {
+    printf("[template name=\"%s\" params=(", ast->data.template.typename->data);
+    for (int i = 0; i < cvector_size(ast->data.template.template); ++i) {
+        if (i) printf(", ");
+        print_node(ast->data.template.template[i], args);
+    }
+    printf(")]");
+    return NULL;
+}
 
-    [AST_FN_DECL_STMT   ] = &_printFnDecl,
+static void *print_ptr_type(ClaspASTNode *ast, void *args) {
+    printf("[ptr to=");
+    print_node(ast->data.pointer.pointed, args);
+    printf("]");
+    return NULL;
+}
 
-    [AST_IF_STMT        ] = &_printIf,
-    [AST_WHILE_STMT     ] = &_printWhile,
+void claspPrintAST(ClaspASTNode *ast) {
+    print_node(ast, NULL);
+}
 
-    [AST_TYPE_SINGLE    ] = &_printSingleType,
-};
\ No newline at end of file
+ClaspASTVisitor clasp_ast_printer = CLASP_STATIC_VISITOR_TABLE(print);
@@ -0,0 +1,97 @@
+/**
+ * Clasp register bytecode implementation
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/regcode.h>
+#include <inttypes.h>
+#include <stdlib.h>
+
+#define CLASP_REG_INFO_ENTRY(op, name, operands) [op] = { name, operands },
+static const struct { const char *name, *operands; } OPCODES[] = { CLASP_REG_OPCODES(CLASP_REG_INFO_ENTRY) };
+#undef CLASP_REG_INFO_ENTRY
+
+const char *regcode_opcode_name(uint8_t op) {
+    return op < CLASP_NUM_REG_OPCODES ? OPCODES[op].name : NULL;
+}
+
+const char *regcode_operands(uint8_t op) {
+    return op < CLASP_NUM_REG_OPCODES ? OPCODES[op].operands : NULL;
+}
+
+static const char *symbol_name(ClaspRegModule *m, int64_t k) {
+    return k >= 0 && (uint64_t) k < cvector_size(m->symbols) ? m->symbols[k] : "?";
+}
+
+static const char *fn_name(ClaspRegModule *m, int64_t k) {
+    if (k < 0 || (uint64_t) k >= cvector_size(m->fns)) return "?";
+    return m->fns[k].name ? m->fns[k].name : "start";
+}
+
+static void print_inst(ClaspRegModule *m, ClaspRegInst *in, FILE *out) {
+    const char *operands = regcode_operands(in->op);
+    if (!operands) {
+        fprintf(out, "<invalid %u>", in->op);
+        return;
+    }
+    fputs(regcode_opcode_name(in->op), out);
+    for (const char *kind = operands; *kind; ++kind) {
+        switch (*kind) {
+            case 'i': case 'f': fprintf(out, " %s", bytecode_class_name(in->x)); break;
+            case 'm': case 'o': fprintf(out, " %s", bytecode_math_name(in->x)); break;
+            case 'v': fprintf(out, " %s %s", bytecode_class_name(in->x & 15), bytecode_class_name(in->x >> 4)); break;
+            case 'n': fprintf(out, " %u", in->x); break;
+            case '1': fprintf(out, " r%u", in->a); break;
+            case '2': fprintf(out, " r%u", in->b); break;
+            case '3': fprintf(out, " r%u", in->c); break;
+            case 'H': fprintf(out, " %d", (int16_t) in->b); break;
+            case 'K': fprintf(out, " %" PRId64, in->k); break;
+            case 'G': fprintf(out, " g%" PRId64, in->k); break;
+            case 'T': fprintf(out, " @%" PRId64, in->k); break;
+            case 'F': fprintf(out, " %s", fn_name(m, in->k)); break;
+            case 'S': fprintf(out, " %s", symbol_name(m, in->k)); break;
+        }
+    }
+}
+
+void regcode_disassemble(ClaspRegModule *m, FILE *out) {
+    fprintf(out, "start %" PRId64 ", %" PRIu64 " globals\n", m->start, m->globals);
+    for (size_t i = 0; i < cvector_size(m->fns); ++i) {
+        ClaspRegFunction *fn = &m->fns[i];
+        fprintf(out, "%s: %u params, %u registers\n", fn_name(m, i), fn->params, fn->registers);
+        for (uint32_t pc = fn->entry; pc < fn->entry + fn->size && pc < cvector_size(m->code); ++pc) {
+            fprintf(out, "%6u  ", pc);
+            print_inst(m, &m->code[pc], out);
+            fputc('\n', out);
+        }
+    }
+}
+
+void regcode_free(ClaspRegModule *m) {
+    for (size_t i = 0; i < cvector_size(m->fns); ++i) free(m->fns[i].name);
+    for (size_t i = 0; i < cvector_size(m->symbols); ++i) free(m->symbols[i]);
+    cvector_free(m->fns);
+    cvector_free(m->symbols);
+    cvector_free(m->code);
+    free(m);
+}
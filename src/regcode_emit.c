@@ -0,0 +1,623 @@
+/**
+ * Clasp register bytecode emitter implementation
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/regcode_emit.h>
+#include <clasp/err.h>
+#include <clasp/types.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cvector/cvector.h>
+
+#define NO_REG UINT32_MAX   // Destination of a value nobody reads
+
+typedef struct Emitter {
+    ClaspRegModule *m;
+    ClaspValueClass ret;        // Return class of the function being emitted
+    bool live;                  // Whether the next instruction can be reached
+    uint32_t locals;            // The function's resolved slots, temporaries come after them
+    uint32_t top;               // Next free temporary
+    uint32_t registers;         // Most registers the function has used
+    size_t errors;
+} Emitter;
+
+static const ClaspRegOpcode INT_OPS[] = {
+    [CLB_ADD] = ROP_ADD, [CLB_SUB] = ROP_SUB, [CLB_MUL] = ROP_MUL, [CLB_DIV] = ROP_DIV,
+    [CLB_REM] = ROP_REM, [CLB_SHL] = ROP_SHL, [CLB_XOR] = ROP_XOR,
+};
+
+static const ClaspRegOpcode INT_K_OPS[] = {
+    [CLB_ADD] = ROP_ADDK, [CLB_SUB] = ROP_SUBK, [CLB_MUL] = ROP_MULK, [CLB_DIV] = ROP_DIVK,
+    [CLB_REM] = ROP_REMK, [CLB_SHL] = ROP_SHLK, [CLB_XOR] = ROP_XORK,
+};
+
+static bool is_float(ClaspValueClass cls) {
+    return cls == CLB_F4 || cls == CLB_F8;
+}
+
+static ClaspValueClass class_of(ClaspASTNode *node) {
+    return bytecode_class(node->exprType->type);
+}
+
+static size_t emit(Emitter *e, ClaspRegInst in) {
+    cvector_push_back(e->m->code, in);
+    if (in.op == ROP_JMP || in.op == ROP_RET || in.op == ROP_RETV) e->live = false;
+    return cvector_size(e->m->code) - 1;
+}
+
+static uint32_t here(Emitter *e) {
+    return cvector_size(e->m->code);
+}
+
+// Point a forward jump at the next instruction, which it makes reachable.
+static void patch(Emitter *e, size_t jump) {
+    e->m->code[jump].k = here(e);
+    e->live = true;
+}
+
+// Temporaries are freed by resetting `top` once the value they hold has been used.
+static uint32_t temp(Emitter *e) {
+    uint32_t r = e->top++;
+    if (e->top > e->registers) e->registers = e->top;
+    return r;
+}
+
+static void move(Emitter *e, uint32_t dst, uint32_t src) {
+    if (dst != src) emit(e, (ClaspRegInst) { ROP_MOV, 0, dst, src });
+}
+
+// Constants are loaded as the cell the VM keeps them in, like the stack emitter's push_const().
+static int64_t cell(ClaspValueClass cls, int64_t i, double f) {
+    switch (cls) {
+        case CLB_B:  return (int8_t) i;
+        case CLB_W:  return (int16_t) i;
+        case CLB_D:  return (int32_t) i;
+        case CLB_F4: {
+            float v = f;
+            uint32_t bits;
+            memcpy(&bits, &v, 4);
+            return bits;
+        }
+        case CLB_F8: {
+            int64_t bits;
+            memcpy(&bits, &f, 8);
+            return bits;
+        }
+        default: return i;
+    }
+}
+
+// A literal as class `cls`, converted the way conv would convert it at run time.
+static int64_t literal_as(ClaspASTNode *node, ClaspValueClass cls) {
+    const char *text = node->data.lit_num.value->data;
+    ClaspValueClass from = class_of(node);
+    if (!is_float(from)) {
+        int64_t i = cell(from, strtoll(text, NULL, 10), 0);
+        return cell(cls, i, (double) i);
+    }
+    double f = from == CLB_F4 ? (float) strtod(text, NULL) : strtod(text, NULL);
+    return cell(cls, (int64_t) f, f);
+}
+
+static int64_t literal(ClaspASTNode *node) {
+    return literal_as(node, class_of(node));
+}
+
+static bool is_int_literal(ClaspASTNode *node) {
+    return node->type == AST_EXPR_LIT_NUMBER && !is_float(class_of(node));
+}
+
+// Integers are kept sign extended, so only narrowing them takes an instruction.
+static bool needs_conv(ClaspValueClass from, ClaspValueClass to) {
+    if (from == to || from == CLB_VOID || to == CLB_VOID) return false;
+    return is_float(from) || is_float(to) || to < from;
+}
+
+static void conv_to(Emitter *e, uint32_t dst, uint32_t src, ClaspValueClass from, ClaspValueClass to) {
+    if (!needs_conv(from, to)) return move(e, dst, src);
+    emit(e, (ClaspRegInst) { ROP_CONV, from | to << 4, dst, src });
+}
+
+// The value of `src` as class `to`. Temporaries are converted in place, locals are left alone.
+static uint32_t conv(Emitter *e, uint32_t src, ClaspValueClass from, ClaspValueClass to) {
+    if (!needs_conv(from, to)) return src;
+    uint32_t dst = src >= e->locals ? src : temp(e);
+    conv_to(e, dst, src, from, to);
+    return dst;
+}
+
+static bool bad_slot(Emitter *e, ClaspToken *name, ClaspSlot slot) {
+    if (slot.kind == CLASP_SLOT_LOCAL || slot.kind == CLASP_SLOT_GLOBAL) return false;
+    if (slot.kind == CLASP_SLOT_OUTER) semantic_err(name, "Functions cannot use '%s' from an enclosing function yet.", name->data);
+    else semantic_err(name, "'%s' cannot be used as a value in bytecode.", name->data);
+    e->errors++;
+    return true;
+}
+
+static bool is_local(ClaspASTNode *node) {
+    return node->type == AST_EXPR_VAR_REF && node->data.var_ref.slot.kind == CLASP_SLOT_LOCAL;
+}
+
+static uint32_t symbol(Emitter *e, const char *name) {
+    for (size_t i = 0; i < cvector_size(e->m->symbols); ++i)
+        if (!strcmp(e->m->symbols[i], name)) return i;
+    char *copy = malloc(strlen(name) + 1);
+    strcpy(copy, name);
+    cvector_push_back(e->m->symbols, copy);
+    return cvector_size(e->m->symbols) - 1;
+}
+
+// ---- Expressions ----
+
+static uint32_t expr(Emitter *e, ClaspASTNode *node);
+static void expr_to(Emitter *e, ClaspASTNode *node, uint32_t dst);
+
+static ClaspMathOp math_op(ClaspTokenType op) {
+    switch (op) {
+        case TOKEN_PLUS:    case TOKEN_PLUS_EQ:    case TOKEN_PLUS_PLUS:   return CLB_ADD;
+        case TOKEN_MINUS:   case TOKEN_MINUS_EQ:   case TOKEN_MINUS_MINUS: return CLB_SUB;
+        case TOKEN_ASTERIX: case TOKEN_ASTERIX_EQ: return CLB_MUL;
+        case TOKEN_SLASH:   case TOKEN_SLASH_EQ:   return CLB_DIV;
+        case TOKEN_PERC:    case TOKEN_PERC_EQ:    return CLB_REM;
+        case TOKEN_TILDE_EQ:                       return CLB_XOR;
+        case TOKEN_LESS_LESS:                      return CLB_SHL;
+        case TOKEN_EQ_EQ:      return CLB_EQ;
+        case TOKEN_BANG_EQ:    return CLB_NE;
+        case TOKEN_LESS:       return CLB_LT;
+        case TOKEN_LESS_EQ:    return CLB_LE;
+        case TOKEN_GREATER:    return CLB_GT;
+        case TOKEN_GREATER_EQ: return CLB_GE;
+        default:               return CLASP_NUM_MATH_OPS;
+    }
+}
+
+// Whether evaluating `node` may assign a local. Calls can't, functions never see their caller's frame.
+static bool writes_local(ClaspASTNode *node) {
+    switch (node->type) {
+        case AST_EXPR_BINOP:
+            if (tktyp_is_assignment(node->data.binop.op->type) && is_local(node->data.binop.left)) return true;
+            return writes_local(node->data.binop.left) || writes_local(node->data.binop.right);
+        case AST_EXPR_UNOP: return writes_local(node->data.unop.right);
+        case AST_EXPR_POSTFIX: return is_local(node->data.postfix.left);
+        case AST_EXPR_FN_CALL:
+            for (size_t i = 0; i < cvector_size(node->data.fn_call.args); ++i)
+                if (writes_local(node->data.fn_call.args[i])) return true;
+            return writes_local(node->data.fn_call.referencer);
+        default: return false;
+    }
+}
+
+// `node` as class `cls` in a register. Literals are converted while emitting.
+static uint32_t operand(Emitter *e, ClaspASTNode *node, ClaspValueClass cls) {
+    if (node->type == AST_EXPR_LIT_NUMBER && needs_conv(class_of(node), cls)) {
+        uint32_t r = temp(e);
+        emit(e, (ClaspRegInst) { ROP_CONST, 0, r, .k = literal_as(node, cls) });
+        return r;
+    }
+    return conv(e, expr(e, node), class_of(node), cls);
+}
+
+/**
+ * The left operand of a binary operation as class `to`. A variable is read in place, unless the right operand may
+ * assign it before the operation reads it.
+*/
+static uint32_t first_operand(Emitter *e, ClaspASTNode *left, ClaspValueClass to, ClaspASTNode *right) {
+    uint32_t r = operand(e, left, to);
+    if (r < e->locals && writes_local(right)) {
+        uint32_t copy = temp(e);
+        move(e, copy, r);
+        r = copy;
+    }
+    return r;
+}
+
+// Compute `left m right` into `dst` as class `t`, integers truncated to `t` if it is narrower than the operands.
+static void arith_to(Emitter *e, ClaspMathOp m, ClaspASTNode *left, ClaspASTNode *right, ClaspValueClass t, uint32_t dst) {
+    ClaspValueClass lc = class_of(left), rc = class_of(right);
+    if (t == CLB_F8 && right->type == AST_EXPR_LIT_NUMBER) {
+        emit(e, (ClaspRegInst) { ROP_MATHF8K, m, dst, operand(e, left, t), 0, literal_as(right, t) });
+        return;
+    }
+    if (is_float(t)) {
+        uint32_t a = first_operand(e, left, t, right);
+        uint32_t b = operand(e, right, t);
+        emit(e, (ClaspRegInst) { t == CLB_F4 ? ROP_MATHF4 : ROP_MATHF8, m, dst, a, b });
+        return;
+    }
+    ClaspValueClass cls = lc > rc ? lc : rc;
+    if (t < cls) cls = t;
+    if (is_int_literal(left) && !is_int_literal(right) && (m == CLB_ADD || m == CLB_MUL || m == CLB_XOR)) {
+        ClaspASTNode *swap = left;
+        left = right;
+        right = swap;
+    }
+    if (is_int_literal(right) && (literal(right) || (m != CLB_DIV && m != CLB_REM))) {
+        emit(e, (ClaspRegInst) { INT_K_OPS[m], cls, dst, expr(e, left), 0, literal(right) });
+        return;
+    }
+    uint32_t a = first_operand(e, left, lc, right);
+    emit(e, (ClaspRegInst) { INT_OPS[m], cls, dst, a, expr(e, right) });
+}
+
+static void compare_to(Emitter *e, ClaspMathOp m, ClaspASTNode *left, ClaspASTNode *right, uint32_t dst) {
+    ClaspValueClass t = bytecode_class(type_promote(left->exprType->type, right->exprType->type));
+    if (!is_float(t)) { // Sign extended integers compare the same whatever their width
+        uint32_t a = first_operand(e, left, class_of(left), right);
+        emit(e, (ClaspRegInst) { ROP_CMP, m, dst, a, expr(e, right) });
+        return;
+    }
+    uint32_t a = first_operand(e, left, t, right);
+    uint32_t b = operand(e, right, t);
+    emit(e, (ClaspRegInst) { t == CLB_F4 ? ROP_CMPF4 : ROP_CMPF8, m, dst, a, b });
+}
+
+// Compute `node` into `dst` as class `cls`.
+static void expr_to_as(Emitter *e, ClaspASTNode *node, ClaspValueClass cls, uint32_t dst) {
+    ClaspValueClass from = class_of(node);
+    if (!needs_conv(from, cls)) return expr_to(e, node, dst);
+    if (node->type == AST_EXPR_LIT_NUMBER) {
+        emit(e, (ClaspRegInst) { ROP_CONST, 0, dst, .k = literal_as(node, cls) });
+        return;
+    }
+    uint32_t top = e->top;
+    conv_to(e, dst, expr(e, node), from, cls);
+    e->top = top;
+}
+
+// Assign to a variable, returning the register that holds the value assigned: the variable itself for locals.
+static uint32_t assign(Emitter *e, ClaspASTNode *node) {
+    ClaspASTNode *left = node->data.binop.left, *right = node->data.binop.right;
+    ClaspTokenType tok = node->data.binop.op->type;
+    ClaspSlot slot = left->data.var_ref.slot;
+    ClaspValueClass lc = class_of(left);
+    if (bad_slot(e, left->data.var_ref.varname, slot)) return 0;
+    uint32_t dst = slot.kind == CLASP_SLOT_LOCAL ? slot.index : temp(e);
+
+    if (tok == TOKEN_EQ) {
+        expr_to_as(e, right, lc, dst);
+    } else { // Compound assignment: compute in the promoted type, store in the variable's
+        ClaspValueClass t = bytecode_class(type_promote(left->exprType->type, right->exprType->type));
+        ClaspMathOp m = math_op(tok);
+        if (!is_float(t) && !is_float(lc)) {
+            arith_to(e, m, left, right, t < lc ? t : lc, dst);
+        } else if (t == lc) {
+            arith_to(e, m, left, right, t, dst);
+        } else {
+            uint32_t r = temp(e);
+            arith_to(e, m, left, right, t, r);
+            conv_to(e, dst, r, t, lc);
+        }
+    }
+    if (slot.kind == CLASP_SLOT_GLOBAL) emit(e, (ClaspRegInst) { ROP_STOREG, 0, dst, .k = slot.index });
+    return dst;
+}
+
+static void binop_to(Emitter *e, ClaspASTNode *node, uint32_t dst) {
+    ClaspASTNode *left = node->data.binop.left, *right = node->data.binop.right;
+    ClaspTokenType tok = node->data.binop.op->type;
+    ClaspMathOp m = math_op(tok);
+    if (tok != TOKEN_EQ && m == CLASP_NUM_MATH_OPS) {
+        semantic_err(node->data.binop.op, "Operator '%s' is not supported in bytecode.", node->data.binop.op->data);
+        e->errors++;
+        return;
+    }
+
+    if (m >= CLB_EQ && m < CLASP_NUM_MATH_OPS) return compare_to(e, m, left, right, dst);
+    if (m == CLB_SHL) return arith_to(e, CLB_SHL, left, right, class_of(left), dst);
+    if (!tktyp_is_assignment(tok)) return arith_to(e, m, left, right, class_of(node), dst);
+
+    if (left->type != AST_EXPR_VAR_REF) return; // The type check rejects assigning to anything else
+    uint32_t value = assign(e, node);
+    if (dst != NO_REG) move(e, dst, value);
+}
+
+// x++ and x--, leaving the old value in `dst`.
+static void postfix_to(Emitter *e, ClaspASTNode *node, uint32_t dst) {
+    ClaspASTNode *target = node->data.postfix.left;
+    if (target->type != AST_EXPR_VAR_REF) return;
+    ClaspSlot slot = target->data.var_ref.slot;
+    if (bad_slot(e, target->data.var_ref.varname, slot)) return;
+    ClaspValueClass t = class_of(target);
+    ClaspMathOp m = math_op(node->data.postfix.op->type);
+
+    uint32_t var = slot.kind == CLASP_SLOT_LOCAL ? slot.index : temp(e);
+    if (slot.kind == CLASP_SLOT_GLOBAL) emit(e, (ClaspRegInst) { ROP_LOADG, 0, var, .k = slot.index });
+    if (dst != NO_REG) move(e, dst, var);
+    if (is_float(t)) {
+        uint32_t one = temp(e);
+        emit(e, (ClaspRegInst) { ROP_CONST, 0, one, .k = cell(t, 1, 1) });
+        emit(e, (ClaspRegInst) { t == CLB_F4 ? ROP_MATHF4 : ROP_MATHF8, m, var, var, one });
+    } else {
+        emit(e, (ClaspRegInst) { INT_K_OPS[m], t, var, var, .k = 1 });
+    }
+    if (slot.kind == CLASP_SLOT_GLOBAL) emit(e, (ClaspRegInst) { ROP_STOREG, 0, var, .k = slot.index });
+}
+
+// Arguments are computed into consecutive temporaries, which become the first registers of the callee's frame.
+static void call_to(Emitter *e, ClaspASTNode *node, uint32_t dst) {
+    ClaspASTNode *callee = node->data.fn_call.referencer;
+    ClaspASTNode *sig = callee->exprType->type;
+    size_t argc = cvector_size(node->data.fn_call.args);
+    bool results = bytecode_class(sig->data.function.ret) != CLB_VOID;
+    ClaspSlot slot = callee->type == AST_EXPR_VAR_REF ? callee->data.var_ref.slot : (ClaspSlot) { CLASP_SLOT_NONE };
+
+    uint32_t fn = 0;
+    if (slot.kind != CLASP_SLOT_FN && slot.kind != CLASP_SLOT_BUILTIN) {
+        fn = expr(e, callee);
+        bool moved = false;
+        for (size_t i = 0; i < argc && !moved; ++i) moved = writes_local(node->data.fn_call.args[i]);
+        if (fn < e->locals && moved) {
+            uint32_t copy = temp(e);
+            move(e, copy, fn);
+            fn = copy;
+        }
+    }
+    uint32_t base = e->top;
+    for (size_t i = 0; i < (argc ? argc : 1); ++i) temp(e); // Keep `base` in the frame, results land there
+    for (size_t i = 0; i < argc; ++i)
+        expr_to_as(e, node->data.fn_call.args[i], bytecode_class(sig->data.function.args[i]), base + i);
+
+    uint32_t result = results && dst != NO_REG ? dst : base;
+    if (slot.kind == CLASP_SLOT_FN) {
+        emit(e, (ClaspRegInst) { ROP_CALL, argc, result, base, .k = slot.index });
+    } else if (slot.kind == CLASP_SLOT_BUILTIN) {
+        emit(e, (ClaspRegInst) { ROP_NATIVE, argc, result, base, .k = symbol(e, callee->data.var_ref.varname->data) });
+    } else {
+        emit(e, (ClaspRegInst) { ROP_CALLI, argc, result, base, fn });
+    }
+    ClaspValueClass returned = bytecode_class(sig->data.function.ret); // Lowered calls may be typed otherwise, see lower_pow
+    if (results && dst != NO_REG && needs_conv(returned, class_of(node))) conv_to(e, result, result, returned, class_of(node));
+}
+
+// The register holding `node`'s value: a local's own register, or a new temporary.
+static uint32_t expr(Emitter *e, ClaspASTNode *node) {
+    if (is_local(node)) return node->data.var_ref.slot.index;
+    if (node->type == AST_EXPR_BINOP && node->data.binop.left->type == AST_EXPR_VAR_REF) {
+        ClaspTokenType tok = node->data.binop.op->type;
+        if (tok == TOKEN_EQ || (tktyp_is_assignment(tok) && math_op(tok) != CLASP_NUM_MATH_OPS)) return assign(e, node);
+    }
+    uint32_t r = temp(e);
+    expr_to(e, node, r);
+    return r;
+}
+
+static void expr_to(Emitter *e, ClaspASTNode *node, uint32_t dst) {
+    uint32_t top = e->top;
+    switch (node->type) {
+        case AST_EXPR_LIT_NUMBER: emit(e, (ClaspRegInst) { ROP_CONST, 0, dst, .k = literal(node) }); break;
+        case AST_EXPR_VAR_REF: {
+            ClaspSlot slot = node->data.var_ref.slot;
+            if (slot.kind == CLASP_SLOT_FN) emit(e, (ClaspRegInst) { ROP_CONST, 0, dst, .k = slot.index });
+            else if (bad_slot(e, node->data.var_ref.varname, slot)) break;
+            else if (slot.kind == CLASP_SLOT_LOCAL) move(e, dst, slot.index);
+            else emit(e, (ClaspRegInst) { ROP_LOADG, 0, dst, .k = slot.index });
+            break;
+        }
+        case AST_EXPR_BINOP: binop_to(e, node, dst); break;
+        case AST_EXPR_UNOP: {
+            ClaspASTNode *right = node->data.unop.right;
+            ClaspValueClass t = class_of(right);
+            switch (node->data.unop.op->type) {
+                case TOKEN_MINUS: emit(e, (ClaspRegInst) { ROP_NEG, t, dst, expr(e, right) }); break;
+                case TOKEN_TILDE: emit(e, (ClaspRegInst) { ROP_NOT, t, dst, expr(e, right) }); break;
+                case TOKEN_BANG: {
+                    uint32_t r = expr(e, right), zero = temp(e);
+                    emit(e, (ClaspRegInst) { ROP_CONST, 0, zero, .k = 0 }); // Zero is all zero bits in every class
+                    emit(e, (ClaspRegInst) { t == CLB_F4 ? ROP_CMPF4 : t == CLB_F8 ? ROP_CMPF8 : ROP_CMP, CLB_EQ, dst, r, zero });
+                    break;
+                }
+                default: break;
+            }
+            break;
+        }
+        case AST_EXPR_POSTFIX: postfix_to(e, node, dst); break;
+        case AST_EXPR_FN_CALL: call_to(e, node, dst); break;
+        default: break;
+    }
+    e->top = top;
+}
+
+// ---- Conditions ----
+
+static ClaspMathOp invert(ClaspMathOp m) {
+    switch (m) {
+        case CLB_EQ: return CLB_NE;
+        case CLB_NE: return CLB_EQ;
+        case CLB_LT: return CLB_GE;
+        case CLB_LE: return CLB_GT;
+        case CLB_GT: return CLB_LE;
+        default:     return CLB_LT;
+    }
+}
+
+/**
+ * Emit a jump taken when `cond` is `when`, returning its index so the caller can point it somewhere. Integer
+ * comparisons branch directly, anything else is computed and tested; floats compare against zero.
+*/
+static size_t branch(Emitter *e, ClaspASTNode *cond, bool when) {
+    uint32_t top = e->top;
+    size_t at;
+    ClaspMathOp m = cond->type == AST_EXPR_BINOP ? math_op(cond->data.binop.op->type) : CLASP_NUM_MATH_OPS;
+    if (m >= CLB_EQ && m < CLASP_NUM_MATH_OPS
+        && !is_float(bytecode_class(type_promote(cond->data.binop.left->exprType->type, cond->data.binop.right->exprType->type)))) {
+        ClaspASTNode *left = cond->data.binop.left, *right = cond->data.binop.right;
+        if (!when) m = invert(m); // Integers have no unordered results, so this is exact
+        if (is_int_literal(right) && literal(right) == (int16_t) literal(right)) {
+            at = emit(e, (ClaspRegInst) { ROP_JCMPK, m, expr(e, left), (uint16_t) literal(right) });
+        } else {
+            uint32_t a = first_operand(e, left, class_of(left), right);
+            at = emit(e, (ClaspRegInst) { ROP_JCMP, m, a, expr(e, right) });
+        }
+    } else {
+        ClaspValueClass t = class_of(cond);
+        uint32_t r = expr(e, cond);
+        if (is_float(t)) {
+            uint32_t test = temp(e);
+            emit(e, (ClaspRegInst) { ROP_CONST, 0, test, .k = 0 });
+            emit(e, (ClaspRegInst) { t == CLB_F4 ? ROP_CMPF4 : ROP_CMPF8, CLB_NE, test, r, test });
+            r = test;
+        }
+        at = emit(e, (ClaspRegInst) { when ? ROP_JNZ : ROP_JZ, 0, r });
+    }
+    e->top = top;
+    return at;
+}
+
+// ---- Statements ----
+
+static void emit_stmt(Emitter *e, ClaspASTNode *node);
+
+/**
+ * Loops are rotated like the stack emitter's, so an iteration is the body and one conditional jump:
+ *   jmp cond; body: <body> <step>; cond: jcmp <cond> body
+*/
+static void emit_loop(Emitter *e, ClaspASTNode *cond, ClaspASTNode *body, ClaspASTNode *step) {
+    size_t skip = cond ? emit(e, (ClaspRegInst) { ROP_JMP }) : 0;
+    uint32_t top = here(e);
+    e->live = true; // Reached through the back edge
+    emit_stmt(e, body);
+    emit_stmt(e, step);
+    if (!cond) {
+        emit(e, (ClaspRegInst) { ROP_JMP, .k = top });
+        return;
+    }
+    patch(e, skip);
+    size_t back = branch(e, cond, true); // Grows the code, so it can move
+    e->m->code[back].k = top;
+}
+
+// An expression whose value nobody reads.
+static void effect(Emitter *e, ClaspASTNode *node) {
+    switch (node->type) {
+        case AST_EXPR_POSTFIX: postfix_to(e, node, NO_REG); break;
+        case AST_EXPR_FN_CALL: call_to(e, node, NO_REG); break;
+        case AST_EXPR_BINOP:
+            if (tktyp_is_assignment(node->data.binop.op->type)) {
+                binop_to(e, node, NO_REG);
+                break;
+            }
+            expr(e, node);
+            break;
+        default: expr(e, node); break;
+    }
+}
+
+static void emit_stmt(Emitter *e, ClaspASTNode *node) {
+    if (!node || !e->live || node->type == AST_FN_DECL_STMT) return; // Functions are emitted on their own
+
+    uint32_t top = e->top;
+    switch (node->type) {
+        case AST_BLOCK_STMT:
+            for (size_t i = 0; i < cvector_size(node->data.block_stmt.body); ++i) emit_stmt(e, node->data.block_stmt.body[i]);
+            break;
+        case AST_RETURN_STMT:
+            if (node->data.return_stmt.retval && e->ret != CLB_VOID) {
+                ClaspASTNode *retval = node->data.return_stmt.retval;
+                emit(e, (ClaspRegInst) { ROP_RETV, 0, operand(e, retval, e->ret) });
+            } else {
+                emit(e, (ClaspRegInst) { ROP_RET });
+            }
+            break;
+        case AST_VAR_DECL_STMT:
+        case AST_LET_DECL_STMT:
+        case AST_CONST_DECL_STMT: {
+            ClaspASTNode *init = node->data.var_decl_stmt.initializer;
+            ClaspSlot slot = node->data.var_decl_stmt.slot;
+            ClaspValueClass t = bytecode_class(node->data.var_decl_stmt.type);
+            if (bad_slot(e, node->data.var_decl_stmt.name, slot)) break;
+            uint32_t dst = slot.kind == CLASP_SLOT_LOCAL ? slot.index : temp(e);
+            if (init) expr_to_as(e, init, t, dst);
+            else emit(e, (ClaspRegInst) { ROP_CONST, 0, dst, .k = 0 });
+            if (slot.kind == CLASP_SLOT_GLOBAL) emit(e, (ClaspRegInst) { ROP_STOREG, 0, dst, .k = slot.index });
+            break;
+        }
+        case AST_IF_STMT: {
+            size_t skip = branch(e, node->data.cond_stmt.cond, false);
+            emit_stmt(e, node->data.cond_stmt.body);
+            patch(e, skip);
+            break;
+        }
+        case AST_WHILE_STMT: emit_loop(e, node->data.cond_stmt.cond, node->data.cond_stmt.body, NULL); break;
+        case AST_FOR_STMT:
+            emit_stmt(e, node->data.for_stmt.init);
+            emit_loop(e, node->data.for_stmt.cond, node->data.for_stmt.body, node->data.for_stmt.step);
+            break;
+        default: // Expression statements, and bare expressions such as for loop steps
+            effect(e, node->type == AST_EXPR_STMT ? node->data.expr_stmt.expr : node);
+            break;
+    }
+    e->top = top;
+}
+
+static void emit_fn(Emitter *e, ClaspRegFunction *fn, ClaspASTNode *body, uint32_t frame_size, ClaspValueClass ret) {
+    e->ret = ret;
+    e->live = true;
+    e->locals = e->top = e->registers = frame_size;
+    fn->entry = here(e);
+    emit_stmt(e, body);
+    if (e->live && ret == CLB_VOID) {
+        emit(e, (ClaspRegInst) { ROP_RET });
+    } else if (e->live) { // Falling off the end of a function that returns a value
+        uint32_t zero = temp(e);
+        emit(e, (ClaspRegInst) { ROP_CONST, 0, zero, .k = 0 });
+        emit(e, (ClaspRegInst) { ROP_RETV, 0, zero });
+    }
+    fn->size = here(e) - fn->entry;
+    fn->registers = e->registers;
+    fn->results = ret != CLB_VOID;
+    if (e->registers > UINT16_MAX) {
+        semantic_err(NULL, "'%s' needs %u registers, more than register code can address.", fn->name ? fn->name : "the top level", e->registers);
+        e->errors++;
+    }
+}
+
+ClaspRegModule *regcode_emit(ClaspASTNode *ast, ClaspResolution *res) {
+    ClaspRegModule *m = calloc(1, sizeof(ClaspRegModule));
+    Emitter e = { .m = m };
+    size_t nfns = cvector_size(res->fns);
+    for (size_t i = 0; i <= nfns; ++i) cvector_push_back(m->fns, (ClaspRegFunction) { 0 }); // The functions, then the entry point
+    m->start = nfns;
+    m->globals = cvector_size(res->globals);
+
+    emit_fn(&e, &m->fns[nfns], ast, res->frame_size, CLB_VOID);
+    for (size_t i = 0; i < nfns; ++i) {
+        ClaspASTNode *fn = res->fns[i];
+        const char *name = fn->data.fn_decl_stmt.name->data;
+        size_t repeats = 0; // Nested functions may reuse a name
+        for (size_t j = 0; j < i; ++j) repeats += !strcmp(res->fns[j]->data.fn_decl_stmt.name->data, name);
+        m->fns[i].name = malloc(strlen(name) + 24);
+        if (repeats) sprintf(m->fns[i].name, "%s.%zu", name, repeats);
+        else strcpy(m->fns[i].name, name);
+        m->fns[i].params = cvector_size(fn->data.fn_decl_stmt.args);
+
+        emit_fn(&e, &m->fns[i], fn->data.fn_decl_stmt.body, fn->data.fn_decl_stmt.frame_size,
+                bytecode_class(fn->exprType->type->data.function.ret));
+    }
+
+    if (e.errors) {
+        regcode_free(m);
+        return NULL;
+    }
+    return m;
+}
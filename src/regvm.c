@@ -0,0 +1,251 @@
+/**
+ * Clasp register VM implementation
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/regvm.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cvector/cvector.h>
+#include "vm_runtime.h"
+
+// ---- Interpreter ----
+
+static void trap(ClaspRegVM *vm, const ClaspRegVMInst *ip, const char *fmt, ...) {
+    int n = snprintf(vm->error, sizeof(vm->error), "at %td: ", ip - vm->code);
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(vm->error + n, sizeof(vm->error) - n, fmt, args);
+    va_end(args);
+}
+
+#define TRAP(...) do { trap(vm, ip, __VA_ARGS__); return false; } while (0)
+
+// Truncate an integer result to its class: translation leaves 64 minus the class's bits in `x`.
+#define NARROW(v) ((int64_t) ((uint64_t) (v) << ip->x) >> ip->x)
+
+static const void *const *regvm_threaded_labels;
+
+#if CLASP_VM_COMPUTED_GOTO
+#define REGVM_LOOP run_threaded
+#define REGVM_LOOP_THREADED 1
+#define REGVM_LOOP_PROFILE 0
+#include "regvm_loop.h"
+#undef REGVM_LOOP
+#undef REGVM_LOOP_THREADED
+#undef REGVM_LOOP_PROFILE
+#endif
+
+#define REGVM_LOOP run_switch
+#define REGVM_LOOP_THREADED 0
+#define REGVM_LOOP_PROFILE 0
+#include "regvm_loop.h"
+#undef REGVM_LOOP
+#undef REGVM_LOOP_THREADED
+#undef REGVM_LOOP_PROFILE
+
+#define REGVM_LOOP run_profile
+#define REGVM_LOOP_THREADED 0
+#define REGVM_LOOP_PROFILE 1
+#include "regvm_loop.h"
+#undef REGVM_LOOP
+#undef REGVM_LOOP_THREADED
+#undef REGVM_LOOP_PROFILE
+
+// ---- Symbols ----
+
+void regvm_define(ClaspRegVM *vm, const char *name, ClaspVMNativeFn fn, uint8_t argc, uint8_t results) {
+    for (size_t i = 0; i < cvector_size(vm->m->symbols); ++i)
+        if (!strcmp(vm->m->symbols[i], name)) vm->symbols[i] = (ClaspVMSymbol) { fn, 0, argc, results };
+}
+
+// ---- Translation ----
+
+static bool reject(ClaspRegVM *vm, size_t pc, const char *fmt, ...) {
+    int n = snprintf(vm->error, sizeof(vm->error), "invalid code at %zu: ", pc);
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(vm->error + n, sizeof(vm->error) - n, fmt, args);
+    va_end(args);
+    return false;
+}
+
+static const uint8_t NARROW_SHIFT[] = { [CLB_B] = 56, [CLB_W] = 48, [CLB_D] = 32, [CLB_Q] = 0 };
+
+/**
+ * Check one function's instructions against its frame and decode them into vm->code. Control never leaves a
+ * function except through calls and returns: jumps stay inside it and its last instruction doesn't fall through,
+ * so checking registers against the frame of the function they are in is enough.
+*/
+static bool translate_fn(ClaspRegVM *vm, size_t index) {
+    ClaspRegModule *m = vm->m;
+    ClaspRegFunction *fn = &m->fns[index];
+    size_t nfns = cvector_size(m->fns), ncode = cvector_size(m->code);
+    if (!fn->size || fn->entry > ncode || fn->size > ncode - fn->entry)
+        return reject(vm, fn->entry, "function %zu is outside the code", index);
+    if (fn->params > fn->registers) return reject(vm, fn->entry, "function %zu has more parameters than registers", index);
+
+    for (size_t pc = fn->entry; pc < fn->entry + fn->size; ++pc) {
+        ClaspRegInst *in = &m->code[pc];
+        ClaspRegVMInst *out = &vm->code[pc];
+        const char *operands = regcode_operands(in->op);
+        if (!operands) return reject(vm, pc, "unknown opcode %u", in->op);
+        *out = (ClaspRegVMInst) { .arg.i = in->k, .a = in->a, .b = in->b, .c = in->c, .op = in->op, .x = in->x };
+
+        for (const char *kind = operands; *kind; ++kind) {
+            switch (*kind) {
+                case 'i':
+                    if (in->x > CLB_Q) return reject(vm, pc, "%s of class %u", regcode_opcode_name(in->op), in->x);
+                    out->x = NARROW_SHIFT[in->x];
+                    break;
+                case 'f':
+                    if (in->x > CLB_F8) return reject(vm, pc, "%s of class %u", regcode_opcode_name(in->op), in->x);
+                    break;
+                case 'm':
+                    if (in->x > CLB_REM) return reject(vm, pc, "no float operation %u", in->x);
+                    break;
+                case 'o':
+                    if (in->x < CLB_EQ || in->x > CLB_GE) return reject(vm, pc, "no comparison %u", in->x);
+                    break;
+                case 'v':
+                    if ((in->x & 15) > CLB_F8 || in->x >> 4 > CLB_F8) return reject(vm, pc, "no conversion 0x%02x", in->x);
+                    break;
+                case '1': case '2': case '3': {
+                    uint16_t r = *kind == '1' ? in->a : *kind == '2' ? in->b : in->c;
+                    uint32_t span = strchr(operands, 'n') && *kind == '2' && in->x ? in->x : 1; // Call arguments
+                    if (r + span > fn->registers)
+                        return reject(vm, pc, "register r%u is outside a frame of %u", r + span - 1, fn->registers);
+                    break;
+                }
+                case 'K':
+                    if (!in->k && (in->op == ROP_DIVK || in->op == ROP_REMK)) return reject(vm, pc, "division by a constant zero");
+                    break;
+                case 'G':
+                    if ((uint64_t) in->k >= m->globals) return reject(vm, pc, "no global %" PRId64, in->k);
+                    break;
+                case 'T':
+                    if (in->k < fn->entry || in->k >= fn->entry + fn->size)
+                        return reject(vm, pc, "jump to %" PRId64 ", outside its function", in->k);
+                    out->arg.target = &vm->code[in->k];
+                    break;
+                case 'F':
+                    if ((uint64_t) in->k >= nfns) return reject(vm, pc, "no function %" PRId64, in->k);
+                    if (in->x != m->fns[in->k].params)
+                        return reject(vm, pc, "call passes %u arguments to a function of %u", in->x, m->fns[in->k].params);
+                    out->arg.fn = &vm->fns[in->k];
+                    break;
+                case 'S':
+                    if ((uint64_t) in->k >= cvector_size(m->symbols)) return reject(vm, pc, "no symbol %" PRId64, in->k);
+                    out->arg.sym = &vm->symbols[in->k];
+                    break;
+            }
+        }
+    }
+
+    uint8_t last = m->code[fn->entry + fn->size - 1].op;
+    if (last != ROP_JMP && last != ROP_RET && last != ROP_RETV)
+        return reject(vm, fn->entry + fn->size - 1, "function %zu runs off its end", index);
+    vm->fns[index] = (ClaspRegVMFunction) { &vm->code[fn->entry], fn->params, fn->registers };
+    return true;
+}
+
+bool regvm_init(ClaspRegVM *vm, ClaspRegModule *m) {
+    size_t ncode = cvector_size(m->code), nfns = cvector_size(m->fns), nsyms = cvector_size(m->symbols);
+    *vm = (ClaspRegVM) { .m = m, .dispatch = CLASP_VM_THREADED };
+    vm->code = calloc(ncode + 1, sizeof(ClaspRegVMInst));
+    vm->fns = calloc(nfns ? nfns : 1, sizeof(ClaspRegVMFunction));
+    vm->symbols = calloc(nsyms ? nsyms : 1, sizeof(ClaspVMSymbol));
+    vm->globals = calloc(m->globals ? m->globals : 1, sizeof(ClaspVMCell));
+    vm->stack = aligned_alloc(64, CLASP_VM_STACK_CELLS * sizeof(ClaspVMCell));
+    memset(vm->stack, 0, CLASP_VM_STACK_CELLS * sizeof(ClaspVMCell)); // Registers aren't cleared on entry
+    vm->frames = malloc(CLASP_VM_MAX_FRAMES * sizeof(ClaspRegVMFrame));
+    vm->profile = calloc(1, sizeof(ClaspRegVMProfile));
+
+    regvm_define(vm, "println", &native_println, 1, 0);
+    regvm_define(vm, "clasp_ipow", &native_ipow, 2, 1);
+    regvm_define(vm, "pow", &native_pow, 2, 1);
+    // Instructions no function covers stay sentinels
+    for (size_t pc = 0; pc <= ncode; ++pc) vm->code[pc].op = CLASP_REGVM_END;
+    for (size_t i = 0; i < nfns; ++i)
+        if (!translate_fn(vm, i)) return false;
+    if (m->start >= 0 && (uint64_t) m->start >= nfns) return reject(vm, 0, "no entry point %" PRId64, m->start);
+
+#if CLASP_VM_COMPUTED_GOTO
+    if (!regvm_threaded_labels) run_threaded(NULL, NULL, NULL);
+    for (size_t pc = 0; pc <= ncode; ++pc) vm->code[pc].handler = regvm_threaded_labels[vm->code[pc].op];
+#endif
+    return true;
+}
+
+void regvm_free(ClaspRegVM *vm) {
+    free(vm->code);
+    free(vm->fns);
+    free(vm->symbols);
+    free(vm->globals);
+    free(vm->stack);
+    free(vm->frames);
+    free(vm->profile);
+}
+
+bool regvm_call(ClaspRegVM *vm, uint64_t fn, ClaspVMCell *args, size_t argc, ClaspVMCell *result) {
+    vm->error[0] = '\0';
+    if (fn >= cvector_size(vm->m->fns)) {
+        snprintf(vm->error, sizeof(vm->error), "function %" PRIu64 " doesn't exist", fn);
+        return false;
+    }
+    const ClaspRegVMFunction *callee = &vm->fns[fn];
+    if (argc != callee->params) {
+        snprintf(vm->error, sizeof(vm->error), "%zu arguments for a function of %u", argc, callee->params);
+        return false;
+    }
+    if (callee->registers > CLASP_VM_STACK_CELLS) {
+        snprintf(vm->error, sizeof(vm->error), "stack overflow");
+        return false;
+    }
+    if (argc) memcpy(vm->stack, args, argc * sizeof(ClaspVMCell));
+    ClaspVMCell out = { 0 };
+    vm->frames[0] = (ClaspRegVMFrame) { NULL, NULL, &out };
+
+    bool ok;
+    switch (vm->dispatch) {
+#if CLASP_VM_COMPUTED_GOTO
+        case CLASP_VM_THREADED:
+        case CLASP_VM_CACHED:   ok = run_threaded(vm, callee->entry, vm->stack); break; // Registers need no cache
+#endif
+        case CLASP_VM_PROFILE:  ok = run_profile(vm, callee->entry, vm->stack); break;
+        default:                ok = run_switch(vm, callee->entry, vm->stack); break;
+    }
+    if (ok && result) *result = out;
+    return ok;
+}
+
+bool regvm_run(ClaspRegVM *vm) {
+    if (vm->m->start < 0) {
+        snprintf(vm->error, sizeof(vm->error), "the module is a library, it has no entry point");
+        return false;
+    }
+    return regvm_call(vm, vm->m->start, NULL, 0, NULL);
+}
@@ -0,0 +1,190 @@
+/**
+ * Clasp register VM interpreter loop
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * The interpreter loop, included by regvm.c once per dispatch style with these defined:
+ *  REGVM_LOOP            Name of the function
+ *  REGVM_LOOP_THREADED   1 to dispatch with computed goto, 0 for a switch
+ *  REGVM_LOOP_PROFILE    1 to count opcodes into vm->profile
+ * Runs from `ip` with the current frame at `fp`.
+ * The threaded loop called with a NULL vm publishes its handler labels in regvm_threaded_labels instead.
+*/
+
+static bool REGVM_LOOP(ClaspRegVM *vm, const ClaspRegVMInst *ip, ClaspVMCell *fp) {
+#if REGVM_LOOP_THREADED
+#define REGVM_LABEL_ENTRY(op, name, operands) [op] = &&L_##op,
+    static const void *const labels[CLASP_NUM_REG_OPCODES + 1] = {
+        CLASP_REG_OPCODES(REGVM_LABEL_ENTRY)
+        [CLASP_REGVM_END] = &&end_of_code
+    };
+#undef REGVM_LABEL_ENTRY
+    if (!vm) {
+        regvm_threaded_labels = labels;
+        return true;
+    }
+#endif
+    ClaspVMCell *const globals = vm->globals;
+    ClaspVMCell *const limit = vm->stack + CLASP_VM_STACK_CELLS;
+    ClaspRegVMFrame *frame = vm->frames, *const frames_end = vm->frames + CLASP_VM_MAX_FRAMES;
+    const size_t nfns = cvector_size(vm->m->fns);
+#if REGVM_LOOP_PROFILE
+    ClaspRegVMProfile *const profile = vm->profile;
+#define PROFILE() do {                                                              \
+        if (ip->op != CLASP_REGVM_END) {                                            \
+            profile->total++;                                                       \
+            profile->ops[ip->op]++;                                                 \
+        }                                                                           \
+    } while (0)
+#else
+#define PROFILE() ((void) 0)
+#endif
+
+#if REGVM_LOOP_THREADED
+#define NEXT() do { PROFILE(); goto *ip->handler; } while (0)
+#define CASE(op) L_##op:
+    NEXT();
+#else
+#define NEXT() goto dispatch
+#define CASE(op) case op:
+dispatch:
+    PROFILE();
+    switch (ip->op) {
+#endif
+
+#define R(field) fp[ip->field]
+#define K (ip->arg)
+
+    CASE(ROP_ADD)  { R(a).i = NARROW(R(b).u + R(c).u);              ip++; } NEXT();
+    CASE(ROP_SUB)  { R(a).i = NARROW(R(b).u - R(c).u);              ip++; } NEXT();
+    CASE(ROP_MUL)  { R(a).i = NARROW(R(b).u * R(c).u);              ip++; } NEXT();
+    CASE(ROP_DIV)  {
+        if (!R(c).i) TRAP("division by zero");
+        R(a).i = NARROW(int_math(CLB_DIV, R(b).i, R(c).i));
+        ip++;
+    } NEXT();
+    CASE(ROP_REM)  {
+        if (!R(c).i) TRAP("division by zero");
+        R(a).i = NARROW(int_math(CLB_REM, R(b).i, R(c).i));
+        ip++;
+    } NEXT();
+    CASE(ROP_SHL)  { R(a).i = NARROW(R(b).u << (R(c).u & 63));      ip++; } NEXT();
+    CASE(ROP_XOR)  { R(a).i = NARROW(R(b).u ^ R(c).u);              ip++; } NEXT();
+
+    CASE(ROP_ADDK) { R(a).i = NARROW(R(b).u + K.u);                 ip++; } NEXT();
+    CASE(ROP_SUBK) { R(a).i = NARROW(R(b).u - K.u);                 ip++; } NEXT();
+    CASE(ROP_MULK) { R(a).i = NARROW(R(b).u * K.u);                 ip++; } NEXT();
+    CASE(ROP_DIVK) { R(a).i = NARROW(int_math(CLB_DIV, R(b).i, K.i)); ip++; } NEXT();
+    CASE(ROP_REMK) { R(a).i = NARROW(int_math(CLB_REM, R(b).i, K.i)); ip++; } NEXT();
+    CASE(ROP_SHLK) { R(a).i = NARROW(R(b).u << (K.u & 63));         ip++; } NEXT();
+    CASE(ROP_XORK) { R(a).i = NARROW(R(b).u ^ K.u);                 ip++; } NEXT();
+
+    CASE(ROP_MATHF4) {
+        R(a) = vm_f4_cell((float) float_math(ip->x, vm_cell_f4(R(b)), vm_cell_f4(R(c))));
+        ip++;
+    } NEXT();
+    CASE(ROP_MATHF8) { R(a).f = float_math(ip->x, R(b).f, R(c).f);  ip++; } NEXT();
+    CASE(ROP_MATHF8K) {
+        R(a).f = float_math(ip->x, R(b).f, ((ClaspVMCell) { .i = K.i }).f);
+        ip++;
+    } NEXT();
+
+    CASE(ROP_CMP)   { R(a).i = COMPARE(ip->x, R(b).i, R(c).i);      ip++; } NEXT();
+    CASE(ROP_CMPF4) { R(a).i = COMPARE(ip->x, vm_cell_f4(R(b)), vm_cell_f4(R(c))); ip++; } NEXT();
+    CASE(ROP_CMPF8) { R(a).i = COMPARE(ip->x, R(b).f, R(c).f);      ip++; } NEXT();
+
+    CASE(ROP_NEG)  { R(a) = negate(R(b), ip->x);                    ip++; } NEXT();
+    CASE(ROP_NOT)  { R(a).i = NARROW(~R(b).u);                      ip++; } NEXT();
+    CASE(ROP_CONV) { R(a) = convert(R(b), ip->x & 15, ip->x >> 4);  ip++; } NEXT();
+
+    CASE(ROP_MOV)    { R(a) = R(b);                                 ip++; } NEXT();
+    CASE(ROP_CONST)  { R(a).i = K.i;                                ip++; } NEXT();
+    CASE(ROP_LOADG)  { R(a) = globals[K.u];                         ip++; } NEXT();
+    CASE(ROP_STOREG) { globals[K.u] = R(a);                         ip++; } NEXT();
+
+    CASE(ROP_JMP)   { ip = K.target; } NEXT();
+    CASE(ROP_JZ)    { ip = R(a).i ? ip + 1 : K.target; } NEXT();
+    CASE(ROP_JNZ)   { ip = R(a).i ? K.target : ip + 1; } NEXT();
+    CASE(ROP_JCMP)  { ip = COMPARE(ip->x, R(a).i, R(b).i) ? K.target : ip + 1; } NEXT();
+    CASE(ROP_JCMPK) { ip = COMPARE(ip->x, R(a).i, (int16_t) ip->b) ? K.target : ip + 1; } NEXT();
+
+    /**
+     * The callee's frame starts at the caller's first argument register, so the arguments are already in place.
+     * Frames are only as large as their registers, the one check a call needs is that the callee's fit.
+    */
+#define CALL(callee) do {                                                           \
+        const ClaspRegVMFunction *fn = (callee);                                    \
+        ClaspVMCell *base = fp + ip->b;                                             \
+        if (frame + 1 == frames_end) TRAP("call stack overflow");                   \
+        if ((uint64_t) (limit - base) < fn->registers) TRAP("stack overflow");      \
+        *++frame = (ClaspRegVMFrame) { ip + 1, fp, &R(a) };                         \
+        fp = base;                                                                  \
+        ip = fn->entry;                                                             \
+    } while (0)
+
+    CASE(ROP_CALL) { CALL(K.fn); } NEXT();
+    CASE(ROP_CALLI) {
+        uint64_t index = R(c).u;
+        if (index >= nfns) TRAP("call to %" PRIu64 ", which isn't a function", index);
+        if (ip->x != vm->fns[index].params) TRAP("call passes %u arguments to a function of %u", ip->x, vm->fns[index].params);
+        CALL(&vm->fns[index]);
+    } NEXT();
+    CASE(ROP_NATIVE) {
+        ClaspVMSymbol *sym = K.sym;
+        if (!sym->native) TRAP("undefined symbol");
+        if (ip->x != sym->argc) TRAP("symbol takes %u arguments, not %u", sym->argc, ip->x);
+        ClaspVMCell r = sym->native(fp + ip->b);
+        if (sym->results) R(a) = r;
+        ip++;
+    } NEXT();
+#undef CALL
+
+    CASE(ROP_RET) {
+        if (!frame->ret) return true;
+        ip = frame->ret;
+        fp = frame->fp;
+        frame--;
+    } NEXT();
+    CASE(ROP_RETV) {
+        *frame->result = R(a);
+        if (!frame->ret) return true;
+        ip = frame->ret;
+        fp = frame->fp;
+        frame--;
+    } NEXT();
+
+#undef R
+#undef K
+
+#if !REGVM_LOOP_THREADED
+    default: goto end_of_code;
+    }
+#endif
+
+end_of_code: // Checked code never gets here, every function ends with a jump or a return
+    TRAP("ran off the end of the code");
+#undef PROFILE
+#undef NEXT
+#undef CASE
+}
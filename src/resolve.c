@@ -0,0 +1,197 @@
+/**
+ * Clasp name resolution implementation
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/resolve.h>
+#include <clasp/scope.h>
+#include <clasp/walk.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cvector/cvector.h>
+#include <sheredom-hashmap/hashmap.h>
+
+/**
+ * What a bound name resolves to.
+*/
+typedef struct Binding {
+    ClaspSlot slot;
+    uint16_t level;                 // Function nesting level of the declaration, 0 for top level code
+} Binding;
+
+typedef struct Frame {
+    uint32_t next;                  // First free slot
+    uint32_t size;                  // Most slots used at once
+} Frame;
+
+typedef struct Resolver {
+    ClaspResolution *out;
+    ClaspScope scope;
+    cvector(Binding *) bindings;
+    hashmap_t builtins;             // Name -> builtin index + 1
+    Frame *frame;
+    uint16_t level;
+    unsigned int top;               // Scope depth of the top level block
+} Resolver;
+
+static ClaspSlot slot(ClaspSlotKind kind, uint32_t index) {
+    return (ClaspSlot) { kind, 0, index };
+}
+
+static void bind(Resolver *r, const char *name, ClaspSlot s) {
+    Binding *b = malloc(sizeof(Binding));
+    *b = (Binding) { s, r->level };
+    cvector_push_back(r->bindings, b);
+    scope_bind(&r->scope, name, NULL, 0, b);
+}
+
+static ClaspSlot local(Resolver *r) {
+    uint32_t index = r->frame->next++;
+    if (r->frame->next > r->frame->size) r->frame->size = r->frame->next;
+    return slot(CLASP_SLOT_LOCAL, index);
+}
+
+static void declare_fn(Resolver *r, ClaspASTNode *fn) {
+    fn->data.fn_decl_stmt.slot = slot(CLASP_SLOT_FN, cvector_size(r->out->fns));
+    cvector_push_back(r->out->fns, fn);
+    bind(r, fn->data.fn_decl_stmt.name->data, fn->data.fn_decl_stmt.slot);
+}
+
+static ClaspSlot lookup(Resolver *r, ClaspToken *name) {
+    ClaspBinding *binding = scope_lookup(&r->scope, name->data);
+    if (!binding) {
+        uintptr_t index = (uintptr_t) hashmap_get(&r->builtins, name->data, strlen(name->data));
+        if (!index) {
+            cvector_push_back(r->out->builtins, name);
+            index = cvector_size(r->out->builtins);
+            hashmap_put(&r->builtins, name->data, strlen(name->data), (void *) index);
+        }
+        return slot(CLASP_SLOT_BUILTIN, index - 1);
+    }
+    Binding *b = binding->value;
+    ClaspSlot s = b->slot;
+    if (s.kind == CLASP_SLOT_LOCAL && b->level != r->level) {
+        s.kind = CLASP_SLOT_OUTER;
+        s.depth = r->level - b->level;
+    }
+    return s;
+}
+
+static void *resolve_node(ClaspASTNode *node, void *args);
+
+static void resolve_block(Resolver *r, ClaspASTNode *block) {
+    uint32_t next = r->frame->next;
+    scope_push(&r->scope);
+        // Functions are visible to the whole block they're declared in, like in the type check
+    for (size_t i = 0; i < cvector_size(block->data.block_stmt.body); ++i) {
+        ClaspASTNode *stmt = block->data.block_stmt.body[i];
+        if (stmt && stmt->type == AST_FN_DECL_STMT) declare_fn(r, stmt);
+    }
+    ast_map_children(block, &resolve_node, r);
+    scope_pop(&r->scope);
+    r->frame->next = next; // The block's variables are dead, their slots can be reused
+}
+
+static void resolve_fn(Resolver *r, ClaspASTNode *fn) {
+    ClaspSlot s = fn->data.fn_decl_stmt.slot;
+    bool hoisted = s.kind == CLASP_SLOT_FN && s.index < cvector_size(r->out->fns) && r->out->fns[s.index] == fn;
+    if (!hoisted) declare_fn(r, fn); // Not directly in a block
+
+    Frame frame = { 0, 0 }, *outer = r->frame;
+    r->frame = &frame;
+    r->level++;
+    scope_push(&r->scope);
+    for (size_t i = 0; i < cvector_size(fn->data.fn_decl_stmt.args); ++i)
+        bind(r, fn->data.fn_decl_stmt.args[i]->name->data, local(r));
+    resolve_node(fn->data.fn_decl_stmt.body, r);
+    scope_pop(&r->scope);
+    r->level--;
+    r->frame = outer;
+    fn->data.fn_decl_stmt.frame_size = frame.size;
+}
+
+static void *resolve_node(ClaspASTNode *node, void *args) {
+    Resolver *r = args;
+    switch (node->type) {
+        case AST_EXPR_VAR_REF:
+            node->data.var_ref.slot = lookup(r, node->data.var_ref.varname);
+            break;
+        case AST_BLOCK_STMT:
+            resolve_block(r, node);
+            break;
+        case AST_VAR_DECL_STMT:
+        case AST_LET_DECL_STMT:
+        case AST_CONST_DECL_STMT: {
+            if (node->data.var_decl_stmt.initializer) resolve_node(node->data.var_decl_stmt.initializer, r); // Before the name is bound
+            ClaspSlot s;
+            if (r->level == 0 && r->scope.depth == r->top) {
+                s = slot(CLASP_SLOT_GLOBAL, cvector_size(r->out->globals));
+                cvector_push_back(r->out->globals, node);
+            } else {
+                s = local(r);
+            }
+            node->data.var_decl_stmt.slot = s;
+            bind(r, node->data.var_decl_stmt.name->data, s);
+            break;
+        }
+        case AST_FN_DECL_STMT:
+            resolve_fn(r, node);
+            break;
+        case AST_FOR_STMT: { // The init declaration belongs to the loop
+            uint32_t next = r->frame->next;
+            scope_push(&r->scope);
+            ast_map_children(node, &resolve_node, r);
+            scope_pop(&r->scope);
+            r->frame->next = next;
+            break;
+        }
+        default:
+            ast_map_children(node, &resolve_node, r);
+            break;
+    }
+    return node;
+}
+
+void ast_resolve(ClaspASTNode *ast, ClaspResolution *out) {
+    *out = (ClaspResolution) { NULL, NULL, NULL, 0 };
+    Frame frame = { 0, 0 };
+    Resolver r = { .out = out, .frame = &frame };
+    scope_init(&r.scope);
+    hashmap_create(16, &r.builtins);
+    r.top = r.scope.depth + 1; // The top level block's scope
+
+    if (ast) resolve_node(ast, &r);
+    out->frame_size = frame.size;
+
+    for (size_t i = 0; i < cvector_size(r.bindings); ++i) free(r.bindings[i]);
+    cvector_free(r.bindings);
+    scope_free(&r.scope);
+    hashmap_destroy(&r.builtins);
+}
+
+void resolution_free(ClaspResolution *res) {
+    cvector_free(res->globals);
+    cvector_free(res->fns);
+    cvector_free(res->builtins);
+    *res = (ClaspResolution) { NULL, NULL, NULL, 0 };
+}
@@ -0,0 +1,75 @@
+/**
+ * Clasp lexical scope implementation
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/scope.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cvector/cvector.h>
+
+void scope_init(ClaspScope *scope) {
+    hashmap_create(16, &scope->names);
+    scope->bindings = NULL;
+    scope->depth = 0;
+}
+
+void scope_free(ClaspScope *scope) {
+    for (size_t i = 0; i < cvector_size(scope->bindings); ++i) free(scope->bindings[i]);
+    cvector_free(scope->bindings);
+    hashmap_destroy(&scope->names);
+}
+
+void scope_push(ClaspScope *scope) {
+    scope->depth++;
+}
+
+void scope_pop(ClaspScope *scope) {
+    while (cvector_size(scope->bindings)) {
+        ClaspBinding *b = scope->bindings[cvector_size(scope->bindings) - 1];
+        if (b->depth != scope->depth) break;
+
+        if (b->shadowed) hashmap_put(&scope->names, b->name, strlen(b->name), b->shadowed);
+        else hashmap_remove(&scope->names, b->name, strlen(b->name));
+        free(b);
+        cvector_pop_back(scope->bindings);
+    }
+    scope->depth--;
+}
+
+ClaspBinding *scope_bind(ClaspScope *scope, const char *name, ClaspASTNode *type, ClaspTypeFlag flag, void *value) {
+    ClaspBinding *b = malloc(sizeof(ClaspBinding));
+    b->name = name;
+    b->type = type;
+    b->flag = flag;
+    b->value = value;
+    b->depth = scope->depth;
+    b->shadowed = scope_lookup(scope, name);
+    hashmap_put(&scope->names, name, strlen(name), b);
+    cvector_push_back(scope->bindings, b);
+    return b;
+}
+
+ClaspBinding *scope_lookup(ClaspScope *scope, const char *name) {
+    return hashmap_get(&scope->names, name, strlen(name));
+}
@@ -0,0 +1,257 @@
+/**
+ * Clasp tail call elimination implementation
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/tce.h>
+#include <clasp/types.h>
+#include <clasp/walk.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <cvector/cvector.h>
+
+/**
+ * The function being rewritten.
+*/
+typedef struct Fn {
+    ClaspASTNode *fn;
+    ClaspASTNode *sig;          // The function's interned type
+    bool ok;                    // Whether the function can be rewritten
+    size_t calls;               // Tail calls found
+    bool flag;                  // Whether the rewrite needs __tce_again
+    ClaspToken *again;          // The flag's name
+    unsigned *next;             // Temporary counter, shared by the whole tree
+} Fn;
+
+static ClaspASTNode *typed(ClaspASTNode *node, ClaspASTNode *type) {
+    node->exprType->type = type;
+    return node;
+}
+
+static ClaspASTNode *int_lit(const char *value) {
+    return typed(lit_num(token_synth(TOKEN_NUMBER, value, NULL)), type_intern("int"));
+}
+
+static ClaspASTNode *assign(ClaspToken *name, ClaspASTNode *type, ClaspASTNode *value) {
+    ClaspASTNode *target = typed_var_ref(name, type, TYPE_MUTABLE);
+    return expr_stmt(typed(binop(target, value, token_synth(TOKEN_EQ, "=", name)), type));
+}
+
+static bool is_self_call(Fn *f, ClaspASTNode *expr) {
+    if (!expr || expr->type != AST_EXPR_FN_CALL) return false;
+    ClaspASTNode *ref = expr->data.fn_call.referencer;
+    return ref->type == AST_EXPR_VAR_REF && !strcmp(ref->data.var_ref.varname->data, f->fn->data.fn_decl_stmt.name->data);
+}
+
+static bool is_void(Fn *f) {
+    return type_size(f->sig->data.function.ret) == 0;
+}
+
+// The tail call a statement is, if any. `last` is whether nothing in the function runs after the statement.
+static ClaspASTNode *tail_call(Fn *f, ClaspASTNode *stmt, bool last) {
+    if (stmt->type == AST_RETURN_STMT && is_self_call(f, stmt->data.return_stmt.retval)) return stmt->data.return_stmt.retval;
+    if (stmt->type == AST_EXPR_STMT && last && is_void(f) && is_self_call(f, stmt->data.expr_stmt.expr)) return stmt->data.expr_stmt.expr;
+    return NULL;
+}
+
+static bool hides(Fn *f, ClaspToken *name) {
+    if (!strcmp(name->data, f->fn->data.fn_decl_stmt.name->data)) return true;
+    for (size_t i = 0; i < cvector_size(f->fn->data.fn_decl_stmt.args); ++i)
+        if (!strcmp(name->data, f->fn->data.fn_decl_stmt.args[i]->name->data)) return true;
+    return false;
+}
+
+// Find the tail calls and anything that rules the rewrite out.
+static void check(Fn *f, ClaspASTNode *stmt, bool last, bool in_loop) {
+    if (!stmt) return;
+    if (tail_call(f, stmt, last)) {
+        f->calls++;
+        if (in_loop) f->ok = false; // Would need a break
+        if (!last) f->flag = true;
+        return;
+    }
+    switch (stmt->type) {
+        case AST_BLOCK_STMT: {
+            size_t n = cvector_size(stmt->data.block_stmt.body);
+            for (size_t i = 0; i < n; ++i) check(f, stmt->data.block_stmt.body[i], last && i + 1 == n, in_loop);
+            break;
+        }
+        case AST_IF_STMT:    check(f, stmt->data.cond_stmt.body, last, in_loop); break;
+        case AST_WHILE_STMT: check(f, stmt->data.cond_stmt.body, false, true); break;
+        case AST_FOR_STMT:
+            check(f, stmt->data.for_stmt.init, false, in_loop);
+            check(f, stmt->data.for_stmt.body, false, true);
+            break;
+        case AST_VAR_DECL_STMT:
+        case AST_LET_DECL_STMT:
+        case AST_CONST_DECL_STMT:
+            if (hides(f, stmt->data.var_decl_stmt.name)) f->ok = false;
+            break;
+        case AST_FN_DECL_STMT: f->ok = false; break;
+        default: break;
+    }
+}
+
+// Whether control can reach the end of a statement. Loops are assumed to exit.
+static bool falls_through(ClaspASTNode *stmt) {
+    if (!stmt) return true;
+    switch (stmt->type) {
+        case AST_RETURN_STMT: return false;
+        case AST_BLOCK_STMT:
+            for (size_t i = 0; i < cvector_size(stmt->data.block_stmt.body); ++i)
+                if (!falls_through(stmt->data.block_stmt.body[i])) return false;
+            return true;
+        default: return true;
+    }
+}
+
+// `{ let t = a; ...; p = t; ...; __tce_again = 1; }`, where only parameters that change are assigned.
+static ClaspASTNode *rebind(Fn *f, ClaspASTNode *call) {
+    cvector(struct ClaspArg *) params = f->fn->data.fn_decl_stmt.args;
+    cvector(ClaspASTNode *) args = call->data.fn_call.args;
+    cvector(size_t) changed = NULL;
+    for (size_t i = 0; i < cvector_size(args); ++i) {
+        ClaspASTNode *arg = args[i];
+        if (arg->type == AST_EXPR_VAR_REF && !strcmp(arg->data.var_ref.varname->data, params[i]->name->data)) continue;
+        cvector_push_back(changed, i);
+    }
+
+    cvector(ClaspASTNode *) out = NULL;
+    unsigned id = (*f->next)++;
+    if (cvector_size(changed) == 1) { // Nothing else reads the old value
+        size_t i = changed[0];
+        cvector_push_back(out, assign(params[i]->name, f->sig->data.function.args[i], args[i]));
+    } else {
+        cvector(ClaspToken *) temps = NULL;
+        for (size_t j = 0; j < cvector_size(changed); ++j) {
+            size_t i = changed[j];
+            char name[256];
+            snprintf(name, sizeof(name), CLASP_TCE_PREFIX "%u_%s", id, params[i]->name->data);
+            ClaspToken *tok = token_synth(TOKEN_ID, name, params[i]->name);
+            cvector_push_back(out, let_decl(tok, f->sig->data.function.args[i], args[i]));
+            cvector_push_back(temps, tok);
+        }
+        for (size_t j = 0; j < cvector_size(changed); ++j) {
+            size_t i = changed[j];
+            ClaspASTNode *type = f->sig->data.function.args[i];
+            cvector_push_back(out, assign(params[i]->name, type, typed_var_ref(temps[j], type, TYPE_IMMUTABLE)));
+        }
+        cvector_free(temps);
+    }
+    if (f->flag) cvector_push_back(out, assign(f->again, type_intern("int"), int_lit("1")));
+    cvector_free(changed);
+    return block_stmt(out);
+}
+
+static ClaspASTNode *not_again(Fn *f) {
+    ClaspASTNode *ref = typed_var_ref(f->again, type_intern("int"), TYPE_MUTABLE);
+    return typed(unop(ref, token_synth(TOKEN_BANG, "!", NULL)), type_intern("int"));
+}
+
+static bool has_tail_call(Fn *f, ClaspASTNode *stmt, bool last);
+
+static ClaspASTNode *rewrite(Fn *f, ClaspASTNode *stmt, bool last) {
+    if (!stmt) return NULL;
+    ClaspASTNode *call = tail_call(f, stmt, last);
+    if (call) return rebind(f, call);
+
+    switch (stmt->type) {
+        case AST_BLOCK_STMT: { // Once a tail call may have run, the rest of the block only runs if it didn't
+            cvector(ClaspASTNode *) body = stmt->data.block_stmt.body;
+            cvector(ClaspASTNode *) out = NULL;
+            cvector(ClaspASTNode *) *into = &out;
+            size_t n = cvector_size(body);
+            for (size_t i = 0; i < n; ++i) {
+                bool is_last = last && i + 1 == n;
+                bool guard = f->flag && has_tail_call(f, body[i], is_last) && i + 1 < n;
+                cvector_push_back(*into, rewrite(f, body[i], is_last));
+                if (!guard) continue;
+                ClaspASTNode *rest = block_stmt(NULL);
+                cvector_push_back(*into, if_stmt(not_again(f), rest));
+                into = &rest->data.block_stmt.body;
+            }
+            cvector_free(body);
+            stmt->data.block_stmt.body = out;
+            return stmt;
+        }
+        case AST_IF_STMT:
+            stmt->data.cond_stmt.body = rewrite(f, stmt->data.cond_stmt.body, last);
+            return stmt;
+        default: return stmt;
+    }
+}
+
+static bool has_tail_call(Fn *f, ClaspASTNode *stmt, bool last) {
+    if (!stmt) return false;
+    if (tail_call(f, stmt, last)) return true;
+    switch (stmt->type) {
+        case AST_BLOCK_STMT: {
+            size_t n = cvector_size(stmt->data.block_stmt.body);
+            for (size_t i = 0; i < n; ++i)
+                if (has_tail_call(f, stmt->data.block_stmt.body[i], last && i + 1 == n)) return true;
+            return false;
+        }
+        case AST_IF_STMT: return has_tail_call(f, stmt->data.cond_stmt.body, last);
+        default: return false;
+    }
+}
+
+static void eliminate(ClaspASTNode *fn, unsigned *next) {
+    Fn f = { .fn = fn, .sig = fn->exprType ? fn->exprType->type : NULL, .ok = true, .next = next };
+    if (!f.sig || f.sig->type != AST_TYPE_FN) return; // Not type checked
+    ClaspASTNode *body = fn->data.fn_decl_stmt.body;
+    check(&f, body, true, false);
+    if (!f.ok || !f.calls) return;
+
+    bool fall = falls_through(body);
+    if (fall && !is_void(&f)) return;
+    if (fall) f.flag = true;
+
+    if (f.flag) {
+        char name[32];
+        snprintf(name, sizeof(name), CLASP_TCE_PREFIX "%u_again", (*next)++);
+        f.again = token_synth(TOKEN_ID, name, fn->data.fn_decl_stmt.name);
+    }
+
+    cvector(ClaspASTNode *) loop = NULL;
+    if (f.flag) cvector_push_back(loop, var_decl(f.again, type_intern("int"), int_lit("0")));
+    cvector_push_back(loop, rewrite(&f, body, true));
+    if (fall) cvector_push_back(loop, if_stmt(not_again(&f), return_stmt(NULL)));
+
+    cvector(ClaspASTNode *) out = NULL;
+    cvector_push_back(out, while_stmt(int_lit("1"), block_stmt(loop)));
+    fn->data.fn_decl_stmt.body = block_stmt(out);
+}
+
+static void *tce_node(ClaspASTNode *node, void *args) {
+    ast_map_children(node, &tce_node, args);
+    if (node->type == AST_FN_DECL_STMT) eliminate(node, args);
+    return node;
+}
+
+ClaspASTNode *ast_tce(ClaspASTNode *ast) {
+    if (!ast) return NULL;
+    unsigned next = 0;
+    return tce_node(ast, &next);
+}
@@ -0,0 +1,386 @@
+/**
+ * Clasp static type checker implementation
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/typecheck.h>
+#include <clasp/types.h>
+#include <clasp/scope.h>
+#include <clasp/static_visitor.h>
+#include <clasp/err.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <cvector/cvector.h>
+
+typedef struct Checker {
+    ClaspScope scope;
+    bool in_fn;
+    ClaspASTNode *ret; // Return type of the function being checked.
+    int errors;
+} Checker;
+
+#define TYPE_ERR(c, tok, ...) do { semantic_err(tok, __VA_ARGS__); (c)->errors++; } while (0)
+
+static ClaspBinding *lookup(Checker *c, const char *name) {
+    return scope_lookup(&c->scope, name);
+}
+
+static void bind(Checker *c, const char *name, ClaspASTNode *type, ClaspTypeFlag flag) {
+    scope_bind(&c->scope, name, type, flag, NULL);
+}
+
+// A token to report errors on for an expression, NULL if there is none.
+static ClaspToken *node_token(ClaspASTNode *node) {
+    if (!node) return NULL;
+    switch (node->type) {
+        case AST_EXPR_BINOP:      return node->data.binop.op;
+        case AST_EXPR_UNOP:       return node->data.unop.op;
+        case AST_EXPR_POSTFIX:    return node->data.postfix.op;
+        case AST_EXPR_LIT_NUMBER: return node->data.lit_num.value;
+        case AST_EXPR_VAR_REF:    return node->data.var_ref.varname;
+        case AST_EXPR_FN_CALL:    return node_token(node->data.fn_call.referencer);
+        default:                  return NULL;
+    }
+}
+
+static bool is_numeric(ClaspASTNode *type) {
+    return type_is_integer(type) || type_is_float(type);
+}
+
+// Numbers convert implicitly between each other, anything else must match exactly.
+static bool assignable(ClaspASTNode *to, ClaspASTNode *from) {
+    return to == from || (is_numeric(to) && is_numeric(from));
+}
+
+static ClaspASTNode *cache(ClaspASTNode *node, ClaspASTNode *type) {
+    if (!node->exprType) {
+        node->exprType = malloc(sizeof(struct ClaspType));
+        node->exprType->flag = TYPE_IMMUTABLE;
+    }
+    node->exprType->type = type;
+    return type;
+}
+
+// Check that an interned type only names types that exist.
+static bool type_known(ClaspASTNode *type) {
+    if (!type) return false;
+    if (type->type == AST_TYPE_FN) {
+        for (size_t i = 0; i < cvector_size(type->data.function.args); ++i)
+            if (!type_known(type->data.function.args[i])) return false;
+        return type_known(type->data.function.ret);
+    }
+    return type_primitive(type) != NULL;
+}
+
+// Intern a written type, reporting it if it names something that doesn't exist.
+static ClaspASTNode *resolve(Checker *c, ClaspASTNode *written, bool report) {
+    if (!written) return NULL;
+    ClaspASTNode *type = type_resolve(written);
+    if (type_known(type)) return type;
+    if (report) {
+        if (written->type == AST_TYPE_SINGLE) TYPE_ERR(c, written->data.single.name, "Unknown type '%s'.", type_name(type));
+        else if (!type)                       TYPE_ERR(c, NULL, "Array, template and pointer types aren't supported.");
+        else                                  TYPE_ERR(c, NULL, "Unknown or unsupported type '%s'.", type_name(type));
+    }
+    return NULL;
+}
+
+static ClaspASTNode *signature(Checker *c, ClaspASTNode *fn, bool report) {
+    cvector(ClaspASTNode *) args = NULL;
+    for (size_t i = 0; i < cvector_size(fn->data.fn_decl_stmt.args); ++i)
+        cvector_push_back(args, resolve(c, fn->data.fn_decl_stmt.args[i]->type, report));
+    ClaspASTNode *type = type_intern_fn(args, resolve(c, fn->data.fn_decl_stmt.ret_type, report));
+    cvector_free(args);
+    return type;
+}
+
+CLASP_STATIC_VISITOR(check, check)
+
+// Check that `target` names a mutable variable, for assignments and ++/--.
+static void check_lvalue(Checker *c, ClaspASTNode *target, ClaspToken *op) {
+    if (!target || target->type != AST_EXPR_VAR_REF) {
+        TYPE_ERR(c, op, "Operator '%s' needs a variable on its left.", op->data);
+    } else if (lookup(c, target->data.var_ref.varname->data) && !(target->exprType->flag & TYPE_MUTABLE)) {
+        TYPE_ERR(c, target->data.var_ref.varname, "Cannot modify immutable or const '%s'.", target->data.var_ref.varname->data);
+    }
+}
+
+static void *check_binop(ClaspASTNode *binop, void *args) {
+    Checker *c = args;
+    ClaspToken *op = binop->data.binop.op;
+    ClaspASTNode *lt = check(binop->data.binop.left,  c);
+    ClaspASTNode *rt = check(binop->data.binop.right, c);
+
+    if (tktyp_is_assignment(op->type)) check_lvalue(c, binop->data.binop.left, op);
+    if (!lt || !rt) return cache(binop, NULL);
+
+    if (op->type == TOKEN_EQ) {
+        if (!assignable(lt, rt)) TYPE_ERR(c, op, "Cannot assign a value of type '%s' to '%s'.", type_name(rt), type_name(lt));
+        return cache(binop, lt);
+    }
+
+    bool integral = op->type == TOKEN_PERC || op->type == TOKEN_PERC_EQ || op->type == TOKEN_TILDE_EQ || op->type == TOKEN_LESS_LESS;
+    if (integral ? !(type_is_integer(lt) && type_is_integer(rt)) : !(is_numeric(lt) && is_numeric(rt))) {
+        TYPE_ERR(c, op, "Operator '%s' expects %s operands, got '%s' and '%s'.",
+            op->data, integral ? "integer" : "numeric", type_name(lt), type_name(rt));
+        return cache(binop, NULL);
+    }
+
+    switch (op->type) {
+        case TOKEN_EQ_EQ:   case TOKEN_BANG_EQ:
+        case TOKEN_LESS:    case TOKEN_LESS_EQ:
+        case TOKEN_GREATER: case TOKEN_GREATER_EQ:
+            return cache(binop, type_intern("int"));
+        case TOKEN_LESS_LESS:
+            return cache(binop, lt);
+        default:
+            if (tktyp_is_assignment(op->type)) return cache(binop, lt);
+            return cache(binop, type_promote(lt, rt));
+    }
+}
+
+static void *check_unop(ClaspASTNode *unop, void *args) {
+    Checker *c = args;
+    ClaspToken *op = unop->data.unop.op;
+    ClaspASTNode *rt = check(unop->data.unop.right, c);
+    if (!rt) return cache(unop, NULL);
+
+    bool integral = op->type == TOKEN_TILDE;
+    if (integral ? !type_is_integer(rt) : !is_numeric(rt)) {
+        TYPE_ERR(c, op, "Operator '%s' expects %s operand, got '%s'.", op->data, integral ? "an integer" : "a numeric", type_name(rt));
+        return cache(unop, NULL);
+    }
+    return cache(unop, op->type == TOKEN_BANG ? type_intern("int") : rt);
+}
+
+static void *check_postfix(ClaspASTNode *post, void *args) {
+    Checker *c = args;
+    ClaspToken *op = post->data.postfix.op;
+    ClaspASTNode *lt = check(post->data.postfix.left, c);
+    check_lvalue(c, post->data.postfix.left, op);
+    if (!lt) return cache(post, NULL);
+
+    if (!is_numeric(lt)) {
+        TYPE_ERR(c, op, "Operator '%s' expects a numeric operand, got '%s'.", op->data, type_name(lt));
+        return cache(post, NULL);
+    }
+    return cache(post, lt);
+}
+
+static void *check_lit_num(ClaspASTNode *lit, void *args) {
+    return cache(lit, type_of_literal(lit->data.lit_num.value));
+}
+
+static void *check_var_ref(ClaspASTNode *var, void *args) {
+    Checker *c = args;
+    ClaspToken *name = var->data.var_ref.varname;
+    ClaspBinding *b = lookup(c, name->data);
+    if (!b) {
+        TYPE_ERR(c, name, "Unknown name '%s'.", name->data);
+        return cache(var, NULL);
+    }
+    cache(var, b->type);
+    var->exprType->flag = b->flag;
+    return b->type;
+}
+
+static void *check_fn_call(ClaspASTNode *call, void *args) {
+    Checker *c = args;
+    ClaspASTNode *ft = check(call->data.fn_call.referencer, c);
+    size_t argc = cvector_size(call->data.fn_call.args);
+    cvector(ClaspASTNode *) argtypes = NULL;
+    for (size_t i = 0; i < argc; ++i)
+        cvector_push_back(argtypes, check(call->data.fn_call.args[i], c));
+
+    ClaspASTNode *ret = NULL;
+    ClaspToken *tok = node_token(call);
+    if (!ft) {
+        // Already reported.
+    } else if (ft->type != AST_TYPE_FN) {
+        TYPE_ERR(c, tok, "Cannot call a value of type '%s'.", type_name(ft));
+    } else if (cvector_size(ft->data.function.args) != argc) {
+        TYPE_ERR(c, tok, "Function '%s' expects %zu arguments, got %zu.",
+            tok ? tok->data : "", cvector_size(ft->data.function.args), argc);
+    } else {
+        for (size_t i = 0; i < argc; ++i) {
+            ClaspASTNode *param = ft->data.function.args[i];
+            if (param && argtypes[i] && !assignable(param, argtypes[i]))
+                TYPE_ERR(c, node_token(call->data.fn_call.args[i]), "Argument %zu of '%s' expects '%s', got '%s'.",
+                    i + 1, tok ? tok->data : "", type_name(param), type_name(argtypes[i]));
+        }
+        ret = ft->data.function.ret;
+    }
+    cvector_free(argtypes);
+    return cache(call, ret);
+}
+
+static void *check_return_stmt(ClaspASTNode *stmt, void *args) {
+    Checker *c = args;
+    ClaspASTNode *retval = stmt->data.return_stmt.retval;
+    ClaspASTNode *t = check(retval, c);
+
+    if (!c->in_fn) {
+        TYPE_ERR(c, node_token(retval), "Return statement outside of a function.");
+    } else if (!c->ret || (retval && !t)) {
+        // Already reported.
+    } else if (type_size(c->ret) == 0 && retval) {
+        TYPE_ERR(c, node_token(retval), "Cannot return a value from a function returning void.");
+    } else if (type_size(c->ret) != 0 && !retval) {
+        TYPE_ERR(c, NULL, "Missing return value in a function returning '%s'.", type_name(c->ret));
+    } else if (retval && !assignable(c->ret, t)) {
+        TYPE_ERR(c, node_token(retval), "Cannot return a value of type '%s' from a function returning '%s'.",
+            type_name(t), type_name(c->ret));
+    }
+    return NULL;
+}
+
+static void *check_expr_stmt(ClaspASTNode *stmt, void *args) {
+    check(stmt->data.expr_stmt.expr, args);
+    return NULL;
+}
+
+static void *check_block_stmt(ClaspASTNode *block, void *args) {
+    Checker *c = args;
+    scope_push(&c->scope);
+
+        // Functions are visible to the whole block they're declared in, so they can be called before (or by) each other.
+    for (size_t i = 0; i < cvector_size(block->data.block_stmt.body); ++i) {
+        ClaspASTNode *stmt = block->data.block_stmt.body[i];
+        if (stmt && stmt->type == AST_FN_DECL_STMT)
+            bind(c, stmt->data.fn_decl_stmt.name->data, signature(c, stmt, false), TYPE_CONST);
+    }
+    for (size_t i = 0; i < cvector_size(block->data.block_stmt.body); ++i)
+        check(block->data.block_stmt.body[i], c);
+
+    scope_pop(&c->scope);
+    return NULL;
+}
+
+static void *check_var_decl(ClaspASTNode *var, void *args) {
+    Checker *c = args;
+    ClaspToken *name = var->data.var_decl_stmt.name;
+    ClaspASTNode *declared = resolve(c, var->data.var_decl_stmt.type, true);
+    ClaspASTNode *init = check(var->data.var_decl_stmt.initializer, c);
+
+    if (var->data.var_decl_stmt.type) {
+        if (declared && init && !assignable(declared, init))
+            TYPE_ERR(c, name, "Cannot initialize '%s' of type '%s' with a value of type '%s'.", name->data, type_name(declared), type_name(init));
+    } else if (!var->data.var_decl_stmt.initializer) {
+        TYPE_ERR(c, name, "Cannot infer the type of '%s' without an initializer.", name->data);
+    } else {
+        declared = init;
+        var->data.var_decl_stmt.type = init; // Inferred, backends see it as if it was written out.
+    }
+    if (declared && declared->type != AST_TYPE_FN && type_size(declared) == 0) {
+        TYPE_ERR(c, name, "Variable '%s' cannot have type '%s'.", name->data, type_name(declared));
+        declared = NULL;
+    }
+
+    ClaspTypeFlag flag = 0;
+    switch (var->type) {
+        case AST_VAR_DECL_STMT:   flag = TYPE_MUTABLE; break;
+        case AST_CONST_DECL_STMT: flag = TYPE_CONST;   break;
+        default: break;
+    }
+    bind(c, name->data, declared, flag);
+    return NULL;
+}
+
+static void *check_fn_decl(ClaspASTNode *fn, void *args) {
+    Checker *c = args;
+    ClaspASTNode *type = signature(c, fn, true);
+    cache(fn, type);
+    fn->exprType->flag = TYPE_CONST;
+
+    ClaspBinding *b = lookup(c, fn->data.fn_decl_stmt.name->data);
+    if (!b || b->depth != c->scope.depth) bind(c, fn->data.fn_decl_stmt.name->data, type, TYPE_CONST); // Not hoisted by a block.
+
+    bool in_fn = c->in_fn;
+    ClaspASTNode *ret = c->ret;
+    c->in_fn = true;
+    c->ret = type->data.function.ret;
+
+    scope_push(&c->scope);
+    for (size_t i = 0; i < cvector_size(fn->data.fn_decl_stmt.args); ++i)
+        bind(c, fn->data.fn_decl_stmt.args[i]->name->data, type->data.function.args[i], TYPE_MUTABLE);
+    check(fn->data.fn_decl_stmt.body, c);
+    scope_pop(&c->scope);
+
+    c->in_fn = in_fn;
+    c->ret = ret;
+    return NULL;
+}
+
+static void check_cond(Checker *c, ClaspASTNode *stmt) {
+    ClaspASTNode *ct = check(stmt->data.cond_stmt.cond, c);
+    if (ct && !is_numeric(ct))
+        TYPE_ERR(c, node_token(stmt->data.cond_stmt.cond), "Condition must be a number, got '%s'.", type_name(ct));
+    check(stmt->data.cond_stmt.body, c);
+}
+
+static void *check_if(ClaspASTNode *stmt, void *args) {
+    check_cond(args, stmt);
+    return NULL;
+}
+
+static void *check_while(ClaspASTNode *stmt, void *args) {
+    check_cond(args, stmt);
+    return NULL;
+}
+
+static void *check_for(ClaspASTNode *stmt, void *args) {
+    Checker *c = args;
+    scope_push(&c->scope); // The init declaration belongs to the loop
+    check(stmt->data.for_stmt.init, c);
+    ClaspASTNode *ct = check(stmt->data.for_stmt.cond, c);
+    if (ct && !is_numeric(ct))
+        TYPE_ERR(c, node_token(stmt->data.for_stmt.cond), "Condition must be a number, got '%s'.", type_name(ct));
+    check(stmt->data.for_stmt.step, c);
+    check(stmt->data.for_stmt.body, c);
+    scope_pop(&c->scope);
+    return NULL;
+}
+
+// Type nodes are only reached through resolve(), these keep the visitor total.
+static void *check_single_type(ClaspASTNode *type, void *args)   { return type_resolve(type); }
+static void *check_array_type(ClaspASTNode *type, void *args)    { return type_resolve(type); }
+static void *check_fn_type(ClaspASTNode *type, void *args)       { return type_resolve(type); }
+static void *check_template_type(ClaspASTNode *type, void *args) { return type_resolve(type); }
+static void *check_ptr_type(ClaspASTNode *type, void *args)      { return type_resolve(type); }
+
+int typecheck(ClaspASTNode *ast) {
+    Checker c = { 0 };
+    scope_init(&c.scope);
+    scope_push(&c.scope); // Built-ins
+
+    cvector(ClaspASTNode *) println_args = NULL;
+    cvector_push_back(println_args, type_intern("int"));
+    bind(&c, "println", type_intern_fn(println_args, type_intern("void")), TYPE_CONST);
+    cvector_free(println_args);
+
+    check(ast, &c);
+
+    scope_free(&c.scope);
+    return c.errors;
+}
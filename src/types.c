@@ -0,0 +1,153 @@
+/**
+ * Clasp interned type implementation
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/types.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cvector/cvector.h>
+#include <sheredom-hashmap/hashmap.h>
+
+static const ClaspPrimitive PRIMITIVES[] = {
+    { "void",   0, false },
+    { "byte",   1, false },
+    { "short",  2, false },
+    { "int",    4, false },
+    { "long",   8, false },
+    { "float",  4, true  },
+    { "double", 8, true  },
+};
+static const size_t N_PRIMITIVES = sizeof(PRIMITIVES) / sizeof(ClaspPrimitive);
+
+static hashmap_t *single_types = NULL;
+static hashmap_t *fn_types = NULL;
+
+static void types_init() {
+    if (single_types) return;
+    single_types = malloc(sizeof(hashmap_t));
+    fn_types = malloc(sizeof(hashmap_t));
+    hashmap_create(16, single_types);
+    hashmap_create(16, fn_types);
+}
+
+ClaspASTNode *type_intern(const char *name) {
+    types_init();
+    ClaspASTNode *type = hashmap_get(single_types, name, strlen(name));
+    if (type) return type;
+
+    ClaspToken *tok = calloc(1, sizeof(ClaspToken));
+    tok->data = malloc(strlen(name) + 1);
+    strcpy(tok->data, name);
+    tok->type = TOKEN_ID;
+    tok->line = "";
+    type = type_single(tok);
+    hashmap_put(single_types, tok->data, strlen(tok->data), type);
+    return type;
+}
+
+ClaspASTNode *type_intern_fn(cvector(ClaspASTNode *) args, ClaspASTNode *ret) {
+    types_init();
+    // The key is the list of component pointers, which are interned themselves.
+    size_t n = cvector_size(args) + 1;
+    ClaspASTNode **key = malloc(n * sizeof(ClaspASTNode *));
+    key[0] = ret;
+    for (size_t i = 1; i < n; ++i) key[i] = args[i - 1];
+
+    ClaspASTNode *type = hashmap_get(fn_types, key, n * sizeof(ClaspASTNode *));
+    if (type) {
+        free(key);
+        return type;
+    }
+
+    union ASTNodeData *data = malloc(sizeof(union ASTNodeData));
+    data->function.args = NULL;
+    for (size_t i = 1; i < n; ++i) cvector_push_back(data->function.args, key[i]);
+    data->function.ret = ret;
+    type = new_AST_node(AST_TYPE_FN, data);
+    hashmap_put(fn_types, key, n * sizeof(ClaspASTNode *), type); // key is owned by the map from here on
+    return type;
+}
+
+ClaspASTNode *type_resolve(ClaspASTNode *type) {
+    if (!type) return NULL;
+    switch (type->type) {
+        case AST_TYPE_SINGLE: return type_intern(type->data.single.name->data);
+        case AST_TYPE_FN: {
+            cvector(ClaspASTNode *) args = NULL;
+            for (size_t i = 0; i < cvector_size(type->data.function.args); ++i)
+                cvector_push_back(args, type_resolve(type->data.function.args[i]));
+            ClaspASTNode *out = type_intern_fn(args, type_resolve(type->data.function.ret));
+            cvector_free(args);
+            return out;
+        }
+        default: return NULL; // Array, template and pointer types have no semantics yet, see typecheck
+    }
+}
+
+const ClaspPrimitive *type_primitive(ClaspASTNode *type) {
+    if (!type || type->type != AST_TYPE_SINGLE) return NULL;
+    for (size_t i = 0; i < N_PRIMITIVES; ++i)
+        if (!strcmp(type->data.single.name->data, PRIMITIVES[i].name)) return &PRIMITIVES[i];
+    return NULL;
+}
+
+size_t type_size(ClaspASTNode *type) {
+    if (type && type->type == AST_TYPE_FN) return sizeof(void *);
+    const ClaspPrimitive *prim = type_primitive(type);
+    return prim ? prim->size : 0;
+}
+
+bool type_is_float(ClaspASTNode *type) {
+    const ClaspPrimitive *prim = type_primitive(type);
+    return prim && prim->is_float;
+}
+
+bool type_is_integer(ClaspASTNode *type) {
+    const ClaspPrimitive *prim = type_primitive(type);
+    return prim && !prim->is_float && prim->size > 0;
+}
+
+ClaspASTNode *type_promote(ClaspASTNode *a, ClaspASTNode *b) {
+    if (type_is_float(a) || type_is_float(b)) {
+        if (type_is_float(a) && type_size(a) == 8) return a;
+        if (type_is_float(b) && type_size(b) == 8) return b;
+        return type_intern("float");
+    }
+    return type_size(a) >= type_size(b) ? a : b;
+}
+
+ClaspASTNode *type_of_literal(ClaspToken *literal) {
+    if (strchr(literal->data, '.')) return type_intern("float");
+    return type_intern(strtoll(literal->data, NULL, 10) > INT32_MAX ? "long" : "int"); // Literals have no sign
+}
+
+const char *type_name(ClaspASTNode *type) {
+    if (!type) return "<unknown>";
+    switch (type->type) {
+        case AST_TYPE_SINGLE: return type->data.single.name->data;
+        case AST_TYPE_FN:     return "<function>";
+        default:              return "<type>";
+    }
+}
@@ -0,0 +1,637 @@
+/**
+ * Clasp bytecode VM implementation
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/jit.h>
+#include <clasp/vm.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cvector/cvector.h>
+#include "vm_runtime.h"
+#if CLASP_VM_HAS_NATIVE
+#include <sys/mman.h>
+#endif
+
+// ---- Interpreter ----
+
+static void trap(ClaspVM *vm, uint32_t offset, const char *fmt, ...) {
+    int n = snprintf(vm->error, sizeof(vm->error), "at %u: ", offset);
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(vm->error + n, sizeof(vm->error) - n, fmt, args);
+    va_end(args);
+}
+
+#define TRAP(...) do { trap(vm, ip->offset, __VA_ARGS__); return false; } while (0)
+
+#define NO_RETURN 0xFF  // An enter's result count when its function never returns
+
+#define INT_MATH(T) {                                                       \
+        if (!TOP.i && (ip->a == CLB_DIV || ip->a == CLB_REM)) TRAP("division by zero"); \
+        BINARY(CELL_I((T) int_math(ip->a, NOS.i, TOP.i)));                  \
+        ip++;                                                               \
+    } NEXT();
+
+static const void *const *vm_threaded_labels;
+static const void *const *vm_cached_labels;
+static const void *const *vm_jit_labels;
+
+#define CLASP_OP_LENGTH(op, name, operands, pops, pushes) [op] = 1,
+#define CLASP_SUPER_LENGTH(op, name, length) [op] = length,
+static const uint8_t op_length[CLASP_VM_NUM_OPS] = {
+    CLASP_OPCODES(CLASP_OP_LENGTH)
+    CLASP_VM_SUPERINSTRUCTIONS(CLASP_SUPER_LENGTH)
+};
+#undef CLASP_OP_LENGTH
+#undef CLASP_SUPER_LENGTH
+
+#if CLASP_VM_COMPUTED_GOTO
+#define VM_LOOP run_threaded
+#define VM_LOOP_THREADED 1
+#define VM_LOOP_PROFILE 0
+#define VM_LOOP_TOS 0
+#define VM_LOOP_JIT 0
+#define VM_LOOP_LABELS vm_threaded_labels
+#include "vm_loop.h"
+#undef VM_LOOP
+#undef VM_LOOP_THREADED
+#undef VM_LOOP_PROFILE
+#undef VM_LOOP_TOS
+#undef VM_LOOP_JIT
+#undef VM_LOOP_LABELS
+
+#define VM_LOOP run_cached
+#define VM_LOOP_THREADED 1
+#define VM_LOOP_PROFILE 0
+#define VM_LOOP_TOS 1
+#define VM_LOOP_JIT 0
+#define VM_LOOP_LABELS vm_cached_labels
+#include "vm_loop.h"
+#undef VM_LOOP
+#undef VM_LOOP_THREADED
+#undef VM_LOOP_PROFILE
+#undef VM_LOOP_TOS
+#undef VM_LOOP_JIT
+#undef VM_LOOP_LABELS
+
+#define VM_LOOP run_jit
+#define VM_LOOP_THREADED 1
+#define VM_LOOP_PROFILE 0
+#define VM_LOOP_TOS 1
+#define VM_LOOP_JIT 1
+#define VM_LOOP_LABELS vm_jit_labels
+#include "vm_loop.h"
+#undef VM_LOOP
+#undef VM_LOOP_THREADED
+#undef VM_LOOP_PROFILE
+#undef VM_LOOP_TOS
+#undef VM_LOOP_JIT
+#undef VM_LOOP_LABELS
+#endif
+
+#define VM_LOOP run_switch
+#define VM_LOOP_THREADED 0
+#define VM_LOOP_PROFILE 0
+#define VM_LOOP_TOS 0
+#define VM_LOOP_JIT 0
+#include "vm_loop.h"
+#undef VM_LOOP
+#undef VM_LOOP_THREADED
+#undef VM_LOOP_PROFILE
+#undef VM_LOOP_TOS
+#undef VM_LOOP_JIT
+
+#define VM_LOOP run_profile
+#define VM_LOOP_THREADED 0
+#define VM_LOOP_PROFILE 1
+#define VM_LOOP_TOS 0
+#define VM_LOOP_JIT 0
+#include "vm_loop.h"
+#undef VM_LOOP
+#undef VM_LOOP_THREADED
+#undef VM_LOOP_PROFILE
+#undef VM_LOOP_TOS
+#undef VM_LOOP_JIT
+
+// ---- Symbols ----
+
+// Symbols are updated in place, translated code holds on to them.
+static ClaspVMSymbol *define(ClaspVM *vm, const char *name, ClaspVMSymbol sym) {
+    ClaspVMSymbol *s = hashmap_get(&vm->symbols, name, strlen(name));
+    if (!s) {
+        s = malloc(sizeof(ClaspVMSymbol));
+        cvector_push_back(vm->_owned, s);
+        hashmap_put(&vm->symbols, name, strlen(name), s);
+    }
+    *s = sym;
+    return s;
+}
+
+void vm_define(ClaspVM *vm, const char *name, ClaspVMNativeFn fn, uint8_t argc, uint8_t results) {
+    define(vm, name, (ClaspVMSymbol) { fn, 0, argc, results });
+}
+
+// ---- Native code ----
+
+/**
+ * Copy the module's blobs for this platform into one mapping, which is made executable once they're all in, so
+ * asm can call them directly. Each starts on a 16 byte boundary.
+*/
+static bool load_natives(ClaspVM *vm) {
+    size_t count = cvector_size(vm->bc->natives);
+    vm->natives = calloc(count ? count : 1, sizeof(ClaspVMNativeFn));
+#if CLASP_VM_HAS_NATIVE
+    size_t size = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const ClaspBytecodeBlob *blob = bytecode_native_find(&vm->bc->natives[i], CLASP_VM_HOST_ARCH);
+        if (blob) size += (cvector_size(blob->code) + 15) & ~(size_t) 15;
+    }
+    if (!size) return true;
+    uint8_t *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED) {
+        snprintf(vm->error, sizeof(vm->error), "can't map %zu bytes of native code", size);
+        return false;
+    }
+    size_t at = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const ClaspBytecodeBlob *blob = bytecode_native_find(&vm->bc->natives[i], CLASP_VM_HOST_ARCH);
+        if (!blob || cvector_empty(blob->code)) continue;
+        memcpy(map + at, blob->code, cvector_size(blob->code));
+        vm->natives[i] = (ClaspVMNativeFn) (void *) (map + at);
+        at += (cvector_size(blob->code) + 15) & ~(size_t) 15;
+    }
+    vm->_native_map = map;
+    vm->_native_size = size;
+    if (mprotect(map, size, PROT_READ | PROT_EXEC)) {
+        snprintf(vm->error, sizeof(vm->error), "can't make native code executable");
+        return false;
+    }
+#endif
+    return true;
+}
+
+// ---- Translation ----
+
+static bool reject(ClaspVM *vm, size_t offset, const char *fmt, ...) {
+    int n = snprintf(vm->error, sizeof(vm->error), "invalid code at %zu: ", offset);
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(vm->error + n, sizeof(vm->error) - n, fmt, args);
+    va_end(args);
+    return false;
+}
+
+static bool valid_operand(char kind, uint64_t value, ClaspOpcode op) {
+    switch (kind) {
+        case 'o': return op == OP_CMPI || op == OP_CMPF4 || op == OP_CMPF8 ? value >= CLB_EQ && value <= CLB_GE
+                       : op == OP_MATHF4 || op == OP_MATHF8            ? value <= CLB_REM : value <= CLB_XOR;
+        case 'c': return op == OP_NOT ? value <= CLB_Q : value <= CLB_F8;
+        default:  return true;
+    }
+}
+
+/**
+ * Decode the module into vm->code. Everything that only depends on the code is checked here, once: opcodes,
+ * operands, jump and call targets, globals and symbol arities.
+*/
+static bool translate(ClaspVM *vm) {
+    ClaspBytecode *bc = vm->bc;
+    const uint8_t *code = bc->code;
+    size_t size = cvector_size(bc->code), nlabels = cvector_size(bc->atable), count = 0;
+    uint32_t *index = malloc((size + 1) * sizeof(uint32_t)); // Code offset -> instruction, UINT32_MAX mid-instruction
+    for (size_t pc = 0; pc <= size; ++pc) index[pc] = UINT32_MAX;
+
+    ClaspBytecodeInst inst;
+    for (size_t pc = 0; pc < size; pc += inst.size, ++count) {
+        if (!bytecode_decode(code, size, pc, &inst)) {
+            free(index);
+            return reject(vm, pc, code[pc] < CLASP_NUM_OPCODES ? "truncated instruction" : "invalid opcode %u", code[pc]);
+        }
+        index[pc] = count;
+    }
+    index[size] = count;
+    vm->code = calloc(count + 1, sizeof(ClaspVMInst));
+    vm->entries = calloc(nlabels ? nlabels : 1, sizeof(ClaspVMInst *));
+    for (size_t i = 0; i < nlabels; ++i)
+        if (index[bc->atable[i]] != UINT32_MAX && code[bc->atable[i]] == OP_ENTER) vm->entries[i] = &vm->code[index[bc->atable[i]]];
+
+    bool ok = true;
+    size_t n = 0;
+    for (size_t pc = 0; ok && pc < size; pc += inst.size, ++n) {
+        bytecode_decode(code, size, pc, &inst);
+        ClaspVMInst *out = &vm->code[n];
+        const ClaspOpcodeInfo *info = bytecode_opcode(inst.op);
+        *out = (ClaspVMInst) { .op = inst.op, .offset = pc };
+        for (size_t k = 0; info->operands[k] && info->operands[k] != 's'; ++k) {
+            if (valid_operand(info->operands[k], inst.args[k], inst.op)) continue;
+            ok = reject(vm, pc, "bad operand %" PRIu64 " for %s", inst.args[k], info->name);
+        }
+        if (!ok) break;
+
+        switch (inst.op) {
+            case OP_CONSTB: out->arg.i = (int8_t) inst.args[0]; break;
+            case OP_CONSTW: out->arg.i = (int16_t) inst.args[0]; break;
+            case OP_CONSTD: out->arg.i = (int32_t) inst.args[0]; break;
+            case OP_CONSTQ: out->arg.u = inst.args[0]; break;
+            case OP_CONSTK:
+                if (inst.args[0] >= cvector_size(bc->constants)) ok = reject(vm, pc, "no constant #%" PRIu64, inst.args[0]);
+                else out->arg.u = bc->constants[inst.args[0]];
+                break;
+            case OP_ENTER: out->arg.frame.size = inst.args[0]; break;
+            case OP_LOADG:
+            case OP_STOREG:
+                if (inst.args[0] >= bc->globals) ok = reject(vm, pc, "no global %" PRIu64, inst.args[0]);
+                out->arg.u = inst.args[0];
+                break;
+            case OP_JMP:
+            case OP_JZ:
+            case OP_JNZ:
+                if (inst.args[0] >= nlabels || index[bc->atable[inst.args[0]]] == UINT32_MAX)
+                    ok = reject(vm, pc, "jump to %" PRIu64 ", which isn't an instruction", inst.args[0]);
+                else out->arg.target = &vm->code[index[bc->atable[inst.args[0]]]];
+                break;
+            case OP_CALL:
+                if (inst.args[0] >= nlabels || !vm->entries[inst.args[0]])
+                    ok = reject(vm, pc, "call to %" PRIu64 ", which isn't a function", inst.args[0]);
+                else out->arg.target = vm->entries[inst.args[0]];
+                out->a = inst.args[1];
+                out->b = inst.args[2];
+                break;
+            case OP_JSYM: {
+                ClaspVMSymbol *sym = hashmap_get(&vm->symbols, inst.sym, strlen(inst.sym));
+                if (!sym) sym = define(vm, inst.sym, (ClaspVMSymbol) { NULL, UINT64_MAX, 0, 0 }); // vm_define() may fill it in
+                out->a = inst.args[0];
+                out->b = inst.args[1];
+                if (sym->addr != UINT64_MAX && !sym->native) { // A function of the module: call it directly
+                    if (!vm->entries[sym->addr]) ok = reject(vm, pc, "symbol %s isn't a function", inst.sym);
+                    out->op = OP_CALL;
+                    out->arg.target = vm->entries[sym->addr];
+                    break;
+                }
+                if (sym->native && sym->argc != inst.args[0])
+                    ok = reject(vm, pc, "%s takes %u arguments, not %" PRIu64, inst.sym, sym->argc, inst.args[0]);
+                else if (sym->native && sym->results != inst.args[1])
+                    ok = reject(vm, pc, "%s returns %u results, not %" PRIu64, inst.sym, sym->results, inst.args[1]);
+                out->arg.sym = sym;
+                break;
+            }
+            case OP_ASM: { // Without a blob for this platform, the stub is a call to the fallback
+                out->a = inst.args[1];
+                out->b = inst.args[2];
+                if (inst.args[0] >= cvector_size(bc->natives)) {
+                    ok = reject(vm, pc, "no native code #%" PRIu64, inst.args[0]);
+                    break;
+                }
+                int64_t fallback = bc->natives[inst.args[0]].fallback;
+                if (vm->natives[inst.args[0]]) {
+                    out->arg.native = vm->natives[inst.args[0]];
+                } else if (fallback >= 0 && (uint64_t) fallback < nlabels && vm->entries[fallback]) {
+                    out->op = OP_CALL;
+                    out->arg.target = vm->entries[fallback];
+                } else {
+                    ok = reject(vm, pc, "native code #%" PRIu64 " has no %s code and no fallback", inst.args[0],
+                                bytecode_arch_name(CLASP_VM_HOST_ARCH));
+                }
+                break;
+            }
+            default:
+                out->a = inst.args[0];
+                out->b = inst.args[1];
+                out->arg.u = inst.args[0];
+                break;
+        }
+    }
+    vm->code[count] = (ClaspVMInst) { .op = CLASP_VM_END, .offset = size };
+
+    free(index);
+    return ok;
+}
+
+// ---- Verification ----
+
+/**
+ * Walk every function from its enter, following jumps, and check that each instruction always runs with the same
+ * operand stack depth, which never goes below the function's frame, that locals are inside the frame and that
+ * a function always returns the same number of results. Calls are checked against the enter of their target.
+ * The deepest operand stack of each function goes in its enter, which then makes sure the whole frame fits.
+ * Instructions no function reaches can never run, so they're left alone.
+*/
+static bool verify(ClaspVM *vm) {
+    ClaspVMInst *code = vm->code;
+    size_t count = 0;
+    while (code[count].op != CLASP_VM_END) count++;
+    int32_t *depth = malloc((count + 1) * sizeof(int32_t));            // Operand depth before each instruction, -1 if unreached
+    ClaspVMInst **owner = malloc((count + 1) * sizeof(ClaspVMInst *)); // Enter of the function each instruction is part of
+    for (size_t n = 0; n <= count; ++n) depth[n] = -1;
+    cvector(uint32_t) work = NULL;
+
+    bool ok = true;
+    for (size_t i = 0; ok && i < cvector_size(vm->bc->atable); ++i) {
+        ClaspVMInst *enter = (ClaspVMInst *) vm->entries[i];
+        if (!enter || depth[enter - code] >= 0) continue; // Not a function, or another address of one already done
+        enter->b = NO_RETURN;
+        int32_t deepest = 0;
+        depth[enter - code] = 0;
+        owner[enter - code] = enter;
+        cvector_push_back(work, enter - code);
+
+        while (ok && !cvector_empty(work)) {
+            uint32_t n = work[cvector_size(work) - 1];
+            cvector_pop_back(work);
+            ClaspVMInst *in = &code[n];
+            if (in->op == CLASP_VM_END) {
+                ok = reject(vm, in->offset, "runs off the end of the code");
+                break;
+            }
+            const ClaspOpcodeInfo *info = bytecode_opcode(in->op);
+            int32_t pops = info->pops, pushes = info->pushes;
+            switch (in->op) {
+                case OP_CALLI: pops = in->a + 1; pushes = in->b; break;
+                case OP_CALL:
+                case OP_JSYM:
+                case OP_ASM:   pops = in->a; pushes = in->b; break;
+                case OP_ENTER:
+                    if (in != enter) ok = reject(vm, in->offset, "runs into another function");
+                    break;
+                case OP_LOADL:
+                case OP_STOREL:
+                    if (in->arg.u >= enter->arg.frame.size) ok = reject(vm, in->offset, "no local slot %" PRIu64, in->arg.u);
+                    break;
+                case OP_RET:
+                case OP_RETV:
+                    if (enter->b != NO_RETURN && enter->b != (in->op == OP_RETV))
+                        ok = reject(vm, in->offset, "returns both with and without a value");
+                    enter->b = in->op == OP_RETV;
+                    break;
+                default: break;
+            }
+            if (info->pushes == CLB_VARIES && pushes > 1) ok = reject(vm, in->offset, "%s with %d results", info->name, pushes);
+            if (ok && depth[n] < pops) ok = reject(vm, in->offset, "stack underflow, %s needs %d cells and has %d", info->name, pops, depth[n]);
+            if (!ok) break;
+
+            int32_t after = depth[n] - pops + pushes;
+            if (after > deepest) deepest = after;
+            uint32_t next[2], nnext = 0;
+            switch (in->op) {
+                case OP_RET:
+                case OP_RETV: break;
+                case OP_JMP:  next[nnext++] = in->arg.target - code; break;
+                case OP_JZ:
+                case OP_JNZ:  next[nnext++] = in->arg.target - code; // Fall through
+                default:      next[nnext++] = n + 1; break;
+            }
+            for (uint32_t k = 0; ok && k < nnext; ++k) {
+                uint32_t m = next[k];
+                if (depth[m] < 0) {
+                    depth[m] = after;
+                    owner[m] = enter;
+                    cvector_push_back(work, m);
+                } else if (owner[m] != enter) {
+                    ok = reject(vm, code[m].offset, "reached from two functions");
+                } else if (depth[m] != after) {
+                    ok = reject(vm, code[m].offset, "stack depth is %d on one path and %d on another", depth[m], after);
+                }
+            }
+        }
+        if (enter->arg.frame.size + (uint64_t) deepest > CLASP_VM_STACK_CELLS)
+            ok = ok && reject(vm, enter->offset, "frame of %" PRIu64 " cells can't fit on the stack",
+                              enter->arg.frame.size + (uint64_t) deepest);
+        enter->arg.frame.room = enter->arg.frame.size + deepest;
+    }
+
+    // Direct calls, now that every function's enter is filled in
+    for (size_t n = 0; ok && n < count; ++n) {
+        ClaspVMInst *in = &code[n];
+        if (depth[n] < 0 || in->op != OP_CALL) continue;
+        const ClaspVMInst *callee = in->arg.target;
+        if (in->a > callee->arg.frame.size)
+            ok = reject(vm, in->offset, "call passes %u arguments to a frame of %u slots", in->a, callee->arg.frame.size);
+        else if (callee->b != NO_RETURN && callee->b != in->b)
+            ok = reject(vm, in->offset, "call expects %u results from a function that returns %u", in->b, callee->b);
+    }
+    for (size_t n = 0; n < count; ++n) code[n].depth = depth[n] < 0 ? 0 : depth[n] < UINT8_MAX ? depth[n] : UINT8_MAX;
+    cvector_free(work);
+    free(depth);
+    free(owner);
+    return ok;
+}
+
+// ---- Superinstructions ----
+
+#define CLASP_SUPER_NAME(op, name, length) [op - CLASP_NUM_OPCODES] = name,
+static const char *const SUPER_NAMES[] = { CLASP_VM_SUPERINSTRUCTIONS(CLASP_SUPER_NAME) };
+#undef CLASP_SUPER_NAME
+
+const char *vm_op_name(uint8_t op) {
+    if (op < CLASP_NUM_OPCODES) return bytecode_opcode(op)->name;
+    return op < CLASP_VM_END ? SUPER_NAMES[op - CLASP_NUM_OPCODES] : "end";
+}
+
+static bool is_const(uint8_t op) {
+    return op >= OP_CONSTB && op <= OP_CONSTK;
+}
+
+static bool is_jcc(uint8_t op) {
+    return op == OP_JZ || op == OP_JNZ;
+}
+
+// Integer math by a constant, unless it divides by zero, which is left to trap
+static bool fuses_math(const ClaspVMInst *k, const ClaspVMInst *math) {
+    return is_const(k->op) && math->op >= OP_MATHBB && math->op <= OP_MATHQQ &&
+           (k->arg.i || (math->a != CLB_DIV && math->a != CLB_REM));
+}
+
+// The class an integer math opcode truncates its result to, the wider of its operands
+static uint8_t math_class(uint8_t op) {
+    uint8_t a = (op - OP_MATHBB) / 4, b = (op - OP_MATHBB) % 4;
+    return a > b ? a : b;
+}
+
+/**
+ * Fuse runs of verified instructions into superinstructions (see CLASP_VM_SUPERINSTRUCTIONS). Only the first
+ * instruction of a run may be reached from anywhere but the one before it.
+*/
+static void fuse(ClaspVM *vm) {
+    ClaspVMInst *code = vm->code;
+    size_t count = 0;
+    while (code[count].op != CLASP_VM_END) count++;
+    bool *target = calloc(count + 1, sizeof(bool));
+    for (size_t n = 0; n < count; ++n) {
+        uint8_t op = code[n].op;
+        if (op == OP_JMP || is_jcc(op) || op == OP_CALL) target[code[n].arg.target - code] = true;
+        if (op == OP_ENTER) target[n] = true; // calli and vm_call() can get here too
+    }
+
+    for (size_t n = 0; n + 1 < count; ++n) {
+        ClaspVMInst *in = &code[n];
+        bool two = !target[n + 1], three = two && n + 2 < count && !target[n + 2];
+        if (three && is_const(in->op) && in[1].op == OP_CMPI && is_jcc(in[2].op)) {
+            in->op = in[2].op == OP_JZ ? OP_CMPKJZ : OP_CMPKJNZ;
+            in->a = in[1].a;
+            n += 2;
+        } else if (three && in->op == OP_LOADL && fuses_math(&in[1], &in[2])) {
+            in->op = OP_LOADLMATHK;
+            in->a = in[2].a;
+            in->b = math_class(in[2].op);
+            n += 2;
+        } else if (two && fuses_math(in, &in[1])) {
+            in->op = OP_MATHK;
+            in->a = in[1].a;
+            in->b = math_class(in[1].op);
+            n += 1;
+        } else if (two && is_const(in->op) && in[1].op == OP_MATHF8) {
+            in->op = OP_MATHF8K;
+            in->a = in[1].a;
+            n += 1;
+        } else if (two && in->op == OP_CMPI && is_jcc(in[1].op)) {
+            in->op = in[1].op == OP_JZ ? OP_CMPJZ : OP_CMPJNZ;
+            n += 1;
+        }
+    }
+    free(target);
+}
+
+// ---- VM ----
+
+bool vm_init(ClaspVM *vm, ClaspBytecode *bc) {
+    *vm = (ClaspVM) { .bc = bc, .dispatch = CLASP_VM_CACHED, .jit_threshold = CLASP_JIT_THRESHOLD };
+    vm->globals = calloc(bc->globals ? bc->globals : 1, sizeof(ClaspVMCell));
+    vm->stack = aligned_alloc(64, CLASP_VM_STACK_CELLS * sizeof(ClaspVMCell));
+    vm->frames = malloc(CLASP_VM_MAX_FRAMES * sizeof(ClaspVMFrame));
+    vm->profile = calloc(1, sizeof(ClaspVMProfile));
+    hashmap_create(16, &vm->symbols);
+    if (!vm->globals || !vm->stack || !vm->frames || !vm->profile) {
+        snprintf(vm->error, sizeof(vm->error), "out of memory for %" PRIu64 " globals and the stack", bc->globals);
+        return false;
+    }
+
+    vm_define(vm, "println", &native_println, 1, 0);
+    vm_define(vm, "clasp_ipow", &native_ipow, 2, 1);
+    vm_define(vm, "pow", &native_pow, 2, 1);
+    for (size_t i = 0; i < cvector_size(bc->symbols); ++i)
+        define(vm, bc->symbols[i].name, (ClaspVMSymbol) { NULL, bc->symbols[i].addr, 0, 0 });
+    if (!load_natives(vm) || !translate(vm) || !verify(vm)) return false;
+    fuse(vm);
+
+#if CLASP_VM_COMPUTED_GOTO
+    if (!vm_threaded_labels) {
+        run_threaded(NULL, NULL, NULL, NULL);
+        run_cached(NULL, NULL, NULL, NULL);
+        run_jit(NULL, NULL, NULL, NULL);
+    }
+#endif
+    return true;
+}
+
+#if CLASP_VM_COMPUTED_GOTO
+/**
+ * The second set of handlers of the loops that cache the top of the stack, for instructions that push onto an empty
+ * operand stack or pop its last cell, see vm_loop.h. This is the depth they run at to use it, plus one, 0 for instructions that have none.
+*/
+static const uint8_t edge_depth[CLASP_VM_NUM_OPS] = {
+    [OP_CONSTB] = 1, [OP_CONSTW] = 1, [OP_CONSTD] = 1, [OP_CONSTQ] = 1, [OP_CONSTK] = 1,
+    [OP_LOADL] = 1, [OP_LOADG] = 1, [OP_LOADLMATHK] = 1,
+    [OP_POP] = 2, [OP_STOREL] = 2, [OP_STOREG] = 2, [OP_JZ] = 2, [OP_JNZ] = 2, [OP_CMPKJZ] = 2, [OP_CMPKJNZ] = 2,
+    [OP_CMPJZ] = 3, [OP_CMPJNZ] = 3,
+};
+
+// Point every instruction at its handler in `labels`, the table of the threaded loop about to run.
+static void thread(ClaspVM *vm, const void *const *labels, bool tos) {
+    if (vm->_labels == labels) return;
+    for (ClaspVMInst *in = vm->code;; ++in) {
+        bool edge = tos && edge_depth[in->op] == in->depth + 1;
+        in->handler = labels[edge * CLASP_VM_NUM_OPS + in->op];
+        if (in->op == CLASP_VM_END) break;
+    }
+    vm->_labels = labels;
+}
+#endif
+
+void vm_free(ClaspVM *vm) {
+    for (size_t i = 0; i < cvector_size(vm->_owned); ++i) free(vm->_owned[i]);
+    cvector_free(vm->_owned);
+    hashmap_destroy(&vm->symbols);
+    free(vm->code);
+    free(vm->entries);
+    free(vm->globals);
+    free(vm->stack);
+    free(vm->frames);
+    free(vm->profile);
+    free(vm->natives);
+#if CLASP_VM_HAS_NATIVE
+    if (vm->_native_map) munmap(vm->_native_map, vm->_native_size);
+#endif
+    jit_free(vm->jit);
+}
+
+bool vm_call(ClaspVM *vm, uint64_t addr, ClaspVMCell *args, size_t argc, ClaspVMCell *result) {
+    vm->error[0] = '\0';
+    if (addr >= cvector_size(vm->bc->atable) || !vm->entries[addr]) {
+        snprintf(vm->error, sizeof(vm->error), "address %" PRIu64 " isn't a function", addr);
+        return false;
+    }
+    if (argc > vm->entries[addr]->arg.frame.size) {
+        snprintf(vm->error, sizeof(vm->error), "%zu arguments for a frame of %u slots", argc, vm->entries[addr]->arg.frame.size);
+        return false;
+    }
+    if (argc) memcpy(vm->stack, args, argc * sizeof(ClaspVMCell));
+    ClaspVMCell out = { 0 };
+    vm->frames[0] = (ClaspVMFrame) { NULL, NULL, &out };
+    const ClaspVMInst *ip = vm->entries[addr];
+
+    bool ok;
+    switch (vm->dispatch) {
+#if CLASP_VM_COMPUTED_GOTO
+        case CLASP_VM_THREADED:
+            thread(vm, vm_threaded_labels, false);
+            ok = run_threaded(vm, ip, vm->stack, vm->stack + argc);
+            break;
+        case CLASP_VM_CACHED:
+            thread(vm, vm_cached_labels, true);
+            ok = run_cached(vm, ip, vm->stack, vm->stack + argc);
+            break;
+        case CLASP_VM_JIT:
+            if (!vm->jit) vm->jit = jit_new(vm);
+            thread(vm, vm_jit_labels, true);
+            ok = run_jit(vm, ip, vm->stack, vm->stack + argc);
+            break;
+#endif
+        case CLASP_VM_PROFILE:  ok = run_profile(vm, ip, vm->stack, vm->stack + argc); break;
+        default:                ok = run_switch(vm, ip, vm->stack, vm->stack + argc); break;
+    }
+    if (ok && result) *result = out;
+    return ok;
+}
+
+bool vm_run(ClaspVM *vm) {
+    if (vm->bc->start < 0) {
+        snprintf(vm->error, sizeof(vm->error), "the module is a library, it has no start address");
+        return false;
+    }
+    return vm_call(vm, vm->bc->start, NULL, 0, NULL);
+}
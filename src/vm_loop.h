@@ -0,0 +1,389 @@
+/**
+ * Clasp bytecode VM interpreter loop
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * The interpreter loop, included by vm.c once per dispatch style with these defined:
+ *  VM_LOOP             Name of the function
+ *  VM_LOOP_THREADED    1 to dispatch with computed goto, 0 for a switch
+ *  VM_LOOP_PROFILE     1 to count opcodes and opcode pairs into vm->profile
+ *  VM_LOOP_TOS         1 to keep the top of the operand stack in a local instead of memory
+ *  VM_LOOP_JIT         1 to count calls and run functions compiled by the JIT, see clasp/jit.h
+ *  VM_LOOP_LABELS      Where a threaded loop publishes its handler labels
+ * Runs from `ip` with the current frame at `fp` and the arguments already in place below `sp`.
+ * A threaded loop called with a NULL vm publishes its handler labels in VM_LOOP_LABELS instead.
+*/
+
+static bool VM_LOOP(ClaspVM *vm, const ClaspVMInst *ip, ClaspVMCell *fp, ClaspVMCell *sp) {
+#if VM_LOOP_THREADED
+#define VM_LABEL_ENTRY(op, name, operands, pops, pushes) [op] = &&L_##op,
+#define VM_SUPER_LABEL_ENTRY(op, name, length) [op] = &&L_##op,
+    static const void *const labels[CLASP_VM_NUM_OPS * (1 + VM_LOOP_TOS)] = {
+        CLASP_OPCODES(VM_LABEL_ENTRY)
+        CLASP_VM_SUPERINSTRUCTIONS(VM_SUPER_LABEL_ENTRY)
+        [CLASP_VM_END] = &&end_of_code,
+#if VM_LOOP_TOS // The handlers at the bottom of the stack, see edge_depth in vm.c
+#define E(op) [CLASP_VM_NUM_OPS + op]
+        E(OP_CONSTB) = &&E_OP_CONSTK, E(OP_CONSTW) = &&E_OP_CONSTK, E(OP_CONSTD) = &&E_OP_CONSTK,
+        E(OP_CONSTQ) = &&E_OP_CONSTK, E(OP_CONSTK) = &&E_OP_CONSTK,
+        E(OP_LOADL) = &&E_OP_LOADL, E(OP_LOADG) = &&E_OP_LOADG, E(OP_LOADLMATHK) = &&E_OP_LOADLMATHK,
+        E(OP_POP) = &&E_OP_POP, E(OP_STOREL) = &&E_OP_STOREL, E(OP_STOREG) = &&E_OP_STOREG,
+        E(OP_JZ) = &&E_OP_JZ, E(OP_JNZ) = &&E_OP_JNZ, E(OP_CMPKJZ) = &&E_OP_CMPKJZ, E(OP_CMPKJNZ) = &&E_OP_CMPKJNZ,
+        E(OP_CMPJZ) = &&E_OP_CMPJZ, E(OP_CMPJNZ) = &&E_OP_CMPJNZ,
+#undef E
+#endif
+    };
+#undef VM_LABEL_ENTRY
+#undef VM_SUPER_LABEL_ENTRY
+    if (!vm) {
+        VM_LOOP_LABELS = labels;
+        return true;
+    }
+#endif
+    ClaspVMCell *const globals = vm->globals;
+    ClaspVMCell *const limit = vm->stack + CLASP_VM_STACK_CELLS;
+    ClaspVMFrame *frame = vm->frames, *const frames_end = vm->frames + CLASP_VM_MAX_FRAMES;
+#if VM_LOOP_PROFILE
+    ClaspVMProfile *const profile = vm->profile;
+    uint8_t last = CLASP_VM_END;
+#define PROFILE() do {                                                              \
+        if (ip->op != CLASP_VM_END) {                                               \
+            profile->total++;                                                       \
+            profile->instructions += op_length[ip->op];                             \
+            profile->ops[ip->op]++;                                                 \
+            if (last != CLASP_VM_END) profile->pairs[last][ip->op]++;               \
+            last = ip->op;                                                          \
+        }                                                                           \
+    } while (0)
+#else
+#define PROFILE() ((void) 0)
+#endif
+
+    /**
+     * Operand stack access. With VM_LOOP_TOS the top of the stack is `tos`, which the compiler keeps in a register,
+     * and `sp` is past the cell below it, so math reads one operand from memory and writes none. Pushing spills
+     * `tos` even when the stack is empty, which leaves a meaningless cell under every frame's operands for the pop
+     * that empties the stack to refill `tos` from; at a call, where `tos` is spilled too, that is one cell more
+     * than the verifier counted, so frames are entered with one cell more room.
+     *  TOP, NOS             The top and next cells
+     *  BELOW(n)             The cell `n` cells below the top
+     *  PUSH(v), DROP()      Push a cell, pop one
+     *  BINARY(v)            Pop two cells and push `v`, computed from TOP and NOS
+     *  SPILL()              Write the top to memory, for calls: the operands are all below `sp` after it
+     *  PUSH_SPILLED(v)      Push onto a stack whose top is in memory, after a call
+     *  FILL()               Reload the top of a stack that is all in memory, after a call
+    */
+#if VM_LOOP_TOS
+    ClaspVMCell tos = { 0 };
+#define TOP             tos
+#define NOS             sp[-1]
+#define BELOW(n)        ((n) ? sp[-(n)] : tos)
+#define PUSH(v)         do { ClaspVMCell pushed_ = (v); *sp++ = tos; tos = pushed_; } while (0)
+#define DROP()          (tos = *--sp)
+#define BINARY(v)       do { ClaspVMCell result_ = (v); sp--; tos = result_; } while (0)
+#define SPILL()         (*sp++ = tos)
+#define PUSH_SPILLED(v) (tos = (v))
+#define FILL()          (tos = *--sp)
+#else
+#define TOP             sp[-1]
+#define NOS             sp[-2]
+#define BELOW(n)        sp[-(n) - 1]
+#define PUSH(v)         do { ClaspVMCell pushed_ = (v); *sp++ = pushed_; } while (0)
+#define DROP()          (sp--)
+#define BINARY(v)       do { ClaspVMCell result_ = (v); sp[-2] = result_; sp--; } while (0)
+#define SPILL()         ((void) 0)
+#define PUSH_SPILLED(v) (*sp++ = (v))
+#define FILL()          ((void) 0)
+#endif
+#define CELL_I(v) ((ClaspVMCell) { .i = (v) })
+#define CELL_F(v) ((ClaspVMCell) { .f = (v) })
+
+// The checks of the jsym at `ip`, which can't be made before it runs as vm_define() may still change its symbol
+#define CHECK_SYMBOL() do {                                                                             \
+        const ClaspVMSymbol *checked_ = ip->arg.sym;                                                    \
+        if (!checked_->native) TRAP("undefined symbol");                                                \
+        if (ip->a != checked_->argc) TRAP("symbol takes %u arguments, not %u", checked_->argc, ip->a);  \
+        if (ip->b != checked_->results) TRAP("symbol returns %u results, not %u", checked_->results, ip->b); \
+    } while (0)
+
+#if VM_LOOP_THREADED
+#define NEXT() do { PROFILE(); goto *ip->handler; } while (0)
+#define CASE(op) L_##op:
+    NEXT();
+#else
+#define NEXT() goto dispatch
+#define CASE(op) case op:
+dispatch:
+    PROFILE();
+    switch (ip->op) {
+#endif
+
+    CASE(OP_MATHBB) INT_MATH(int8_t)
+    CASE(OP_MATHBW) INT_MATH(int16_t)
+    CASE(OP_MATHBD) INT_MATH(int32_t)
+    CASE(OP_MATHBQ) INT_MATH(int64_t)
+    CASE(OP_MATHWB) INT_MATH(int16_t)
+    CASE(OP_MATHWW) INT_MATH(int16_t)
+    CASE(OP_MATHWD) INT_MATH(int32_t)
+    CASE(OP_MATHWQ) INT_MATH(int64_t)
+    CASE(OP_MATHDB) INT_MATH(int32_t)
+    CASE(OP_MATHDW) INT_MATH(int32_t)
+    CASE(OP_MATHDD) INT_MATH(int32_t)
+    CASE(OP_MATHDQ) INT_MATH(int64_t)
+    CASE(OP_MATHQB) INT_MATH(int64_t)
+    CASE(OP_MATHQW) INT_MATH(int64_t)
+    CASE(OP_MATHQD) INT_MATH(int64_t)
+    CASE(OP_MATHQQ) INT_MATH(int64_t)
+
+    CASE(OP_MATHF4) {
+        BINARY(vm_f4_cell((float) float_math(ip->a, vm_cell_f4(NOS), vm_cell_f4(TOP))));
+        ip++;
+    } NEXT();
+    CASE(OP_MATHF8) { BINARY(CELL_F(float_math(ip->a, NOS.f, TOP.f)));                 ip++; } NEXT();
+
+    CASE(OP_CMPI)   { BINARY(CELL_I(COMPARE(ip->a, NOS.i, TOP.i)));                    ip++; } NEXT();
+    CASE(OP_CMPF4)  { BINARY(CELL_I(COMPARE(ip->a, vm_cell_f4(NOS), vm_cell_f4(TOP)))); ip++; } NEXT();
+    CASE(OP_CMPF8)  { BINARY(CELL_I(COMPARE(ip->a, NOS.f, TOP.f)));                    ip++; } NEXT();
+
+    CASE(OP_NEG)  { TOP = negate(TOP, ip->a);          ip++; } NEXT();
+    CASE(OP_NOT)  { TOP.i = narrow(~TOP.i, ip->a);     ip++; } NEXT();
+    CASE(OP_CONV) { TOP = convert(TOP, ip->a, ip->b);  ip++; } NEXT();
+
+    CASE(OP_CONSTB)
+    CASE(OP_CONSTW)
+    CASE(OP_CONSTD)
+    CASE(OP_CONSTQ)
+    CASE(OP_CONSTK) { PUSH(CELL_I(ip->arg.i)); ip++; } NEXT();
+
+    CASE(OP_POP) { DROP();    ip++; } NEXT();
+    CASE(OP_DUP) { PUSH(TOP); ip++; } NEXT();
+
+    CASE(OP_LOADL)  { PUSH(fp[ip->arg.u]);                 ip++; } NEXT();
+    CASE(OP_STOREL) { fp[ip->arg.u] = TOP; DROP();         ip++; } NEXT();
+    CASE(OP_LOADG)  { PUSH(globals[ip->arg.u]);            ip++; } NEXT();
+    CASE(OP_STOREG) { globals[ip->arg.u] = TOP; DROP();    ip++; } NEXT();
+
+    CASE(OP_JMP) { ip = ip->arg.target; } NEXT();
+    CASE(OP_JZ)  { int64_t c = TOP.i; DROP(); ip = c ? ip + 1 : ip->arg.target; } NEXT();
+    CASE(OP_JNZ) { int64_t c = TOP.i; DROP(); ip = c ? ip->arg.target : ip + 1; } NEXT();
+
+    /**
+     * Calls leave the arguments where they are, as the first slots of the callee's frame. `result` is read after
+     * the spill.
+    */
+#define CALL(entry, argc, result) do {                                              \
+        if (frame + 1 == frames_end) TRAP("call stack overflow");                   \
+        SPILL();                                                                    \
+        *++frame = (ClaspVMFrame) { ip + 1, fp, result };                           \
+        fp = sp - (argc);                                                           \
+        ip = entry;                                                                 \
+    } while (0)
+
+    CASE(OP_CALL) { CALL(ip->arg.target, ip->a, sp - ip->a); } NEXT();
+    CASE(OP_CALLI) {
+        uint8_t argc = ip->a;
+        uint64_t addr = BELOW(argc).u;
+        const ClaspVMInst *entry = addr < cvector_size(vm->bc->atable) ? vm->entries[addr] : NULL;
+        if (!entry) TRAP("call to %" PRIu64 ", which isn't a function", addr);
+        if (argc > entry->arg.frame.size) TRAP("call passes %u arguments to a frame of %u slots", argc, entry->arg.frame.size);
+        if (entry->b != ip->b && entry->b != NO_RETURN) TRAP("call expects %u results from a function that returns %u", ip->b, entry->b);
+        CALL(entry, argc, sp - argc - 1);
+    } NEXT();
+    CASE(OP_JSYM) {
+        ClaspVMSymbol *sym = ip->arg.sym;
+        uint8_t argc = ip->a;
+        CHECK_SYMBOL();
+        SPILL();
+        ClaspVMCell r = sym->native(sp - argc);
+        sp -= argc;
+        if (ip->b) PUSH_SPILLED(r);
+        else FILL();
+        ip++;
+    } NEXT();
+    CASE(OP_ASM) {
+        uint8_t argc = ip->a;
+        SPILL();
+        ClaspVMCell r = ip->arg.native(sp - argc);
+        sp -= argc;
+        if (ip->b) PUSH_SPILLED(r);
+        else FILL();
+        ip++;
+    } NEXT();
+#undef CALL
+
+    /**
+     * The only stack check: the verifier worked out how deep the frame's operand stack gets.
+    */
+    CASE(OP_ENTER) {
+#if VM_LOOP_JIT
+        /**
+         * Count the call, and once the function is compiled run it instead, then return from it like ret/retv.
+         * Traps in compiled code are reported from the instruction that trapped, as they would be here.
+        */
+        ClaspJitFunction *jf = &vm->jit->fns[ip - vm->code];
+        if (!jf->code && jf->calls < vm->jit_threshold && ++jf->calls == vm->jit_threshold) jit_compile(vm, ip);
+        if (jf->code) {
+            ClaspJitResult r = jf->code(fp, sp, frames_end - frame - 1);
+            if (r.trap) {
+                ip = vm->code + (r.trap >> 8);
+                switch (r.trap & 0xFF) {
+                    case CLASP_JIT_DIVISION: TRAP("division by zero");
+                    case CLASP_JIT_STACK:    TRAP("stack overflow");
+                    case CLASP_JIT_FRAMES:   TRAP("call stack overflow");
+                    default:                 CHECK_SYMBOL(); TRAP("undefined symbol");
+                }
+            }
+            bool value = ip->b == 1;
+            if (!frame->ret) {
+                if (value) *frame->result = r.value;
+                return true;
+            }
+            sp = frame->result;
+            if (value) PUSH_SPILLED(r.value);
+            else FILL();
+            ip = frame->ret;
+            fp = frame->fp;
+            frame--;
+            NEXT();
+        }
+#endif
+        if ((uint64_t) (limit - fp) < ip->arg.frame.room + VM_LOOP_TOS) TRAP("stack overflow");
+        ClaspVMCell *end = fp + ip->arg.frame.size;
+        for (ClaspVMCell *slot = sp; slot < end; ++slot) slot->i = 0;
+        sp = end;
+        ip++;
+    } NEXT();
+    CASE(OP_RET) {
+        if (!frame->ret) return true;
+        sp = frame->result;
+        FILL();
+        ip = frame->ret;
+        fp = frame->fp;
+        frame--;
+    } NEXT();
+    CASE(OP_RETV) {
+        ClaspVMCell value = TOP;
+        if (!frame->ret) {
+            *frame->result = value;
+            return true;
+        }
+        sp = frame->result;
+        PUSH_SPILLED(value);
+        ip = frame->ret;
+        fp = frame->fp;
+        frame--;
+    } NEXT();
+
+    /**
+     * Superinstructions read the operands of the instructions they cover in place, see fuse().
+    */
+    CASE(OP_MATHK) {
+        TOP.i = narrow(int_math(ip->a, TOP.i, ip->arg.i), ip->b);
+        ip += 2;
+    } NEXT();
+    CASE(OP_MATHF8K) {
+        TOP.f = float_math(ip->a, TOP.f, ((ClaspVMCell) { .i = ip->arg.i }).f);
+        ip += 2;
+    } NEXT();
+    CASE(OP_LOADLMATHK) {
+        PUSH(CELL_I(narrow(int_math(ip->a, fp[ip->arg.u].i, ip[1].arg.i), ip->b)));
+        ip += 3;
+    } NEXT();
+    CASE(OP_CMPJZ) {
+        int64_t c = COMPARE(ip->a, NOS.i, TOP.i);
+        DROP();
+        DROP();
+        ip = c ? ip + 2 : ip[1].arg.target;
+    } NEXT();
+    CASE(OP_CMPJNZ) {
+        int64_t c = COMPARE(ip->a, NOS.i, TOP.i);
+        DROP();
+        DROP();
+        ip = c ? ip[1].arg.target : ip + 2;
+    } NEXT();
+    CASE(OP_CMPKJZ) {
+        int64_t c = COMPARE(ip->a, TOP.i, ip->arg.i);
+        DROP();
+        ip = c ? ip + 3 : ip[2].arg.target;
+    } NEXT();
+    CASE(OP_CMPKJNZ) {
+        int64_t c = COMPARE(ip->a, TOP.i, ip->arg.i);
+        DROP();
+        ip = c ? ip[2].arg.target : ip + 3;
+    } NEXT();
+
+#if VM_LOOP_TOS
+    /**
+     * At the bottom of a frame's operand stack the cell under the top is meaningless, so pushing onto an empty stack
+     * needn't spill `tos` and popping the last cell needn't refill it. Translation picks these where the verifier
+     * found the stack at that depth, which takes the spill and refill off the path from one statement to the next.
+    */
+    E_OP_CONSTK:     { sp++; tos.i = ip->arg.i;        ip++; } NEXT();
+    E_OP_LOADL:      { sp++; tos = fp[ip->arg.u];      ip++; } NEXT();
+    E_OP_LOADG:      { sp++; tos = globals[ip->arg.u]; ip++; } NEXT();
+    E_OP_LOADLMATHK: {
+        sp++;
+        tos.i = narrow(int_math(ip->a, fp[ip->arg.u].i, ip[1].arg.i), ip->b);
+        ip += 3;
+    } NEXT();
+    E_OP_POP:    { sp--;                           ip++; } NEXT();
+    E_OP_STOREL: { fp[ip->arg.u] = tos; sp--;      ip++; } NEXT();
+    E_OP_STOREG: { globals[ip->arg.u] = tos; sp--; ip++; } NEXT();
+    E_OP_JZ:     { sp--; ip = tos.i ? ip + 1 : ip->arg.target; } NEXT();
+    E_OP_JNZ:    { sp--; ip = tos.i ? ip->arg.target : ip + 1; } NEXT();
+    E_OP_CMPJZ:  {
+        sp -= 2;
+        ip = COMPARE(ip->a, sp[1].i, tos.i) ? ip + 2 : ip[1].arg.target;
+    } NEXT();
+    E_OP_CMPJNZ: {
+        sp -= 2;
+        ip = COMPARE(ip->a, sp[1].i, tos.i) ? ip[1].arg.target : ip + 2;
+    } NEXT();
+    E_OP_CMPKJZ:  { sp--; ip = COMPARE(ip->a, tos.i, ip->arg.i) ? ip + 3 : ip[2].arg.target; } NEXT();
+    E_OP_CMPKJNZ: { sp--; ip = COMPARE(ip->a, tos.i, ip->arg.i) ? ip[2].arg.target : ip + 3; } NEXT();
+#endif
+
+#if !VM_LOOP_THREADED
+    default: goto end_of_code;
+    }
+#endif
+
+end_of_code: // The only instruction translation lets through that isn't an opcode, verified code never reaches it
+    TRAP("ran off the end of the code");
+#undef PROFILE
+#undef NEXT
+#undef CASE
+#undef TOP
+#undef NOS
+#undef BELOW
+#undef PUSH
+#undef DROP
+#undef BINARY
+#undef SPILL
+#undef PUSH_SPILLED
+#undef FILL
+#undef CELL_I
+#undef CELL_F
+#undef CHECK_SYMBOL
+}
@@ -0,0 +1,109 @@
+/**
+ * Clasp VM arithmetic and runtime symbols
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * What the stack VM (vm.c) and the register VM (regvm.c) share: the arithmetic of the math, compare and conv
+ * instructions, and the runtime symbols every module may call.
+*/
+
+#ifndef VM_RUNTIME_H
+#define VM_RUNTIME_H
+
+#include <clasp/bytecode.h>
+#include <clasp/runtime.h>
+#include <clasp/vm.h>
+#include <math.h>
+#include <stdio.h>
+
+// ---- Arithmetic ----
+
+// Wraps on overflow, like the hardware the spec follows. Division by zero is checked by the caller.
+static inline int64_t int_math(uint8_t op, int64_t a, int64_t b) {
+    switch (op) {
+        case CLB_ADD: return (int64_t) ((uint64_t) a + (uint64_t) b);
+        case CLB_SUB: return (int64_t) ((uint64_t) a - (uint64_t) b);
+        case CLB_MUL: return (int64_t) ((uint64_t) a * (uint64_t) b);
+        case CLB_DIV: return b == -1 ? (int64_t) -(uint64_t) a : a / b;
+        case CLB_REM: return b == -1 ? 0 : a % b;
+        case CLB_SHL: return (int64_t) ((uint64_t) a << (b & 63));
+        default:      return a ^ b;
+    }
+}
+
+static inline double float_math(uint8_t op, double a, double b) {
+    switch (op) {
+        case CLB_ADD: return a + b;
+        case CLB_SUB: return a - b;
+        case CLB_MUL: return a * b;
+        case CLB_DIV: return a / b;
+        default:      return fmod(a, b);
+    }
+}
+
+#define COMPARE(op, a, b)                   \
+    ((op) == CLB_EQ ? (a) == (b) :          \
+     (op) == CLB_NE ? (a) != (b) :          \
+     (op) == CLB_LT ? (a) <  (b) :          \
+     (op) == CLB_LE ? (a) <= (b) :          \
+     (op) == CLB_GT ? (a) >  (b) : (a) >= (b))
+
+static inline int64_t narrow(int64_t v, uint8_t cls) {
+    switch (cls) {
+        case CLB_B: return (int8_t) v;
+        case CLB_W: return (int16_t) v;
+        case CLB_D: return (int32_t) v;
+        default:    return v;
+    }
+}
+
+static inline ClaspVMCell negate(ClaspVMCell v, uint8_t cls) {
+    if (cls == CLB_F4) return vm_f4_cell(-vm_cell_f4(v));
+    if (cls == CLB_F8) return (ClaspVMCell) { .f = -v.f };
+    return (ClaspVMCell) { .i = narrow((int64_t) -v.u, cls) };
+}
+
+static inline ClaspVMCell convert(ClaspVMCell v, uint8_t from, uint8_t to) {
+    double f = from == CLB_F4 ? vm_cell_f4(v) : v.f;
+    if (to == CLB_F4) return vm_f4_cell(from <= CLB_Q ? (float) v.i : (float) f);
+    if (to == CLB_F8) return (ClaspVMCell) { .f = from <= CLB_Q ? (double) v.i : f };
+    return (ClaspVMCell) { .i = narrow(from <= CLB_Q ? v.i : (int64_t) f, to) };
+}
+
+// ---- Runtime symbols ----
+
+static ClaspVMCell native_println(ClaspVMCell *args) {
+    printf("%d\n", (int32_t) args[0].i);
+    return (ClaspVMCell) { 0 };
+}
+
+static ClaspVMCell native_ipow(ClaspVMCell *args) {
+    return (ClaspVMCell) { .i = clasp_ipow(args[0].i, args[1].i) };
+}
+
+static ClaspVMCell native_pow(ClaspVMCell *args) {
+    return (ClaspVMCell) { .f = pow(args[0].f, args[1].f) };
+}
+
+#endif // VM_RUNTIME_H
@@ -0,0 +1,155 @@
+/**
+ * Clasp fused AST walker implementation
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Source Libraries
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/walk.h>
+#include <cvector/cvector.h>
+
+static inline void run_hooks(ClaspASTNode *node, ClaspASTPass *passes, size_t n, size_t table) {
+    for (size_t i = 0; i < n; ++i) {
+        ClaspVisitorFn *hooks = table ? passes[i].post : passes[i].pre;
+        if (hooks && hooks[node->type]) hooks[node->type](node, passes[i].args);
+    }
+}
+
+void ast_walk(ClaspASTNode *node, ClaspASTPass *passes, size_t n) {
+    if (!node) return;
+    run_hooks(node, passes, n, 0);
+
+    union ASTNodeData *d = &node->data;
+    switch (node->type) {
+        case AST_EXPR_BINOP:
+            ast_walk(d->binop.left, passes, n);
+            ast_walk(d->binop.right, passes, n);
+            break;
+        case AST_EXPR_UNOP:    ast_walk(d->unop.right, passes, n);   break;
+        case AST_EXPR_POSTFIX: ast_walk(d->postfix.left, passes, n); break;
+        case AST_EXPR_FN_CALL:
+            ast_walk(d->fn_call.referencer, passes, n);
+            for (size_t i = 0; i < cvector_size(d->fn_call.args); ++i) ast_walk(d->fn_call.args[i], passes, n);
+            break;
+        case AST_RETURN_STMT: ast_walk(d->return_stmt.retval, passes, n); break;
+        case AST_EXPR_STMT:   ast_walk(d->expr_stmt.expr, passes, n);     break;
+        case AST_BLOCK_STMT:
+            for (size_t i = 0; i < cvector_size(d->block_stmt.body); ++i) ast_walk(d->block_stmt.body[i], passes, n);
+            break;
+        case AST_VAR_DECL_STMT:
+        case AST_LET_DECL_STMT:
+        case AST_CONST_DECL_STMT:
+            ast_walk(d->var_decl_stmt.type, passes, n);
+            ast_walk(d->var_decl_stmt.initializer, passes, n);
+            break;
+        case AST_FN_DECL_STMT:
+            for (size_t i = 0; i < cvector_size(d->fn_decl_stmt.args); ++i) ast_walk(d->fn_decl_stmt.args[i]->type, passes, n);
+            ast_walk(d->fn_decl_stmt.ret_type, passes, n);
+            ast_walk(d->fn_decl_stmt.body, passes, n);
+            break;
+        case AST_IF_STMT:
+        case AST_WHILE_STMT:
+            ast_walk(d->cond_stmt.cond, passes, n);
+            ast_walk(d->cond_stmt.body, passes, n);
+            break;
+        case AST_FOR_STMT:
+            ast_walk(d->for_stmt.init, passes, n);
+            ast_walk(d->for_stmt.cond, passes, n);
+            ast_walk(d->for_stmt.step, passes, n);
+            ast_walk(d->for_stmt.body, passes, n);
+            break;
+        case AST_TYPE_ARRAY: ast_walk(d->array.enclosed, passes, n); break;
+        case AST_TYPE_FN:
+            for (size_t i = 0; i < cvector_size(d->function.args); ++i) ast_walk(d->function.args[i], passes, n);
+            ast_walk(d->function.ret, passes, n);
+            break;
+        case AST_TYPE_TEMPLATE:
+            for (size_t i = 0; i < cvector_size(d->template.template); ++i) ast_walk(d->template.template[i], passes, n);
+            break;
+        case AST_TYPE_PTR: ast_walk(d->pointer.pointed, passes, n); break;
+        default: break;
+    }
+
+    run_hooks(node, passes, n, 1);
+}
+
+void ast_map_children(ClaspASTNode *node, ClaspVisitorFn fn, void *args) {
+#define MAP(slot) do { if (slot) (slot) = fn((slot), args); } while (0)
+    union ASTNodeData *d = &node->data;
+    switch (node->type) {
+        case AST_EXPR_BINOP:
+            MAP(d->binop.left);
+            MAP(d->binop.right);
+            break;
+        case AST_EXPR_UNOP:    MAP(d->unop.right);   break;
+        case AST_EXPR_POSTFIX: MAP(d->postfix.left); break;
+        case AST_EXPR_FN_CALL:
+            MAP(d->fn_call.referencer);
+            for (size_t i = 0; i < cvector_size(d->fn_call.args); ++i) MAP(d->fn_call.args[i]);
+            break;
+        case AST_RETURN_STMT: MAP(d->return_stmt.retval); break;
+        case AST_EXPR_STMT:   MAP(d->expr_stmt.expr);     break;
+        case AST_BLOCK_STMT:
+            for (size_t i = 0; i < cvector_size(d->block_stmt.body); ++i) MAP(d->block_stmt.body[i]);
+            break;
+        case AST_VAR_DECL_STMT:
+        case AST_LET_DECL_STMT:
+        case AST_CONST_DECL_STMT:
+            MAP(d->var_decl_stmt.initializer);
+            break;
+        case AST_FN_DECL_STMT: MAP(d->fn_decl_stmt.body); break;
+        case AST_IF_STMT:
+        case AST_WHILE_STMT:
+            MAP(d->cond_stmt.cond);
+            MAP(d->cond_stmt.body);
+            break;
+        case AST_FOR_STMT:
+            MAP(d->for_stmt.init);
+            MAP(d->for_stmt.cond);
+            MAP(d->for_stmt.step);
+            MAP(d->for_stmt.body);
+            break;
+        default: break;
+    }
+#undef MAP
+}
+
+static void *stats_enter(ClaspASTNode *node, void *args) {
+    ClaspASTStats *stats = args;
+    stats->counts[node->type]++;
+    stats->total++;
+    if (++stats->depth > stats->max_depth) stats->max_depth = stats->depth;
+    return NULL;
+}
+
+static void *stats_leave(ClaspASTNode *node, void *args) {
+    ((ClaspASTStats *) args)->depth--;
+    return NULL;
+}
+
+#define ALL_NODES(fn) [0 ... CLASP_NUM_VISITORS - 1] = &fn
+static ClaspASTVisitor stats_pre  = { ALL_NODES(stats_enter) };
+static ClaspASTVisitor stats_post = { ALL_NODES(stats_leave) };
+#undef ALL_NODES
+
+ClaspASTPass ast_stats_pass(ClaspASTStats *stats) {
+    return (ClaspASTPass) { stats_pre, stats_post, stats };
+}
@@ -149,6 +149,18 @@ void *visit_while(ClaspASTNode *ast, void *args) {
     printf(")\n");
 }
 
+void *visit_for(ClaspASTNode *ast, void *args) {
+    printf("(forStmt: init=");
+    visit(ast->data.for_stmt.init, args, self_visitor);
+    printf(" cond=");
+    visit(ast->data.for_stmt.cond, args, self_visitor);
+    printf(" step=");
+    visit(ast->data.for_stmt.step, args, self_visitor);
+    printf(" body=");
+    visit(ast->data.for_stmt.body, args, self_visitor);
+    printf(")\n");
+}
+
 void *visit_single_type(ClaspASTNode *ast, void *args) {
     printf("[single name=\"%s\"]", ast->data.single.name->data);
 }
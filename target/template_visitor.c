@@ -74,6 +74,10 @@ void *visit_while(ClaspASTNode *stmt, void *args) {
 
 }
 
+void *visit_for(ClaspASTNode *stmt, void *args) {
+
+}
+
 void *visit_single_type(ClaspASTNode *type, void *args) {
     
 }
\ No newline at end of file
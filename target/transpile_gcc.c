@@ -25,13 +25,30 @@
 
 #include <clasp/clasp.h>
 #include <clasp/visitor.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Nested binops are parenthesized, C precedence doesn't match Clasp's (and passes add operators like <<).
+static void visit_operand(ClaspASTNode *operand, int *tabs) {
+    bool paren = operand && operand->type == AST_EXPR_BINOP;
+    if (paren) printf("(");
+    visit(operand, tabs, self_visitor);
+    if (paren) printf(")");
+}
 
 void *visit_binop(ClaspASTNode *binop, void *args) {
     int tabs = *(int*)args;
-    visit(binop->data.binop.left, &tabs, self_visitor);
+    visit_operand(binop->data.binop.left, &tabs);
     ClaspToken *op = binop->data.binop.op;
+    ClaspASTNode *right = binop->data.binop.right;
+    // ast_fold turns x * 2^k into x << k, but C leaves shifting a negative signed number undefined; multiply back
+    if (op->type == TOKEN_LESS_LESS && right->type == AST_EXPR_LIT_NUMBER) {
+        printf(" * %lld", 1LL << strtoll(right->data.lit_num.value->data, NULL, 10));
+        return NULL;
+    }
     printf(" %s ", op->data);
-    visit(binop->data.binop.right, &tabs, self_visitor);
+    visit_operand(right, &tabs);
     return NULL;
 }
 
@@ -39,7 +56,7 @@ void *visit_unop(ClaspASTNode *unop, void *args) {
     int tabs = *(int*)args;
     ClaspToken *op = unop->data.unop.op;
     printf("%s", op->data);
-    visit(unop->data.unop.right, &tabs, self_visitor);
+    visit_operand(unop->data.unop.right, &tabs);
     return NULL;
 }
 
@@ -53,7 +70,10 @@ void *visit_postfix(ClaspASTNode *postfix, void *args) {
 
 void *visit_lit_num(ClaspASTNode *lit, void *args) {
     ClaspToken *num = lit->data.lit_num.value;
-    printf("%s", num->data);
+    ClaspASTNode *type = lit->exprType ? lit->exprType->type : NULL;
+    // Clasp's decimal literals are floats, C's are doubles
+    bool single = type && type_is_float(type) && type_size(type) == 4;
+    printf("%s%s", num->data, single ? "f" : "");
     return NULL;
 }
 
@@ -122,7 +142,6 @@ void *visit_var_decl(ClaspASTNode *var, void *args) {
             printf("const ");
             break;
     }
-    if (var->data.var_decl_stmt.type == NULL) fprintf(stderr, "Error: no specified type for variable '%s'.\n", var->data.var_decl_stmt.name->data);
     visit(var->data.var_decl_stmt.type, &tabs, self_visitor);
     printf(" %s", var->data.var_decl_stmt.name->data);
     if (var->data.var_decl_stmt.initializer != NULL) {
@@ -175,8 +194,66 @@ void *visit_while(ClaspASTNode *stmt, void *args) {
     return NULL;
 }
 
+// Clasp primitive -> C type. Types come from the checker, so every decl has one and they're all interned.
+static const char *C_TYPES[][2] = {
+    { "void",   "void"        },
+    { "byte",   "signed char" },
+    { "short",  "short"       },
+    { "int",    "int"         },
+    { "long",   "long long"   },
+    { "float",  "float"       },
+    { "double", "double"      },
+};
+
+// A statement inside a for loop header: no indentation or terminator.
+static void visit_header_stmt(ClaspASTNode *stmt, int *tabs) {
+    if (!stmt) return;
+    switch (stmt->type) {
+        case AST_EXPR_STMT:
+            visit(stmt->data.expr_stmt.expr, tabs, self_visitor);
+            break;
+        case AST_VAR_DECL_STMT:
+        case AST_LET_DECL_STMT:
+        case AST_CONST_DECL_STMT:
+            if (stmt->type != AST_VAR_DECL_STMT) printf("const ");
+            visit(stmt->data.var_decl_stmt.type, tabs, self_visitor);
+            printf(" %s", stmt->data.var_decl_stmt.name->data);
+            if (stmt->data.var_decl_stmt.initializer) {
+                printf(" = ");
+                visit(stmt->data.var_decl_stmt.initializer, tabs, self_visitor);
+            }
+            break;
+        default:
+            fprintf(stderr, "Error: unsupported statement in for loop header.\n");
+            break;
+    }
+}
+
+void *visit_for(ClaspASTNode *stmt, void *args) {
+    int tabs = *(int*)args;
+    TABS(tabs);
+
+    printf("for (");
+    visit_header_stmt(stmt->data.for_stmt.init, &tabs);
+    printf("; ");
+    visit(stmt->data.for_stmt.cond, &tabs, self_visitor);
+    printf("; ");
+    visit_header_stmt(stmt->data.for_stmt.step, &tabs);
+    printf(") ");
+    tabs = -tabs;
+    visit(stmt->data.for_stmt.body, &tabs, self_visitor);
+    return NULL;
+}
+
 void *visit_single_type(ClaspASTNode *type, void *args) {
-    printf("%s", type->data.single.name->data);
+    const char *name = type->data.single.name->data;
+    for (size_t i = 0; i < sizeof(C_TYPES) / sizeof(C_TYPES[0]); ++i) {
+        if (!strcmp(name, C_TYPES[i][0])) {
+            printf("%s", C_TYPES[i][1]);
+            return NULL;
+        }
+    }
+    printf("%s", name);
     return NULL;
 }
 
@@ -184,8 +261,15 @@ void target_run(ClaspASTNode *ast, void *args) {
     int tabs = -1;
         // TODO: load stdlibs from a file (or have them included)
     printf("#include <stdio.h>\n\
+#include <math.h>\n\
 void println(int x) {\n\
 	printf(\"%%d\\n\", x);\n\
+}\n\
+long long clasp_ipow(long long base, long long exp) {\n\
+	if (exp < 0) return base == 1 ? 1 : base == -1 ? ((exp & 1) ? -1 : 1) : 0;\n\
+	unsigned long long b = base, out = 1;\n\
+	for (; exp; exp >>= 1, b *= b) if (exp & 1) out *= b;\n\
+	return (long long)out;\n\
 }\n");
     visit(ast, &tabs, self_visitor);
 }
\ No newline at end of file
@@ -0,0 +1,149 @@
+/**
+ * Clasp binary AST cache test
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Test Suite
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/lexer.h>
+#include <clasp/parser.h>
+#include <clasp/ast_cache.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <unistd.h>
+
+typedef struct {
+    char *data;
+    unsigned int idx;
+} StringStream;
+
+StringStream str;
+
+char read_string() {
+    if (str.idx == strlen(str.data)) return EOF;
+    return str.data[str.idx++];
+}
+
+static void assert_token_eq(ClaspToken *a, ClaspToken *b) {
+    assert((a == NULL) == (b == NULL));
+    if (!a) return;
+    assert(!strcmp(a->data, b->data));
+    assert(a->type == b->type);
+    assert(a->lineno == b->lineno);
+    assert(a->where == b->where);
+}
+
+static void assert_tree_eq(ClaspASTNode *a, ClaspASTNode *b) {
+    assert((a == NULL) == (b == NULL));
+    if (!a) return;
+    assert(a->type == b->type);
+    assert((a->exprType == NULL) == (b->exprType == NULL));
+    if (a->exprType) {
+        assert(a->exprType->flag == b->exprType->flag);
+        assert_tree_eq(a->exprType->type, b->exprType->type);
+    }
+
+    union ASTNodeData *x = &a->data, *y = &b->data;
+    switch (a->type) {
+        case AST_EXPR_BINOP:
+            assert_token_eq(x->binop.op, y->binop.op);
+            assert_tree_eq(x->binop.left, y->binop.left);
+            assert_tree_eq(x->binop.right, y->binop.right);
+            break;
+        case AST_EXPR_UNOP:
+            assert_token_eq(x->unop.op, y->unop.op);
+            assert_tree_eq(x->unop.right, y->unop.right);
+            break;
+        case AST_EXPR_POSTFIX:
+            assert_token_eq(x->postfix.op, y->postfix.op);
+            assert_tree_eq(x->postfix.left, y->postfix.left);
+            break;
+        case AST_EXPR_LIT_NUMBER: assert_token_eq(x->lit_num.value, y->lit_num.value);   break;
+        case AST_EXPR_VAR_REF:    assert_token_eq(x->var_ref.varname, y->var_ref.varname); break;
+        case AST_EXPR_FN_CALL:
+            assert_tree_eq(x->fn_call.referencer, y->fn_call.referencer);
+            assert(cvector_size(x->fn_call.args) == cvector_size(y->fn_call.args));
+            for (size_t i = 0; i < cvector_size(x->fn_call.args); ++i) assert_tree_eq(x->fn_call.args[i], y->fn_call.args[i]);
+            break;
+        case AST_RETURN_STMT: assert_tree_eq(x->return_stmt.retval, y->return_stmt.retval); break;
+        case AST_EXPR_STMT:   assert_tree_eq(x->expr_stmt.expr, y->expr_stmt.expr);         break;
+        case AST_BLOCK_STMT:
+            assert(cvector_size(x->block_stmt.body) == cvector_size(y->block_stmt.body));
+            for (size_t i = 0; i < cvector_size(x->block_stmt.body); ++i) assert_tree_eq(x->block_stmt.body[i], y->block_stmt.body[i]);
+            break;
+        case AST_VAR_DECL_STMT:
+        case AST_LET_DECL_STMT:
+        case AST_CONST_DECL_STMT:
+            assert_token_eq(x->var_decl_stmt.name, y->var_decl_stmt.name);
+            assert_tree_eq(x->var_decl_stmt.type, y->var_decl_stmt.type);
+            assert_tree_eq(x->var_decl_stmt.initializer, y->var_decl_stmt.initializer);
+            break;
+        case AST_FN_DECL_STMT:
+            assert_token_eq(x->fn_decl_stmt.name, y->fn_decl_stmt.name);
+            assert_tree_eq(x->fn_decl_stmt.ret_type, y->fn_decl_stmt.ret_type);
+            assert_tree_eq(x->fn_decl_stmt.body, y->fn_decl_stmt.body);
+            assert(cvector_size(x->fn_decl_stmt.args) == cvector_size(y->fn_decl_stmt.args));
+            for (size_t i = 0; i < cvector_size(x->fn_decl_stmt.args); ++i) {
+                assert_token_eq(x->fn_decl_stmt.args[i]->name, y->fn_decl_stmt.args[i]->name);
+                assert_tree_eq(x->fn_decl_stmt.args[i]->type, y->fn_decl_stmt.args[i]->type);
+            }
+            break;
+        case AST_IF_STMT:
+        case AST_WHILE_STMT:
+            assert_tree_eq(x->cond_stmt.cond, y->cond_stmt.cond);
+            assert_tree_eq(x->cond_stmt.body, y->cond_stmt.body);
+            break;
+        case AST_TYPE_SINGLE: assert(!strcmp(x->single.name->data, y->single.name->data)); break;
+        default: break;
+    }
+}
+
+int main(int argc, char **argv) {
+    str = (StringStream) { "fn sq(x: int) -> int { return x * x; }\nvar total: int = 0;\nconst n = 8 * 4 + 1;\nlet half: float = 2.5;\nfor (var i: int = 0; i < n; i++) { total += sq(i) - -i; }\nif (total > 10) { println(total); }\nwhile (total) total--;\n", 0 };
+    ClaspLexer *l = calloc(1, sizeof(ClaspLexer));
+    new_lexer(l, read_string, NULL);
+    ClaspParser *p = malloc(sizeof(ClaspParser));
+    new_parser(p, l);
+    ClaspASTNode *tree = parser_compile(p);
+
+    assert(ast_cache_write(tree, "ast_cache_test.clast"));
+    ClaspASTCache *cache = ast_cache_load("ast_cache_test.clast");
+    assert(cache != NULL);
+    assert_tree_eq(tree, cache->root);
+
+        // Lists in a loaded tree must still be growable by passes.
+    cvector_push_back(cache->root->data.block_stmt.body, NULL);
+    ast_cache_free(cache);
+
+        // Truncated files are rejected.
+    FILE *f = fopen("ast_cache_test.clast", "r+b");
+    assert(f != NULL);
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fclose(f);
+    assert(truncate("ast_cache_test.clast", size - 3) == 0);
+    assert(ast_cache_load("ast_cache_test.clast") == NULL);
+    remove("ast_cache_test.clast");
+
+    return 0;
+}
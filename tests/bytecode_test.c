@@ -0,0 +1,250 @@
+/**
+ * Clasp bytecode emitter test
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Test Suite
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/lexer.h>
+#include <clasp/parser.h>
+#include <clasp/typecheck.h>
+#include <clasp/lower.h>
+#include <clasp/resolve.h>
+#include <clasp/bytecode_emit.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <unistd.h>
+
+typedef struct {
+    char *data;
+    unsigned int idx;
+} StringStream;
+
+StringStream str;
+
+char read_string() {
+    if (str.idx == strlen(str.data)) return EOF;
+    return str.data[str.idx++];
+}
+
+static ClaspBytecode *emit(const char *src) {
+    char buf[1024];
+    snprintf(buf, sizeof(buf), "%s\n", src);
+    str = (StringStream) { buf, 0 };
+    ClaspLexer *l = calloc(1, sizeof(ClaspLexer));
+    new_lexer(l, read_string, NULL);
+    ClaspParser *p = malloc(sizeof(ClaspParser));
+    new_parser(p, l);
+    ClaspASTNode *tree = parser_compile(p);
+    assert(typecheck(tree) == 0);
+    tree = lower_pow(tree);
+    ClaspResolution res;
+    ast_resolve(tree, &res);
+    ClaspBytecode *bc = bytecode_emit(tree, &res);
+    resolution_free(&res);
+    return bc;
+}
+
+static char *listing(ClaspBytecode *bc) {
+    char *text = NULL;
+    size_t len = 0;
+    FILE *out = open_memstream(&text, &len);
+    bytecode_disassemble(bc, out);
+    fclose(out);
+    return text;
+}
+
+// Source and a line its listing must contain.
+static const struct {
+    const char *src;
+    const char *expect;
+} CORPUS[] = {
+        // Width variants come from the operand types, widening is free
+    { "fn f(a: byte, b: long) -> long { return a + b; }",                         "mathbq add" },
+    { "fn f(a: long, b: short) -> long { return a * b; }",                        "mathqw mul" },
+    { "fn f(a: int, b: int) -> int { return a - b; }",                            "mathdd sub" },
+    { "fn f(a: int) -> long { return a; }",                                       "loadl 0\n    10  retv" },
+        // Narrowing and floats convert
+    { "fn f(a: long) -> byte { return a; }",                                      "conv q b" },
+    { "fn f(a: int, b: double) -> double { return a * b; }",                      "conv d f8" },
+    { "fn f(a: float, b: float) -> float { return a / b; }",                      "mathf4 div" },
+        // Comparisons of any integers share one opcode
+    { "fn f(a: byte, b: long) -> int { return a < b; }",                          "cmpi lt" },
+    { "fn f(a: double) -> int { if (a) { return 1; } return 0; }",                "cmpf8 ne" },
+        // Calls
+    { "fn g(x: int) -> int { return x; }\nfn f() -> int { return g(2); }",       "call @0 1 1" },
+    { "fn f(x: int) -> void { println(x); }",                                     "jsym 1 0 println" },
+    { "fn g(x: int) -> int { return x; }\nlet h = g;\nprintln(h(1));", "calli 1 1" },
+    { "fn f(x: long, n: long) -> long { return x ^ n; }",                         "jsym 2 1 clasp_ipow" },
+        // Assignments leave their value
+    { "fn f(a: int) -> long { var b: long = 0; b = a; return b; }",             "loadl 0\n    15  dup\n    16  storel 1" },
+        // Globals and frames
+    { "var g: int = 1;\nfn f() -> int { return g; }",                             "loadg 0" },
+    { "fn f(a: int) -> int { { var b: int = a; } { var c: int = a; return c; } }", "enter 2" },
+        // Loops test at the bottom
+    { "fn f(n: int) -> int { var i: int = 0; while (i < n) { i++; } return i; }", "jnz @2" },
+        // Falling off the end returns zero
+    { "fn f(x: int) -> int { if (x) { return 1; } }",                             "constb 0\n    24  retv" },
+        // Small constants are inline, wide ones come from the pool
+    { "fn f(x: int) -> int { return x * 1000; }",                                 "constw 1000" },
+    { "fn f(x: int) -> int { return x * 100000; }",                               "const #0 = 100000" },
+    { "fn f(x: double) -> double { return x + 1.5; }",                            "constk #0" },
+};
+
+static const char *LISTING_SRC = "fn f(n: int) -> int { var s: long = 0; for (var i: int = 0; i < n; i++) s += i; return s; }\nprintln(f(4));";
+static const char *LISTING =
+    "start 1, 0 globals\n"
+    "symbol f = @0\n"
+    "@1:\n"
+    "     0  enter 0\n"
+    "     3  constb 4\n"
+    "     5  call @0 1 1\n"
+    "    16  jsym 1 0 println\n"
+    "    27  ret\n"
+    "@0:\n"
+    "    28  enter 3\n"
+    "    31  constb 0\n"
+    "    33  storel 1\n"
+    "    36  constb 0\n"
+    "    38  storel 2\n"
+    "    41  jmp @3\n"
+    "@2:\n"
+    "    50  loadl 1\n"
+    "    53  loadl 2\n"
+    "    56  mathqd add\n"
+    "    58  dup\n"
+    "    59  storel 1\n"
+    "    62  pop\n"
+    "    63  loadl 2\n"
+    "    66  dup\n"
+    "    67  constb 1\n"
+    "    69  mathdd add\n"
+    "    71  storel 2\n"
+    "    74  pop\n"
+    "@3:\n"
+    "    75  loadl 2\n"
+    "    78  loadl 0\n"
+    "    81  cmpi lt\n"
+    "    83  jnz @2\n"
+    "    92  loadl 1\n"
+    "    95  conv q d\n"
+    "    98  retv\n";
+
+int main(int argc, char **argv) {
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(CORPUS) / sizeof(CORPUS[0]); ++i) {
+        ClaspBytecode *bc = emit(CORPUS[i].src);
+        assert(bc);
+        char *text = listing(bc);
+
+        // Every module survives a trip through a file
+        char path[] = "/tmp/clasp_bytecode_testXXXXXX";
+        int fd = mkstemp(path);
+        assert(fd >= 0);
+        assert(bytecode_write(bc, path));
+        ClaspBytecode *read = bytecode_read(path);
+        char *again = read ? listing(read) : NULL;
+        remove(path);
+
+        bool ok = strstr(text, CORPUS[i].expect) && again && !strcmp(text, again);
+        char label[41];
+        snprintf(label, sizeof(label), "%s", CORPUS[i].src);
+        for (char *c = label; *c; ++c) if (*c == '\n') *c = ' ';
+        printf("%-4s %-40s\n", ok ? "ok" : "FAIL", label);
+        if (!ok) printf("%s", text);
+        failures += !ok;
+        free(text);
+        free(again);
+        bytecode_free(bc);
+        bytecode_free(read);
+    }
+
+    // Full listing
+    ClaspBytecode *bc = emit(LISTING_SRC);
+    char *text = listing(bc);
+    bool ok = !strcmp(text, LISTING);
+    printf("%-4s listing\n", ok ? "ok" : "FAIL");
+    if (!ok) printf("%s", text);
+    failures += !ok;
+    free(text);
+
+    // Truncated files are rejected
+    char path[] = "/tmp/clasp_bytecode_testXXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    assert(bytecode_write(bc, path));
+    assert(truncate(path, 3 + 8 + 8 + 4) == 0);
+    ok = bytecode_read(path) == NULL;
+    printf("%-4s truncated file rejected\n", ok ? "ok" : "FAIL");
+    failures += !ok;
+    remove(path);
+
+    // So are global counts nothing could allocate
+    bc->globals = (uint64_t) -1 / 4;
+    assert(bytecode_write(bc, path));
+    ok = bytecode_read(path) == NULL;
+    printf("%-4s global count out of range rejected\n", ok ? "ok" : "FAIL");
+    failures += !ok;
+    remove(path);
+    bytecode_free(bc);
+
+    // Every use of a wide constant shares one pool entry
+    bc = emit("fn f(x: long) -> long { return x * 100000 + 100000 - 300000; }\nprintln(f(100000));");
+    ok = bc && cvector_size(bc->constants) == 2 && bc->constants[0] == 100000;
+    printf("%-4s constant pool shared\n", ok ? "ok" : "FAIL");
+    failures += !ok;
+    bytecode_free(bc);
+
+    // Native code keeps its blobs, keyed by platform, through a file
+    bc = emit("fn mix(a: long, b: long) -> long { return a * 31 + b; }\nprintln(mix(2, 5));");
+    uint64_t native = bytecode_native(bc, 0);
+    bytecode_native_blob(bc, native, CLB_ARCH_AARCH64_LINUX, "\x00\x7c\x1f\x9b", 4);
+    bytecode_native_blob(bc, native, CLB_ARCH_X86_64_LINUX, "\xc3", 1);
+    bytecode_native_blob(bc, native, CLB_ARCH_X86_64_LINUX, "\x48\x8b\x07\xc3", 4);
+    bytecode_native(bc, -1);
+    text = listing(bc);
+    strcpy(path, "/tmp/clasp_bytecode_testXXXXXX");
+    fd = mkstemp(path);
+    assert(fd >= 0 && bytecode_write(bc, path));
+    ClaspBytecode *read = bytecode_read(path);
+    char *again = read ? listing(read) : NULL;
+    remove(path);
+    ok = strstr(text, "native #0 else @0, aarch64-linux 4 bytes, x86_64-linux 4 bytes\nnative #1\n") && again &&
+         !strcmp(text, again) && !memcmp(bytecode_native_find(&read->natives[0], CLB_ARCH_X86_64_LINUX)->code, "\x48\x8b\x07\xc3", 4);
+    printf("%-4s native code round trip\n", ok ? "ok" : "FAIL");
+    if (!ok) printf("%s", text);
+    failures += !ok;
+    free(text);
+    free(again);
+    bytecode_free(bc);
+    bytecode_free(read);
+
+    // Locals of enclosing functions have no bytecode form yet
+    ok = emit("fn f(x: int) -> int { fn g() -> int { return x; } return g(); }") == NULL;
+    printf("%-4s captured local rejected\n", ok ? "ok" : "FAIL");
+    failures += !ok;
+
+    fflush(stdout);
+    assert(failures == 0);
+    return 0;
+}
@@ -0,0 +1,182 @@
+/**
+ * Clasp common subexpression elimination test
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Test Suite
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/lexer.h>
+#include <clasp/parser.h>
+#include <clasp/typecheck.h>
+#include <clasp/hashcons.h>
+#include <clasp/cse.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+typedef struct {
+    char *data;
+    unsigned int idx;
+} StringStream;
+
+StringStream str;
+
+char read_string() {
+    if (str.idx == strlen(str.data)) return EOF;
+    return str.data[str.idx++];
+}
+
+// Render an expression fully parenthesized, so the corpus pins down the tree shape.
+static void render(ClaspASTNode *node, char *out) {
+    char a[512] = "", b[512] = "";
+    switch (node->type) {
+        case AST_EXPR_LIT_NUMBER: strcat(out, node->data.lit_num.value->data); break;
+        case AST_EXPR_VAR_REF:    strcat(out, node->data.var_ref.varname->data); break;
+        case AST_EXPR_BINOP:
+            render(node->data.binop.left, a);
+            render(node->data.binop.right, b);
+            sprintf(out + strlen(out), "(%s %s %s)", a, node->data.binop.op->data, b);
+            break;
+        case AST_EXPR_UNOP:
+            render(node->data.unop.right, a);
+            sprintf(out + strlen(out), "%s%s", node->data.unop.op->data, a);
+            break;
+        case AST_EXPR_POSTFIX:
+            render(node->data.postfix.left, a);
+            sprintf(out + strlen(out), "%s%s", a, node->data.postfix.op->data);
+            break;
+        case AST_EXPR_FN_CALL:
+            render(node->data.fn_call.args[0], a);
+            sprintf(out + strlen(out), "%s(%s)", node->data.fn_call.referencer->data.var_ref.varname->data, a);
+            break;
+        default: strcat(out, "?"); break;
+    }
+}
+
+// Statements as "name = init" or their expression, separated by "; ", blocks in braces.
+static void render_stmts(ClaspASTNode *block, size_t skip, char *out) {
+    for (size_t i = skip; i < cvector_size(block->data.block_stmt.body); ++i) {
+        ClaspASTNode *stmt = block->data.block_stmt.body[i];
+        if (!stmt) continue;
+        if (*out && out[strlen(out) - 1] != '{') strcat(out, "; ");
+        switch (stmt->type) {
+            case AST_LET_DECL_STMT:
+            case AST_VAR_DECL_STMT:
+                sprintf(out + strlen(out), "%s = ", stmt->data.var_decl_stmt.name->data);
+                render(stmt->data.var_decl_stmt.initializer, out);
+                break;
+            case AST_EXPR_STMT: {
+                ClaspASTNode *e = stmt->data.expr_stmt.expr;
+                if (e->type != AST_EXPR_BINOP || !tktyp_is_assignment(e->data.binop.op->type)) {
+                    render(e, out);
+                    break;
+                }
+                sprintf(out + strlen(out), "%s %s ", e->data.binop.left->data.var_ref.varname->data, e->data.binop.op->data);
+                render(e->data.binop.right, out);
+                break;
+            }
+            case AST_BLOCK_STMT:
+                strcat(out, "{");
+                render_stmts(stmt, 0, out);
+                strcat(out, "}");
+                break;
+            case AST_IF_STMT: strcat(out, "if"); break;
+            default: strcat(out, "?"); break;
+        }
+    }
+}
+
+static ClaspASTNode *compile(const char *src) {
+    str = (StringStream) { (char *) src, 0 };
+    ClaspLexer *l = calloc(1, sizeof(ClaspLexer));
+    new_lexer(l, read_string, NULL);
+    ClaspParser *p = malloc(sizeof(ClaspParser));
+    new_parser(p, l);
+    ClaspASTNode *tree = parser_compile(p);
+    assert(typecheck(tree) == 0);
+    return tree;
+}
+
+static const char *PRELUDE = "var a: int = 1;\nvar b: int = 2;\nvar c: int = 3;\nvar x: int = 0;\nvar y: double = 0;\n";
+#define PRELUDE_STMTS 5
+
+static const char *CORPUS[][2] = {
+        // Reuse within a basic block
+    { "x = a * b + c; x = x + a * b + c;",      "__cse0 = (a * b); x = (__cse0 + c); x = ((x + __cse0) + c)" },
+    { "x = (a * b + c) * 2; x = a * b + c;",    "__cse0 = ((a * b) + c); x = (__cse0 * 2); x = __cse0" },
+    { "x = (a + b) * (a + b);",                 "__cse0 = (a + b); x = (__cse0 * __cse0)" },
+    { "var m: int = a - b; var n: int = a - b;", "__cse0 = (a - b); m = __cse0; n = __cse0" },
+    { "x = -(a + b); x = -(a + b) * c;",        "__cse0 = -(a + b); x = __cse0; x = (__cse0 * c)" },
+    { "y = a * 1.5 + b; y = a * 1.5 - b;",      "__cse0 = (a * 1.5); y = (__cse0 + b); y = (__cse0 - b)" },
+        // Only maximal expressions get a temporary
+    { "x = a * b + c; x = a * b + c;",          "__cse0 = ((a * b) + c); x = __cse0; x = __cse0" },
+        // Killed by assignments and declarations
+    { "x = a * b; a = 5; x = a * b;",           "x = (a * b); a = 5; x = (a * b)" },
+    { "x = a * b; a++; x = a * b;",             "x = (a * b); a++; x = (a * b)" },
+    { "x = a * b; b = b + a * b; x = a * b;",   "__cse0 = (a * b); x = __cse0; b = (b + __cse0); x = (a * b)" },
+    { "x = c + 1; var c: int = 4; x = c + 1;",  "x = (c + 1); c = 4; x = (c + 1)" },
+        // Calls, control flow and side effects end the basic block
+    { "x = a * b; println(a * b); x = a * b;",  "x = (a * b); println((a * b)); x = (a * b)" },
+    { "x = a * b; if (c) x = 1; x = a * b;",    "x = (a * b); if; x = (a * b)" },
+    { "{ x = a * b; x = x + a * b; }",          "{__cse0 = (a * b); x = __cse0; x = (x + __cse0)}" },
+        // Different types, different expressions
+    { "x = a + b; y = a + b; y = a + 1.0;",     "__cse0 = (a + b); x = __cse0; y = __cse0; y = (a + 1.0)" },
+        // Constants are left to folding
+    { "x = 2 * 3; x = 2 * 3;",                  "x = (2 * 3); x = (2 * 3)" },
+};
+
+int main(int argc, char **argv) {
+    int failures = 0;
+
+        // Hashing
+    ClaspASTNode *h = compile("var a: int = 1;\nvar b: long = 2;\na * b + 1;\na * b + 1;\n(a * b) + 1;\na * b + 2;\nb * a + 1;\n");
+    ClaspASTNode **s = h->data.block_stmt.body;
+    ClaspASTNode *e1 = s[2]->data.expr_stmt.expr, *e2 = s[3]->data.expr_stmt.expr, *e3 = s[4]->data.expr_stmt.expr;
+    ClaspASTNode *e4 = s[5]->data.expr_stmt.expr, *e5 = s[6]->data.expr_stmt.expr;
+    assert(ast_hash(e1) && ast_hash(e1) == ast_hash(e2) && ast_hash(e1) == ast_hash(e3));
+    assert(ast_equal(e1, e2) && ast_equal(e1, e3));
+    assert(!ast_equal(e1, e4) && !ast_equal(e1, e5));
+    assert(ast_hash(e1) != ast_hash(e4));
+
+        // Dedup: equal subtrees become one node
+    ClaspHashCons table;
+    hashcons_init(&table);
+    ClaspASTNode *c1 = ast_hashcons(&table, e1), *c2 = ast_hashcons(&table, e2), *c4 = ast_hashcons(&table, e4);
+    assert(c1 == e1 && c2 == e1);
+    assert(c4 != e1 && c4->data.binop.left == e1->data.binop.left);
+    assert(table.count == 7); // a, b, a * b, 1, a * b + 1, 2, a * b + 2
+    hashcons_free(&table);
+
+    for (size_t i = 0; i < sizeof(CORPUS) / sizeof(CORPUS[0]); ++i) {
+        char src[1024];
+        snprintf(src, sizeof(src), "%s%s\n", PRELUDE, CORPUS[i][0]);
+        ClaspASTNode *tree = ast_cse(compile(src));
+        char out[1024] = "";
+        render_stmts(tree, PRELUDE_STMTS, out);
+        bool ok = !strcmp(out, CORPUS[i][1]);
+        printf("%-4s %-42s -> %s\n", ok ? "ok" : "FAIL", CORPUS[i][0], out);
+        failures += !ok;
+    }
+    fflush(stdout);
+    assert(failures == 0);
+    return 0;
+}
@@ -0,0 +1,130 @@
+/**
+ * Clasp dead code elimination test
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Test Suite
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/lexer.h>
+#include <clasp/parser.h>
+#include <clasp/typecheck.h>
+#include <clasp/fold.h>
+#include <clasp/dce.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+typedef struct {
+    char *data;
+    unsigned int idx;
+} StringStream;
+
+StringStream str;
+
+char read_string() {
+    if (str.idx == strlen(str.data)) return EOF;
+    return str.data[str.idx++];
+}
+
+// Render just enough of each statement to see what survived: names for declarations, an outline for the rest.
+static void render(ClaspASTNode *node, char *out) {
+    if (!node) return;
+    switch (node->type) {
+        case AST_BLOCK_STMT:
+            strcat(out, "{");
+            for (size_t i = 0; i < cvector_size(node->data.block_stmt.body); ++i) {
+                if (!node->data.block_stmt.body[i]) continue;
+                if (out[strlen(out) - 1] != '{') strcat(out, " ");
+                render(node->data.block_stmt.body[i], out);
+            }
+            strcat(out, "}");
+            break;
+        case AST_FN_DECL_STMT:
+            sprintf(out + strlen(out), "fn %s", node->data.fn_decl_stmt.name->data);
+            render(node->data.fn_decl_stmt.body, out);
+            break;
+        case AST_VAR_DECL_STMT:
+        case AST_LET_DECL_STMT:
+        case AST_CONST_DECL_STMT: sprintf(out + strlen(out), "%s;", node->data.var_decl_stmt.name->data); break;
+        case AST_RETURN_STMT: strcat(out, "ret;"); break;
+        case AST_EXPR_STMT:   strcat(out, "expr;"); break;
+        case AST_IF_STMT:     strcat(out, "if"); render(node->data.cond_stmt.body, out); break;
+        case AST_WHILE_STMT:  strcat(out, "while"); render(node->data.cond_stmt.body, out); break;
+        case AST_FOR_STMT:    strcat(out, "for"); render(node->data.for_stmt.body, out); break;
+        default: strcat(out, "?"); break;
+    }
+}
+
+static const char *CORPUS[][2] = {
+        // Statements after return
+    { "fn f(x: int) -> int { return x; x++; }\nprintln(f(1));",                        "{fn f{ret;} expr;}"                },
+    { "fn f(x: int) -> int { { return x; } println(x); }\nprintln(f(1));",             "{fn f{{ret;}} expr;}"              },
+    { "fn f(x: int) -> int { if (x) return 1; return x; }\nprintln(f(1));",            "{fn f{ifret; ret;} expr;}"         },
+        // Constant conditions
+    { "var x: int = 1;\nif (1 > 2) { x++; }\nprintln(x);",                              "{x; expr;}"                        },
+    { "var x: int = 1;\nif (2 > 1) { x++; }\nprintln(x);",                              "{x; {expr;} expr;}"                },
+    { "var x: int = 1;\nwhile (0) { x++; }\nprintln(x);",                               "{x; expr;}"                        },
+    { "var x: int = 1;\nwhile (x) if (0) x++;\nprintln(x);",                            "{x; while{} expr;}"                },
+    { "var x: int = 1;\nfor (var i: int = x; 0; i++) x++;\nprintln(x);",                "{x; {i;} expr;}"                   },
+        // Expression statements without side effects
+    { "var x: int = 1;\nx + 1;\nx;\nx++;\nprintln(x);",                                 "{x; expr; expr;}"                  },
+    { "fn sq(x: int) -> int { return x * x; }\nvar x: int = 1;\nsq(x);\nprintln(x);",   "{x; expr;}"                        },
+    { "var g: int = 3;\nfn f() -> int { if (g < 0) { var g: int = 0; } g = g + 1; return 0; }\nf();\nprintln(g);",
+      "{g; fn f{if{g;} expr; ret;} expr; expr;}"                                                                             },
+    { "fn spin(x: int) -> int { while (1) {} return x; }\nspin(1);\nprintln(1);",         "{fn spin{while{} ret;} expr; expr;}" },
+    { "fn q(x: int) -> int { return 10 / x; }\nfn h(x: int) -> int { return x / 2; }\nq(0);\nh(1);\nprintln(1);",
+      "{fn q{ret;} expr; expr;}"                                                                                             },
+        // Unreachable functions
+    { "fn a() -> int { return 1; }\nfn b() -> int { return a(); }\nfn c() -> int { return 2; }\nprintln(b());", "{fn a{ret;} fn b{ret;} expr;}" },
+    { "fn a() -> int { return b(); }\nfn b() -> int { return a(); }\nprintln(1);",     "{expr;}"                           },
+    { "fn a() -> int { return 1; }\nfn b() -> int { return a(); }\nif (0) println(b());\nprintln(1);", "{expr;}"           },
+    { "fn a() -> int { return 1; }\nfn b() -> int { return 2; }\nvar x: int = a();\nprintln(x);", "{fn a{ret;} x; expr;}" },
+    { "fn sq(x: int) -> int { return x * x; }\nfn main() -> int { println(sq(3)); return 0; }", "{fn sq{ret;} fn main{expr; ret;}}" },
+};
+
+int main(int argc, char **argv) {
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(CORPUS) / sizeof(CORPUS[0]); ++i) {
+        char src[1024];
+        snprintf(src, sizeof(src), "%s\n", CORPUS[i][0]);
+        str = (StringStream) { src, 0 };
+        ClaspLexer *l = calloc(1, sizeof(ClaspLexer));
+        new_lexer(l, read_string, NULL);
+        ClaspParser *p = malloc(sizeof(ClaspParser));
+        new_parser(p, l);
+        ClaspASTNode *tree = parser_compile(p);
+        assert(typecheck(tree) == 0);
+
+        tree = ast_dce(ast_fold(tree));
+        char out[1024] = "";
+        render(tree, out);
+        bool ok = !strcmp(out, CORPUS[i][1]);
+        char label[37];
+        snprintf(label, sizeof(label), "%s", CORPUS[i][0]);
+        for (char *c = label; *c; ++c) if (*c == '\n') *c = ' ';
+        printf("%-4s %-36s -> %s\n", ok ? "ok" : "FAIL", label, out);
+        failures += !ok;
+    }
+    fflush(stdout);
+    assert(failures == 0);
+    return 0;
+}
@@ -0,0 +1,154 @@
+/**
+ * Clasp constant folding test
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Test Suite
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/lexer.h>
+#include <clasp/parser.h>
+#include <clasp/typecheck.h>
+#include <clasp/fold.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+typedef struct {
+    char *data;
+    unsigned int idx;
+} StringStream;
+
+StringStream str;
+
+char read_string() {
+    if (str.idx == strlen(str.data)) return EOF;
+    return str.data[str.idx++];
+}
+
+// Render an expression fully parenthesized, so the corpus pins down the tree shape.
+static void render(ClaspASTNode *node, char *out) {
+    char a[256] = "", b[256] = "";
+    switch (node->type) {
+        case AST_EXPR_LIT_NUMBER: strcat(out, node->data.lit_num.value->data); break;
+        case AST_EXPR_VAR_REF:    strcat(out, node->data.var_ref.varname->data); break;
+        case AST_EXPR_BINOP:
+            render(node->data.binop.left, a);
+            render(node->data.binop.right, b);
+            sprintf(out + strlen(out), "(%s %s %s)", a, node->data.binop.op->data, b);
+            break;
+        case AST_EXPR_UNOP:
+            render(node->data.unop.right, a);
+            sprintf(out + strlen(out), "%s%s", node->data.unop.op->data, a);
+            break;
+        case AST_EXPR_POSTFIX:
+            render(node->data.postfix.left, a);
+            sprintf(out + strlen(out), "%s%s", a, node->data.postfix.op->data);
+            break;
+        default: strcat(out, "?"); break;
+    }
+}
+
+// The last expression statement of the program, looking into trailing if/while bodies and blocks.
+static ClaspASTNode *last_expr(ClaspASTNode *node) {
+    while (node->type != AST_EXPR_STMT) {
+        if (node->type == AST_BLOCK_STMT) {
+            size_t n = cvector_size(node->data.block_stmt.body);
+            while (!node->data.block_stmt.body[n - 1]) n--; // The parser leaves a NULL for the end of the file
+            node = node->data.block_stmt.body[n - 1];
+        } else {
+            node = node->data.cond_stmt.body;
+        }
+    }
+    return node->data.expr_stmt.expr;
+}
+
+static const char *PRELUDE = "var x: int = 5;\nvar y: float = 1.5;\nvar z: long = 2;\nvar b: byte = 1;\n";
+
+static const char *CORPUS[][2] = {
+        // Evaluation, with the width of the expression's type
+    { "8 * 4 + 1",                 "33"          },
+    { "7 / 2",                     "3"           },
+    { "7.0 / 2",                   "3.5"         },
+    { "1.5 * 2",                   "3.0"         },
+    { "0.1 + 0.2",                 "0.300000012" },
+    { "var d: double = 0;\nd = 0.1 + 0.2", "(d = 0.300000012)" },
+    { "-7 % 3",                    "-1"          },
+    { "2 ^ 10",                    "1024"        },
+    { "1 < 2",                     "1"           },
+    { "!0",                        "1"           },
+    { "~5",                        "-6"          },
+    { "2147483647 + 1",            "-2147483648" },
+    { "b = 100 + 100",             "(b = 200)"   },
+    { "x = 2 * 3",                 "(x = 6)"     },
+    { "1 / 0",                     "(1 / 0)"     },
+    { "x / 0",                     "(x / 0)"     },
+        // Identities
+    { "x * 1",                     "x"           },
+    { "1 * x",                     "x"           },
+    { "x + 0",                     "x"           },
+    { "y + 0",                     "(y + 0)"     },
+    { "y - 0",                     "y"           },
+    { "x * (3 - 2)",               "x"           },
+    { "x * 1.0",                   "(x * 1.0)"   },
+    { "x * 0",                     "0"           },
+    { "x++ * 0",                   "(x++ * 0)"   },
+    { "-(-x)",                     "x"           },
+    { "x ^ 1",                     "x"           },
+        // Strength reduction
+    { "x * 8",                     "(x << 3)"    },
+    { "16 * x",                    "(x << 4)"    },
+    { "z * 4",                     "(z << 2)"    },
+    { "x * 6",                     "(x * 6)"     },
+    { "y * 4",                     "(y * 4)"     },
+        // Constant substitution
+    { "const N = 4;\nx * N",                               "(x << 2)"   },
+    { "const M = 2 * 3;\nM + 1",                           "7"          },
+    { "const H: float = 2;\ny * H",                        "(y * 2.0)"  },
+    { "let L = 4;\nx * L",                                 "(x * L)"    },
+    { "const N = 4;\nif (x) { var N: int = x; x * N; }",   "(x * N)"    },
+    { "const N = 4;\nfn f(N: int) -> int { return N; }\nx * N", "(x << 2)" },
+};
+
+int main(int argc, char **argv) {
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(CORPUS) / sizeof(CORPUS[0]); ++i) {
+        char src[1024];
+        snprintf(src, sizeof(src), "%s%s;\n", PRELUDE, CORPUS[i][0]);
+        str = (StringStream) { src, 0 };
+        ClaspLexer *l = calloc(1, sizeof(ClaspLexer));
+        new_lexer(l, read_string, NULL);
+        ClaspParser *p = malloc(sizeof(ClaspParser));
+        new_parser(p, l);
+        ClaspASTNode *tree = parser_compile(p);
+        assert(typecheck(tree) == 0);
+
+        tree = ast_fold(tree);
+        char out[1024] = "";
+        render(last_expr(tree), out);
+        bool ok = !strcmp(out, CORPUS[i][1]);
+        printf("%-4s %-28s -> %s\n", ok ? "ok" : "FAIL", CORPUS[i][0], out);
+        failures += !ok;
+    }
+    fflush(stdout);
+    assert(failures == 0);
+    return 0;
+}
@@ -0,0 +1,172 @@
+/**
+ * Clasp function inliner test
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Test Suite
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/lexer.h>
+#include <clasp/parser.h>
+#include <clasp/typecheck.h>
+#include <clasp/inline.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+typedef struct {
+    char *data;
+    unsigned int idx;
+} StringStream;
+
+StringStream str;
+
+char read_string() {
+    if (str.idx == strlen(str.data)) return EOF;
+    return str.data[str.idx++];
+}
+
+// Render an expression fully parenthesized, so the corpus pins down the tree shape.
+static void render(ClaspASTNode *node, char *out) {
+    char a[512] = "", b[512] = "";
+    switch (node->type) {
+        case AST_EXPR_LIT_NUMBER: strcat(out, node->data.lit_num.value->data); break;
+        case AST_EXPR_VAR_REF:    strcat(out, node->data.var_ref.varname->data); break;
+        case AST_EXPR_BINOP:
+            render(node->data.binop.left, a);
+            render(node->data.binop.right, b);
+            sprintf(out + strlen(out), "(%s %s %s)", a, node->data.binop.op->data, b);
+            break;
+        case AST_EXPR_UNOP:
+            render(node->data.unop.right, a);
+            sprintf(out + strlen(out), "%s%s", node->data.unop.op->data, a);
+            break;
+        case AST_EXPR_FN_CALL:
+            for (size_t i = 0; i < cvector_size(node->data.fn_call.args); ++i) {
+                if (i) strcat(a, ", ");
+                render(node->data.fn_call.args[i], a);
+            }
+            sprintf(out + strlen(out), "%s(%s)", node->data.fn_call.referencer->data.var_ref.varname->data, a);
+            break;
+        default: strcat(out, "?"); break;
+    }
+}
+
+static ClaspASTNode *compile(const char *src) {
+    str = (StringStream) { (char *) src, 0 };
+    ClaspLexer *l = calloc(1, sizeof(ClaspLexer));
+    new_lexer(l, read_string, NULL);
+    ClaspParser *p = malloc(sizeof(ClaspParser));
+    new_parser(p, l);
+    ClaspASTNode *tree = parser_compile(p);
+    assert(typecheck(tree) == 0);
+    return tree;
+}
+
+// The top-level temporaries and the initializer of `r`, as "name = init; ...; r".
+static void render_result(ClaspASTNode *tree, char *out) {
+    for (size_t i = 0; i < cvector_size(tree->data.block_stmt.body); ++i) {
+        ClaspASTNode *stmt = tree->data.block_stmt.body[i];
+        if (!stmt || stmt->type == AST_FN_DECL_STMT) continue;
+        const char *name = stmt->data.var_decl_stmt.name->data;
+        if (!strncmp(name, CLASP_INLINE_PREFIX, strlen(CLASP_INLINE_PREFIX))) {
+            sprintf(out + strlen(out), "%s = ", name);
+            render(stmt->data.var_decl_stmt.initializer, out);
+            strcat(out, "; ");
+        } else if (!strcmp(name, "r")) {
+            render(stmt->data.var_decl_stmt.initializer, out);
+        }
+    }
+}
+
+static const char *PRELUDE =
+    "var g: int = 2;\n"
+    "var x: int = 3;\n"
+    "fn sq(x: int) -> int { return x * x; }\n"
+    "fn cube(x: int) -> int { return sq(x) * x; }\n"
+    "fn add3(a: int, b: int, c: int) -> int { return a + b + c; }\n"
+    "fn hyp(a: int, b: int) -> int { let a2: int = a * a; let b2: int = b * b; return a2 + b2; }\n"
+    "fn scale(x: int) -> int { return x * g; }\n"
+    "fn fact(n: int) -> int { if (n < 2) return 1; return n * fact(n - 1); }\n"
+    "fn noisy(x: int) -> int { println(x); return x; }\n"
+    "fn bump() -> int { g++; return g; }\n"
+    "fn wide(x: int) -> long { return x * 2; }\n"
+    "fn big(x: int) -> int { return (x + 1) * (x + 2) * (x + 3) * (x + 4) + (x + 5) * (x + 6) * (x + 7); }\n";
+
+static const char *CORPUS[][3] = {
+        // Substituted in place
+    { "int",  "sq(x)",                  "(x * x)"                                               },
+    { "int",  "sq(3)",                  "(3 * 3)"                                               },
+    { "int",  "cube(x)",                "((x * x) * x)"                                         },
+    { "int",  "add3(x, 1, x + 1)",      "((x + 1) + (x + 1))"                                   },
+    { "int",  "scale(x)",               "(x * g)"                                               },
+        // Arguments and locals through temporaries
+    { "int",  "sq(x + 1)",              "__inl1_x = (x + 1); (__inl1_x * __inl1_x)"             },
+    { "int",  "hyp(x, 2)",              "__inl1_a2 = (x * x); __inl1_b2 = (2 * 2); (__inl1_a2 + __inl1_b2)" },
+    { "long", "wide(x)",                "__inl1_ret = (x * 2); __inl1_ret"                      },
+        // Left alone
+    { "int",  "fact(4)",                "fact(4)"                                               },
+    { "int",  "noisy(x)",               "noisy(x)"                                              },
+    { "int",  "bump()",                 "bump()"                                                },
+    { "int",  "sq(bump())",             "sq(bump())"                                            },
+    { "int",  "big(x) + big(2)",        "(big(x) + big(2))"                                     },
+        // A call with side effects keeps the rest of the statement from moving ahead of it
+    { "int",  "sq(x) + noisy(sq(x + 1))", "((x * x) + noisy(sq((x + 1))))"                     },
+};
+
+int main(int argc, char **argv) {
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(CORPUS) / sizeof(CORPUS[0]); ++i) {
+        char src[2048];
+        snprintf(src, sizeof(src), "%svar r: %s = %s;\n", PRELUDE, CORPUS[i][0], CORPUS[i][1]);
+        ClaspASTNode *tree = ast_inline(compile(src), NULL);
+        char out[1024] = "";
+        render_result(tree, out);
+        bool ok = !strcmp(out, CORPUS[i][2]);
+        printf("%-4s %-26s -> %s\n", ok ? "ok" : "FAIL", CORPUS[i][1], out);
+        failures += !ok;
+    }
+
+        // A budget of 0 turns inlining off
+    char src[2048];
+    snprintf(src, sizeof(src), "%svar r: int = sq(x);\n", PRELUDE);
+    ClaspInlineOptions off = { 0, false };
+    char out[1024] = "";
+    render_result(ast_inline(compile(src), &off), out);
+    bool ok = !strcmp(out, "sq(x)");
+    printf("%-4s %-26s -> %s\n", ok ? "ok" : "FAIL", "--inline=0", out);
+    failures += !ok;
+
+        // A global read by the callee can't be inlined where a local hides it
+    ClaspASTNode *tree = ast_inline(compile("var g: int = 2;\nfn scale(x: int) -> int { return x * g; }\n"
+                                            "fn user(g: int) -> int { return scale(g); }\nfn other(y: int) -> int { return scale(y); }\n"), NULL);
+    out[0] = '\0';
+    render(tree->data.block_stmt.body[2]->data.fn_decl_stmt.body->data.block_stmt.body[0]->data.return_stmt.retval, out);
+    strcat(out, ", ");
+    render(tree->data.block_stmt.body[3]->data.fn_decl_stmt.body->data.block_stmt.body[0]->data.return_stmt.retval, out);
+    ok = !strcmp(out, "scale(g), (y * g)");
+    printf("%-4s %-26s -> %s\n", ok ? "ok" : "FAIL", "capture", out);
+    failures += !ok;
+
+    fflush(stdout);
+    assert(failures == 0);
+    return 0;
+}
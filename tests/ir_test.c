@@ -0,0 +1,223 @@
+/**
+ * Clasp SSA IR test
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Test Suite
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/lexer.h>
+#include <clasp/parser.h>
+#include <clasp/typecheck.h>
+#include <clasp/types.h>
+#include <clasp/ir_build.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+typedef struct {
+    char *data;
+    unsigned int idx;
+} StringStream;
+
+StringStream str;
+
+char read_string() {
+    if (str.idx == strlen(str.data)) return EOF;
+    return str.data[str.idx++];
+}
+
+static ClaspIRModule *build(const char *src) {
+    char buf[1024];
+    snprintf(buf, sizeof(buf), "%s\n", src);
+    str = (StringStream) { buf, 0 };
+    ClaspLexer *l = calloc(1, sizeof(ClaspLexer));
+    new_lexer(l, read_string, NULL);
+    ClaspParser *p = malloc(sizeof(ClaspParser));
+    new_parser(p, l);
+    ClaspASTNode *tree = parser_compile(p);
+    assert(typecheck(tree) == 0);
+    return ir_build(tree);
+}
+
+static ClaspIRFunction *function(ClaspIRModule *m, const char *name) {
+    for (size_t i = 0; i < cvector_size(m->fns); ++i)
+        if (!strcmp(m->fns[i]->name, name)) return m->fns[i];
+    return NULL;
+}
+
+static size_t count(ClaspIRFunction *fn, ClaspIROp op) {
+    size_t n = 0;
+    for (size_t i = 0; i < cvector_size(fn->insts); ++i) n += fn->insts[i].op == op;
+    return n;
+}
+
+// Source, function to look at, its blocks, phis and globals in the module.
+static const struct {
+    const char *src;
+    const char *fn;
+    size_t blocks, phis, globals;
+} CORPUS[] = {
+        // Straight line code needs no phis
+    { "fn f(x: int) -> int { let y: int = x * 2; return y + 1; }",                                    "f", 1, 0, 0 },
+    { "fn f(x: int) -> int { var y: int = x; y = y * 2; y += 1; return y; }",                         "f", 1, 0, 0 },
+        // Joins merge only what was written
+    { "fn f(x: int) -> int { var y: int = 1; if (x) { y = 2; } return y; }",                          "f", 3, 1, 0 },
+    { "fn f(x: int) -> int { var y: int = 1; if (x) { println(x); } return y; }",                     "f", 3, 0, 0 },
+    { "fn f(x: int) -> int { if (x) { return 1; } return 2; }",                                       "f", 3, 0, 0 },
+        // Loops get one phi per variable written in them
+    { "fn f(n: int) -> int { var s: int = 0; var i: int = 0; while (i < n) { s += i; i++; } return s; }", "f", 4, 2, 0 },
+    { "fn f(n: int) -> int { var s: int = 0; for (var i: int = 0; i < n; i++) s += i; return s; }",   "f", 4, 2, 0 },
+    { "fn f(n: int) -> int { var s: int = 0; while (n) { s++; } return s; }",                         "f", 4, 1, 0 },
+    { "fn f(n: int) -> int { var s: int = 0; while (s < n) { var j: int = 0; while (j < s) { j++; } s += j; } return s; }", "f", 7, 2, 0 },
+        // Loop invariant variables stay out of the header
+    { "fn f(n: int, k: int) -> int { var i: int = 0; while (i < n) { i += k; } return i; }",          "f", 4, 1, 0 },
+        // Top level variables used by functions become globals
+    { "var g: int = 1;\nfn f() -> int { return g; }\nprintln(f());",                                 "f", 1, 0, 1 },
+    { "var g: int = 1;\nvar h: int = 2;\nfn f() -> int { return g; }\nprintln(f() + h);",            CLASP_IR_INIT, 1, 0, 1 },
+        // Conversions and float conditions
+    { "fn f(x: float) -> long { var y: long = 0; if (x) { y = 3; } return y; }",                      "f", 3, 1, 0 },
+};
+
+static const char *DUMP_SRC = "fn f(n: int) -> int { var i: int = 0; while (i < n) { i++; } return i; }";
+static const char *DUMP =
+    "fn __init() -> void {\n"
+    "b0:\n"
+    "    ret\n"
+    "}\n"
+    "\n"
+    "fn f(i32) -> i32 {\n"
+    "b0:\n"
+    "    %0 = param i32 0\n"
+    "    %1 = const i32 0\n"
+    "    br b1\n"
+    "b1: ; preds b0, b2\n"
+    "    %3 = phi i32 [%1, b0], [%7, b2]\n"
+    "    %4 = lt i32 %3, %0\n"
+    "    cbr %4, b2, b3\n"
+    "b2: ; preds b1\n"
+    "    %6 = const i32 1\n"
+    "    %7 = add i32 %3, %6\n"
+    "    br b1\n"
+    "b3: ; preds b1\n"
+    "    ret %3\n"
+    "}\n";
+
+// A hand built `fn f(i32) -> i32` with an entry block, for breaking on purpose.
+static ClaspIRModule *skeleton(ClaspIRFunction **fn) {
+    ClaspIRModule *m = calloc(1, sizeof(ClaspIRModule));
+    cvector(ClaspASTNode *) args = NULL;
+    cvector_push_back(args, type_intern("int"));
+    *fn = ir_function(m, "f", type_intern_fn(args, type_intern("int")));
+    cvector_free(args);
+    cvector_push_back((*fn)->blocks, ((ClaspIRBlock) { NULL, NULL }));
+    ClaspIRInst param = { .op = IR_PARAM, .type = IR_I32 };
+    param.imm.index = 0;
+    ir_emit(*fn, 0, param);
+    return m;
+}
+
+static void expect_invalid(const char *what, ClaspIRModule *m, int *failures) {
+    size_t errors = ir_verify(m, NULL);
+    printf("%-4s verifier rejects %s\n", errors ? "ok" : "FAIL", what);
+    *failures += !errors;
+    ir_free(m);
+}
+
+int main(int argc, char **argv) {
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(CORPUS) / sizeof(CORPUS[0]); ++i) {
+        ClaspIRModule *m = build(CORPUS[i].src);
+        assert(m);
+        size_t errors = ir_verify(m, stdout);
+        ClaspIRFunction *fn = function(m, CORPUS[i].fn);
+        assert(fn);
+        size_t blocks = cvector_size(fn->blocks), phis = count(fn, IR_PHI), globals = cvector_size(m->globals);
+        bool ok = !errors && blocks == CORPUS[i].blocks && phis == CORPUS[i].phis && globals == CORPUS[i].globals;
+        char label[41];
+        snprintf(label, sizeof(label), "%s", CORPUS[i].src);
+        for (char *c = label; *c; ++c) if (*c == '\n') *c = ' ';
+        printf("%-4s %-40s -> %zu blocks, %zu phis, %zu globals\n", ok ? "ok" : "FAIL", label, blocks, phis, globals);
+        if (!ok) ir_dump(m, stdout);
+        failures += !ok;
+        ir_free(m);
+    }
+
+    // Text form
+    ClaspIRModule *m = build(DUMP_SRC);
+    char *text = NULL;
+    size_t len = 0;
+    FILE *out = open_memstream(&text, &len);
+    ir_dump(m, out);
+    fclose(out);
+    bool ok = !strcmp(text, DUMP);
+    printf("%-4s dump\n", ok ? "ok" : "FAIL");
+    if (!ok) printf("%s", text);
+    failures += !ok;
+    free(text);
+    ir_free(m);
+
+    // Broken functions
+    ClaspIRFunction *fn;
+    m = skeleton(&fn);
+    expect_invalid("a block without a terminator", m, &failures);
+
+    m = skeleton(&fn);
+    ir_emit(fn, 0, (ClaspIRInst) { .op = IR_RET, .type = IR_VOID, .a = CLASP_IR_NONE });
+    expect_invalid("a missing return value", m, &failures);
+
+    m = skeleton(&fn);
+    ClaspIRInst wide = { .op = IR_CONST, .type = IR_I64 };
+    ClaspIRValue w = ir_emit(fn, 0, wide);
+    ir_emit(fn, 0, (ClaspIRInst) { .op = IR_ADD, .type = IR_I32, .a = 0, .b = w });
+    ir_emit(fn, 0, (ClaspIRInst) { .op = IR_RET, .type = IR_VOID, .a = 0 });
+    expect_invalid("mismatched operand types", m, &failures);
+
+    m = skeleton(&fn);
+    ClaspIRValue late = cvector_size(fn->insts) + 1;
+    ir_emit(fn, 0, (ClaspIRInst) { .op = IR_NEG, .type = IR_I32, .a = late });
+    ir_emit(fn, 0, (ClaspIRInst) { .op = IR_NEG, .type = IR_I32, .a = 0 });
+    ir_emit(fn, 0, (ClaspIRInst) { .op = IR_RET, .type = IR_VOID, .a = 0 });
+    expect_invalid("a use before its definition", m, &failures);
+
+    m = skeleton(&fn);
+    cvector_push_back(fn->blocks, ((ClaspIRBlock) { NULL, NULL }));
+    ir_emit(fn, 0, (ClaspIRInst) { .op = IR_BR, .type = IR_VOID, .a = 1 });
+    cvector_push_back(fn->blocks[1].preds, 0);
+    ClaspIRInst phi = { .op = IR_PHI, .type = IR_I32 };
+    phi.imm.list.first = 0;
+    phi.imm.list.count = 2;
+    cvector_push_back(fn->operands, 0);
+    cvector_push_back(fn->operands, 0);
+    ClaspIRValue p = ir_emit(fn, 1, phi);
+    ir_emit(fn, 1, (ClaspIRInst) { .op = IR_RET, .type = IR_VOID, .a = p });
+    expect_invalid("a phi with more operands than predecessors", m, &failures);
+
+    m = skeleton(&fn);
+    cvector_push_back(fn->blocks, ((ClaspIRBlock) { NULL, NULL }));
+    ir_emit(fn, 0, (ClaspIRInst) { .op = IR_BR, .type = IR_VOID, .a = 1 });
+    ir_emit(fn, 1, (ClaspIRInst) { .op = IR_RET, .type = IR_VOID, .a = 0 });
+    expect_invalid("a branch missing from the predecessor list", m, &failures);
+
+    fflush(stdout);
+    assert(failures == 0);
+    return 0;
+}
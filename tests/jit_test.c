@@ -0,0 +1,205 @@
+/**
+ * Clasp bytecode JIT test
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Test Suite
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/lexer.h>
+#include <clasp/parser.h>
+#include <clasp/typecheck.h>
+#include <clasp/lower.h>
+#include <clasp/resolve.h>
+#include <clasp/bytecode_emit.h>
+#include <clasp/peephole.h>
+#include <clasp/jit.h>
+#include <clasp/vm.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+typedef struct {
+    char *data;
+    unsigned int idx;
+} StringStream;
+
+StringStream str;
+
+char read_string() {
+    if (str.idx == strlen(str.data)) return EOF;
+    return str.data[str.idx++];
+}
+
+static ClaspBytecode *compile(const char *src, bool peephole) {
+    char buf[1024];
+    snprintf(buf, sizeof(buf), "%s\n", src);
+    str = (StringStream) { buf, 0 };
+    ClaspLexer *l = calloc(1, sizeof(ClaspLexer));
+    new_lexer(l, read_string, NULL);
+    ClaspParser *p = malloc(sizeof(ClaspParser));
+    new_parser(p, l);
+    ClaspASTNode *tree = parser_compile(p);
+    assert(typecheck(tree) == 0);
+    tree = lower_pow(tree);
+    ClaspResolution res;
+    ast_resolve(tree, &res);
+    ClaspBytecode *bc = bytecode_emit(tree, &res);
+    resolution_free(&res);
+    assert(bc);
+    if (peephole) bytecode_peephole(bc);
+    return bc;
+}
+
+static char output[256];
+
+// println, writing into `output` instead of stdout
+static ClaspVMCell record(ClaspVMCell *args) {
+    size_t len = strlen(output);
+    snprintf(output + len, sizeof(output) - len, "%d ", (int32_t) args[0].i);
+    return (ClaspVMCell) { 0 };
+}
+
+// Run a module, returning whether it ran. The output goes to `output` and the error to vm->error.
+static bool run(ClaspVM *vm, ClaspBytecode *bc, ClaspVMDispatch dispatch, uint32_t threshold) {
+    bool ok = vm_init(vm, bc);
+    vm->dispatch = dispatch;
+    vm->jit_threshold = threshold;
+    vm_define(vm, "println", &record, 1, 0);
+    output[0] = '\0';
+    return ok && vm_run(vm);
+}
+
+// Whether a function of the module, by name, has been compiled
+static bool compiled(ClaspVM *vm, const char *name) {
+    ClaspVMSymbol *sym = hashmap_get(&vm->symbols, name, strlen(name));
+    return vm->jit && vm->jit->fns[vm->entries[sym->addr] - vm->code].code;
+}
+
+// Source, and the functions that must end up compiled with a threshold of 1
+static const struct {
+    const char *src;
+    const char *compiled;
+} CORPUS[] = {
+    { "fn fib(n: int) -> int { if (n < 2) { return n; } return fib(n - 1) + fib(n - 2); }\n"
+      "var total: long = 0;\nfor (var i: int = 0; i < 10; i++) { total += fib(i); }\nprintln(total);",   "fib" },
+        // Every integer class, division and comparisons
+    { "fn f(a: byte, b: short, c: int, d: long) -> long { a += 100; b *= 300; c = c / 7 + c % 7; d *= 1000000;\n"
+      "var e: int = -a; var g: long = !c; println(a); println(b); println(c); println(e); println(g); println(~b);\n"
+      "d ~= 5; return d / 1000; }\nprintln(f(100, 200, -100, 9));\nprintln(f(1, 2, 3, 4));",                "f" },
+    { "fn q(a: long, b: long) -> long { return a / b + a % b; }\nprintln(q(-7, -1));\nprintln(q(-9, 4));",   "q" },
+    { "fn c(a: int, b: int) -> int { var n: int = 0; if (a < b) { n += 1; } if (a <= b) { n += 2; }\n"
+      "if (a > b) { n += 4; } if (a >= b) { n += 8; } if (a == b) { n += 16; } if (a != b) { n += 32; }\n"
+      "return n; }\nprintln(c(1, 2));\nprintln(c(2, 2));\nprintln(c(3, 2));\nprintln(c(1, 2) < c(3, 2));",  "c" },
+        // Doubles, conversions and the native pow
+    { "fn h(x: double, n: int) -> int { var y: double = x * n - 0.5; y = y / 2 + 1.0; var m: double = 7.5;\n"
+      "m -= 6; if (y > m) { println(1); } if (y != y) { println(2); } if (m <= 1.5) { println(3); }\n"
+      "return y ^ 2.0; }\nprintln(h(1.5, 4));\nprintln(h(-2.0, 3));",                                    "h" },
+    { "fn half(x: float, n: int) -> int { var y: float = x / 2 + n; y = -y; var z: double = y;\n"
+      "if (y < -2.5) { println(1); } if (y == z) { println(2); } return y * 10; }\nprintln(half(3.0, 1));\nprintln(half(1.5, 2));", "half" },
+        // Loops, nested blocks and globals
+    { "var g: long = 0;\nfn f(n: int) -> int { var s: int = 0; for (var i: int = 0; i < n; i++) { var j: int = 0;\n"
+      "while (j < i) { s += j; j++; g += 1; } } return s; }\nprintln(f(10));\nprintln(g);",                 "f" },
+    { "fn f(x: int) -> int { if (x) { return 1; } }\nfn v(x: int) -> void { println(x); }\nv(f(0));\nv(f(5));", "v" },
+};
+
+int main(int argc, char **argv) {
+    int failures = 0;
+
+    // Compiled code prints what the interpreter does, with and without the peephole pass
+    for (size_t i = 0; i < sizeof(CORPUS) / sizeof(CORPUS[0]); ++i) {
+        for (int peephole = 0; peephole < 2; ++peephole) {
+            ClaspBytecode *bc = compile(CORPUS[i].src, peephole);
+            ClaspVM vm;
+            bool ok = run(&vm, bc, CLASP_VM_CACHED, 1);
+            char expect[256];
+            strcpy(expect, output);
+            vm_free(&vm);
+            bool jitted = run(&vm, bc, CLASP_VM_JIT, 1); // Always, so vm is initialized for the vm_free below
+            ok = ok && jitted && !strcmp(output, expect);
+            ok = ok && (!CLASP_VM_HAS_JIT || compiled(&vm, CORPUS[i].compiled));
+            char label[41];
+            snprintf(label, sizeof(label), "%s", CORPUS[i].src);
+            for (char *c = label; *c; ++c) if (*c == '\n') *c = ' ';
+            printf("%-4s %-40s -> %s%s\n", ok ? "ok" : "FAIL", label, output, vm.error);
+            if (!ok) printf("     expected %s\n", expect);
+            failures += !ok;
+            vm_free(&vm);
+            bytecode_free(bc);
+        }
+    }
+
+    // Functions are compiled on the call that reaches the threshold, callees with them or on their own
+    {
+        ClaspBytecode *bc = compile("fn sq(x: int) -> int { return x * x; }\nfn two(x: int) -> int { return sq(x) + sq(x); }\n"
+                                    "for (var i: int = 0; i < 3; i++) { println(sq(i)); }\nprintln(two(3));\nprintln(two(4));", true);
+        ClaspVM vm;
+        bool ok = run(&vm, bc, CLASP_VM_JIT, 3) && !strcmp(output, "0 1 4 18 32 ");
+        ok = ok && compiled(&vm, "sq") == CLASP_VM_HAS_JIT && !compiled(&vm, "two");
+        vm_free(&vm);
+        bool again = run(&vm, bc, CLASP_VM_JIT, 2);
+        ok = ok && again && !strcmp(output, "0 1 4 18 32 ");
+        ok = ok && compiled(&vm, "sq") == CLASP_VM_HAS_JIT && compiled(&vm, "two") == CLASP_VM_HAS_JIT;
+        printf("%-4s compiles at the threshold -> %s%s\n", ok ? "ok" : "FAIL", output, vm.error);
+        failures += !ok;
+        vm_free(&vm);
+        bytecode_free(bc);
+    }
+
+    // Functions without templates are left to the interpreter, and so are their callers
+    {
+        ClaspBytecode *bc = compile("fn g(x: int) -> int { return x + 1; }\nfn call(x: int) -> int { let h = g; return h(x); }\n"
+                                    "fn twice(x: int) -> int { return call(x) * 2; }\nprintln(twice(3));\nprintln(g(5));", true);
+        ClaspVM vm;
+        bool ok = run(&vm, bc, CLASP_VM_JIT, 1) && !strcmp(output, "8 6 ");
+        ok = ok && !compiled(&vm, "call") && !compiled(&vm, "twice") && compiled(&vm, "g") == CLASP_VM_HAS_JIT;
+        printf("%-4s falls back to the interpreter -> %s%s\n", ok ? "ok" : "FAIL", output, vm.error);
+        failures += !ok;
+        vm_free(&vm);
+        bytecode_free(bc);
+    }
+
+    // Traps in compiled code are reported as the interpreter reports them
+    const char *TRAPS[] = {
+        "fn d(x: int, y: int) -> int { return x / y; }\nprintln(d(4, 2));\nprintln(d(4, 0));",
+        "fn f(x: int) -> int { return f(x) + 1; }\nprintln(f(1));",
+        "fn f(x: long) -> long { var a: long = x; var b: long = x; var c: long = x; var d: long = x; var e: long = x;\n"
+        "return f(x + a + b + c + d + e) + 1; }\nprintln(f(1));",
+    };
+    for (size_t i = 0; i < sizeof(TRAPS) / sizeof(TRAPS[0]); ++i) {
+        ClaspBytecode *bc = compile(TRAPS[i], true);
+        ClaspVM vm;
+        bool ok = !run(&vm, bc, CLASP_VM_THREADED, 1);
+        char expect[160];
+        strcpy(expect, vm.error);
+        vm_free(&vm);
+        ok = ok && !run(&vm, bc, CLASP_VM_JIT, 1) && !strcmp(vm.error, expect);
+        printf("%-4s traps %s\n", ok ? "ok" : "FAIL", vm.error);
+        if (!ok) printf("     expected %s\n", expect);
+        failures += !ok;
+        vm_free(&vm);
+        bytecode_free(bc);
+    }
+
+    fflush(stdout);
+    assert(failures == 0);
+    return 0;
+}
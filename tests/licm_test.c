@@ -0,0 +1,126 @@
+/**
+ * Clasp loop-invariant code motion test
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Test Suite
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/lexer.h>
+#include <clasp/parser.h>
+#include <clasp/typecheck.h>
+#include <clasp/fold.h>
+#include <clasp/licm.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+typedef struct {
+    char *data;
+    unsigned int idx;
+} StringStream;
+
+StringStream str;
+
+char read_string() {
+    if (str.idx == strlen(str.data)) return EOF;
+    return str.data[str.idx++];
+}
+
+// Render an expression fully parenthesized, so the corpus pins down the tree shape.
+static void render(ClaspASTNode *node, char *out) {
+    char a[256] = "", b[256] = "";
+    switch (node->type) {
+        case AST_EXPR_LIT_NUMBER: strcat(out, node->data.lit_num.value->data); break;
+        case AST_EXPR_VAR_REF:    strcat(out, node->data.var_ref.varname->data); break;
+        case AST_EXPR_BINOP:
+            render(node->data.binop.left, a);
+            render(node->data.binop.right, b);
+            sprintf(out + strlen(out), "(%s %s %s)", a, node->data.binop.op->data, b);
+            break;
+        case AST_EXPR_UNOP:
+            render(node->data.unop.right, a);
+            sprintf(out + strlen(out), "%s%s", node->data.unop.op->data, a);
+            break;
+        default: strcat(out, "?"); break;
+    }
+}
+
+static const char *PRELUDE = "var x: int = 5;\nvar n: int = 3;\nlet k: int = x + 1;\nvar y: double = 1.5;\nvar t: int = 0;\n";
+
+// Loop, then the initializers of the temporaries hoisted in front of it.
+static const char *CORPUS[][2] = {
+        // Invariant operands
+    { "while (t < 100) { t += x * n; }",                    "(x * n)"               },
+    { "while (t < x * n) t++;",                             "(x * n)"               },
+    { "while (t < 100) t += -x + t;",                       "-x"                    },
+    { "while (t < 100) { t += (x + 1) * (n - 1) - t; }",    "((x + 1) * (n - 1))"   },
+    { "while (t < 100) { let m: int = x + 1; t += m * 2; }", "(x + 1)"              },
+    { "while (y < 100.0) { y = y + (x + 0.5) * 2.0; }",     "((x + 0.5) * 2.0)"     },
+    { "for (var i: int = 0; i < x * n; i++) t += i * k;",   "(x * n)"               },
+        // Variant operands
+    { "while (t < 100) { t += x * t; }",                    ""                      },
+    { "while (t < 100) { n++; t += x * n; }",               ""                      },
+    { "while (t < 100) { t += 1; x = x + n; }",             ""                      },
+    { "for (var i: int = 0; i < 10; i++) t += i * 2;",      ""                      },
+        // Calls may assign any var, but not let/const
+    { "while (t < 100) { println(t); t += x * n; }",        ""                      },
+    { "while (t < 100) { println(t); t += k * 3; }",        "(k * 3)"               },
+        // Integer division only by a nonzero literal
+    { "while (t < 100) { t += x / n; }",                    ""                      },
+    { "while (t < 100) { t += x % n + 1; }",                ""                      },
+    { "while (t < 100) { t += x / 4; }",                    "(x / 4)"               },
+        // Temporaries from inner loops keep moving out
+    { "while (t < 100) { var j: int = 0; while (j < 10) { j++; t += x * n; } }", "(x * n)"  },
+    { "while (t < 100) { var j: int = 0; while (j < 10) { j++; t += j * (x - n); } }", "(x - n)" },
+    { "while (t < 100) { var j: int = t; while (j < 10) { j++; t += t * (x - n); } }", "(x - n)" },
+    { "while (t < 100) { var j: int = 0; while (j < 10) { j++; t += x * t; } n++; }", "" },
+};
+
+int main(int argc, char **argv) {
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(CORPUS) / sizeof(CORPUS[0]); ++i) {
+        char src[1024];
+        snprintf(src, sizeof(src), "%s%s\n", PRELUDE, CORPUS[i][0]);
+        str = (StringStream) { src, 0 };
+        ClaspLexer *l = calloc(1, sizeof(ClaspLexer));
+        new_lexer(l, read_string, NULL);
+        ClaspParser *p = malloc(sizeof(ClaspParser));
+        new_parser(p, l);
+        ClaspASTNode *tree = parser_compile(p);
+        assert(typecheck(tree) == 0);
+
+        tree = ast_licm(ast_fold(tree));
+        char out[1024] = "";
+        for (size_t j = 0; j < cvector_size(tree->data.block_stmt.body); ++j) {
+            ClaspASTNode *stmt = tree->data.block_stmt.body[j];
+            if (!stmt || stmt->type != AST_LET_DECL_STMT || strncmp(stmt->data.var_decl_stmt.name->data, CLASP_LICM_PREFIX, strlen(CLASP_LICM_PREFIX))) continue;
+            if (*out) strcat(out, ", ");
+            render(stmt->data.var_decl_stmt.initializer, out);
+        }
+        bool ok = !strcmp(out, CORPUS[i][1]);
+        printf("%-4s %-52s -> %s\n", ok ? "ok" : "FAIL", CORPUS[i][0], out);
+        failures += !ok;
+    }
+    fflush(stdout);
+    assert(failures == 0);
+    return 0;
+}
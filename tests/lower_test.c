@@ -0,0 +1,160 @@
+/**
+ * Clasp lowering pass test
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Test Suite
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/lexer.h>
+#include <clasp/parser.h>
+#include <clasp/typecheck.h>
+#include <clasp/fold.h>
+#include <clasp/lower.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+typedef struct {
+    char *data;
+    unsigned int idx;
+} StringStream;
+
+StringStream str;
+
+char read_string() {
+    if (str.idx == strlen(str.data)) return EOF;
+    return str.data[str.idx++];
+}
+
+// Render an expression fully parenthesized, so the corpus pins down the tree shape.
+static void render(ClaspASTNode *node, char *out) {
+    char a[256] = "", b[256] = "";
+    switch (node->type) {
+        case AST_EXPR_LIT_NUMBER: strcat(out, node->data.lit_num.value->data); break;
+        case AST_EXPR_VAR_REF:    strcat(out, node->data.var_ref.varname->data); break;
+        case AST_EXPR_BINOP:
+            render(node->data.binop.left, a);
+            render(node->data.binop.right, b);
+            sprintf(out + strlen(out), "(%s %s %s)", a, node->data.binop.op->data, b);
+            break;
+        case AST_EXPR_UNOP:
+            render(node->data.unop.right, a);
+            sprintf(out + strlen(out), "%s%s", node->data.unop.op->data, a);
+            break;
+        case AST_EXPR_FN_CALL:
+            render(node->data.fn_call.args[0], a);
+            render(node->data.fn_call.args[1], b);
+            sprintf(out + strlen(out), "%s(%s, %s)", node->data.fn_call.referencer->data.var_ref.varname->data, a, b);
+            break;
+        case AST_EXPR_POSTFIX:
+            render(node->data.postfix.left, a);
+            sprintf(out + strlen(out), "%s%s", a, node->data.postfix.op->data);
+            break;
+        default: strcat(out, "?"); break;
+    }
+}
+
+// The last expression statement of the program, looking into trailing if/while bodies and blocks.
+static ClaspASTNode *last_expr(ClaspASTNode *node) {
+    while (node->type != AST_EXPR_STMT) {
+        if (node->type == AST_BLOCK_STMT) {
+            size_t n = cvector_size(node->data.block_stmt.body);
+            while (!node->data.block_stmt.body[n - 1]) n--; // The parser leaves a NULL for the end of the file
+            node = node->data.block_stmt.body[n - 1];
+        } else {
+            node = node->data.cond_stmt.body;
+        }
+    }
+    return node->data.expr_stmt.expr;
+}
+
+static const char *PRELUDE = "var x: int = 5;\nvar n: int = 3;\nvar y: double = 1.5;\nvar f: float = 2;\n";
+
+static const char *CORPUS[][2] = {
+        // Small constant exponents unroll into balanced multiply chains
+    { "x ^ 2",        "(x * x)"                     },
+    { "x ^ 5",        "(((x * x) * (x * x)) * x)"   },
+    { "y ^ 3",        "((y * y) * y)"               },
+    { "y ^ 2.0",      "(y * y)"                     },
+    { "(x + 1) ^ 2",  "((x + 1) * (x + 1))"         },
+    { "x ^ 8",        "(((x * x) * (x * x)) * ((x * x) * (x * x)))" },
+        // Everything else goes through the runtime
+    { "x ^ 9",        "clasp_ipow(x, 9)"            },
+    { "(x + 1) ^ 3",  "clasp_ipow((x + 1), 3)"      },
+    { "x ^ n",        "clasp_ipow(x, n)"            },
+    { "x ^ -1",       "clasp_ipow(x, -1)"           },
+    { "y ^ 0.5",      "pow(y, 0.5)"                 },
+    { "f ^ n",        "pow(f, n)"                   },
+    { "x ^ y",        "pow(x, y)"                   },
+    { "x ^ 2.0",      "pow(x, 2.0)"                 },  // Multiplying ints would wrap before the result is a double
+        // Compound assignment
+    { "x ^= 2",       "(x = (x * x))"               },
+    { "x ^= n",       "(x = clasp_ipow(x, n))"      },
+    { "x ^= 0.5",     "(x = pow(x, 0.5))"           },
+};
+
+int main(int argc, char **argv) {
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(CORPUS) / sizeof(CORPUS[0]); ++i) {
+        char src[1024];
+        snprintf(src, sizeof(src), "%s%s;\n", PRELUDE, CORPUS[i][0]);
+        str = (StringStream) { src, 0 };
+        ClaspLexer *l = calloc(1, sizeof(ClaspLexer));
+        new_lexer(l, read_string, NULL);
+        ClaspParser *p = malloc(sizeof(ClaspParser));
+        new_parser(p, l);
+        ClaspASTNode *tree = parser_compile(p);
+        assert(typecheck(tree) == 0);
+
+        tree = lower_pow(ast_fold(tree));
+        char out[1024] = "";
+        render(last_expr(tree), out);
+        bool ok = !strcmp(out, CORPUS[i][1]);
+        printf("%-4s %-16s -> %s\n", ok ? "ok" : "FAIL", CORPUS[i][0], out);
+        failures += !ok;
+    }
+
+        // for loops lower to `{ init; while (cond) { body; step } }`
+    str = (StringStream) { "var t: int = 0;\nfor (var i: int = 0; i < 4; i++) t += i ^ 2;\n", 0 };
+    ClaspLexer *l = calloc(1, sizeof(ClaspLexer));
+    new_lexer(l, read_string, NULL);
+    ClaspParser *p = malloc(sizeof(ClaspParser));
+    new_parser(p, l);
+    ClaspASTNode *tree = parser_compile(p);
+    assert(typecheck(tree) == 0);
+    tree = lower_for(lower_pow(tree));
+    ClaspASTNode *loop = tree->data.block_stmt.body[1];
+    assert(loop->type == AST_BLOCK_STMT && cvector_size(loop->data.block_stmt.body) == 2);
+    assert(loop->data.block_stmt.body[0]->type == AST_VAR_DECL_STMT);
+    ClaspASTNode *w = loop->data.block_stmt.body[1];
+    assert(w->type == AST_WHILE_STMT);
+    char out[1024] = "";
+    render(w->data.cond_stmt.cond, out);
+    render(last_expr(w), out);
+    bool ok = !strcmp(out, "(i < 4)i++");
+    printf("%-4s %-16s -> %s\n", ok ? "ok" : "FAIL", "for", out);
+    failures += !ok;
+
+    fflush(stdout);
+    assert(failures == 0);
+    return 0;
+}
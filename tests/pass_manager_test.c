@@ -0,0 +1,126 @@
+/**
+ * Clasp pass manager test
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Test Suite
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/lexer.h>
+#include <clasp/parser.h>
+#include <clasp/typecheck.h>
+#include <clasp/fold.h>
+#include <clasp/dce.h>
+#include <clasp/pass_manager.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+typedef struct {
+    char *data;
+    unsigned int idx;
+} StringStream;
+
+StringStream str;
+
+char read_string() {
+    if (str.idx == strlen(str.data)) return EOF;
+    return str.data[str.idx++];
+}
+
+static char trace[64];
+
+static ClaspASTNode *pass_a(ClaspASTNode *ast) { strcat(trace, "a"); return ast; }
+static ClaspASTNode *pass_b(ClaspASTNode *ast) { strcat(trace, "b"); return ast; }
+static ClaspASTNode *pass_c(ClaspASTNode *ast, void *args) { strcat(trace, args); return ast; }
+
+static void run(const char *select, const char *expected) {
+    ClaspPassManager pm;
+    pass_manager_init(&pm, false);
+    pass_manager_add(&pm, "a", &pass_a);
+    pass_manager_add(&pm, "b", &pass_b);
+    pass_manager_add_with(&pm, "c", &pass_c, "c");
+    bool ok = !select || pass_manager_select(&pm, select);
+    trace[0] = '\0';
+    if (ok) pass_manager_run(&pm, NULL);
+    printf("%-4s %-10s -> %s\n", (expected ? ok && !strcmp(trace, expected) : !ok) ? "ok" : "FAIL", select ? select : "(all)", ok ? trace : "rejected");
+    assert(expected ? ok && !strcmp(trace, expected) : !ok);
+    assert(!pm.stats); // Nothing is measured unless asked
+    pass_manager_free(&pm);
+}
+
+int main(int argc, char **argv) {
+    // Order and selection
+    run(NULL, "abc");
+    run("c,a", "ca");
+    run("b,b,a", "bba");
+    run("", "");
+    run("a,d", NULL);
+
+    // Measuring real passes
+    str = (StringStream) { "var x: int = 2 * 3;\nif (0) { x++; }\nprintln(x);\n", 0 };
+    ClaspLexer *l = calloc(1, sizeof(ClaspLexer));
+    new_lexer(l, read_string, NULL);
+    ClaspParser *p = malloc(sizeof(ClaspParser));
+    new_parser(p, l);
+
+    ClaspPassManager pm;
+    pass_manager_init(&pm, true);
+    pass_manager_add(&pm, "fold", &ast_fold);
+    pass_manager_add(&pm, "dce", &ast_dce);
+
+    size_t phase = pass_manager_begin(&pm, "parse", NULL);
+    ClaspASTNode *tree = parser_compile(p);
+    pass_manager_end(&pm, phase, tree);
+    assert(typecheck(tree) == 0);
+    tree = pass_manager_run(&pm, tree);
+
+    assert(cvector_size(pm.stats) == 3);
+    assert(!strcmp(pm.stats[0].name, "parse") && !strcmp(pm.stats[1].name, "fold") && !strcmp(pm.stats[2].name, "dce"));
+    assert(pm.stats[0].nodes_in == 0 && pm.stats[0].nodes_out > 0);
+    assert(pm.stats[1].nodes_in == pm.stats[0].nodes_out);
+    assert(pm.stats[1].nodes_out < pm.stats[1].nodes_in);    // 2 * 3 folds to a literal
+    assert(pm.stats[2].nodes_out < pm.stats[2].nodes_in);    // The if goes away
+    for (size_t i = 0; i < cvector_size(pm.stats); ++i) assert(pm.stats[i].ms >= 0);
+    printf("ok   stats: nodes %llu -> %llu -> %llu\n", (unsigned long long) pm.stats[1].nodes_in,
+        (unsigned long long) pm.stats[1].nodes_out, (unsigned long long) pm.stats[2].nodes_out);
+
+    char *text = NULL;
+    size_t len = 0;
+    FILE *out = open_memstream(&text, &len);
+    pass_manager_report(&pm, out, CLASP_REPORT_JSON);
+    fclose(out);
+    assert(!strncmp(text, "{\"total_ms\": ", 13));
+    assert(strstr(text, "{\"name\": \"fold\", \"ms\": "));
+    assert(text[len - 2] == '}');
+    free(text);
+
+    out = open_memstream(&text, &len);
+    pass_manager_report(&pm, out, CLASP_REPORT_TABLE);
+    fclose(out);
+    assert(!strncmp(text, "Pass", 4) && strstr(text, "\ndce ") && strstr(text, "\nTotal "));
+    free(text);
+    printf("ok   reports\n");
+
+    pass_manager_free(&pm);
+    fflush(stdout);
+    return 0;
+}
@@ -0,0 +1,170 @@
+/**
+ * Clasp bytecode peephole optimizer test
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Test Suite
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/lexer.h>
+#include <clasp/parser.h>
+#include <clasp/typecheck.h>
+#include <clasp/lower.h>
+#include <clasp/resolve.h>
+#include <clasp/bytecode_emit.h>
+#include <clasp/peephole.h>
+#include <clasp/vm.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+typedef struct {
+    char *data;
+    unsigned int idx;
+} StringStream;
+
+StringStream str;
+
+char read_string() {
+    if (str.idx == strlen(str.data)) return EOF;
+    return str.data[str.idx++];
+}
+
+static ClaspBytecode *emit(const char *src) {
+    char buf[1024];
+    snprintf(buf, sizeof(buf), "%s\n", src);
+    str = (StringStream) { buf, 0 };
+    ClaspLexer *l = calloc(1, sizeof(ClaspLexer));
+    new_lexer(l, read_string, NULL);
+    ClaspParser *p = malloc(sizeof(ClaspParser));
+    new_parser(p, l);
+    ClaspASTNode *tree = parser_compile(p);
+    assert(typecheck(tree) == 0);
+    tree = lower_pow(tree);
+    ClaspResolution res;
+    ast_resolve(tree, &res);
+    ClaspBytecode *bc = bytecode_emit(tree, &res);
+    resolution_free(&res);
+    assert(bc);
+    return bc;
+}
+
+static char *listing(ClaspBytecode *bc) {
+    char *text = NULL;
+    size_t len = 0;
+    FILE *out = open_memstream(&text, &len);
+    bytecode_disassemble(bc, out);
+    fclose(out);
+    return text;
+}
+
+static char output[256];
+
+// println, writing into `output` instead of stdout
+static ClaspVMCell record(ClaspVMCell *args) {
+    size_t len = strlen(output);
+    snprintf(output + len, sizeof(output) - len, "%d ", (int32_t) args[0].i);
+    return (ClaspVMCell) { 0 };
+}
+
+// What a module prints, "error" if the VM rejects or traps it.
+static char *run(ClaspBytecode *bc) {
+    ClaspVM vm;
+    output[0] = '\0';
+    bool ok = vm_init(&vm, bc);
+    vm_define(&vm, "println", &record, 1, 0);
+    ok = ok && vm_run(&vm);
+    vm_free(&vm);
+    return strdup(ok ? output : "error");
+}
+
+// Source, instructions removed, and text the listing must (not) have afterwards.
+static const struct {
+    const char *src;
+    size_t removed;
+    const char *expect;
+    const char *absent;
+} CORPUS[] = {
+        // Assignments used as statements
+    { "var g: int = 1;\ng = 5;\nprintln(g);",                          2, "constb 5",          "dup" },
+    { "fn f(x: int) -> int { var y: int = 0; y = x; return y; }\nprintln(f(3));", 2, "storel 1",   "dup" },
+    { "var i: int = 0;\ni++;\ni += 2;\nprintln(i);",                     4, "mathdd add",        "pop" },
+        // Values nothing uses
+    { "fn f(x: int) -> int { x; 4; return x; }\nprintln(f(3));",       4, "loadl 0\n",         "pop" },
+        // Constant conversions
+    { "var d: double = 1.5;\nd = d * 0.5;\nprintln(d > 0.7);",         5, "constk",            "conv f4 f8" },
+    { "var s: short = 3;\nvar b: byte = 300;\nprintln(b + s);",         2, "constb 44",         "conv d b" },
+        // Jumps to the next instruction
+    { "var i: int = 5;\nwhile (i < 3) { }\nprintln(i);",               1, "cmpi lt",           "jmp" },
+        // Loops keep working with their labels moved
+    { "var s: int = 0;\nfor (var i: int = 0; i < 10; i++) { s += i; }\nprintln(s);", 4, "jnz",    "dup" },
+    { "fn fib(n: int) -> int { if (n < 2) { return n; } return fib(n - 1) + fib(n - 2); }\nprintln(fib(10));", 0, "call", NULL },
+};
+
+int main(int argc, char **argv) {
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(CORPUS) / sizeof(CORPUS[0]); ++i) {
+        ClaspBytecode *bc = emit(CORPUS[i].src);
+        char *before = run(bc);
+        size_t removed = bytecode_peephole(bc);
+        char *after = run(bc);
+        char *text = listing(bc);
+
+        // The optimized module prints the same, and survives the VM's verifier
+        bool ok = removed == CORPUS[i].removed && strstr(text, CORPUS[i].expect) &&
+                  (!CORPUS[i].absent || !strstr(text, CORPUS[i].absent)) && strcmp(after, "error") && !strcmp(before, after);
+        char label[41];
+        snprintf(label, sizeof(label), "%s", CORPUS[i].src);
+        for (char *c = label; *c; ++c) if (*c == '\n') *c = ' ';
+        printf("%-4s %-40s -%zu -> %s\n", ok ? "ok" : "FAIL", label, removed, after);
+        if (!ok) printf("printed '%s' before\n%s", before, text);
+        failures += !ok;
+        free(before);
+        free(after);
+        free(text);
+        bytecode_free(bc);
+    }
+
+    // Pool entries only removed code used are dropped, the float 2.5 becomes the double 2.5 and 1 the double 1
+    ClaspBytecode *bc = emit("var d: double = 2.5;\nprintln(d > 1);");
+    bytecode_peephole(bc);
+    bool ok = cvector_size(bc->constants) == 2 && bc->constants[0] == 0x4004000000000000 && bc->constants[1] == 0x3ff0000000000000;
+    printf("%-4s unused constants dropped\n", ok ? "ok" : "FAIL");
+    failures += !ok;
+    bytecode_free(bc);
+
+    // A pattern can't swallow an instruction something jumps to
+    bc = bytecode_new();
+    bc->start = bytecode_label(bc);
+    bytecode_place(bc, bc->start);
+    const uint8_t code[] = { OP_ENTER, 0, 0, OP_CONSTB, 1, OP_CONSTB, 2, OP_POP, OP_POP, OP_RET };
+    for (size_t i = 0; i < sizeof(code); ++i) cvector_push_back(bc->code, code[i]);
+    uint64_t label = bytecode_label(bc); // Grows the address table, so it can move
+    bc->atable[label] = 7;               // The first pop
+    ok = bytecode_peephole(bc) == 0 && cvector_size(bc->code) == sizeof(code);
+    printf("%-4s jump targets kept\n", ok ? "ok" : "FAIL");
+    failures += !ok;
+    bytecode_free(bc);
+
+    fflush(stdout);
+    assert(failures == 0);
+    return 0;
+}
@@ -0,0 +1,253 @@
+/**
+ * Clasp register VM tests
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Test Suite
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/lexer.h>
+#include <clasp/parser.h>
+#include <clasp/typecheck.h>
+#include <clasp/lower.h>
+#include <clasp/resolve.h>
+#include <clasp/regcode_emit.h>
+#include <clasp/regvm.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <inttypes.h>
+
+typedef struct {
+    char *data;
+    unsigned int idx;
+} StringStream;
+
+StringStream str;
+
+char read_string() {
+    if (str.idx == strlen(str.data)) return EOF;
+    return str.data[str.idx++];
+}
+
+static ClaspRegModule *compile(const char *src) {
+    char buf[1024];
+    snprintf(buf, sizeof(buf), "%s\n", src);
+    str = (StringStream) { buf, 0 };
+    ClaspLexer *l = calloc(1, sizeof(ClaspLexer));
+    new_lexer(l, read_string, NULL);
+    ClaspParser *p = malloc(sizeof(ClaspParser));
+    new_parser(p, l);
+    ClaspASTNode *tree = parser_compile(p);
+    assert(typecheck(tree) == 0);
+    tree = lower_pow(tree);
+    ClaspResolution res;
+    ast_resolve(tree, &res);
+    ClaspRegModule *m = regcode_emit(tree, &res);
+    resolution_free(&res);
+    assert(m);
+    return m;
+}
+
+static char output[256];
+
+// println, writing into `output` instead of stdout
+static ClaspVMCell record(ClaspVMCell *args) {
+    size_t len = strlen(output);
+    snprintf(output + len, sizeof(output) - len, "%d ", (int32_t) args[0].i);
+    return (ClaspVMCell) { 0 };
+}
+
+// Run a module with every dispatch style, they must agree. Returns the error, or NULL.
+static const char *run(ClaspRegModule *m, const char *expect, int *failures) {
+    static char error[160];
+    error[0] = '\0';
+    ClaspVMDispatch styles[] = { CLASP_VM_THREADED, CLASP_VM_SWITCH, CLASP_VM_PROFILE };
+    for (size_t i = 0; i < sizeof(styles) / sizeof(styles[0]); ++i) {
+        ClaspRegVM vm;
+        bool ok = regvm_init(&vm, m);
+        vm.dispatch = styles[i];
+        regvm_define(&vm, "println", &record, 1, 0);
+        output[0] = '\0';
+        ok = ok && regvm_run(&vm);
+        if (!ok) strcpy(error, vm.error);
+        if (ok && expect && strcmp(output, expect)) {
+            printf("FAIL dispatch %zu printed '%s', expected '%s'\n", i, output, expect);
+            (*failures)++;
+        }
+        regvm_free(&vm);
+    }
+    return error[0] ? error : NULL;
+}
+
+// Source and what it prints, vm_test's programs first so both VMs are held to the same results.
+static const struct {
+    const char *src;
+    const char *expect;
+} CORPUS[] = {
+    { "fn fib(n: int) -> int { if (n < 2) { return n; } return fib(n - 1) + fib(n - 2); }\n"
+      "var total: long = 0;\nfor (var i: int = 0; i < 10; i++) { total += fib(i); }\nprintln(total);", "88 " },
+        // Integers wrap at their width
+    { "var b: byte = 100;\nb += 100;\nprintln(b);\nvar s: short = 32767;\ns++;\nprintln(s);",       "-56 -32768 " },
+    { "var x: long = 2000000;\nx *= 2000;\nvar y: int = x;\nprintln(y);\nprintln(x / 1000000);",             "-294967296 4000 " },
+    { "var d: long = 3000000000;\nprintln(d / 1000000);\nprintln(3000000000 > 2147483647);",                  "3000 1 " },
+    { "println(7 / 2);\nprintln(-7 % 3);\nvar m: int = 6;\nm ~= 3;\nprintln(m);", "3 -1 5 " },
+    { "var a: int = 5;\nprintln(-a);\nprintln(!a);\nprintln(!0);\nprintln(~a);",                     "-5 0 1 -6 " },
+        // Floats
+    { "var d: double = 1.5;\nd = d * 4;\nprintln(d);\nvar f: float = 7.0;\nprintln(f / 2 > 3.4);",   "6 1 " },
+    { "var d: double = 0.5;\nif (d) { println(1); }\nd -= 0.5;\nif (d) { println(2); }",             "1 " },
+    { "var d: double = 0.1;\nvar k: long = d * 1000000000;\nprintln(k);",                             "100000001 " },
+        // Runtime symbols
+    { "var x: long = 3;\nvar n: long = 4;\nprintln(x ^ n);\nvar f: double = 2.0;\nvar g: double = 10;\nprintln(f ^ g);", "81 1024 " },
+        // Runtime symbols return long or double, converted to the type of the power
+    { "var r: float = 3.0;\nfor (var i: int = 1; i < 4; i++) { var e: float = i; println(r ^ e); }",   "3 9 27 " },
+    { "var x: int = 100000;\nvar e: int = 3;\nprintln((x ^ e) > 0);\nprintln(x ^ e);",              "0 -1530494976 " },
+    { "var x: int = 100000;\nlet y: double = x ^ 2.0;\nprintln(y / 1000000);",                        "10000 " },
+        // Globals, function values, locals in nested blocks
+    { "var g: int = 1;\nfn bump(k: int) -> void { g += k; }\nbump(2);\nbump(3);\nprintln(g);",      "6 " },
+    { "fn twice(x: int) -> int { return x * 2; }\nlet h = twice;\nprintln(h(21));",                   "42 " },
+    { "fn f(n: int) -> int { var s: int = 0; for (var i: int = 0; i < n; i++) { var j: int = 0; while (j < i) { s += j; j++; } } return s; }\nprintln(f(10));", "120 " },
+    { "fn f(x: int) -> int { if (x) { return 1; } }\nprintln(f(0));\nprintln(f(5));",                "0 1 " },
+    { "fn f(x: int) -> int { if (x > 3) { return 1; } return 0; }\nprintln(f(5));\nprintln(f(2));",    "1 0 " },
+    { "var a: int = 2;\nvar b: int = 3;\nif (a < b) { println(1); }\nwhile (b < a) { b++; }\nprintln(b);", "1 3 " },
+    { "fn f(x: byte) -> byte { return x * 3 + 1; }\nprintln(f(50));",                                "-105 " },
+        // Variables read in place must not see assignments made after the read
+    { "fn f() -> int { var x: int = 1; return x + (x = 5); }\nprintln(f());",                         "6 " },
+    { "fn f() -> int { var x: int = 1; var y: int = x++ + x; return y * 10 + x; }\nprintln(f());",    "32 " },
+        // Arguments computed into the callee's frame, nested calls above them
+    { "fn add(a: int, b: int) -> int { return a + b; }\nprintln(add(add(1, 2), add(3, add(4, 5))));", "15 " },
+    { "fn f(a: long, b: long) -> long { return a - b; }\nvar k: int = 3;\nprintln(f(k * 10, k));",   "27 " },
+};
+
+// The listing of a module's function, for checking what the emitter chose.
+static char *listing(ClaspRegModule *m) {
+    char *text;
+    size_t size;
+    FILE *out = open_memstream(&text, &size);
+    regcode_disassemble(m, out);
+    fclose(out);
+    return text;
+}
+
+int main(int argc, char **argv) {
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(CORPUS) / sizeof(CORPUS[0]); ++i) {
+        ClaspRegModule *m = compile(CORPUS[i].src);
+        int before = failures;
+        const char *error = run(m, CORPUS[i].expect, &failures);
+        bool ok = !error && failures == before;
+        char label[41];
+        snprintf(label, sizeof(label), "%s", CORPUS[i].src);
+        for (char *c = label; *c; ++c) if (*c == '\n') *c = ' ';
+        printf("%-4s %-40s -> %s\n", ok ? "ok" : "FAIL", label, error ? error : output);
+        failures += !ok && failures == before;
+        regcode_free(m);
+    }
+
+    // Traps
+    const struct {
+        const char *src;
+        const char *error;
+    } TRAPS[] = {
+        { "var z: int = 0;\nprintln(1 / z);",                                  "division by zero" },
+        { "fn f(x: int) -> int { return f(x) + 1; }\nprintln(f(1));",        "call stack overflow" },
+        { "var x: int = 5;\nprintln(x % 0);",                                   "division by zero" },
+    };
+    for (size_t i = 0; i < sizeof(TRAPS) / sizeof(TRAPS[0]); ++i) {
+        ClaspRegModule *m = compile(TRAPS[i].src);
+        const char *error = run(m, NULL, &failures);
+        bool ok = error && strstr(error, TRAPS[i].error);
+        printf("%-4s traps %s\n", ok ? "ok" : "FAIL", TRAPS[i].error);
+        failures += !ok;
+        regcode_free(m);
+    }
+
+    // A loop over locals: variables are used in their registers and the test is one compare-and-branch
+    {
+        ClaspRegModule *m = compile("fn f(n: int) -> int { var s: int = 0; for (var i: int = 0; i < n; i++) { s += i * 3; } return s; }\n"
+                                    "println(f(100));");
+        char *text = listing(m);
+        bool shape = strstr(text, "mulk d r3 r2 3\n") && strstr(text, "add d r1 r1 r3\n") && strstr(text, "addk d r2 r2 1\n")
+                  && strstr(text, "jcmp lt r2 r0 @") && !strstr(text, "mov");
+        ClaspRegVM vm;
+        bool ok = regvm_init(&vm, m);
+        vm.dispatch = CLASP_VM_PROFILE;
+        regvm_define(&vm, "println", &record, 1, 0);
+        ok = ok && regvm_run(&vm) && vm.profile->ops[ROP_JCMP] == 101 && vm.profile->total < 4 * 100 + 20;
+        printf("%-4s loop over locals, %" PRIu64 " dispatches\n", shape && ok ? "ok" : "FAIL", vm.profile->total);
+        if (!shape) printf("%s", text);
+        failures += !(shape && ok);
+        free(text);
+        regvm_free(&vm);
+        regcode_free(m);
+    }
+
+    // The loop's branch back lands on every code size, so some of them grow the code while it's being emitted
+    bool sized = true;
+    for (int pad = 0; pad < 40; ++pad) {
+        char src[1024] = "", expect[128] = "";
+        for (int i = 0; i < pad; ++i) strcat(src, "println(0);\n");
+        strcat(src, "var s: int = 0;\nfor (var i: int = 0; i < 3; i++) { s += i; }\nprintln(s);");
+        for (int i = 0; i < pad; ++i) strcat(expect, "0 ");
+        strcat(expect, "3 ");
+        ClaspRegModule *m = compile(src);
+        int before = failures;
+        const char *error = run(m, expect, &failures);
+        bool ok = !error && failures == before;
+        if (!ok) printf("FAIL loop after %d statements -> %s\n", pad, error ? error : output);
+        failures += !ok && failures == before;
+        sized &= ok;
+        regcode_free(m);
+    }
+    printf("%-4s loops at every code size\n", sized ? "ok" : "FAIL");
+
+    // Hand built code the emitter never produces, rejected when loading
+    const struct {
+        ClaspRegInst code[3];
+        size_t size;
+        uint16_t registers;
+        const char *error;
+    } BROKEN[] = {
+        { { { ROP_CONST, 0, 1, .k = 5 }, { ROP_RET } },                        2, 1, "register r1 is outside a frame of 1" },
+        { { { ROP_JMP, .k = 2 } },                                             1, 0, "jump to 2, outside its function" },
+        { { { ROP_CONST, 0, 0, .k = 5 } },                                     1, 1, "runs off its end" },
+        { { { ROP_DIVK, CLB_D, 0, 0, .k = 0 }, { ROP_RET } },                  2, 1, "division by a constant zero" },
+        { { { ROP_ADD, CLB_F8, 0, 0, 0 }, { ROP_RET } },                       2, 1, "add of class 5" },
+        { { { ROP_LOADG, 0, 0, .k = 3 }, { ROP_RET } },                        2, 1, "no global 3" },
+        { { { ROP_CALL, 2, 0, 0, .k = 0 }, { ROP_RET } },                      2, 2, "call passes 2 arguments to a function of 0" },
+        { { { ROP_CALL, 2, 0, 1, .k = 0 }, { ROP_RET } },                      2, 2, "register r2 is outside a frame of 2" },
+        { { { 0xEE } },                                                        1, 0, "unknown opcode" },
+    };
+    for (size_t i = 0; i < sizeof(BROKEN) / sizeof(BROKEN[0]); ++i) {
+        ClaspRegModule *m = calloc(1, sizeof(ClaspRegModule));
+        for (size_t j = 0; j < BROKEN[i].size; ++j) cvector_push_back(m->code, BROKEN[i].code[j]);
+        cvector_push_back(m->fns, ((ClaspRegFunction) { NULL, 0, BROKEN[i].size, 0, BROKEN[i].registers, 0 }));
+        const char *error = run(m, NULL, &failures);
+        bool ok = error && strstr(error, BROKEN[i].error);
+        printf("%-4s rejects %s\n", ok ? "ok" : "FAIL", error ? error : "nothing");
+        failures += !ok;
+        regcode_free(m);
+    }
+
+    fflush(stdout);
+    assert(failures == 0);
+    return 0;
+}
@@ -0,0 +1,153 @@
+/**
+ * Clasp name resolution test
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Test Suite
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/lexer.h>
+#include <clasp/parser.h>
+#include <clasp/typecheck.h>
+#include <clasp/resolve.h>
+#include <clasp/walk.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+typedef struct {
+    char *data;
+    unsigned int idx;
+} StringStream;
+
+StringStream str;
+
+char read_string() {
+    if (str.idx == strlen(str.data)) return EOF;
+    return str.data[str.idx++];
+}
+
+static void slot(ClaspSlot s, char *out) {
+    static const char KINDS[] = "-LOGFB";
+    if (s.kind == CLASP_SLOT_OUTER) sprintf(out + strlen(out), "O%u.%u", s.depth, s.index);
+    else sprintf(out + strlen(out), "%c%u", KINDS[s.kind], s.index);
+}
+
+// Declarations as `name:slot`, references as `name@slot`, functions as `fn name:slot/frame size`.
+static void *render_decl(ClaspASTNode *node, void *args) {
+    char *out = args;
+    if (*out) strcat(out, " ");
+    sprintf(out + strlen(out), "%s:", node->data.var_decl_stmt.name->data);
+    slot(node->data.var_decl_stmt.slot, out);
+    return NULL;
+}
+
+static void *render_ref(ClaspASTNode *node, void *args) {
+    char *out = args;
+    if (*out) strcat(out, " ");
+    sprintf(out + strlen(out), "%s@", node->data.var_ref.varname->data);
+    slot(node->data.var_ref.slot, out);
+    return NULL;
+}
+
+static void *render_fn(ClaspASTNode *node, void *args) {
+    char *out = args;
+    if (*out) strcat(out, " ");
+    sprintf(out + strlen(out), "fn %s:", node->data.fn_decl_stmt.name->data);
+    slot(node->data.fn_decl_stmt.slot, out);
+    sprintf(out + strlen(out), "/%u", node->data.fn_decl_stmt.frame_size);
+    return NULL;
+}
+
+static const char *CORPUS[][2] = {
+        // Globals and the top level frame
+    { "var x: int = 1;\nx = x + 1;",                                   "x:G0 x@G0 x@G0"                                     },
+    { "var x: int = 1;\n{ var y: int = x; println(y); }",              "x:G0 y:L0 x@G0 println@B0 y@L0"                     },
+    { "{ var a: int = 1; }\n{ var b: int = 2; println(b); }",          "a:L0 b:L0 println@B0 b@L0"                          },
+        // Parameters first, then locals, reusing slots of finished blocks
+    { "fn f(a: int, b: int) -> int { var c: int = a; return c + b; }", "fn f:F0/3 c:L2 a@L0 c@L2 b@L1"                     },
+    { "fn f(a: int) -> int { { var b: int = a; } var c: int = a; return c; }", "fn f:F0/2 b:L1 a@L0 c:L1 a@L0 c@L1"       },
+    { "fn f(a: int) -> int { for (var i: int = 0; i < a; i++) a += i; return a; }", "fn f:F0/2 i:L1 i@L1 a@L0 i@L1 a@L0 i@L1 a@L0" },
+        // Shadowing
+    { "var x: int = 1;\nfn f(x: int) -> int { return x; }\nprintln(f(x));", "x:G0 fn f:F0/1 x@L0 println@B0 f@F0 x@G0"    },
+    { "fn f(a: int) -> int { var b: int = a; { var b: int = b + 1; a = b; } return b; }", "fn f:F0/3 b:L1 a@L0 b:L2 b@L1 a@L0 b@L2 b@L1" },
+        // Functions are numbered in declaration order and visible to their whole block
+    { "fn f() -> int { return g(); }\nfn g() -> int { return 1; }",    "fn f:F0/0 g@F1 fn g:F1/0"                           },
+    { "fn f(a: int) -> int { fn g(b: int) -> int { return b; } return g(a); }", "fn f:F0/1 fn g:F1/1 b@L0 g@F1 a@L0"     },
+        // Locals of enclosing functions
+    { "fn f(a: int) -> int { fn g() -> int { return a; } return g(); }", "fn f:F0/1 fn g:F1/0 a@O1.0 g@F1"                 },
+    { "{ var t: int = 2; fn g() -> int { return t; } println(g()); }", "t:L0 fn g:F0/0 t@O1.0 println@B0 g@F0"              },
+};
+
+int main(int argc, char **argv) {
+    ClaspASTVisitor pre = { 0 };
+    pre[AST_VAR_DECL_STMT] = pre[AST_LET_DECL_STMT] = pre[AST_CONST_DECL_STMT] = &render_decl;
+    pre[AST_EXPR_VAR_REF] = &render_ref;
+    pre[AST_FN_DECL_STMT] = &render_fn;
+
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(CORPUS) / sizeof(CORPUS[0]); ++i) {
+        char src[1024];
+        snprintf(src, sizeof(src), "%s\n", CORPUS[i][0]);
+        str = (StringStream) { src, 0 };
+        ClaspLexer *l = calloc(1, sizeof(ClaspLexer));
+        new_lexer(l, read_string, NULL);
+        ClaspParser *p = malloc(sizeof(ClaspParser));
+        new_parser(p, l);
+        ClaspASTNode *tree = parser_compile(p);
+        assert(typecheck(tree) == 0);
+
+        ClaspResolution res;
+        ast_resolve(tree, &res);
+        char out[1024] = "";
+        ClaspASTPass pass = { pre, NULL, out };
+        ast_walk(tree, &pass, 1);
+        bool ok = !strcmp(out, CORPUS[i][1]);
+        char label[37];
+        snprintf(label, sizeof(label), "%s", CORPUS[i][0]);
+        for (char *c = label; *c; ++c) if (*c == '\n') *c = ' ';
+        printf("%-4s %-36s -> %s\n", ok ? "ok" : "FAIL", label, out);
+        failures += !ok;
+        resolution_free(&res);
+    }
+
+    // Tables
+    str = (StringStream) { "var g: int = 1;\nfn f(a: int) -> int { return a; }\nvar h: int = f(g);\n{ let t: int = h; println(t); }\n", 0 };
+    ClaspLexer *l = calloc(1, sizeof(ClaspLexer));
+    new_lexer(l, read_string, NULL);
+    ClaspParser *p = malloc(sizeof(ClaspParser));
+    new_parser(p, l);
+    ClaspASTNode *tree = parser_compile(p);
+    assert(typecheck(tree) == 0);
+    ClaspResolution res;
+    ast_resolve(tree, &res);
+    assert(cvector_size(res.globals) == 2);
+    assert(!strcmp(res.globals[1]->data.var_decl_stmt.name->data, "h"));
+    assert(cvector_size(res.fns) == 1 && res.fns[0]->type == AST_FN_DECL_STMT);
+    assert(cvector_size(res.builtins) == 1 && !strcmp(res.builtins[0]->data, "println"));
+    assert(res.frame_size == 1);
+    resolution_free(&res);
+    printf("ok   tables\n");
+
+    fflush(stdout);
+    assert(failures == 0);
+    return 0;
+}
@@ -0,0 +1,126 @@
+/**
+ * Clasp tail call elimination test
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Test Suite
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/lexer.h>
+#include <clasp/parser.h>
+#include <clasp/typecheck.h>
+#include <clasp/tce.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+typedef struct {
+    char *data;
+    unsigned int idx;
+} StringStream;
+
+StringStream str;
+
+char read_string() {
+    if (str.idx == strlen(str.data)) return EOF;
+    return str.data[str.idx++];
+}
+
+// Outline each statement, with the target of assignments and the name of declarations.
+static void render(ClaspASTNode *node, char *out) {
+    if (!node) return;
+    switch (node->type) {
+        case AST_BLOCK_STMT:
+            strcat(out, "{");
+            for (size_t i = 0; i < cvector_size(node->data.block_stmt.body); ++i) {
+                if (!node->data.block_stmt.body[i]) continue;
+                if (out[strlen(out) - 1] != '{') strcat(out, " ");
+                render(node->data.block_stmt.body[i], out);
+            }
+            strcat(out, "}");
+            break;
+        case AST_FN_DECL_STMT:
+            sprintf(out + strlen(out), "fn %s", node->data.fn_decl_stmt.name->data);
+            render(node->data.fn_decl_stmt.body, out);
+            break;
+        case AST_VAR_DECL_STMT:
+        case AST_LET_DECL_STMT:
+        case AST_CONST_DECL_STMT: sprintf(out + strlen(out), "%s;", node->data.var_decl_stmt.name->data); break;
+        case AST_RETURN_STMT: strcat(out, "ret;"); break;
+        case AST_EXPR_STMT: {
+            ClaspASTNode *expr = node->data.expr_stmt.expr;
+            if (expr->type == AST_EXPR_BINOP && expr->data.binop.op->type == TOKEN_EQ)
+                sprintf(out + strlen(out), "%s=;", expr->data.binop.left->data.var_ref.varname->data);
+            else strcat(out, "expr;");
+            break;
+        }
+        case AST_IF_STMT:     strcat(out, "if"); render(node->data.cond_stmt.body, out); break;
+        case AST_WHILE_STMT:  strcat(out, "while"); render(node->data.cond_stmt.body, out); break;
+        case AST_FOR_STMT:    strcat(out, "for"); render(node->data.for_stmt.body, out); break;
+        default: strcat(out, "?"); break;
+    }
+}
+
+static const char *CORPUS[][2] = {
+        // Tail calls
+    { "fn f(n: int, a: int) -> int { if (n == 0) return a; return f(n - 1, a + n); }",  "{fn f{while{{ifret; {__tce0_n; __tce0_a; n=; a=;}}}}}" },
+    { "fn f(n: int, a: int) -> int { if (n == 0) return a; return f(n - 1, a); }",      "{fn f{while{{ifret; {n=;}}}}}"                        },
+    { "fn f(a: int, b: int) -> int { if (b == 0) return a; return f(b, a % b); }",      "{fn f{while{{ifret; {__tce0_a; __tce0_b; a=; b=;}}}}}" },
+    { "fn f(n: int) -> int { if (n > 9) { return f(n / 2); } return n; }",              "{fn f{while{__tce0_again; {if{{n=; __tce0_again=;}} if{ret;}}}}}" },
+    { "fn f(n: int) -> int { if (n < 10) return n; { return f(n - 1); } }",            "{fn f{while{{ifret; {{n=;}}}}}}"                       },
+    { "fn f(n: int) -> void { if (n > 0) { println(n); f(n - 1); } }",                  "{fn f{while{__tce0_again; {if{expr; {n=; __tce0_again=;}}} ifret;}}}" },
+        // Left alone
+    { "fn f(n: int) -> int { if (n < 2) return 1; return n * f(n - 1); }",              "{fn f{ifret; ret;}}"                                   },
+    { "fn f(n: int) -> void { if (n > 0) { f(n - 1); println(n); } }",                  "{fn f{if{expr; expr;}}}"                               },
+    { "fn f(n: int) -> void { if (n > 5) { f(n - 2); } println(n); }",                  "{fn f{if{expr;} expr;}}"                               },
+    { "fn f(n: int) -> int { while (n > 9) { return f(n - 1); } return n; }",           "{fn f{while{ret;} ret;}}"                              },
+    { "fn f(n: int) -> int { if (n > 9) { let n2: int = n; return f(n2 - 1); } return n; }", "{fn f{while{__tce0_again; {if{n2; {n=; __tce0_again=;}} if{ret;}}}}}" },
+    { "fn f(n: int) -> int { if (n > 9) { let f: int = n; return f; } return n; }",    "{fn f{if{f; ret;} ret;}}"                              },
+    { "fn g(n: int) -> int { return n; }\nfn f(n: int) -> int { return g(n); }",       "{fn g{ret;} fn f{ret;}}"                               },
+};
+
+int main(int argc, char **argv) {
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(CORPUS) / sizeof(CORPUS[0]); ++i) {
+        char src[1024];
+        snprintf(src, sizeof(src), "%s\n", CORPUS[i][0]);
+        str = (StringStream) { src, 0 };
+        ClaspLexer *l = calloc(1, sizeof(ClaspLexer));
+        new_lexer(l, read_string, NULL);
+        ClaspParser *p = malloc(sizeof(ClaspParser));
+        new_parser(p, l);
+        ClaspASTNode *tree = parser_compile(p);
+        assert(typecheck(tree) == 0);
+
+        tree = ast_tce(tree);
+        char out[1024] = "";
+        render(tree, out);
+        bool ok = !strcmp(out, CORPUS[i][1]);
+        char label[37];
+        snprintf(label, sizeof(label), "%s", CORPUS[i][0]);
+        for (char *c = label; *c; ++c) if (*c == '\n') *c = ' ';
+        printf("%-4s %-36s -> %s\n", ok ? "ok" : "FAIL", label, out);
+        failures += !ok;
+    }
+    fflush(stdout);
+    assert(failures == 0);
+    return 0;
+}
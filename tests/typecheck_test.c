@@ -0,0 +1,123 @@
+/**
+ * Clasp type checker test
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Test Suite
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/lexer.h>
+#include <clasp/parser.h>
+#include <clasp/typecheck.h>
+#include <clasp/types.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+typedef struct {
+    char *data;
+    unsigned int idx;
+} StringStream;
+
+StringStream str;
+
+char read_string() {
+    if (str.idx == strlen(str.data)) return EOF;
+    return str.data[str.idx++];
+}
+
+static ClaspASTNode *parse(char *src) {
+    str = (StringStream) { src, 0 };
+    ClaspLexer *l = calloc(1, sizeof(ClaspLexer));
+    new_lexer(l, read_string, NULL);
+    ClaspParser *p = malloc(sizeof(ClaspParser));
+    new_parser(p, l);
+    return parser_compile(p);
+}
+
+int main(int argc, char **argv) {
+    ClaspASTNode *tree = parse(
+        "fn scale(a: int, b: double) -> double { return a * b; }\n"
+        "var x: long = 3;\n"
+        "let y = x + 2.5;\n"
+        "let z = scale(1, 2) < 4;\n"
+        "while (x > 0) { x--; println(x % 2); }\n"
+    );
+    assert(typecheck(tree) == 0);
+
+    ClaspASTNode *INT = type_intern("int"), *LONG = type_intern("long"), *FLOAT = type_intern("float"), *DOUBLE = type_intern("double");
+    assert(type_intern("int") == INT);
+
+    cvector(ClaspASTNode *) body = tree->data.block_stmt.body;
+    ClaspASTNode *ret = body[0]->data.fn_decl_stmt.body->data.block_stmt.body[0]->data.return_stmt.retval;
+    assert(ret->exprType->type == DOUBLE);
+    assert(ret->data.binop.left->exprType->type == INT);
+    assert(body[0]->exprType->type->type == AST_TYPE_FN);
+    assert(body[0]->exprType->type->data.function.ret == DOUBLE);
+
+        // Inferred declarations get their type filled in.
+    assert(body[2]->data.var_decl_stmt.type == FLOAT);
+    assert(body[2]->data.var_decl_stmt.initializer->data.binop.left->exprType->type == LONG);
+    assert(body[3]->data.var_decl_stmt.type == INT);
+    assert(body[3]->data.var_decl_stmt.initializer->data.binop.left->exprType->type == DOUBLE);
+
+    ClaspASTNode *loop = body[4]->data.cond_stmt.body->data.block_stmt.body[0]->data.expr_stmt.expr;
+    assert(loop->exprType->type == LONG);
+    assert(loop->data.postfix.left->exprType->flag & TYPE_MUTABLE);
+
+        // Integer literals too big for an int are longs.
+    ClaspASTNode *big = parse("let a = 2147483647;\nlet b = 3000000000;\n");
+    assert(typecheck(big) == 0);
+    assert(big->data.block_stmt.body[0]->data.var_decl_stmt.type == INT);
+    assert(big->data.block_stmt.body[1]->data.var_decl_stmt.type == LONG);
+
+        // Functions can be used before they're declared, names go out of scope with their block.
+    assert(typecheck(parse("println(twice(2));\nfn twice(n: int) -> int { return n * 2; }\n")) == 0);
+    assert(typecheck(parse("if (1) { var a: int = 1; }\nprintln(a);\n")) == 1);
+
+        // Array, template and pointer types can't be interned, so they're rejected.
+    ClaspASTNode *ptr = parse("var p: int = 1;\n");
+    ClaspASTNode *decl = ptr->data.block_stmt.body[0];
+    union ASTNodeData *pointed = calloc(1, sizeof(union ASTNodeData));
+    pointed->pointer.pointed = decl->data.var_decl_stmt.type;
+    decl->data.var_decl_stmt.type = new_AST_node(AST_TYPE_PTR, pointed);
+    assert(type_resolve(decl->data.var_decl_stmt.type) == NULL);
+    assert(typecheck(ptr) == 1);
+
+        // One error per bad statement.
+    char *bad[] = {
+        "println(nope);\n",
+        "var f: float = 1.5;\nprintln(f % 2);\n",
+        "let k = 1;\nk++;\n",
+        "fn f(a: int) -> int { return a; }\nprintln(f(1, 2));\n",
+        "fn g() -> void { return 1; }\n",
+        "var q: quux = 1;\n",
+        "return 1;\n",
+        "var v = println(1);\n",
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i) {
+        int errors = typecheck(parse(bad[i]));
+        printf("bad[%zu]: %d error(s)\n", i, errors);
+        assert(errors == 1);
+    }
+
+    return 0;
+}
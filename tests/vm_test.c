@@ -0,0 +1,277 @@
+/**
+ * Clasp bytecode VM test
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Test Suite
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/lexer.h>
+#include <clasp/parser.h>
+#include <clasp/typecheck.h>
+#include <clasp/lower.h>
+#include <clasp/resolve.h>
+#include <clasp/bytecode_emit.h>
+#include <clasp/vm.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <inttypes.h>
+
+typedef struct {
+    char *data;
+    unsigned int idx;
+} StringStream;
+
+StringStream str;
+
+char read_string() {
+    if (str.idx == strlen(str.data)) return EOF;
+    return str.data[str.idx++];
+}
+
+static ClaspBytecode *compile(const char *src) {
+    char buf[1024];
+    snprintf(buf, sizeof(buf), "%s\n", src);
+    str = (StringStream) { buf, 0 };
+    ClaspLexer *l = calloc(1, sizeof(ClaspLexer));
+    new_lexer(l, read_string, NULL);
+    ClaspParser *p = malloc(sizeof(ClaspParser));
+    new_parser(p, l);
+    ClaspASTNode *tree = parser_compile(p);
+    assert(typecheck(tree) == 0);
+    tree = lower_pow(tree);
+    ClaspResolution res;
+    ast_resolve(tree, &res);
+    ClaspBytecode *bc = bytecode_emit(tree, &res);
+    resolution_free(&res);
+    assert(bc);
+    return bc;
+}
+
+static char output[256];
+
+// println, writing into `output` instead of stdout
+static ClaspVMCell record(ClaspVMCell *args) {
+    size_t len = strlen(output);
+    snprintf(output + len, sizeof(output) - len, "%d ", (int32_t) args[0].i);
+    return (ClaspVMCell) { 0 };
+}
+
+// Run a module with every dispatch style, they must agree. Returns the error, or NULL.
+static const char *run(ClaspBytecode *bc, const char *expect, int *failures) {
+    static char error[160];
+    error[0] = '\0';
+    ClaspVMDispatch styles[] = { CLASP_VM_THREADED, CLASP_VM_CACHED, CLASP_VM_JIT, CLASP_VM_SWITCH, CLASP_VM_PROFILE };
+    for (size_t i = 0; i < sizeof(styles) / sizeof(styles[0]); ++i) {
+        ClaspVM vm;
+        bool ok = vm_init(&vm, bc);
+        vm.dispatch = styles[i];
+        vm.jit_threshold = 1; // Compile everything, the entry point too
+        vm_define(&vm, "println", &record, 1, 0);
+        output[0] = '\0';
+        ok = ok && vm_run(&vm);
+        if (!ok) strcpy(error, vm.error);
+        if (ok && expect && strcmp(output, expect)) {
+            printf("FAIL dispatch %zu printed '%s', expected '%s'\n", i, output, expect);
+            (*failures)++;
+        }
+        vm_free(&vm);
+    }
+    return error[0] ? error : NULL;
+}
+
+// Turn every call to function `fn` into an asm of native code entry `native`, which is encoded the same size.
+static void use_native(ClaspBytecode *bc, uint64_t fn, uint64_t native) {
+    ClaspBytecodeInst inst;
+    for (size_t pc = 0; bytecode_decode(bc->code, cvector_size(bc->code), pc, &inst); pc += inst.size) {
+        if (inst.op != OP_CALL || inst.args[0] != fn) continue;
+        bc->code[pc] = OP_ASM;
+        for (size_t i = 0; i < 8; ++i) bc->code[pc + 1 + i] = (uint8_t) (native >> (i * 8));
+    }
+}
+
+static size_t count_op(ClaspBytecode *bc, uint8_t op) {
+    ClaspVM vm;
+    size_t n = 0;
+    if (vm_init(&vm, bc))
+        for (ClaspVMInst *in = vm.code; in->op != CLASP_VM_END; ++in) n += in->op == op;
+    vm_free(&vm);
+    return n;
+}
+
+// Source and what it prints.
+static const struct {
+    const char *src;
+    const char *expect;
+} CORPUS[] = {
+    { "fn fib(n: int) -> int { if (n < 2) { return n; } return fib(n - 1) + fib(n - 2); }\n"
+      "var total: long = 0;\nfor (var i: int = 0; i < 10; i++) { total += fib(i); }\nprintln(total);", "88 " },
+        // Integers wrap at their width
+    { "var b: byte = 100;\nb += 100;\nprintln(b);\nvar s: short = 32767;\ns++;\nprintln(s);",       "-56 -32768 " },
+    { "var x: long = 2000000;\nx *= 2000;\nvar y: int = x;\nprintln(y);\nprintln(x / 1000000);",             "-294967296 4000 " },
+    { "var d: long = 3000000000;\nprintln(d / 1000000);\nprintln(3000000000 > 2147483647);",                  "3000 1 " },
+    { "println(7 / 2);\nprintln(-7 % 3);\nvar m: int = 6;\nm ~= 3;\nprintln(m);", "3 -1 5 " },
+    { "var a: int = 5;\nprintln(-a);\nprintln(!a);\nprintln(!0);\nprintln(~a);",                     "-5 0 1 -6 " },
+        // Floats
+    { "var d: double = 1.5;\nd = d * 4;\nprintln(d);\nvar f: float = 7.0;\nprintln(f / 2 > 3.4);",   "6 1 " },
+    { "var d: double = 0.5;\nif (d) { println(1); }\nd -= 0.5;\nif (d) { println(2); }",             "1 " },
+        // Runtime symbols
+    { "var x: long = 3;\nvar n: long = 4;\nprintln(x ^ n);\nvar f: double = 2.0;\nvar g: double = 10;\nprintln(f ^ g);", "81 1024 " },
+        // Runtime symbols return long or double, converted to the type of the power
+    { "var r: float = 3.0;\nfor (var i: int = 1; i < 4; i++) { var e: float = i; println(r ^ e); }",   "3 9 27 " },
+    { "var x: int = 100000;\nvar e: int = 3;\nprintln((x ^ e) > 0);\nprintln(x ^ e);",              "0 -1530494976 " },
+    { "var x: int = 100000;\nlet y: double = x ^ 2.0;\nprintln(y / 1000000);",                        "10000 " },
+        // Globals, function values, locals in nested blocks
+    { "var g: int = 1;\nfn bump(k: int) -> void { g += k; }\nbump(2);\nbump(3);\nprintln(g);",      "6 " },
+    { "fn twice(x: int) -> int { return x * 2; }\nlet h = twice;\nprintln(h(21));",                   "42 " },
+    { "fn f(n: int) -> int { var s: int = 0; for (var i: int = 0; i < n; i++) { var j: int = 0; while (j < i) { s += j; j++; } } return s; }\nprintln(f(10));", "120 " },
+    { "fn f(x: int) -> int { if (x) { return 1; } }\nprintln(f(0));\nprintln(f(5));",                "0 1 " },
+        // Superinstructions
+    { "fn f(x: int) -> int { if (x > 3) { return 1; } return 0; }\nprintln(f(5));\nprintln(f(2));",    "1 0 " },
+    { "var a: int = 2;\nvar b: int = 3;\nif (a < b) { println(1); }\nwhile (b < a) { b++; }\nprintln(b);", "1 3 " },
+    { "fn f(x: byte) -> byte { return x * 3 + 1; }\nprintln(f(50));",                                "-105 " },
+};
+
+int main(int argc, char **argv) {
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(CORPUS) / sizeof(CORPUS[0]); ++i) {
+        ClaspBytecode *bc = compile(CORPUS[i].src);
+        int before = failures;
+        const char *error = run(bc, CORPUS[i].expect, &failures);
+        bool ok = !error && failures == before;
+        char label[41];
+        snprintf(label, sizeof(label), "%s", CORPUS[i].src);
+        for (char *c = label; *c; ++c) if (*c == '\n') *c = ' ';
+        printf("%-4s %-40s -> %s\n", ok ? "ok" : "FAIL", label, error ? error : output);
+        failures += !ok && failures == before;
+        bytecode_free(bc);
+    }
+
+    // Traps
+    const struct {
+        const char *src;
+        const char *error;
+    } TRAPS[] = {
+        { "var z: int = 0;\nprintln(1 / z);",                                  "division by zero" },
+        { "fn f(x: int) -> int { return f(x) + 1; }\nprintln(f(1));",        "call stack overflow" },
+        { "var x: int = 5;\nprintln(x % 0);",                                   "division by zero" },
+    };
+    for (size_t i = 0; i < sizeof(TRAPS) / sizeof(TRAPS[0]); ++i) {
+        ClaspBytecode *bc = compile(TRAPS[i].src);
+        const char *error = run(bc, NULL, &failures);
+        bool ok = error && strstr(error, TRAPS[i].error);
+        printf("%-4s traps %s\n", ok ? "ok" : "FAIL", TRAPS[i].error);
+        failures += !ok;
+        bytecode_free(bc);
+    }
+
+    // Superinstructions take one dispatch for several instructions
+    {
+        ClaspBytecode *bc = compile("var s: int = 0;\nfor (var i: int = 0; i < 100; i++) { s += i * 2; }\nprintln(s);");
+        ClaspVM vm;
+        bool ok = vm_init(&vm, bc);
+        vm.dispatch = CLASP_VM_PROFILE;
+        vm_define(&vm, "println", &record, 1, 0);
+        ok = ok && vm_run(&vm) && vm.profile->instructions > vm.profile->total + 200 && vm.profile->ops[OP_CMPKJNZ] == 101;
+        printf("%-4s superinstructions, %" PRIu64 " instructions in %" PRIu64 " dispatches\n", ok ? "ok" : "FAIL",
+               vm.profile->instructions, vm.profile->total);
+        failures += !ok;
+        vm_free(&vm);
+        bytecode_free(bc);
+    }
+
+    // Native code: the blob for this platform is called directly, elsewhere the bytecode fallback runs
+    {
+        const char *src = "fn mix(a: long, b: long) -> long { return a * 31 + b; }\nprintln(mix(2, 5));\nprintln(mix(-1, 3));";
+        const char mix32[] = "\x48\x8b\x07\x48\x6b\xc0\x20\x48\x03\x47\x08\xc3"; // a * 32 + b, to tell them apart
+        ClaspBytecode *bc = compile(src);
+        use_native(bc, 0, bytecode_native(bc, 0));
+        bytecode_native_blob(bc, 0, CLB_ARCH_X86_64_LINUX, mix32, sizeof(mix32) - 1);
+        int before = failures;
+        const char *error = run(bc, CLASP_VM_HAS_NATIVE ? "69 -29 " : "67 -28 ", &failures);
+        bool ok = !error && failures == before && count_op(bc, OP_ASM) == 2 * CLASP_VM_HAS_NATIVE;
+        printf("%-4s asm on %s -> %s\n", ok ? "ok" : "FAIL", bytecode_arch_name(CLASP_VM_HOST_ARCH), error ? error : output);
+        failures += !ok && failures == before;
+        bytecode_free(bc);
+
+        bc = compile(src);
+        use_native(bc, 0, bytecode_native(bc, 0));
+        bytecode_native_blob(bc, 0, CLB_ARCH_AARCH64_LINUX, "\x00\x7c\x1f\x9b\x00\x00\x01\x8b\xc0\x03\x5f\xd6", 12);
+        before = failures;
+        error = run(bc, "67 -28 ", &failures);
+        ok = !error && failures == before && count_op(bc, OP_ASM) == 0;
+        printf("%-4s asm falls back without a blob -> %s\n", ok ? "ok" : "FAIL", error ? error : output);
+        failures += !ok && failures == before;
+
+        bc->natives[0].fallback = -1;
+        error = run(bc, NULL, &failures);
+        ok = error && strstr(error, "and no fallback");
+        printf("%-4s rejects %s\n", ok ? "ok" : "FAIL", error ? error : "nothing");
+        failures += !ok;
+        bytecode_free(bc);
+    }
+
+    // Hand built code the emitter never produces
+    const struct {
+        uint8_t code[20];
+        size_t size;
+        size_t label;           // Offset of address table entry 1, if not 0
+        const char *error;
+    } BROKEN[] = {
+        { { OP_CONSTB, 1, OP_RET },                                       3, 0, "isn't a function" },
+            // Rejected when loading
+        { { OP_ENTER, 0, 0, 0xEE },                                       4, 0, "invalid opcode" },
+        { { OP_ENTER, 0, 0, OP_CONSTD, 1 },                               5, 0, "truncated instruction" },
+        { { OP_ENTER, 0, 0, OP_LOADG, 0, 0, 0, 0 },                       8, 0, "no global 0" },
+        { { OP_ENTER, 0, 0, OP_MATHDD, 40, OP_RET },                      6, 0, "bad operand 40 for mathdd" },
+        { { OP_ENTER, 0, 0, OP_JMP, 7, 0, 0, 0, 0, 0, 0, 0 },             12, 0, "jump to 7" },
+        { { OP_ENTER, 0, 0, OP_ASM, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0, OP_RET }, 15, 0, "no native code #3" },
+            // Rejected by the verifier
+        { { OP_ENTER, 0, 0, OP_POP, OP_RET },                             5, 0, "stack underflow" },
+        { { OP_ENTER, 0, 0, OP_LOADL, 1, 0, OP_RET },                     7, 0, "no local slot 1" },
+        { { OP_ENTER, 0, 0, OP_CONSTB, 1 },                               5, 0, "runs off the end" },
+        { { OP_ENTER, 0, 0, OP_CONSTB, 1, OP_JMP, 0, 0, 0, 0, 0, 0, 0, 0 }, 14, 0, "stack depth is 0 on one path and 1" },
+        { { OP_ENTER, 0, 0, OP_CONSTB, 0, OP_JZ, 1, 0, 0, 0, 0, 0, 0, 0, OP_RET, OP_CONSTB, 1, OP_RETV },
+                                                                          18, 15, "returns both with and without" },
+        { { OP_ENTER, 0, 0, OP_CALL, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, OP_RET }, 15, 0, "call expects 1 results" },
+        { { OP_ENTER, 0, 0, OP_CONSTB, 1, OP_POP, OP_ENTER, 0, 0, OP_RET }, 10, 6, "runs into another function" },
+    };
+    for (size_t i = 0; i < sizeof(BROKEN) / sizeof(BROKEN[0]); ++i) {
+        ClaspBytecode *bc = bytecode_new();
+        bc->start = bytecode_label(bc);
+        bytecode_place(bc, bc->start);
+        for (size_t j = 0; j < BROKEN[i].size; ++j) cvector_push_back(bc->code, BROKEN[i].code[j]);
+        if (BROKEN[i].label) {
+            uint64_t label = bytecode_label(bc); // Grows the address table, so it can move
+            bc->atable[label] = BROKEN[i].label;
+        }
+        const char *error = run(bc, NULL, &failures);
+        bool ok = error && strstr(error, BROKEN[i].error);
+        printf("%-4s rejects %s\n", ok ? "ok" : "FAIL", error ? error : "nothing");
+        failures += !ok;
+        bytecode_free(bc);
+    }
+
+    fflush(stdout);
+    assert(failures == 0);
+    return 0;
+}
@@ -0,0 +1,100 @@
+/**
+ * Clasp fused AST walker test
+ * Authored 10/18/2026-present
+ * 
+ * This program is part of the Clasp Test Suite
+ * 
+ * Copyright (c) 2024, Frederick Ziola
+ *                      frederick.ziola@gmail.com
+ * 
+ * SPDX-License-Identifier: GPL-3.0
+ * 
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <clasp/lexer.h>
+#include <clasp/parser.h>
+#include <clasp/walk.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+typedef struct {
+    char *data;
+    unsigned int idx;
+} StringStream;
+
+StringStream str;
+
+char read_string() {
+    if (str.idx == strlen(str.data)) return EOF;
+    return str.data[str.idx++];
+}
+
+// Records the order hooks were called in, to check pre/post ordering between passes.
+typedef struct {
+    char log[4096];
+    char tag;
+} Trace;
+
+static void *trace_pre(ClaspASTNode *node, void *args) {
+    Trace *t = args;
+    size_t len = strlen(t->log);
+    t->log[len] = t->tag;
+    t->log[len + 1] = '\0';
+    return NULL;
+}
+
+static void *trace_post(ClaspASTNode *node, void *args) {
+    Trace *t = args;
+    size_t len = strlen(t->log);
+    t->log[len] = t->tag - 'a' + 'A';
+    t->log[len + 1] = '\0';
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    str = (StringStream) { "fn add(a: int, b: int) -> int { return a + b; }\nvar x: int = add(1, 2) * 3;\nwhile (x > 0) { x--; }\n", 0 };
+    ClaspLexer *l = calloc(1, sizeof(ClaspLexer));
+    new_lexer(l, read_string, NULL);
+    ClaspParser *p = malloc(sizeof(ClaspParser));
+    new_parser(p, l);
+    ClaspASTNode *tree = parser_compile(p);
+
+        // Fused stats must match stats collected on their own.
+    ClaspASTStats alone = { 0 }, fused_a = { 0 }, fused_b = { 0 };
+    ClaspASTPass single = ast_stats_pass(&alone);
+    ast_walk(tree, &single, 1);
+
+    ClaspASTPass both[] = { ast_stats_pass(&fused_a), ast_stats_pass(&fused_b) };
+    ast_walk(tree, both, 2);
+    assert(!memcmp(&alone, &fused_a, sizeof(alone)));
+    assert(!memcmp(&alone, &fused_b, sizeof(alone)));
+    assert(alone.depth == 0);
+    assert(alone.counts[AST_FN_DECL_STMT] == 1);
+    assert(alone.counts[AST_WHILE_STMT] == 1);
+    assert(alone.counts[AST_EXPR_POSTFIX] == 1);
+    printf("nodes: %lu, max depth: %u\n", (unsigned long) alone.total, alone.max_depth);
+
+        // Hooks only fire for the node types they're registered for, pre before children, post after.
+    Trace trace = { "", 'a' };
+    ClaspASTVisitor pre  = { [AST_WHILE_STMT] = &trace_pre,  [AST_EXPR_POSTFIX] = &trace_pre  };
+    ClaspASTVisitor post = { [AST_WHILE_STMT] = &trace_post, [AST_EXPR_POSTFIX] = &trace_post };
+    ClaspASTPass traced = { pre, post, &trace };
+    ast_walk(tree, &traced, 1);
+    assert(!strcmp(trace.log, "aaAA"));
+
+    return 0;
+}